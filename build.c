@@ -34,10 +34,34 @@ static const char_t* const sources[] =
 	"./source/lasm/utf8.c",
 	"./source/lasm/token.c",
 	"./source/lasm/lexer.c",
+	"./source/lasm/ir.c",
 	"./source/lasm/ast.c",
+	"./source/lasm/expr.c",
+	"./source/lasm/symtab.c",
+	"./source/lasm/local.c",
+	"./source/lasm/data.c",
+	"./source/lasm/cache.c",
 	"./source/lasm/parser.c",
+	"./source/lasm/fold.c",
+	"./source/lasm/fixup.c",
+	"./source/lasm/relax.c",
+	"./source/lasm/bank.c",
+	"./source/lasm/layout.c",
+	"./source/lasm/segment.c",
+	"./source/lasm/cycles.c",
+	"./source/lasm/elf.c",
+	"./source/lasm/disasm.c",
+	"./source/lasm/archs/z80_names.c",
+	"./source/lasm/archs/z80_isa.c",
 	"./source/lasm/archs/z80_parser.c",
+	"./source/lasm/archs/z80_encoder.c",
+	"./source/lasm/archs/z80_peephole.c",
+	"./source/lasm/archs/z80_disasm.c",
+	"./source/lasm/archs/rl78_names.c",
+	"./source/lasm/archs/rl78_isa.c",
 	"./source/lasm/archs/rl78_parser.c",
+	"./source/lasm/archs/rl78_encoder.c",
+	"./source/lasm/archs/rl78_disasm.c",
 	"./source/main.c",
 };
 
@@ -85,6 +109,15 @@ build_target(docs, "generate the docs for the project.")
 	return status;
 }
 
+build_target(isa, "regenerate the name lookup tables of the architectures from ./source/lasm/archs/archs.isa.")
+{
+	build_command_s command = {0};
+	build_command_append(&command, "python3", "./scripts/gen_isa.py");
+	const bool_t status = build_proc_run_sync(&command);
+	build_vector_drop(&command);
+	return status;
+}
+
 build_target(lint_debug, "lint debug build of the project.")
 {
 	return lint(build_conf_debug);
@@ -100,6 +133,7 @@ build_targets(
 	bind_target(build_debug  ),
 	bind_target(build_release),
 	bind_target(docs         ),
+	bind_target(isa          ),
 	bind_target(lint_debug   ),
 	bind_target(lint_release ),
 );
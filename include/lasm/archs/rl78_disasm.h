@@ -0,0 +1,39 @@
+
+/**
+ * @file rl78_disasm.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-03
+ */
+
+#ifndef __lasm__include__lasm__archs__rl78_disasm_h__
+#define __lasm__include__lasm__archs__rl78_disasm_h__
+
+#include "lasm/common.h"
+#include "lasm/archs/rl78_isa.h"
+
+/**
+ * @brief Write the canonical text of an encoded instruction.
+ * 
+ * @note The form is found through the same encodings table, that the encoder
+ * uses, and the text is written in the syntax, that the parser accepts. The
+ * relative targets are written as their absolute addresses, and the es prefix
+ * is written before the memory operand, that takes it, so the text is encoded
+ * back into the same bytes at the same address.
+ * 
+ * @param inst     bytes of the instruction, with its es prefix, if any
+ * @param length   count of the available bytes
+ * @param addr     address of the instruction
+ * @param buffer   buffer for the text of the instruction
+ * @param capacity capacity of the buffer
+ * 
+ * @return uint8_t (length of the instruction, or 0 if the bytes do not decode
+ * into an instruction)
+ */
+uint8_t rl78_disasm_inst(const uint8_t* const inst, const uint64_t length, const uint64_t addr, char_t* const buffer, const uint64_t capacity);
+
+#endif
@@ -0,0 +1,46 @@
+
+/**
+ * @file rl78_encoder.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-25
+ */
+
+#ifndef __lasm__include__lasm__archs__rl78_encoder_h__
+#define __lasm__include__lasm__archs__rl78_encoder_h__
+
+#include "lasm/common.h"
+#include "lasm/ast.h"
+#include "lasm/relax.h"
+
+/**
+ * @brief Encode the instructions IR of the label into the label's body.
+ * 
+ * @param label label to encode the instructions IR of
+ */
+void rl78_encoder_encode(lasm_ast_label_s* const label);
+
+/**
+ * @brief Get the other form of a relaxable instruction.
+ * 
+ * @note The 'br' and 'call' instructions to labels, that are written without
+ * the explicit addressing (e.g. 'br loop'), are relaxable, and their short
+ * forms are the '$addr20' branch and the '$!addr20' call. The operands, that
+ * are written as plain addresses of labels (e.g. 'mov a, counter'), are
+ * relaxable between their '!addr16', saddr, and sfr forms.
+ * 
+ * @param inst   encoding of the instruction in its current form
+ * @param kind   kind of the relaxable field in the other form
+ * @param length length of the instruction in its current form
+ * @param form   other form of the instruction, with its relaxable field zeroed
+ * 
+ * @return bool_t (false if the instruction has no form with the given kind of
+ * the field)
+ */
+bool_t rl78_encoder_relax(const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form);
+
+#endif
@@ -0,0 +1,271 @@
+
+/**
+ * @file rl78_isa.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#ifndef __lasm__include__lasm__archs__rl78_isa_h__
+#define __lasm__include__lasm__archs__rl78_isa_h__
+
+#include "lasm/common.h"
+#include "lasm/ir.h"
+#include "lasm/cycles.h"
+#include "lasm/archs/rl78_names.h"
+
+// note: the windows of the short direct addressing, and of the special function
+// registers, at the top of the address space.
+#define rl78_isa_saddr_first 0xFFE20
+#define rl78_isa_saddr_last  0xFFF1F
+#define rl78_isa_sfr_first   0xFFF00
+#define rl78_isa_sfr_last    0xFFFFF
+
+#define rl78_isa_es_prefix 0x11
+
+typedef enum
+{
+	rl78_mode_none,     // note: register or immediate operand.
+	rl78_mode_addr,     // note: plain address, that takes the shortest of the fitting forms.
+	rl78_mode_abs16,    // note: !addr16
+	rl78_mode_abs20,    // note: !!addr20
+	rl78_mode_rel8,     // note: $addr20
+	rl78_mode_rel16,    // note: $!addr20
+	rl78_mode_de,       // note: [de]
+	rl78_mode_hl,       // note: [hl]
+	rl78_mode_de_byte,  // note: [de+byte]
+	rl78_mode_hl_byte,  // note: [hl+byte]
+	rl78_mode_sp_byte,  // note: [sp+byte]
+	rl78_mode_hl_b,     // note: [hl+b]
+	rl78_mode_hl_c,     // note: [hl+c]
+	rl78_mode_word_b,   // note: word[b]
+	rl78_mode_word_c,   // note: word[c]
+	rl78_mode_word_bc,  // note: word[bc]
+	rl78_mode_table,    // note: [addr5] of the callt table.
+	rl78_modes_count,
+} rl78_mode_e;
+
+#define rl78_mode_mask     0x3F
+#define rl78_mode_flag_es  0x40  // note: the operand is prefixed with 'es:'.
+#define rl78_mode_flag_bit 0x80  // note: the operand is suffixed with '.bit'.
+
+typedef enum
+{
+	rl78_pattern_none,
+	rl78_pattern_r8,         // note: x, a, c, b, e, d, l, or h, with the codes 0 to 7.
+	rl78_pattern_r8_not_a,   // note: any of the r8 registers, except for a.
+	rl78_pattern_r8_xacb,    // note: x, a, c, or b, with the codes 0 to 3.
+	rl78_pattern_rp,         // note: ax, bc, de, or hl, with the codes 0 to 3.
+	rl78_pattern_rp_not_ax,  // note: bc, de, or hl.
+	rl78_pattern_rb,         // note: rb0, rb1, rb2, or rb3, with the codes 0 to 3.
+	rl78_pattern_x,
+	rl78_pattern_a,
+	rl78_pattern_b,
+	rl78_pattern_c,
+	rl78_pattern_ax,
+	rl78_pattern_bc,
+	rl78_pattern_de,
+	rl78_pattern_hl,
+	rl78_pattern_sp,
+	rl78_pattern_es,
+	rl78_pattern_psw,
+	rl78_pattern_cy,
+	rl78_pattern_imm8,       // note: #byte
+	rl78_pattern_imm16,      // note: #word
+	rl78_pattern_one,        // note: rotation count, that is always 1.
+	rl78_pattern_shift8,     // note: shift count from 1 to 7.
+	rl78_pattern_shift16,    // note: shift count from 1 to 15.
+	rl78_pattern_saddr,
+	rl78_pattern_saddrp,     // note: saddr at an even address.
+	rl78_pattern_sfr,
+	rl78_pattern_sfrp,       // note: sfr at an even address.
+	rl78_pattern_abs16,      // note: !addr16 of the data.
+	rl78_pattern_code16,     // note: !addr16 of the code, in the first 64 KiB.
+	rl78_pattern_abs20,
+	rl78_pattern_rel8,
+	rl78_pattern_rel16,
+	rl78_pattern_ind_de,
+	rl78_pattern_ind_hl,
+	rl78_pattern_de_byte,
+	rl78_pattern_hl_byte,
+	rl78_pattern_sp_byte,
+	rl78_pattern_hl_b,
+	rl78_pattern_hl_c,
+	rl78_pattern_word_b,
+	rl78_pattern_word_c,
+	rl78_pattern_word_bc,
+	rl78_pattern_table,
+	rl78_pattern_a_bit,
+	rl78_pattern_hl_bit,
+	rl78_pattern_saddr_bit,
+	rl78_pattern_sfr_bit,
+	rl78_pattern_abs16_bit,
+	rl78_patterns_count,
+} rl78_pattern_e;
+
+#define rl78_isa_no_shift 0xFF
+
+#define rl78_isa_flag_relax 0x01  // note: the branch has a relative form.
+#define rl78_isa_flag_jump  0x02
+#define rl78_isa_flag_call  0x04
+
+typedef struct
+{
+	uint8_t mnemonic;     // note: rl78_mnemonic_e.
+	uint8_t patterns[2];  // note: rl78_pattern_e of each operand.
+	uint8_t prefix[2];    // note: 0x61, 0x71, 0x31, or 0xCE 0xFB prefix bytes, or 0 for none.
+	uint8_t opcode;
+	uint8_t shifts[2];    // note: bit position of each operand's code in the opcode, or rl78_isa_no_shift.
+	uint8_t flags;
+	uint8_t cycles[2];    // note: clocks of the form, and of its branch, that is not taken.
+} rl78_isa_encoding_s;
+
+extern const rl78_isa_encoding_s rl78_isa_encodings[];
+
+/**
+ * @brief Find the form of the mnemonic, that matches the operands.
+ * 
+ * @note The forms of a mnemonic are tried from the shortest to the longest, so
+ * the plain constant addresses take the saddr and sfr forms, when they are in
+ * those windows, and '[hl+0]' and '[de+0]' take the '[hl]' and '[de]' forms.
+ * The plain symbolic addresses take the saddr forms only when the mnemonic has
+ * no other form for them.
+ * 
+ * @param mnemonic       mnemonic id
+ * @param operands       parsed operands
+ * @param operands_count count of the parsed operands
+ * 
+ * @return uint16_t (index of the form in rl78_isa_encodings, or UINT16_MAX if
+ * none of the forms match)
+ */
+uint16_t rl78_isa_match(const rl78_mnemonic_e mnemonic, const lasm_ir_operand_s* const operands, const uint8_t operands_count);
+
+/**
+ * @brief Find the form of the mnemonic, that takes the patterns.
+ * 
+ * @param mnemonic mnemonic id
+ * @param first    pattern of the first operand
+ * @param second   pattern of the second operand
+ * 
+ * @return uint16_t (index of the form in rl78_isa_encodings, or UINT16_MAX if
+ * the mnemonic has no such form)
+ */
+uint16_t rl78_isa_find_form(const rl78_mnemonic_e mnemonic, const rl78_pattern_e first, const rl78_pattern_e second);
+
+/**
+ * @brief Find the form of an encoded instruction.
+ * 
+ * @param inst   bytes of the instruction, with its es prefix, if any
+ * @param length count of the available bytes
+ * 
+ * @return uint16_t (index of the form in rl78_isa_encodings, or UINT16_MAX if
+ * none of the forms match)
+ */
+uint16_t rl78_isa_decode(const uint8_t* const inst, const uint64_t length);
+
+/**
+ * @brief Get the length of the form's encoding.
+ * 
+ * @param form     index of the form in rl78_isa_encodings
+ * @param extended the encoding has the es prefix
+ * 
+ * @return uint8_t
+ */
+uint8_t rl78_isa_length(const uint16_t form, const bool_t extended);
+
+/**
+ * @brief Get the cycles of an encoded instruction.
+ * 
+ * @note The clocks are of the accesses to the internal ram, as the reads of the
+ * data from the code flash take 4 more clocks.
+ * 
+ * @param inst   bytes of the instruction, with its es prefix, if any
+ * @param length count of the available bytes
+ * @param cost   cycles of the instruction
+ * 
+ * @return bool_t (false, if the bytes do not decode into an instruction)
+ */
+bool_t rl78_isa_cycles(const uint8_t* const inst, const uint64_t length, lasm_cycles_inst_s* const cost);
+
+/**
+ * @brief Get the width of the operand's field, that follows the opcode.
+ * 
+ * @param pattern pattern of the operand
+ * 
+ * @return uint8_t (the width, or 0 if the operand is implied by the opcode)
+ */
+uint8_t rl78_isa_field_width(const rl78_pattern_e pattern);
+
+/**
+ * @brief Get the kind of the direct address field of the pattern.
+ * 
+ * @param pattern pattern of the operand
+ * 
+ * @return lasm_ir_fixup_kind_e (lasm_ir_fixup_kind_lo16 for the !addr16,
+ * lasm_ir_fixup_kind_saddr and lasm_ir_fixup_kind_sfr for the saddr and sfr
+ * patterns, or lasm_ir_fixup_kinds_count for the other patterns)
+ */
+lasm_ir_fixup_kind_e rl78_isa_direct_kind(const rl78_pattern_e pattern);
+
+/**
+ * @brief Find the form of the same mnemonic and the same other operand, which
+ * direct address operand is of the given kind.
+ * 
+ * @param form    index of the form in rl78_isa_encodings
+ * @param operand index of the form's direct address operand
+ * @param kind    kind of the direct address field of the other form
+ * 
+ * @return uint16_t (index of the other form, or UINT16_MAX if the mnemonic has
+ * no such form)
+ */
+uint16_t rl78_isa_direct_form(const uint16_t form, const uint8_t operand, const lasm_ir_fixup_kind_e kind);
+
+/**
+ * @brief Get the code of the operand, that matched the pattern.
+ * 
+ * @note The code is the register's code for the register patterns, the bit
+ * number for the bit patterns, and the count for the shift patterns.
+ * 
+ * @param pattern pattern of the operand
+ * @param operand matched operand
+ * 
+ * @return uint8_t
+ */
+uint8_t rl78_isa_code(const rl78_pattern_e pattern, const lasm_ir_operand_s* const operand);
+
+/**
+ * @brief Get the code of the operand in the opcode of an encoded instruction.
+ * 
+ * @param form    index of the instruction's form in rl78_isa_encodings
+ * @param opcode  opcode of the instruction, without its prefixes
+ * @param operand index of the operand
+ * 
+ * @return uint8_t (0, if the operand has no code in the opcode)
+ */
+uint8_t rl78_isa_operand_code(const uint16_t form, const uint8_t opcode, const uint8_t operand);
+
+/**
+ * @brief Get the address of the special function register, that is written as
+ * a register (e.g. 'psw' or 'sp').
+ * 
+ * @param reg register id
+ * 
+ * @return uint64_t (the address, or 0 if the register is not a special function
+ * register)
+ */
+uint64_t rl78_isa_sfr_reg_addr(const rl78_reg_e reg);
+
+/**
+ * @brief Check if the operand of the pattern may be prefixed with 'es:'.
+ * 
+ * @param pattern pattern of the operand
+ * 
+ * @return bool_t
+ */
+bool_t rl78_isa_accepts_es(const rl78_pattern_e pattern);
+
+#endif
@@ -0,0 +1,177 @@
+
+/**
+ * @file rl78_names.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+// note: this file is generated by './scripts/gen_isa.py' from './source/lasm/archs/archs.isa'.
+// do not edit it by hand!
+
+#ifndef __lasm__include__lasm__archs__rl78_names_h__
+#define __lasm__include__lasm__archs__rl78_names_h__
+
+#include "lasm/common.h"
+
+typedef enum
+{
+	rl78_mnemonic_add,
+	rl78_mnemonic_addc,
+	rl78_mnemonic_addw,
+	rl78_mnemonic_and,
+	rl78_mnemonic_and1,
+	rl78_mnemonic_bc,
+	rl78_mnemonic_bf,
+	rl78_mnemonic_bh,
+	rl78_mnemonic_bnc,
+	rl78_mnemonic_bnh,
+	rl78_mnemonic_bnz,
+	rl78_mnemonic_br,
+	rl78_mnemonic_brk,
+	rl78_mnemonic_bt,
+	rl78_mnemonic_btclr,
+	rl78_mnemonic_bz,
+	rl78_mnemonic_call,
+	rl78_mnemonic_callt,
+	rl78_mnemonic_clr1,
+	rl78_mnemonic_clrb,
+	rl78_mnemonic_clrw,
+	rl78_mnemonic_cmp,
+	rl78_mnemonic_cmp0,
+	rl78_mnemonic_cmps,
+	rl78_mnemonic_cmpw,
+	rl78_mnemonic_dec,
+	rl78_mnemonic_decw,
+	rl78_mnemonic_di,
+	rl78_mnemonic_divhu,
+	rl78_mnemonic_divwu,
+	rl78_mnemonic_ei,
+	rl78_mnemonic_halt,
+	rl78_mnemonic_inc,
+	rl78_mnemonic_incw,
+	rl78_mnemonic_mach,
+	rl78_mnemonic_machu,
+	rl78_mnemonic_mov,
+	rl78_mnemonic_mov1,
+	rl78_mnemonic_movs,
+	rl78_mnemonic_movw,
+	rl78_mnemonic_mulh,
+	rl78_mnemonic_mulhu,
+	rl78_mnemonic_mulu,
+	rl78_mnemonic_nop,
+	rl78_mnemonic_not1,
+	rl78_mnemonic_oneb,
+	rl78_mnemonic_onew,
+	rl78_mnemonic_or,
+	rl78_mnemonic_or1,
+	rl78_mnemonic_pop,
+	rl78_mnemonic_push,
+	rl78_mnemonic_ret,
+	rl78_mnemonic_retb,
+	rl78_mnemonic_reti,
+	rl78_mnemonic_rol,
+	rl78_mnemonic_rolc,
+	rl78_mnemonic_rolwc,
+	rl78_mnemonic_ror,
+	rl78_mnemonic_rorc,
+	rl78_mnemonic_sar,
+	rl78_mnemonic_sarw,
+	rl78_mnemonic_sel,
+	rl78_mnemonic_set1,
+	rl78_mnemonic_shl,
+	rl78_mnemonic_shlw,
+	rl78_mnemonic_shr,
+	rl78_mnemonic_shrw,
+	rl78_mnemonic_skc,
+	rl78_mnemonic_skh,
+	rl78_mnemonic_sknc,
+	rl78_mnemonic_sknh,
+	rl78_mnemonic_sknz,
+	rl78_mnemonic_skz,
+	rl78_mnemonic_stop,
+	rl78_mnemonic_sub,
+	rl78_mnemonic_subc,
+	rl78_mnemonic_subw,
+	rl78_mnemonic_xch,
+	rl78_mnemonic_xchw,
+	rl78_mnemonic_xor,
+	rl78_mnemonic_xor1,
+	rl78_mnemonics_count,
+} rl78_mnemonic_e;
+
+typedef enum
+{
+	rl78_register_x,
+	rl78_register_a,
+	rl78_register_c,
+	rl78_register_b,
+	rl78_register_e,
+	rl78_register_d,
+	rl78_register_l,
+	rl78_register_h,
+	rl78_register_ax,
+	rl78_register_bc,
+	rl78_register_de,
+	rl78_register_hl,
+	rl78_register_sp,
+	rl78_register_psw,
+	rl78_register_cs,
+	rl78_register_es,
+	rl78_register_pmc,
+	rl78_register_mem,
+	rl78_register_cy,
+	rl78_register_rb0,
+	rl78_register_rb1,
+	rl78_register_rb2,
+	rl78_register_rb3,
+	rl78_registers_count,
+} rl78_reg_e;
+
+/**
+ * @brief Find the mnemonic by its name.
+ * 
+ * @note The name is hashed once, and compared with at most one of the
+ * names in the perfect hash table, so the lookup takes a constant time.
+ * 
+ * @param name name of the mnemonic
+ * 
+ * @return rl78_mnemonic_e (rl78_mnemonics_count if not found)
+ */
+rl78_mnemonic_e rl78_isa_find_mnemonic(const char_t* const name);
+
+/**
+ * @brief Get the name of the mnemonic.
+ * 
+ * @param mnemonic mnemonic id
+ * 
+ * @return const char_t*
+ */
+const char_t* rl78_isa_mnemonic_name(const rl78_mnemonic_e mnemonic);
+
+/**
+ * @brief Find the register by its name.
+ * 
+ * @note The name is hashed once, and compared with at most one of the
+ * names in the perfect hash table, so the lookup takes a constant time.
+ * 
+ * @param name name of the register
+ * 
+ * @return rl78_reg_e (rl78_registers_count if not found)
+ */
+rl78_reg_e rl78_isa_find_reg(const char_t* const name);
+
+/**
+ * @brief Get the name of the register.
+ * 
+ * @param reg register id
+ * 
+ * @return const char_t*
+ */
+const char_t* rl78_isa_reg_name(const rl78_reg_e reg);
+
+#endif
@@ -16,7 +16,19 @@
 #include "lasm/common.h"
 #include "lasm/lexer.h"
 #include "lasm/ast.h"
+#include "lasm/archs/rl78_isa.h"
 
+/**
+ * @brief Parse the body tokens of the label into the instructions IR.
+ * 
+ * @note The operands of an instruction are written on the same line as its
+ * mnemonic, and the opcode id of the parsed instruction is the index of its
+ * matching form in the rl78_isa_encodings table.
+ * 
+ * @param lexer  lexer reference
+ * @param labels all labels reference
+ * @param label  label to parse the body tokens of
+ */
 void rl78_parser_parse_tokens(lasm_lexer_s* const lexer, lasm_labels_vector_s* const labels, lasm_ast_label_s* const label);
 
 #endif
@@ -0,0 +1,61 @@
+
+/**
+ * @file z80_encoder.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-25
+ */
+
+#ifndef __lasm__include__lasm__archs__z80_encoder_h__
+#define __lasm__include__lasm__archs__z80_encoder_h__
+
+#include "lasm/common.h"
+#include "lasm/ast.h"
+#include "lasm/relax.h"
+#include "lasm/bank.h"
+
+/**
+ * @brief Encode the instructions IR of the label into the label's body.
+ * 
+ * @param label label to encode the instructions IR of
+ */
+void z80_encoder_encode(lasm_ast_label_s* const label);
+
+/**
+ * @brief Get the other form of a relaxable branch.
+ * 
+ * @note The 'jp' jumps to labels, that are unconditional or use any of the
+ * 'nz', 'z', 'nc', and 'c' conditions, are relaxable, and their short forms
+ * are the matching 'jr' jumps.
+ * 
+ * @param inst   encoding of the branch in its current form
+ * @param kind   kind of the target field in the other form, which is
+ *               lasm_ir_fixup_kind_abs for the long form, and
+ *               lasm_ir_fixup_kind_rel for the short form
+ * @param length length of the branch in its current form
+ * @param form   other form of the branch, with its target field zeroed
+ * 
+ * @return bool_t
+ */
+bool_t z80_encoder_relax(const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form);
+
+/**
+ * @brief Generate the far call trampoline, that calls the target in a bank.
+ * 
+ * @note The trampoline selects the target's bank by writing its number to the
+ * port, and calls the target. When the caller's bank is provided, it is written
+ * back to the port after the target returns. All of the registers, including
+ * the flags, are preserved on the way in and on the way out.
+ * 
+ * @param bank       bank of the target
+ * @param port       port, that selects the bank
+ * @param restore    bank of the caller to select back, or lasm_ast_bank_none
+ * @param trampoline generated trampoline, with the target's field zeroed
+ */
+void z80_encoder_trampoline(const uint64_t bank, const uint64_t port, const uint64_t restore, lasm_bank_trampoline_s* const trampoline);
+
+#endif
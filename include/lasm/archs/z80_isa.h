@@ -0,0 +1,173 @@
+
+/**
+ * @file z80_isa.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#ifndef __lasm__include__lasm__archs__z80_isa_h__
+#define __lasm__include__lasm__archs__z80_isa_h__
+
+#include "lasm/common.h"
+#include "lasm/ir.h"
+#include "lasm/cycles.h"
+#include "lasm/archs/z80_names.h"
+
+// note: register id of the absolute memory operands.
+#define z80_register_none ((z80_reg_e)z80_registers_count)
+
+typedef enum
+{
+	z80_pattern_none,
+	z80_pattern_r8,      // note: b, c, d, e, h, l, (hl), or a, with the codes 0 to 7.
+	z80_pattern_r8_reg,  // note: b, c, d, e, h, l, or a, without (hl).
+	z80_pattern_a,
+	z80_pattern_i,
+	z80_pattern_r,
+	z80_pattern_hl,
+	z80_pattern_de,
+	z80_pattern_sp,
+	z80_pattern_af,
+	z80_pattern_dd,      // note: bc, de, hl, or sp, with the codes 0 to 3.
+	z80_pattern_qq,      // note: bc, de, hl, or af, with the codes 0 to 3.
+	z80_pattern_ind_bc,
+	z80_pattern_ind_de,
+	z80_pattern_ind_hl,  // note: (hl) as the target of a jump, without a displacement.
+	z80_pattern_ind_sp,
+	z80_pattern_ind_c,
+	z80_pattern_ind_nn,  // note: absolute memory address of 16 bits.
+	z80_pattern_ind_n,   // note: absolute port address of 8 bits.
+	z80_pattern_n,
+	z80_pattern_nn,
+	z80_pattern_rel,
+	z80_pattern_cc,
+	z80_pattern_jcc,     // note: nz, z, nc, or c.
+	z80_pattern_bit,
+	z80_pattern_rst,
+	z80_pattern_im,
+	z80_patterns_count,
+} z80_pattern_e;
+
+#define z80_isa_no_shift 0xFF
+
+#define z80_isa_flag_index 0x01  // note: the hl forms have ix and iy variants with the 0xDD and 0xFD prefixes.
+#define z80_isa_flag_relax 0x02  // note: the jump has a relative form.
+#define z80_isa_flag_jump  0x04
+#define z80_isa_flag_call  0x08
+
+typedef struct
+{
+	uint8_t mnemonic;     // note: z80_mnemonic_e.
+	uint8_t patterns[2];  // note: z80_pattern_e of each operand.
+	uint8_t prefix;       // note: 0xCB or 0xED prefix, or 0 for none.
+	uint8_t opcode;
+	uint8_t shifts[2];    // note: bit position of each operand's code in the opcode, or z80_isa_no_shift.
+	uint8_t flags;
+	uint8_t cycles[2];    // note: T-states of the form, and of its (hl) variant for the r8 forms, or of its branch, that is not taken.
+} z80_isa_encoding_s;
+
+extern const z80_isa_encoding_s z80_isa_encodings[];
+
+/**
+ * @brief Check if any form of the mnemonic takes the condition as its first
+ * operand.
+ * 
+ * @param mnemonic mnemonic id
+ * 
+ * @return bool_t
+ */
+bool_t z80_isa_takes_cond(const z80_mnemonic_e mnemonic);
+
+/**
+ * @brief Find the form of the mnemonic, that matches the operands.
+ * 
+ * @note The ix and iy registers, and the (ix+d) and (iy+d) operands, match the
+ * hl and (hl) patterns of the forms, that have the index variants, as long as
+ * only one of the index registers is used, and hl itself is not.
+ * 
+ * @param mnemonic       mnemonic id
+ * @param operands       parsed operands
+ * @param operands_count count of the parsed operands
+ * 
+ * @return uint16_t (index of the form in z80_isa_encodings, or UINT16_MAX if
+ * none of the forms match)
+ */
+uint16_t z80_isa_match(const z80_mnemonic_e mnemonic, const lasm_ir_operand_s* const operands, const uint8_t operands_count);
+
+/**
+ * @brief Find the form of an encoded instruction.
+ * 
+ * @param inst   bytes of the instruction, with its index prefix, if any
+ * @param length count of the available bytes
+ * 
+ * @return uint16_t (index of the form in z80_isa_encodings, or UINT16_MAX if
+ * none of the forms match)
+ */
+uint16_t z80_isa_decode(const uint8_t* const inst, const uint64_t length);
+
+/**
+ * @brief Get the length of an encoded instruction.
+ * 
+ * @param inst bytes of the instruction, with its index prefix, if any
+ * @param form index of the instruction's form in z80_isa_encodings
+ * 
+ * @return uint8_t
+ */
+uint8_t z80_isa_length(const uint8_t* const inst, const uint16_t form);
+
+/**
+ * @brief Get the code of the operand in the opcode of an encoded instruction.
+ * 
+ * @note The code is the register's, or the condition's, code for the register
+ * and the condition patterns, the bit number for the bit pattern, the restart
+ * vector for the rst pattern, and the encoded interrupt mode for the im pattern.
+ * 
+ * @param form    index of the instruction's form in z80_isa_encodings
+ * @param opcode  opcode of the instruction, without its prefixes
+ * @param operand index of the operand
+ * 
+ * @return uint8_t (0, if the operand has no code in the opcode)
+ */
+uint8_t z80_isa_operand_code(const uint16_t form, const uint8_t opcode, const uint8_t operand);
+
+/**
+ * @brief Get the cycles of an encoded instruction.
+ * 
+ * @note The (ix+d) and (iy+d) variants take the T-states of the (hl) variant,
+ * and 12 more, or 8 more for the 0xCB prefixed forms, and the other index
+ * variants take 4 more T-states for their prefix.
+ * 
+ * @param inst   bytes of the instruction, with its index prefix, if any
+ * @param length count of the available bytes
+ * @param cost   cycles of the instruction
+ * 
+ * @return bool_t (false, if the bytes do not decode into an instruction)
+ */
+bool_t z80_isa_cycles(const uint8_t* const inst, const uint64_t length, lasm_cycles_inst_s* const cost);
+
+/**
+ * @brief Get the index register of the operands.
+ * 
+ * @param operands       operands of a matched form
+ * @param operands_count count of the operands
+ * 
+ * @return z80_reg_e (z80_register_ix, z80_register_iy, or z80_register_none)
+ */
+z80_reg_e z80_isa_index_reg(const lasm_ir_operand_s* const operands, const uint8_t operands_count);
+
+/**
+ * @brief Get the code of the register operand, that matched the pattern.
+ * 
+ * @param pattern pattern of the operand
+ * @param operand matched operand
+ * 
+ * @return uint8_t
+ */
+uint8_t z80_isa_reg_code(const z80_pattern_e pattern, const lasm_ir_operand_s* const operand);
+
+#endif
@@ -0,0 +1,190 @@
+
+/**
+ * @file z80_names.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+// note: this file is generated by './scripts/gen_isa.py' from './source/lasm/archs/archs.isa'.
+// do not edit it by hand!
+
+#ifndef __lasm__include__lasm__archs__z80_names_h__
+#define __lasm__include__lasm__archs__z80_names_h__
+
+#include "lasm/common.h"
+
+typedef enum
+{
+	z80_mnemonic_adc,
+	z80_mnemonic_add,
+	z80_mnemonic_and,
+	z80_mnemonic_bit,
+	z80_mnemonic_call,
+	z80_mnemonic_ccf,
+	z80_mnemonic_cp,
+	z80_mnemonic_cpd,
+	z80_mnemonic_cpdr,
+	z80_mnemonic_cpi,
+	z80_mnemonic_cpir,
+	z80_mnemonic_cpl,
+	z80_mnemonic_daa,
+	z80_mnemonic_dec,
+	z80_mnemonic_di,
+	z80_mnemonic_djnz,
+	z80_mnemonic_ei,
+	z80_mnemonic_ex,
+	z80_mnemonic_exx,
+	z80_mnemonic_halt,
+	z80_mnemonic_im,
+	z80_mnemonic_in,
+	z80_mnemonic_inc,
+	z80_mnemonic_ind,
+	z80_mnemonic_indr,
+	z80_mnemonic_ini,
+	z80_mnemonic_inir,
+	z80_mnemonic_jp,
+	z80_mnemonic_jr,
+	z80_mnemonic_ld,
+	z80_mnemonic_ldd,
+	z80_mnemonic_lddr,
+	z80_mnemonic_ldi,
+	z80_mnemonic_ldir,
+	z80_mnemonic_neg,
+	z80_mnemonic_nop,
+	z80_mnemonic_or,
+	z80_mnemonic_otdr,
+	z80_mnemonic_otir,
+	z80_mnemonic_out,
+	z80_mnemonic_outd,
+	z80_mnemonic_outi,
+	z80_mnemonic_pop,
+	z80_mnemonic_push,
+	z80_mnemonic_res,
+	z80_mnemonic_ret,
+	z80_mnemonic_reti,
+	z80_mnemonic_retn,
+	z80_mnemonic_rl,
+	z80_mnemonic_rla,
+	z80_mnemonic_rlc,
+	z80_mnemonic_rlca,
+	z80_mnemonic_rld,
+	z80_mnemonic_rr,
+	z80_mnemonic_rra,
+	z80_mnemonic_rrc,
+	z80_mnemonic_rrca,
+	z80_mnemonic_rrd,
+	z80_mnemonic_rst,
+	z80_mnemonic_sbc,
+	z80_mnemonic_scf,
+	z80_mnemonic_set,
+	z80_mnemonic_sla,
+	z80_mnemonic_sra,
+	z80_mnemonic_srl,
+	z80_mnemonic_sub,
+	z80_mnemonic_xor,
+	z80_mnemonics_count,
+} z80_mnemonic_e;
+
+typedef enum
+{
+	z80_register_a,
+	z80_register_af,
+	z80_register_b,
+	z80_register_bc,
+	z80_register_c,
+	z80_register_d,
+	z80_register_de,
+	z80_register_e,
+	z80_register_h,
+	z80_register_hl,
+	z80_register_i,
+	z80_register_ix,
+	z80_register_iy,
+	z80_register_l,
+	z80_register_r,
+	z80_register_sp,
+	z80_registers_count,
+} z80_reg_e;
+
+typedef enum
+{
+	z80_cond_nz,
+	z80_cond_z,
+	z80_cond_nc,
+	z80_cond_c,
+	z80_cond_po,
+	z80_cond_pe,
+	z80_cond_p,
+	z80_cond_m,
+	z80_conds_count,
+} z80_cond_e;
+
+/**
+ * @brief Find the mnemonic by its name.
+ * 
+ * @note The name is hashed once, and compared with at most one of the
+ * names in the perfect hash table, so the lookup takes a constant time.
+ * 
+ * @param name name of the mnemonic
+ * 
+ * @return z80_mnemonic_e (z80_mnemonics_count if not found)
+ */
+z80_mnemonic_e z80_isa_find_mnemonic(const char_t* const name);
+
+/**
+ * @brief Get the name of the mnemonic.
+ * 
+ * @param mnemonic mnemonic id
+ * 
+ * @return const char_t*
+ */
+const char_t* z80_isa_mnemonic_name(const z80_mnemonic_e mnemonic);
+
+/**
+ * @brief Find the register by its name.
+ * 
+ * @note The name is hashed once, and compared with at most one of the
+ * names in the perfect hash table, so the lookup takes a constant time.
+ * 
+ * @param name name of the register
+ * 
+ * @return z80_reg_e (z80_registers_count if not found)
+ */
+z80_reg_e z80_isa_find_reg(const char_t* const name);
+
+/**
+ * @brief Get the name of the register.
+ * 
+ * @param reg register id
+ * 
+ * @return const char_t*
+ */
+const char_t* z80_isa_reg_name(const z80_reg_e reg);
+
+/**
+ * @brief Find the condition by its name.
+ * 
+ * @note The name is hashed once, and compared with at most one of the
+ * names in the perfect hash table, so the lookup takes a constant time.
+ * 
+ * @param name name of the condition
+ * 
+ * @return z80_cond_e (z80_conds_count if not found)
+ */
+z80_cond_e z80_isa_find_cond(const char_t* const name);
+
+/**
+ * @brief Get the name of the condition.
+ * 
+ * @param cond condition id
+ * 
+ * @return const char_t*
+ */
+const char_t* z80_isa_cond_name(const z80_cond_e cond);
+
+#endif
@@ -0,0 +1,53 @@
+
+/**
+ * @file z80_peephole.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-30
+ */
+
+#ifndef __lasm__include__lasm__archs__z80_peephole_h__
+#define __lasm__include__lasm__archs__z80_peephole_h__
+
+#include "lasm/common.h"
+#include "lasm/config.h"
+#include "lasm/ast.h"
+
+/**
+ * @brief Rewrite the wasteful instruction sequences in the instructions IR of
+ * the label, before the label is encoded.
+ * 
+ * @note The sequences are matched against a table of patterns, and each
+ * rewrite is reported with the location of its first instruction. A pattern
+ * never matches across a local label, and a jump to the local label, that
+ * directly follows it, is removed. A 'call' followed by a 'ret' is kept, when
+ * any of the regions is banked, as the banks of the caller and the callee are
+ * known only after the layout. The result of such a rewrite depends on the
+ * regions, so it is reported, and the label is not cached.
+ * 
+ * @param label  label to rewrite the instructions IR of
+ * @param banked whether any of the declared regions is banked
+ * 
+ * @return bool_t
+ */
+bool_t z80_peephole_rewrite(lasm_ast_label_s* const label, const bool_t banked);
+
+/**
+ * @brief Remove the 'jp' jumps, that end the labels' bodies, and target the
+ * labels, which are placed right after them.
+ * 
+ * @note The jumps are found through their fixups, so the cached bodies are
+ * rewritten as well. A label is known to be placed right after the previous
+ * one only when it continues the previous label's region with an alignment of
+ * 1, and when the labels are neither packed nor folded.
+ * 
+ * @param config build config
+ * @param labels labels with bound fixups, before the layout
+ */
+void z80_peephole_fallthrough(const lasm_config_build_s* const config, lasm_labels_vector_s* const labels);
+
+#endif
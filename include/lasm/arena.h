@@ -44,8 +44,27 @@ typedef struct
 {
 	lasm_arena_node_s* begin;
 	lasm_arena_node_s* end;
+	uint64_t size;
 } lasm_arena_s;
 
+typedef struct
+{
+	uint64_t live;
+	uint64_t peak;
+	uint64_t total;
+} lasm_arena_stats_s;
+
+/**
+ * @brief Get the memory statistics of all arenas.
+ * 
+ * @note The statistics include the sizes of arena nodes themselves. The live
+ * bytes are the bytes, that are currently allocated, the peak bytes are the
+ * highest live bytes so far, and the total bytes are all bytes ever allocated.
+ * 
+ * @return lasm_arena_stats_s
+ */
+lasm_arena_stats_s lasm_arena_stats(void);
+
 /**
  * @brief Create arena object.
  * 
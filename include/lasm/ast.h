@@ -16,15 +16,63 @@
 #include "lasm/common.h"
 #include "lasm/vector.h"
 #include "lasm/token.h"
+#include "lasm/ir.h"
 
 lasm_define_vector_type(lasm_bytes_vector, uint8_t);
 
+typedef enum
+{
+	lasm_ast_expr_type_uval,
+	lasm_ast_expr_type_symbol,
+	lasm_ast_expr_type_sizeof,
+	lasm_ast_expr_type_addrof,
+	lasm_ast_expr_type_unary,
+	lasm_ast_expr_type_binary,
+} lasm_ast_expr_type_e;
+
+typedef struct lasm_ast_expr_s lasm_ast_expr_s;
+
+struct lasm_ast_expr_s
+{
+	lasm_ast_expr_type_e type;
+	lasm_location_s location;
+	bool_t folded;
+	bool_t visiting;
+	uint64_t value;
+
+	union
+	{
+		uint64_t uval;
+
+		struct
+		{
+			const char_t* name;
+			uint64_t length;
+		} symbol;
+
+		struct
+		{
+			lasm_token_type_e op;
+			lasm_ast_expr_s* operand;
+		} unary;
+
+		struct
+		{
+			lasm_token_type_e op;
+			lasm_ast_expr_s* left;
+			lasm_ast_expr_s* right;
+		} binary;
+	} as;
+};
+
 typedef enum
 {
 	lasm_ast_attr_type_addr,
 	lasm_ast_attr_type_align,
 	lasm_ast_attr_type_size,
 	lasm_ast_attr_type_perm,
+	lasm_ast_attr_type_region,
+	lasm_ast_attr_type_cycles,
 	lasm_ast_attr_types_count,
 } lasm_ast_attr_type_e;
 
@@ -59,10 +107,27 @@ typedef struct
 	lasm_ast_perm_type_e value;
 } lasm_ast_attr_perm_s;
 
+#define lasm_ast_region_none ((uint64_t)-1)
+
+#define lasm_ast_bank_none ((uint64_t)-1)
+
+typedef struct
+{
+	uint64_t value;  // note: index of the region, or lasm_ast_region_none.
+	const char_t* name;
+	uint64_t bank;   // note: bank of the region, or lasm_ast_bank_none.
+} lasm_ast_attr_region_s;
+
+typedef struct
+{
+	uint64_t value;  // note: budget of the worst case cycles of the label.
+} lasm_ast_attr_cycles_s;
+
 typedef struct
 {
 	lasm_ast_attr_type_e type;
 	bool_t inferred;
+	lasm_ast_expr_s* expr;
 
 	union
 	{
@@ -70,20 +135,158 @@ typedef struct
 		lasm_ast_attr_align_s align;
 		lasm_ast_attr_size_s size;
 		lasm_ast_attr_perm_s perm;
+		lasm_ast_attr_region_s region;
+		lasm_ast_attr_cycles_s cycles;
 	} as;
 } lasm_ast_attr_s;
 
+#define lasm_ast_label_none ((uint64_t)-1)
+
+typedef struct
+{
+	lasm_location_s location;
+	lasm_ir_fixup_kind_e kind;
+	uint8_t width;         // note: width of the patched field in bytes.
+	uint8_t field_offset;  // note: offset of the patched field within its instruction.
+	bool_t relax;          // note: the field belongs to an instruction, that has a short and a long form.
+	lasm_ir_flow_e flow;   // note: control transfer, that the field is the target of.
+	uint64_t offset;       // note: offset of the patched field within the label's body.
+	const char_t* symbol;  // note: name of the target label, or an empty string for a constant target.
+	uint64_t symbol_length;
+	uint64_t addend;
+	uint64_t label;        // note: index of the label, that owns the field, bound by the deep parse.
+	uint64_t target;       // note: index of the target label, bound by the deep parse.
+	uint64_t local;        // note: index of the target's local label, or lasm_ast_label_none.
+} lasm_ast_fixup_s;
+
+lasm_define_vector_type(lasm_fixups_vector, lasm_ast_fixup_s);
+
+typedef struct
+{
+	lasm_location_s location;
+	const char_t* name;    // note: name of the local label with its leading dot, or NULL for a cached label.
+	uint64_t length;
+	uint64_t inst;         // note: index of the instruction, that the local label precedes.
+	uint64_t offset;       // note: offset of the local label within the label's body.
+} lasm_ast_local_s;
+
+lasm_define_vector_type(lasm_locals_vector, lasm_ast_local_s);
+
+typedef enum
+{
+	lasm_ast_data_type_bytes,
+	lasm_ast_data_type_words,
+	lasm_ast_data_type_dwords,
+	lasm_ast_data_type_fill,
+	lasm_ast_data_type_incbin,
+	lasm_ast_data_types_count,
+} lasm_ast_data_type_e;
+
+typedef struct
+{
+	uint64_t offset;       // note: offset of the value within the directive's bytes.
+	lasm_ast_expr_s* expr;
+} lasm_ast_data_value_s;
+
+lasm_define_vector_type(lasm_data_values_vector, lasm_ast_data_value_s);
+
+typedef struct
+{
+	lasm_location_s location;
+	lasm_ast_data_type_e type;
+	uint8_t width;                    // note: width of each of the values in bytes.
+	lasm_bytes_vector_s bytes;        // note: bytes of the values, with the symbolic values left zeroed.
+	lasm_data_values_vector_s values; // note: symbolic values, that are patched through the fixups.
+	uint64_t length;                  // note: count of the filled or included bytes.
+	uint8_t fill;                     // note: value of the filled bytes.
+	const char_t* path;               // note: path of the included file.
+	uint64_t offset;                  // note: offset of the included bytes within the file.
+} lasm_ast_data_s;
+
+lasm_define_vector_type(lasm_data_vector, lasm_ast_data_s);
+
+typedef struct
+{
+	lasm_location_s location;
+	const char_t* path;  // note: path of the included file, or NULL, when the body does not end with one.
+	uint64_t offset;     // note: offset of the included bytes within the file.
+	uint64_t length;     // note: count of the included bytes.
+} lasm_ast_blob_s;
+
 typedef struct
 {
 	lasm_location_s location;
 	lasm_ast_attr_s attrs[lasm_ast_attr_types_count];
 	const char_t* name;
+	uint64_t fingerprint;
 	lasm_tokens_vector_s body_tokens;
+	lasm_ir_insts_vector_s ir;
 	lasm_bytes_vector_s body;
+	lasm_fixups_vector_s fixups;  // note: fields of the body, that are patched with the addresses of other labels.
+	lasm_locals_vector_s locals;  // note: local labels of the body, ordered by their offsets.
+	lasm_data_vector_s data;      // note: data directives of the body, that are encoded in bulk.
+	lasm_ast_blob_s blob;         // note: included bytes, that follow the body, and that are written straight from their file.
+	bool_t cached;
+	bool_t strings;        // note: the body consists only of string literals.
+	bool_t symbolic;       // note: the body has symbolic operands, that depend on the layout.
+	bool_t transient;      // note: the body depends on the declared regions, so it is not stored in the cache.
+	uint64_t alias;        // note: index of the label, that this label is folded into, or lasm_ast_label_none.
+	uint64_t alias_offset; // note: offset of this label's body within the body of its alias.
 } lasm_ast_label_s;
 
+/**
+ * @brief Stringify label.
+ * 
+ * @note The attributes are stringified with their values, so the labels must
+ * be laid out before they get stringified.
+ * 
+ * @warning This function uses a static internal buffer for stringified labels.
+ * Use returned reference before calling this function again, as with each call
+ * the internal buffer gets modified.
+ * 
+ * @param label label to stringify
+ * 
+ * @return const char_t*
+ */
 const char_t* lasm_ast_label_to_string(const lasm_ast_label_s* const label);
 
+/**
+ * @brief Get the length of the label's body, including the included bytes,
+ * that follow it.
+ * 
+ * @note The included bytes at the end of a body are never copied into the
+ * body, so the length of the body alone does not cover them.
+ * 
+ * @param label label reference
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_ast_label_length(const lasm_ast_label_s* const label);
+
 lasm_define_vector_type(lasm_labels_vector, lasm_ast_label_s);
 
+typedef struct
+{
+	lasm_location_s location;
+	const char_t* name;
+	uint64_t origin;
+	uint64_t length;
+	lasm_ast_perm_type_e perm;
+	uint64_t bank;  // note: number of the bank, that the region's window maps, or lasm_ast_bank_none.
+	uint64_t port;  // note: port, that selects the bank of the region's window.
+} lasm_ast_region_s;
+
+/**
+ * @brief Check if the permissions of a region allow placing a label with
+ * provided permissions in it.
+ * 
+ * @param region permissions of the region
+ * @param label  permissions of the label
+ * 
+ * @return bool_t
+ */
+bool_t lasm_ast_perm_type_allows(const lasm_ast_perm_type_e region, const lasm_ast_perm_type_e label);
+
+lasm_define_vector_type(lasm_regions_vector, lasm_ast_region_s);
+
 #endif
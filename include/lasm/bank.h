@@ -0,0 +1,53 @@
+
+/**
+ * @file bank.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#ifndef __lasm__include__lasm__bank_h__
+#define __lasm__include__lasm__bank_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/config.h"
+#include "lasm/ast.h"
+
+#define lasm_bank_trampoline_capacity 16
+
+typedef struct
+{
+	uint8_t bytes[lasm_bank_trampoline_capacity];
+	uint8_t length;
+	uint8_t field_offset;  // note: offset of the target's absolute address field.
+} lasm_bank_trampoline_s;
+
+/**
+ * @brief Route the calls between the banks through far call trampolines, and
+ * check, that no jump crosses the banks.
+ * 
+ * @note The bank of a label is the bank of its region, so it is known before
+ * the layout: a label with an inferred address and region continues the region
+ * of the previous label, and a label with an explicit address is never placed
+ * into a banked region, unless it names the region.
+ * 
+ * @note A call from a label to a label in another bank is redirected to a
+ * trampoline, that selects the target's bank, calls the target, and selects
+ * the caller's bank again before returning, when both banks are selected with
+ * the same port. The trampolines are generated only for the targets, that are
+ * called across the banks, shared by all of the callers from the same bank,
+ * and placed at the end of the first executable region, that is not banked.
+ * 
+ * @param arena   arena reference
+ * @param config  build config reference
+ * @param labels  labels with bound fixups
+ * @param regions declared memory regions
+ */
+void lasm_banks_route(lasm_arena_s* const arena, const lasm_config_build_s* const config, lasm_labels_vector_s* const labels, const lasm_regions_vector_s* const regions);
+
+#endif
@@ -0,0 +1,78 @@
+
+/**
+ * @file cache.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-23
+ */
+
+#ifndef __lasm__include__lasm__cache_h__
+#define __lasm__include__lasm__cache_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/config.h"
+#include "lasm/ast.h"
+
+typedef struct
+{
+	uint64_t fingerprint;
+	bool_t symbolic;
+	lasm_bytes_vector_s body;
+	lasm_fixups_vector_s fixups;  // note: unbound fixups of the body, which locations have no file.
+	lasm_locals_vector_s locals;  // note: offsets of the local labels of the body.
+	lasm_ast_blob_s blob;         // note: included bytes, that follow the body, which location has no file.
+} lasm_cache_entry_s;
+
+lasm_define_vector_type(lasm_cache_entries_vector, lasm_cache_entry_s);
+
+typedef struct
+{
+	lasm_arena_s* arena;
+	lasm_config_build_s* config;
+	const char_t* path;
+	lasm_cache_entries_vector_s entries;
+	uint64_t hits;
+	uint64_t misses;
+} lasm_cache_s;
+
+/**
+ * @brief Load the encoding cache that belongs to the build's output.
+ * 
+ * @note The cache lives next to the output file with a '.cache' extension. A
+ * missing, corrupted or incompatible (e.g. different architecture) cache file
+ * results in an empty cache.
+ * 
+ * @param arena  arena reference
+ * @param config build config reference
+ * 
+ * @return lasm_cache_s
+ */
+lasm_cache_s lasm_cache_load(lasm_arena_s* const arena, lasm_config_build_s* const config);
+
+/**
+ * @brief Find the cached body for a label with provided fingerprint.
+ * 
+ * @param cache       cache reference
+ * @param fingerprint fingerprint of the label's header and body tokens
+ * 
+ * @return const lasm_cache_entry_s*
+ */
+const lasm_cache_entry_s* lasm_cache_find(lasm_cache_s* const cache, const uint64_t fingerprint);
+
+/**
+ * @brief Store the fingerprints and the encoded bodies of the labels.
+ * 
+ * @note The transient labels are left out, so they are encoded again by the
+ * next build.
+ * 
+ * @param cache  cache reference
+ * @param labels labels to store
+ */
+void lasm_cache_store(lasm_cache_s* const cache, const lasm_labels_vector_s* const labels);
+
+#endif
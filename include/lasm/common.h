@@ -129,4 +129,20 @@ int32_t lasm_common_strncmp(const char_t* const left, const char_t* const right,
  */
 char_t* lasm_common_strchr(const char_t* const string, const int32_t c) __attribute__((warn_unused_result));
 
+#define lasm_common_hash_seed ((uint64_t)0xCBF29CE484222325)
+
+/**
+ * @brief Hash a memory region with the fnv-1a 64 bit hash function.
+ * 
+ * @note The seed allows chaining multiple memory regions into one hash. Start
+ * the chain with the @ref lasm_common_hash_seed value.
+ * 
+ * @param seed   hash to continue from
+ * @param data   pointer to the memory region to hash
+ * @param length length of the memory region
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_common_hash(const uint64_t seed, const void* const data, const uint64_t length) __attribute__((warn_unused_result));
+
 #endif
@@ -40,9 +40,6 @@ typedef enum
 	lasm_format_type_elf,
 	lasm_format_type_elf32,
 	lasm_format_type_elf64,
-	lasm_format_type_pe,
-	lasm_format_type_pe32,
-	lasm_format_type_pe32plus,
 	lasm_format_types_count,
 	lasm_format_type_none,
 } lasm_format_type_e;
@@ -53,6 +50,7 @@ typedef enum
 {
 	lasm_config_type_init,
 	lasm_config_type_build,
+	lasm_config_type_disasm,
 	lasm_config_types_count,
 } lasm_config_type_e;
 
@@ -69,8 +67,25 @@ typedef struct
 	const char_t* entry;
 	const char_t* output;
 	const char_t* source;
+	bool_t cache;
+	bool_t stats;
+	bool_t pack;
+	bool_t fold;
+	bool_t pool;
+	bool_t relax;
+	bool_t peephole;
+	bool_t cycles;
 } lasm_config_build_s;
 
+typedef struct
+{
+	lasm_arch_type_e arch;
+	const char_t* output;
+	const char_t* source;  // note: source file to assemble, when it ends with '.lasm', or the raw image.
+	uint64_t base;         // note: load address of the raw image.
+	bool_t round_trip;
+} lasm_config_disasm_s;
+
 typedef struct
 {
 	lasm_config_type_e type;
@@ -79,6 +94,7 @@ typedef struct
 	{
 		lasm_config_init_s init;
 		lasm_config_build_s build;
+		lasm_config_disasm_s disasm;
 	} as;
 } lasm_config_s;
 
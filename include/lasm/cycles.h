@@ -0,0 +1,53 @@
+
+/**
+ * @file cycles.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-31
+ */
+
+#ifndef __lasm__include__lasm__cycles_h__
+#define __lasm__include__lasm__cycles_h__
+
+#include "lasm/common.h"
+#include "lasm/config.h"
+#include "lasm/ast.h"
+
+typedef enum
+{
+	lasm_cycles_end_none,    // note: the instruction falls through to the next one.
+	lasm_cycles_end_branch,  // note: the instruction ends a basic block, and may fall through to the next one.
+	lasm_cycles_end_exit,    // note: the instruction ends a basic block, and never falls through.
+	lasm_cycles_end_skip,    // note: the instruction ends a basic block, and may skip the next instruction.
+	lasm_cycles_ends_count,
+} lasm_cycles_end_e;
+
+typedef struct
+{
+	uint8_t length;          // note: length of the instruction in bytes.
+	uint16_t taken;          // note: cycles when the branch is taken, the block repeats, or the conditional call is made.
+	uint16_t not_taken;      // note: cycles otherwise, which are equal to the taken ones for the other instructions.
+	lasm_cycles_end_e end;
+} lasm_cycles_inst_s;
+
+/**
+ * @brief Count the cycles of the executable labels, print the report of their
+ * basic blocks, and verify the budgets of the labels.
+ * 
+ * @note The straight line path of a label runs from its first instruction up
+ * to the first instruction, that never falls through, or up to the end of its
+ * body, and it may leave earlier through any of the taken branches. The best
+ * and the worst cases are the cheapest and the most expensive of these ways,
+ * and the calls are counted without the cycles of their targets. The labels,
+ * that have the 'cycles' attribute, must not exceed it in the worst case.
+ * 
+ * @param config configuration of the build
+ * @param labels laid out labels with applied fixups
+ */
+void lasm_cycles_check(const lasm_config_build_s* const config, const lasm_labels_vector_s* const labels);
+
+#endif
@@ -0,0 +1,69 @@
+
+/**
+ * @file data.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-02
+ */
+
+#ifndef __lasm__include__lasm__data_h__
+#define __lasm__include__lasm__data_h__
+
+#include "lasm/common.h"
+#include "lasm/lexer.h"
+#include "lasm/ast.h"
+
+/**
+ * @brief Parse the data directive at the index of the label's body tokens, if
+ * there is one.
+ * 
+ * @note The data directives take the place of the instructions' mnemonics:
+ * 'bytes', 'words', and 'dwords' take comma separated values (and string
+ * literals for 'bytes'), 'fill' takes a count and an optional byte value,
+ * 'space' takes a count of zeroed bytes, and 'incbin' takes a path of a file
+ * with an optional offset and length of its bytes. The parsed directive is
+ * appended to the label's instructions IR with the lasm_ir_opcode_data opcode.
+ * 
+ * @param lexer lexer reference
+ * @param label label, that owns the body tokens
+ * @param index index of the body token to parse, advanced past the directive
+ * 
+ * @return bool_t
+ */
+bool_t lasm_data_parse(lasm_lexer_s* const lexer, lasm_ast_label_s* const label, uint64_t* const index);
+
+/**
+ * @brief Append the bytes of the data directive to the label's body, and record
+ * the fixups of its symbolic values.
+ * 
+ * @note The bytes are appended in bulk: the values are copied, the filled bytes
+ * are set, and the included bytes are read from their file straight into the
+ * label's body. The included bytes, that end the body, are not read at all, and
+ * they are recorded as the label's blob instead.
+ * 
+ * @param label label, that owns the data directive
+ * @param inst  instruction of the data directive
+ */
+void lasm_data_encode(lasm_ast_label_s* const label, lasm_ir_inst_s* const inst);
+
+/**
+ * @brief Fold the sizes, the inodes, and the modification times of the files,
+ * that the label's body includes, into the label's fingerprint, along with the
+ * bytes of the files, that are included in the middle of the body.
+ * 
+ * @note The included bytes are not part of the body tokens, so without them a
+ * cached body would outlive the changes of its included files.
+ * 
+ * @param arena       arena reference
+ * @param label       label, that owns the body tokens
+ * @param fingerprint fingerprint of the label's tokens
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_data_fingerprint(lasm_arena_s* const arena, const lasm_ast_label_s* const label, const uint64_t fingerprint);
+
+#endif
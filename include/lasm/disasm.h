@@ -0,0 +1,77 @@
+
+/**
+ * @file disasm.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-03
+ */
+
+#ifndef __lasm__include__lasm__disasm_h__
+#define __lasm__include__lasm__disasm_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/config.h"
+#include "lasm/ast.h"
+
+typedef struct
+{
+	uint64_t labels;  // note: count of the written labels.
+	uint64_t insts;   // note: count of the decoded instructions.
+	uint64_t bytes;   // note: count of the bytes, that are written as data.
+} lasm_disasm_stats_s;
+
+/**
+ * @brief Read the raw image into a single executable label, that is loaded at
+ * the base address.
+ * 
+ * @param arena  arena reference
+ * @param config disasm config reference
+ * 
+ * @return lasm_labels_vector_s
+ */
+lasm_labels_vector_s lasm_disasm_read_image(lasm_arena_s* const arena, const lasm_config_disasm_s* const config);
+
+/**
+ * @brief Write the bodies of the labels back as a source file, that assembles
+ * into the same bytes at the same addresses.
+ * 
+ * @note Each label is written with its address, size, permissions, and region,
+ * and the regions are written before the labels. The instructions of the
+ * executable labels are decoded through the same encodings tables, that the
+ * encoders use, and the bytes, that do not decode, are written as 'bytes'
+ * directives. The instructions IR of an assembled label keeps the boundaries of
+ * its instructions and data directives, so the data in the middle of the code
+ * is never decoded as instructions. Labels without the IR, such as raw images,
+ * are decoded from their first byte on.
+ * 
+ * @note Folded labels, and labels without bodies, are not written.
+ * 
+ * @param arena   arena reference
+ * @param config  disasm config reference
+ * @param labels  assembled labels, or the label of the raw image
+ * @param regions declared regions
+ * 
+ * @return lasm_disasm_stats_s
+ */
+lasm_disasm_stats_s lasm_disasm_write(lasm_arena_s* const arena, const lasm_config_disasm_s* const config, const lasm_labels_vector_s* const labels, const lasm_regions_vector_s* const regions);
+
+/**
+ * @brief Compare the bodies of the labels with the bodies of the reassembled
+ * labels, and report the first mismatching byte of each label.
+ * 
+ * @note The mismatches are reported at the lines of the disassembly, that
+ * were encoded into the mismatching bytes.
+ * 
+ * @param labels      labels, that were written by lasm_disasm_write
+ * @param reassembled labels, that were assembled from the written source file
+ * 
+ * @return uint64_t (count of the mismatching labels)
+ */
+uint64_t lasm_disasm_compare(const lasm_labels_vector_s* const labels, const lasm_labels_vector_s* const reassembled);
+
+#endif
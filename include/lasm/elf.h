@@ -0,0 +1,46 @@
+
+/**
+ * @file elf.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-27
+ */
+
+#ifndef __lasm__include__lasm__elf_h__
+#define __lasm__include__lasm__elf_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/config.h"
+#include "lasm/ast.h"
+#include "lasm/segment.h"
+
+/**
+ * @brief Write the segments of the labels into an ELF executable file at the
+ * build's output path.
+ * 
+ * @note Each segment is written as a single loadable program header, so the
+ * number of program headers is the number of segments. The 'elf' format is
+ * written as ELF32, as all of the supported architectures have 32 bit (or
+ * narrower) address spaces.
+ * 
+ * @note The physical address of a segment in a banked region is its address
+ * with the bank number above the low 16 bits, e.g. 0x14000 for bank 1.
+ * 
+ * @note The segments are streamed label by label, and the included bytes at
+ * the ends of the bodies are sent straight from their files with sendfile, or
+ * written from mappings of the files, when the kernel cannot send them.
+ * 
+ * @param arena    arena reference
+ * @param config   build config reference
+ * @param labels   laid out and verified labels
+ * @param segments segments of the labels
+ * @param entry    address of the entry label
+ */
+void lasm_elf_write(lasm_arena_s* const arena, const lasm_config_build_s* const config, const lasm_labels_vector_s* const labels, const lasm_segments_s* const segments, const uint64_t entry);
+
+#endif
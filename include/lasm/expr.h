@@ -0,0 +1,74 @@
+
+/**
+ * @file expr.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-24
+ */
+
+#ifndef __lasm__include__lasm__expr_h__
+#define __lasm__include__lasm__expr_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/token.h"
+#include "lasm/ast.h"
+
+typedef uint64_t (*lasm_expr_resolve_f)(void* const context, const lasm_ast_expr_s* const expr);
+
+typedef struct
+{
+	void* context;
+	lasm_expr_resolve_f resolve;
+} lasm_expr_resolver_s;
+
+/**
+ * @brief Parse an integer expression from the tokens, starting at the index.
+ * 
+ * @note Supported operators, from the lowest to the highest precedence, are
+ * '|', '^', '&', '<<' and '>>', '+' and '-', and unary '-' and '~'. Operands
+ * are numeric and rune literals, label identifiers (address of the label),
+ * 'sizeof(label)', 'addrof(label)', and parenthesised expressions.
+ * 
+ * @note Subexpressions, that do not reference any labels, are folded while
+ * parsing.
+ * 
+ * @param arena  arena reference
+ * @param tokens tokens to parse the expression from
+ * @param index  index of the first token, gets advanced past the expression
+ * 
+ * @return lasm_ast_expr_s*
+ */
+lasm_ast_expr_s* lasm_expr_parse(lasm_arena_s* const arena, const lasm_tokens_vector_s* const tokens, uint64_t* const index);
+
+/**
+ * @brief Evaluate an expression.
+ * 
+ * @note Label references are resolved with the resolver. The result of each
+ * evaluated node is memoised in the node, so evaluating the same expression
+ * again does not resolve its labels again.
+ * 
+ * @param expr     expression reference
+ * @param resolver resolver for label references
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_expr_eval(lasm_ast_expr_s* const expr, const lasm_expr_resolver_s* const resolver);
+
+/**
+ * @brief Forget the memoised results of the expression's nodes, that depend on
+ * label references, so the next evaluation resolves them again.
+ * 
+ * @note The constant nodes, that were folded while parsing, are kept folded.
+ * 
+ * @param expr expression reference
+ * 
+ * @return bool_t
+ */
+bool_t lasm_expr_unfold(lasm_ast_expr_s* const expr);
+
+#endif
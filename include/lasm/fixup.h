@@ -0,0 +1,105 @@
+
+/**
+ * @file fixup.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#ifndef __lasm__include__lasm__fixup_h__
+#define __lasm__include__lasm__fixup_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/ir.h"
+#include "lasm/ast.h"
+#include "lasm/symtab.h"
+
+/**
+ * @brief Record the fixups of the symbolic operands of an encoded instruction.
+ * 
+ * @note Encoders call this function after they append the encoding of the
+ * instruction to the label's body, with the operands' fields left zeroed. The
+ * expression of a symbolic operand must be the address of a label plus or
+ * minus a constant, which is kept as the fixup's addend. Relative fields with
+ * constant targets are recorded as well, without a target label.
+ * 
+ * @param label  label, that owns the instruction
+ * @param inst   encoded instruction reference
+ * @param offset offset of the instruction's encoding within the label's body
+ */
+void lasm_fixups_collect(lasm_ast_label_s* const label, const lasm_ir_inst_s* const inst, const uint64_t offset);
+
+/**
+ * @brief Record the fixup of a symbolic value of a data directive.
+ * 
+ * @note The value is patched with the absolute address of its label plus or
+ * minus a constant, in the same way as a symbolic operand of an instruction.
+ * 
+ * @param label  label, that owns the data directive
+ * @param expr   expression of the value
+ * @param width  width of the value's field in bytes
+ * @param offset offset of the value's field within the label's body
+ */
+void lasm_fixups_collect_value(lasm_ast_label_s* const label, const lasm_ast_expr_s* const expr, const uint8_t width, const uint64_t offset);
+
+/**
+ * @brief Bind the fixups of all labels to the indices of their owning and
+ * target labels.
+ * 
+ * @note The binding happens after all of the labels are parsed, so a fixup may
+ * reference a label defined after the label, that owns it. The fixups of the
+ * cached labels are bound in the same way as the freshly encoded ones.
+ * 
+ * @param labels labels reference
+ * @param symtab symbol table of the labels
+ */
+void lasm_fixups_bind(lasm_labels_vector_s* const labels, const lasm_symtab_s* const symtab);
+
+/**
+ * @brief Patch the fields of all fixups with the addresses of their targets.
+ * 
+ * @note The fixups of all labels are gathered into a single flat array, sorted
+ * by their targets, and then patched in one pass, so the address of each target
+ * is resolved only once. Fields are patched in little endian, and a value, that
+ * does not fit into its field, is reported as an error.
+ * 
+ * @param arena  arena reference
+ * @param labels laid out and verified labels
+ */
+void lasm_fixups_apply(lasm_arena_s* const arena, lasm_labels_vector_s* const labels);
+
+/**
+ * @brief Compute the value of the fixup's field from the current addresses of
+ * the labels.
+ * 
+ * @note The value of a relative field is the distance from the end of the
+ * field to the target, and it is returned in two's complement.
+ * 
+ * @param labels labels reference
+ * @param fixup  bound fixup reference
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_fixup_value(const lasm_labels_vector_s* const labels, const lasm_ast_fixup_s* const fixup);
+
+/**
+ * @brief Check if the value fits into the fixup's field.
+ * 
+ * @note Relative fields are signed, the saddr and sfr fields fit when their
+ * addresses are in the windows of the fields, the rl78 16 bit address fields
+ * fit when their addresses are in the first or the last 64 KiB, and all of the
+ * other fields are unsigned.
+ * 
+ * @param fixup fixup reference
+ * @param value value of the field
+ * 
+ * @return bool_t
+ */
+bool_t lasm_fixup_fits(const lasm_ast_fixup_s* const fixup, const uint64_t value);
+
+#endif
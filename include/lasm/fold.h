@@ -0,0 +1,85 @@
+
+/**
+ * @file fold.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#ifndef __lasm__include__lasm__fold_h__
+#define __lasm__include__lasm__fold_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/ast.h"
+
+typedef struct
+{
+	uint64_t hash;
+	uint64_t index;  // note: index of the label, or lasm_ast_label_none for an empty slot.
+} lasm_fold_slot_s;
+
+typedef struct
+{
+	lasm_labels_vector_s* labels;
+	lasm_fold_slot_s* slots;
+	uint64_t capacity;
+	uint64_t folded;
+	uint64_t saved;
+} lasm_fold_s;
+
+/**
+ * @brief Create a folding table for the labels.
+ * 
+ * @param arena  arena reference
+ * @param labels labels to fold
+ * 
+ * @return lasm_fold_s
+ */
+lasm_fold_s lasm_fold_new(lasm_arena_s* const arena, lasm_labels_vector_s* const labels);
+
+/**
+ * @brief Fold the label into an identical label, that was offered before it.
+ * 
+ * @note Only the labels with inferred addresses, read only permissions, and
+ * non empty bodies, which fixups do not depend on the labels' own addresses,
+ * can be folded. Two labels are identical when their bodies, fixups, sizes,
+ * alignments, permissions and regions are the same, and their fixups target
+ * the same addresses. A label, that has no identical label, is remembered, so
+ * the labels offered after it can be folded into it.
+ * 
+ * @note The alignment, permissions, size and region of the label must already
+ * be resolved, while its address must not be assigned yet. A folded label gets
+ * the index of the label it is folded into as its alias.
+ * 
+ * @param fold  folding table reference
+ * @param index index of the label to fold
+ * 
+ * @return bool_t
+ */
+bool_t lasm_fold_label(lasm_fold_s* const fold, const uint64_t index);
+
+/**
+ * @brief Pool the string labels, so that identical strings, and strings, that
+ * are suffixes of other strings, share the memory of the longer strings.
+ * 
+ * @note Only string labels with inferred addresses, explicit 'r' permissions,
+ * constant alignments and sizes, that match their bodies, are pooled. The
+ * strings are sorted by their reversed bytes, which places every string right
+ * after the strings it is a suffix of, so a single pass over the sorted
+ * strings finds all of the shared suffixes. A pooled label gets the longer
+ * label as its alias, and the offset of its body within the longer label's
+ * body, as long as that offset keeps the pooled label aligned.
+ * 
+ * @param arena  arena reference
+ * @param labels labels to pool
+ * @param pooled count of the pooled labels
+ * @param saved  count of the saved bytes
+ */
+void lasm_fold_pool_strings(lasm_arena_s* const arena, lasm_labels_vector_s* const labels, uint64_t* const pooled, uint64_t* const saved);
+
+#endif
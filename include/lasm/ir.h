@@ -0,0 +1,126 @@
+
+/**
+ * @file ir.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-25
+ */
+
+#ifndef __lasm__include__lasm__ir_h__
+#define __lasm__include__lasm__ir_h__
+
+#include "lasm/common.h"
+#include "lasm/vector.h"
+#include "lasm/token.h"
+
+typedef struct lasm_ast_expr_s lasm_ast_expr_s;
+
+#define lasm_ir_operands_capacity 3
+
+// note: the opcode id of the data directives, that is never a valid index into
+// the encodings tables of the architectures. the index of the directive's data
+// in the label is kept in the value of its first operand.
+#define lasm_ir_opcode_data ((uint16_t)0xFFFE)
+
+typedef enum
+{
+	lasm_ir_operand_type_none,
+	lasm_ir_operand_type_reg,
+	lasm_ir_operand_type_cond,
+	lasm_ir_operand_type_imm,
+	lasm_ir_operand_type_mem,
+	lasm_ir_operand_type_sym,
+} lasm_ir_operand_type_e;
+
+typedef enum
+{
+	lasm_ir_fixup_kind_abs,   // note: absolute address of the target.
+	lasm_ir_fixup_kind_rel,   // note: distance from the end of the field to the target.
+	lasm_ir_fixup_kind_lo,    // note: low byte of the target's address.
+	lasm_ir_fixup_kind_hi,    // note: high byte of the target's address.
+	lasm_ir_fixup_kind_lo16,  // note: low 16 bits of the target's address.
+	lasm_ir_fixup_kind_saddr, // note: low byte of the target's address, that is in the rl78 short direct addressing window.
+	lasm_ir_fixup_kind_sfr,   // note: low byte of the target's address, that is in the rl78 special function registers window.
+	lasm_ir_fixup_kind_size,  // note: size of the target label.
+	lasm_ir_fixup_kinds_count,
+} lasm_ir_fixup_kind_e;
+
+typedef enum
+{
+	lasm_ir_flow_none,  // note: the field is not a target of a control transfer.
+	lasm_ir_flow_jump,  // note: the field is the target of a jump.
+	lasm_ir_flow_call,  // note: the field is the target of a call, that returns back.
+	lasm_ir_flows_count,
+} lasm_ir_flow_e;
+
+typedef struct
+{
+	uint8_t type;          // note: lasm_ir_operand_type_e.
+	uint8_t id;            // note: architecture specific register or condition id.
+	uint8_t mode;          // note: architecture specific addressing mode of the operand.
+	uint8_t bit;           // note: bit number of the operands, that address a single bit.
+	uint8_t fixup_offset;  // note: offset of the operand's field within the encoded instruction.
+	uint8_t fixup_width;   // note: width of the operand's field in bytes, 0 if it has no field.
+	uint8_t fixup_kind;    // note: lasm_ir_fixup_kind_e of the operand's field.
+	uint8_t fixup_relax;   // note: non zero, if the field belongs to an instruction, that has a short and a long form.
+	uint8_t fixup_flow;    // note: lasm_ir_flow_e of the operand's field.
+	uint64_t value;
+	lasm_ast_expr_s* expr; // note: symbolic reference, which gets resolved through the fixup slot.
+} lasm_ir_operand_s;
+
+typedef struct
+{
+	uint16_t opcode;       // note: architecture specific opcode id.
+	uint8_t operands_count;
+	uint32_t size;         // note: size of the encoded instruction in bytes.
+	lasm_location_s location;
+	lasm_ir_operand_s operands[lasm_ir_operands_capacity];
+} lasm_ir_inst_s;
+
+lasm_define_vector_type(lasm_ir_insts_vector, lasm_ir_inst_s);
+
+/**
+ * @brief Create an instruction with provided opcode id and without operands.
+ * 
+ * @param opcode   architecture specific opcode id
+ * @param location location of the instruction's mnemonic
+ * 
+ * @return lasm_ir_inst_s
+ */
+lasm_ir_inst_s lasm_ir_inst_new(const uint16_t opcode, const lasm_location_s location);
+
+/**
+ * @brief Append an operand to the instruction.
+ * 
+ * @param inst    instruction reference
+ * @param operand operand to append
+ */
+void lasm_ir_inst_push_operand(lasm_ir_inst_s* const inst, const lasm_ir_operand_s operand);
+
+/**
+ * @brief Create an operand from an expression.
+ * 
+ * @note Folded expressions become immediate operands, while expressions, that
+ * reference labels, become symbolic operands, resolved through fixup slots.
+ * 
+ * @param type operand type for the folded expression (imm or mem)
+ * @param expr expression reference
+ * 
+ * @return lasm_ir_operand_s
+ */
+lasm_ir_operand_s lasm_ir_operand_from_expr(const lasm_ir_operand_type_e type, lasm_ast_expr_s* const expr);
+
+/**
+ * @brief Check if the operand is a symbolic reference.
+ * 
+ * @param operand operand reference
+ * 
+ * @return bool_t
+ */
+bool_t lasm_ir_operand_is_symbolic(const lasm_ir_operand_s* const operand);
+
+#endif
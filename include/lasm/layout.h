@@ -0,0 +1,75 @@
+
+/**
+ * @file layout.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-26
+ */
+
+#ifndef __lasm__include__lasm__layout_h__
+#define __lasm__include__lasm__layout_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/config.h"
+#include "lasm/ast.h"
+#include "lasm/symtab.h"
+
+/**
+ * @brief Lay out the labels by assigning final values to all of their
+ * attributes in a single forward sweep.
+ * 
+ * @note When packing is enabled in the build config, the labels with inferred
+ * addresses are not placed in the source order. Instead, they are placed into
+ * the free gaps around the labels with explicit addresses, from the largest to
+ * the smallest, each into the first gap it fits into with its alignment. Then
+ * only the labels with explicit addresses can be referenced by an address.
+ * 
+ * @note An inferred address follows the end of the previous label, rounded up
+ * to the label's alignment. An inferred alignment and permissions reuse the
+ * ones of the previous label (1 and 'rwx' for the first label). An inferred
+ * size is the size of the label's body.
+ * 
+ * @note A label with an inferred region continues the region of the previous
+ * label when its address is inferred, or belongs to the region, that contains
+ * its explicit address. Inferred addresses of the labels in a region follow
+ * the end of the previous label in the same region, starting at its origin.
+ * 
+ * @note Attribute expressions are evaluated during the sweep. An expression can
+ * reference the address of a label, that is either placed before, or has an
+ * explicit address.
+ * 
+ * @param arena   arena reference
+ * @param config  build config reference
+ * @param labels  labels to lay out
+ * @param symtab  symbol table of the labels
+ * @param regions declared memory regions
+ */
+void lasm_layout_apply(lasm_arena_s* const arena, const lasm_config_build_s* const config, lasm_labels_vector_s* const labels, const lasm_symtab_s* const symtab, const lasm_regions_vector_s* const regions);
+
+/**
+ * @brief Verify, that the laid out labels do not overlap, that their bodies do
+ * not exceed their sizes, and that they fit into their regions.
+ * 
+ * @note The labels are sorted by their start addresses and swept once, while
+ * the ranges, that are still open, are kept in a min-heap by their end
+ * addresses, so the verification takes O(n log n) time. Every conflicting
+ * pair is reported, and the build is aborted after all of them are reported.
+ * Labels with zero size do not occupy any memory, and are not checked for
+ * overlaps, and the labels of different banks never overlap each other.
+ * 
+ * @note When any regions are declared, every label, that occupies memory, must
+ * be inside of a region, which permissions allow the label's permissions. The
+ * utilisation of each region is reported.
+ * 
+ * @param arena   arena reference
+ * @param labels  labels to verify
+ * @param regions declared memory regions
+ */
+void lasm_layout_verify(lasm_arena_s* const arena, const lasm_labels_vector_s* const labels, const lasm_regions_vector_s* const regions);
+
+#endif
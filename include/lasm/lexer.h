@@ -22,6 +22,7 @@
 typedef struct
 {
 	lasm_arena_s* arena;
+	lasm_arena_s* tokens_arena;
 	lasm_config_build_s* config;
 
 	FILE* file;
@@ -49,6 +50,10 @@ typedef struct
 /**
  * @brief Create a lexer.
  * 
+ * @note The payloads of the lexed tokens (identifiers and strings) are stored
+ * in the tokens arena, which defaults to the provided arena. It can be swapped
+ * by the user to release the tokens earlier than the lexer's arena.
+ * 
  * @param arena  arena reference
  * @param config build config reference
  * 
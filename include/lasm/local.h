@@ -0,0 +1,60 @@
+
+/**
+ * @file local.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-01
+ */
+
+#ifndef __lasm__include__lasm__local_h__
+#define __lasm__include__lasm__local_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/ast.h"
+
+/**
+ * @brief Parse the definition of a local label at the index of the label's body
+ * tokens, if there is one.
+ * 
+ * @note A local label is an identifier with a leading dot, that is followed by
+ * a ':' (e.g. '.loop:'), and it precedes the next instruction of the label. It
+ * is visible only in the body of the label, that defines it, so the same name
+ * may be defined in the bodies of other labels.
+ * 
+ * @param arena arena reference
+ * @param label label, that owns the body tokens
+ * @param index index of the body token to parse, advanced past the definition
+ * 
+ * @return bool_t
+ */
+bool_t lasm_local_parse(lasm_arena_s* const arena, lasm_ast_label_s* const label, uint64_t* const index);
+
+/**
+ * @brief Find the index of a local label with provided name in the label.
+ * 
+ * @note The local labels are looked up in the label's own table, so they never
+ * get into the symbol table of the labels.
+ * 
+ * @param label  label, that defines the local label
+ * @param name   name of the local label with its leading dot
+ * @param length length of the name
+ * @param index  index of the found local label
+ * 
+ * @return bool_t
+ */
+bool_t lasm_local_find(const lasm_ast_label_s* const label, const char_t* const name, const uint64_t length, uint64_t* const index);
+
+/**
+ * @brief Set the offsets of the label's local labels from the sizes of its
+ * encoded instructions.
+ * 
+ * @param label encoded label reference
+ */
+void lasm_locals_place(lasm_ast_label_s* const label);
+
+#endif
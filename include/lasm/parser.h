@@ -18,13 +18,23 @@
 #include "lasm/config.h"
 #include "lasm/lexer.h"
 #include "lasm/ast.h"
+#include "lasm/cache.h"
+#include "lasm/symtab.h"
 
 typedef struct
 {
 	lasm_arena_s* arena;
 	lasm_config_build_s* config;
+	lasm_arena_s tokens_arena;
 	lasm_lexer_s lexer;
 	lasm_labels_vector_s labels;
+	lasm_regions_vector_s regions;
+	lasm_cache_s cache;
+	lasm_symtab_s symtab;
+	lasm_symtab_s regions_symtab;
+	lasm_tokens_vector_s attr_tokens;
+	uint64_t fingerprint;
+	uint64_t tokens_released;
 } lasm_parser_s;
 
 /**
@@ -44,8 +54,43 @@ lasm_parser_s lasm_parser_new(lasm_arena_s* const arena, lasm_config_build_s* co
  */
 void lasm_parser_drop(lasm_parser_s* const parser);
 
+/**
+ * @brief Parse the headers of all labels and parse their body tokens into the
+ * instructions IR.
+ * 
+ * @note Each label gets a fingerprint of its header and body tokens, which is
+ * used to reuse the bodies encoded by previous builds. Labels with fingerprints
+ * found in the cache are not parsed into the instructions IR, and their cached
+ * bodies are used instead.
+ * 
+ * @note A label, which body consists only of string literals (optionally
+ * separated with commas), is a string label. Its body is made of the bytes of
+ * the string literals, and it is neither parsed into the instructions IR, nor
+ * cached.
+ * 
+ * @note Region declarations may appear between the labels. A region must be
+ * declared before any label references it with its 'region' attribute.
+ * 
+ * @note The body tokens of a label are stored in the parser's tokens arena,
+ * which is released as soon as the label's body is parsed, so the tokens of at
+ * most one label are alive at any time.
+ * 
+ * @param parser parser reference
+ */
 void lasm_parser_shallow_parse(lasm_parser_s* const parser);
 
+/**
+ * @brief Encode the instructions IR of all labels, that were parsed by the
+ * shallow parse, with the architecture's encoder.
+ * 
+ * @note The fields of the encoded bodies, that reference the addresses of other
+ * labels, are left zeroed and recorded as fixups, which are bound to their
+ * target labels once all of the labels are encoded.
+ * 
+ * @param parser parser reference
+ * 
+ * @return lasm_labels_vector_s
+ */
 lasm_labels_vector_s lasm_parser_deep_parse(lasm_parser_s* const parser);
 
 #endif
@@ -0,0 +1,71 @@
+
+/**
+ * @file relax.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#ifndef __lasm__include__lasm__relax_h__
+#define __lasm__include__lasm__relax_h__
+
+#include "lasm/common.h"
+#include "lasm/config.h"
+#include "lasm/ir.h"
+#include "lasm/ast.h"
+
+#define lasm_relax_form_capacity 8
+
+typedef struct
+{
+	uint8_t bytes[lasm_relax_form_capacity];
+	uint8_t length;
+	uint8_t field_offset;
+	uint8_t field_width;
+	lasm_ir_fixup_kind_e kind;
+} lasm_relax_form_s;
+
+/**
+ * @brief Rewrite the relaxable branches and operands into their short forms.
+ * 
+ * @note Encoders emit the relaxable instructions in their long forms, so the
+ * encoded and cached bodies do not depend on the relaxation. The bodies and
+ * the offsets of the fixups, that follow a rewritten instruction, are shifted.
+ * The operands, which targets have constant explicit addresses, take the forms
+ * of their targets' windows, and the other operands take the saddr forms only
+ * when guessing.
+ * 
+ * @param arch     architecture of the labels' bodies
+ * @param labels   labels reference
+ * @param branches shrink the branches too, and not only the operands
+ * @param guess    shrink the operands, which targets' addresses are not known
+ *                 until the layout
+ * @param saved    count of the bytes saved by the short forms
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_relax_shrink(const lasm_arch_type_e arch, lasm_labels_vector_s* const labels, const bool_t branches, const bool_t guess, uint64_t* const saved);
+
+/**
+ * @brief Grow the short branches and operands, which targets are out of their
+ * ranges or windows with the current addresses of the labels, into their long
+ * forms.
+ * 
+ * @note A field is never shrunk back, so repeating the growth after each
+ * update of the addresses converges.
+ * 
+ * @param arch   architecture of the labels' bodies
+ * @param labels laid out labels with bound fixups
+ * @param grown  count of the bytes added by the long forms
+ * @param first  index of the first label, that has grown, or
+ *               lasm_ast_label_none
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_relax_grow(const lasm_arch_type_e arch, lasm_labels_vector_s* const labels, uint64_t* const grown, uint64_t* const first);
+
+#endif
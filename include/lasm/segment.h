@@ -0,0 +1,65 @@
+
+/**
+ * @file segment.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-27
+ */
+
+#ifndef __lasm__include__lasm__segment_h__
+#define __lasm__include__lasm__segment_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+#include "lasm/vector.h"
+#include "lasm/ast.h"
+
+typedef struct
+{
+	uint64_t addr;
+	uint64_t mem_size;
+	uint64_t file_size;
+	lasm_ast_perm_type_e perm;
+	uint64_t region;
+	uint64_t bank;   // note: bank of the segment's region, or lasm_ast_bank_none.
+	uint64_t first;  // note: index of the segment's first label in the labels order.
+	uint64_t count;
+} lasm_segment_s;
+
+lasm_define_vector_type(lasm_segments_vector, lasm_segment_s);
+
+typedef struct
+{
+	lasm_segments_vector_s segments;
+	uint64_t* order;  // note: indices of the labels, that occupy memory, sorted by address.
+	uint64_t order_count;
+} lasm_segments_s;
+
+/**
+ * @brief Group the laid out labels into contiguous loadable segments.
+ * 
+ * @note The labels are swept by their addresses and a label is appended to the
+ * current segment, unless its permissions or region differ from the segment's
+ * ones, or it is separated from the segment by more than its alignment padding.
+ * The padding between the labels of a segment is zero filled. Labels with zero
+ * size, and folded labels, do not occupy memory of their own and do not belong
+ * to any segment.
+ * 
+ * @note The file size of a segment ends with the last byte of the last label's
+ * body, so the reserved bytes at the end of a segment are not stored.
+ * 
+ * @note The labels of the banked regions are swept after all of the other
+ * labels, bank by bank, as the windows of different banks share addresses.
+ * 
+ * @param arena  arena reference
+ * @param labels laid out and verified labels
+ * 
+ * @return lasm_segments_s
+ */
+lasm_segments_s lasm_segments_build(lasm_arena_s* const arena, const lasm_labels_vector_s* const labels);
+
+#endif
@@ -0,0 +1,72 @@
+
+/**
+ * @file symtab.h
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-24
+ */
+
+#ifndef __lasm__include__lasm__symtab_h__
+#define __lasm__include__lasm__symtab_h__
+
+#include "lasm/common.h"
+#include "lasm/arena.h"
+
+typedef struct
+{
+	const char_t* name;
+	uint64_t length;
+	uint64_t hash;
+	uint64_t index;
+} lasm_symtab_slot_s;
+
+typedef struct
+{
+	lasm_arena_s* arena;
+	lasm_symtab_slot_s* slots;
+	uint64_t capacity;
+	uint64_t count;
+} lasm_symtab_s;
+
+/**
+ * @brief Create a symbol table.
+ * 
+ * @param arena arena reference
+ * 
+ * @return lasm_symtab_s
+ */
+lasm_symtab_s lasm_symtab_new(lasm_arena_s* const arena);
+
+/**
+ * @brief Insert a symbol with provided name and index into the symbol table.
+ * 
+ * @note If a symbol with the same name already exists, the symbol table is
+ * not modified and the index of the existing symbol is written to existing.
+ * 
+ * @param symtab   symbol table reference
+ * @param name     name of the symbol
+ * @param length   length of the name
+ * @param index    index to associate with the name
+ * @param existing index of the existing symbol with the same name
+ * 
+ * @return bool_t
+ */
+bool_t lasm_symtab_insert(lasm_symtab_s* const symtab, const char_t* const name, const uint64_t length, const uint64_t index, uint64_t* const existing);
+
+/**
+ * @brief Find the index of a symbol with provided name.
+ * 
+ * @param symtab symbol table reference
+ * @param name   name of the symbol
+ * @param length length of the name
+ * @param index  index of the found symbol
+ * 
+ * @return bool_t
+ */
+bool_t lasm_symtab_find(const lasm_symtab_s* const symtab, const char_t* const name, const uint64_t length, uint64_t* const index);
+
+#endif
@@ -41,6 +41,14 @@ typedef enum
 	lasm_token_type_keyword_rwx,				// rwx
 	lasm_token_type_keyword_auto,				// auto
 	lasm_token_type_keyword_end,				// end
+	lasm_token_type_keyword_sizeof,				// sizeof
+	lasm_token_type_keyword_addrof,				// addrof
+	lasm_token_type_keyword_region,				// region
+	lasm_token_type_keyword_origin,				// origin
+	lasm_token_type_keyword_length,				// length
+	lasm_token_type_keyword_bank,				// bank
+	lasm_token_type_keyword_port,				// port
+	lasm_token_type_keyword_cycles,				// cycles
 	lasm_token_type_keywords_count,
 
 	// Symbolic tokens
@@ -53,6 +61,17 @@ typedef enum
 	lasm_token_type_symbolic_right_bracket,		// ]
 	lasm_token_type_symbolic_plus,				// +
 	lasm_token_type_symbolic_minus,				// -
+	lasm_token_type_symbolic_left_paren,		// (
+	lasm_token_type_symbolic_right_paren,		// )
+	lasm_token_type_symbolic_shift_left,		// <<
+	lasm_token_type_symbolic_shift_right,		// >>
+	lasm_token_type_symbolic_ampersand,			// &
+	lasm_token_type_symbolic_pipe,				// |
+	lasm_token_type_symbolic_caret,				// ^
+	lasm_token_type_symbolic_tilde,				// ~
+	lasm_token_type_symbolic_hash,				// #
+	lasm_token_type_symbolic_exclamation,		// !
+	lasm_token_type_symbolic_dollar,			// $
 	lasm_token_type_informationless_count,
 
 	// Tokens with additional information
@@ -116,6 +135,19 @@ lasm_token_s lasm_token_new(const lasm_token_type_e type, const lasm_location_s
  */
 const char_t* lasm_token_to_string(const lasm_token_s* const token);
 
+/**
+ * @brief Fold token's type and payload into a running fingerprint.
+ * 
+ * @note The location of the token is not part of the fingerprint, so moving
+ * the same tokens around in the source file does not change the fingerprint.
+ * 
+ * @param seed  fingerprint to continue from
+ * @param token token to fingerprint
+ * 
+ * @return uint64_t
+ */
+uint64_t lasm_token_fingerprint(const uint64_t seed, const lasm_token_s* const token);
+
 lasm_define_vector_type(lasm_tokens_vector, lasm_token_s);
 
 #endif
@@ -32,6 +32,13 @@
 	void _type_name ## _push(_type_name ## _s* const vector,                   \
 		                      _element_type element);                          \
 	                                                                           \
+	void _type_name ## _append(_type_name ## _s* const vector,                 \
+		                       const _element_type* const elements,            \
+		                       const uint64_t count);                          \
+	                                                                           \
+	_element_type* _type_name ## _extend(_type_name ## _s* const vector,       \
+		                                 const uint64_t count);                \
+	                                                                           \
 	bool_t _type_name ## _pop(_type_name ## _s* const vector,                  \
 		                      _element_type* const element);                   \
 	                                                                           \
@@ -89,6 +96,54 @@
 		vector->data[vector->count++] = element;                               \
 	}                                                                          \
 	                                                                           \
+	_element_type* _type_name ## _extend(_type_name ## _s* const vector,       \
+		                                 const uint64_t count)                 \
+	{                                                                          \
+		lasm_debug_assert(vector != NULL);                                     \
+		                                                                       \
+		if (vector->count + count >= vector->capacity)                         \
+		{                                                                      \
+			const uint64_t new_capacity = (uint64_t)(                          \
+				vector->capacity + (vector->capacity / 2) + count + 1          \
+			);                                                                 \
+			                                                                   \
+			_element_type* new_data = lasm_arena_alloc(                        \
+				vector->arena, new_capacity * sizeof(_element_type));          \
+			lasm_debug_assert(new_data != NULL);                               \
+			                                                                   \
+			if (vector->count > 0)                                             \
+			{                                                                  \
+				lasm_common_memcpy(new_data, vector->data,                     \
+					vector->count * sizeof(_element_type)                      \
+				);                                                             \
+			}                                                                  \
+			                                                                   \
+			vector->data = new_data;                                           \
+			vector->capacity = new_capacity;                                   \
+		}                                                                      \
+		                                                                       \
+		_element_type* const elements = vector->data + vector->count;          \
+		vector->count += count;                                                \
+		return elements;                                                       \
+	}                                                                          \
+	                                                                           \
+	void _type_name ## _append(_type_name ## _s* const vector,                 \
+		                       const _element_type* const elements,            \
+		                       const uint64_t count)                           \
+	{                                                                          \
+		lasm_debug_assert(vector != NULL);                                     \
+		lasm_debug_assert(elements != NULL);                                   \
+		                                                                       \
+		if (count <= 0)                                                        \
+		{                                                                      \
+			return;                                                            \
+		}                                                                      \
+		                                                                       \
+		lasm_common_memcpy(_type_name ## _extend(vector, count), elements,     \
+			count * sizeof(_element_type)                                      \
+		);                                                                     \
+	}                                                                          \
+	                                                                           \
 	bool_t _type_name ## _pop(_type_name ## _s* const vector,                  \
 		                      _element_type* const element)                    \
 	{                                                                          \
@@ -79,6 +79,20 @@ def generate_docs(project_dir: str) -> bool:
 	return True
 
 
+def generate_isa(project_dir: str) -> bool:
+	if not bootstrap_build_system(project_dir):
+		return False
+
+	print(f'info : generating the name lookup tables of the architectures.')
+	result: subprocess.CompletedProcess[bytes] = subprocess.run(
+		[os.path.join(project_dir, build_bin_name), f'isa'], cwd=project_dir
+	)
+	if result.returncode != 0:
+		return False
+
+	return True
+
+
 def lint_project(build_configuration: str, project_dir: str) -> bool:
 	if build_configuration not in configurations:
 		print(f'error: build configuration must be one of the {configurations}')
@@ -104,6 +118,7 @@ def main() -> None:
 	build_parser: argparse.ArgumentParser = subparsers.add_parser(f'build', help=f'The build command')
 	build_parser.add_argument(f'--config', choices=configurations, type=str, default=configurations[0], help=f'Build configuration')
 	docs_parser:  argparse.ArgumentParser = subparsers.add_parser(f'docs', help=f'The docs command')
+	isa_parser:   argparse.ArgumentParser = subparsers.add_parser(f'isa', help=f'The isa command')
 	lint_parser:  argparse.ArgumentParser = subparsers.add_parser(f'lint', help=f'The lint command')
 	lint_parser.add_argument(f'--config', choices=configurations, type=str, default=configurations[0], help=f'Lint configuration')
 	args: argparse.Namespace = parser.parse_args()
@@ -121,6 +136,9 @@ def main() -> None:
 	elif args.command == f'docs':
 		if not generate_docs(project_dir):
 			sys.exit(1)
+	elif args.command == f'isa':
+		if not generate_isa(project_dir):
+			sys.exit(1)
 	elif args.command == f'lint':
 		if not lint_project(args.config, project_dir):
 			sys.exit(1)
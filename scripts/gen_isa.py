@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+
+import argparse
+import sys
+import os
+
+
+isa_file_name: str = f'source/lasm/archs/archs.isa'
+kinds: dict[str, tuple[str, str, str, str, str]] = {
+	# note: list keyword: (enum member prefix, enum type suffix, lookup function suffix, name function suffix, description).
+	f'mnemonics': (f'mnemonic', f'mnemonic_e', f'find_mnemonic', f'mnemonic_name', f'mnemonic' ),
+	f'registers': (f'register', f'reg_e',      f'find_reg',      f'reg_name',      f'register' ),
+	f'conds':     (f'cond',     f'cond_e',     f'find_cond',     f'cond_name',     f'condition'),
+}
+
+hash_seed: int = 0xCBF29CE484222325
+hash_prime: int = 0x00000100000001B3
+hash_mask: int = 0xFFFFFFFFFFFFFFFF
+mix_multiplier: int = 0x9E3779B97F4A7C15
+max_bucket_seed: int = 0xFFFFFFFF
+
+
+def fnv1a(seed: int, name: str) -> int:
+	# note: same as lasm_common_hash in source/lasm/common.c.
+	value: int = seed
+	for byte in name.encode(f'ascii'):
+		value ^= byte
+		value = (value * hash_prime) & hash_mask
+	return value
+
+
+def mix(value: int) -> int:
+	# note: fibonacci hashing, so the short names spread over all of the slots.
+	return (((value * mix_multiplier) & hash_mask) >> 32)
+
+
+def bucket_of(name: str, buckets_count: int) -> int:
+	return mix(fnv1a(hash_seed, name)) % buckets_count
+
+
+def slot_of(name: str, seed: int, slots_count: int) -> int:
+	return mix(fnv1a(hash_seed, name) ^ seed) % slots_count
+
+
+def parse_isa(path: str) -> dict[str, dict[str, list[str]]]:
+	archs: dict[str, dict[str, list[str]]] = {}
+	arch: str | None = None
+	kind: str | None = None
+
+	with open(path, f'r') as file:
+		for line_number, line in enumerate(file, 1):
+			words: list[str] = line.split(f';', 1)[0].split()
+			index: int = 0
+
+			while index < len(words):
+				word: str = words[index]
+				index += 1
+
+				if word == f'arch':
+					if index >= len(words):
+						raise ValueError(f'{path}:{line_number}: expected the name of the architecture after \'arch\'.')
+					arch, kind = words[index], None
+					index += 1
+					if arch in archs:
+						raise ValueError(f'{path}:{line_number}: architecture \'{arch}\' is described more than once.')
+					archs[arch] = {}
+				elif word in kinds:
+					if arch is None:
+						raise ValueError(f'{path}:{line_number}: \'{word}\' is listed before any \'arch\'.')
+					kind = word
+					archs[arch].setdefault(kind, [])
+				elif arch is None or kind is None:
+					raise ValueError(f'{path}:{line_number}: name \'{word}\' is listed outside of any list.')
+				elif not word.isidentifier() or not word.isascii():
+					raise ValueError(f'{path}:{line_number}: name \'{word}\' is not a valid c identifier.')
+				elif word in archs[arch][kind]:
+					raise ValueError(f'{path}:{line_number}: name \'{word}\' is listed more than once in the {kind} of \'{arch}\'.')
+				else:
+					archs[arch][kind].append(word)
+
+	return archs
+
+
+def make_perfect_hash(names: list[str]) -> tuple[list[int], list[int]]:
+	# note: hash and displace. the first hash of a name picks its bucket, and the
+	# seed of the bucket makes the second hash, that picks the name's slot. the
+	# buckets with the most names get their seeds first.
+	slots_count: int = 1
+	while slots_count < len(names):
+		slots_count *= 2
+
+	while True:
+		buckets_count: int = max(1, (len(names) + 1) // 2)
+		buckets: list[list[int]] = [[] for _ in range(buckets_count)]
+		for index, name in enumerate(names):
+			buckets[bucket_of(name, buckets_count)].append(index)
+
+		seeds: list[int] = [0] * buckets_count
+		slots: list[int] = [len(names)] * slots_count
+		failed: bool = False
+
+		for bucket in sorted(range(buckets_count), key=lambda bucket: -len(buckets[bucket])):
+			if not buckets[bucket]:
+				continue
+
+			for seed in range(max_bucket_seed):
+				taken: list[int] = [slot_of(names[index], seed, slots_count) for index in buckets[bucket]]
+				if len(set(taken)) == len(taken) and all(slots[slot] == len(names) for slot in taken):
+					break
+				if seed > 10000:
+					failed = True
+					break
+
+			if failed:
+				break
+
+			seeds[bucket] = seed
+			for index, slot in zip(buckets[bucket], taken):
+				slots[slot] = index
+
+		if not failed:
+			return seeds, slots
+
+		slots_count *= 2
+
+
+def file_banner(name: str) -> str:
+	return (
+		f'\n'
+		f'/**\n'
+		f' * @file {name}\n'
+		f' * \n'
+		f' * @copyright This file is a part of the "lasm" project and is distributed, and\n'
+		f' * licensed under "lasm gplv1" license.\n'
+		f' * \n'
+		f' * @author joba14\n'
+		f' * \n'
+		f' * @date 2024-07-28\n'
+		f' */\n'
+		f'\n'
+		f'// note: this file is generated by \'./scripts/gen_isa.py\' from \'./{isa_file_name}\'.\n'
+		f'// do not edit it by hand!\n'
+		f'\n'
+	)
+
+
+def make_header(arch: str, lists: dict[str, list[str]]) -> str:
+	guard: str = f'__lasm__include__lasm__archs__{arch}_names_h__'
+	text: str = file_banner(f'{arch}_names.h')
+	text += f'#ifndef {guard}\n#define {guard}\n\n#include "lasm/common.h"\n'
+
+	for kind, names in lists.items():
+		member, type_suffix, _, _, _ = kinds[kind]
+		text += f'\ntypedef enum\n{{\n'
+		for name in names:
+			text += f'\t{arch}_{member}_{name},\n'
+		text += f'\t{arch}_{member}s_count,\n}} {arch}_{type_suffix};\n'
+
+	for kind, names in lists.items():
+		member, type_suffix, function_suffix, name_suffix, description = kinds[kind]
+		text += (
+			f'\n'
+			f'/**\n'
+			f' * @brief Find the {description} by its name.\n'
+			f' * \n'
+			f' * @note The name is hashed once, and compared with at most one of the\n'
+			f' * names in the perfect hash table, so the lookup takes a constant time.\n'
+			f' * \n'
+			f' * @param name name of the {description}\n'
+			f' * \n'
+			f' * @return {arch}_{type_suffix} ({arch}_{member}s_count if not found)\n'
+			f' */\n'
+			f'{arch}_{type_suffix} {arch}_isa_{function_suffix}(const char_t* const name);\n'
+			f'\n'
+			f'/**\n'
+			f' * @brief Get the name of the {description}.\n'
+			f' * \n'
+			f' * @param {type_suffix[:-2]} {description} id\n'
+			f' * \n'
+			f' * @return const char_t*\n'
+			f' */\n'
+			f'const char_t* {arch}_isa_{name_suffix}(const {arch}_{type_suffix} {type_suffix[:-2]});\n'
+		)
+
+	text += f'\n#endif\n'
+	return text
+
+
+def make_source(arch: str, lists: dict[str, list[str]]) -> str:
+	text: str = file_banner(f'{arch}_names.c')
+	text += f'#include "lasm/archs/{arch}_names.h"\n#include "lasm/debug.h"\n'
+	text += f'\n#define _mix_multiplier ((uint64_t)0x{mix_multiplier:016X})\n'
+
+	for kind, names in lists.items():
+		member, _, _, _, _ = kinds[kind]
+		seeds, slots = make_perfect_hash(names)
+		width: int = max(len(name) for name in names)
+
+		if len(names) >= 0xFF:
+			raise ValueError(f'too many {kind} in \'{arch}\' for the 8 bit slots.')
+
+		text += f'\nstatic const char_t* const _g_{arch}_{member}_names[{arch}_{member}s_count] =\n{{\n'
+		for name in names:
+			text += f'\t[{arch}_{member}_{name}]{" " * (width - len(name))} = "{name}",\n'
+		text += f'}};\n'
+
+		text += f'\nstatic const uint32_t _g_{arch}_{member}_seeds[{len(seeds)}] =\n{{\n'
+		for index in range(0, len(seeds), 8):
+			text += f'\t' + f' '.join(f'0x{seed:08X},' for seed in seeds[index:index + 8]) + f'\n'
+		text += f'}};\n'
+
+		text += f'\n// note: {arch}_{member}s_count marks the empty slots.\n'
+		text += f'static const uint8_t _g_{arch}_{member}_slots[{len(slots)}] =\n{{\n'
+		for index in range(0, len(slots), 16):
+			text += f'\t' + f' '.join(f'{slot:3},' for slot in slots[index:index + 16]) + f'\n'
+		text += f'}};\n'
+
+	text += (
+		f'\n'
+		f'static uint64_t _find_name(const char_t* const* const names, const uint64_t count, const uint32_t* const seeds, const uint64_t seeds_count,\n'
+		f'\tconst uint8_t* const slots, const uint64_t slots_count, const char_t* const name);\n'
+	)
+
+	for kind in lists:
+		member, type_suffix, function_suffix, name_suffix, _ = kinds[kind]
+		text += (
+			f'\n'
+			f'{arch}_{type_suffix} {arch}_isa_{function_suffix}(const char_t* const name)\n'
+			f'{{\n'
+			f'\tlasm_debug_assert(name != NULL);\n'
+			f'\treturn ({arch}_{type_suffix})_find_name(_g_{arch}_{member}_names, {arch}_{member}s_count,\n'
+			f'\t\t_g_{arch}_{member}_seeds, sizeof(_g_{arch}_{member}_seeds) / sizeof(_g_{arch}_{member}_seeds[0]),\n'
+			f'\t\t_g_{arch}_{member}_slots, sizeof(_g_{arch}_{member}_slots) / sizeof(_g_{arch}_{member}_slots[0]), name);\n'
+			f'}}\n'
+			f'\n'
+			f'const char_t* {arch}_isa_{name_suffix}(const {arch}_{type_suffix} {type_suffix[:-2]})\n'
+			f'{{\n'
+			f'\tlasm_debug_assert({type_suffix[:-2]} < {arch}_{member}s_count);\n'
+			f'\treturn _g_{arch}_{member}_names[{type_suffix[:-2]}];\n'
+			f'}}\n'
+		)
+
+	text += (
+		f'\n'
+		f'static uint64_t _find_name(const char_t* const* const names, const uint64_t count, const uint32_t* const seeds, const uint64_t seeds_count,\n'
+		f'\tconst uint8_t* const slots, const uint64_t slots_count, const char_t* const name)\n'
+		f'{{\n'
+		f'\tlasm_debug_assert(names != NULL);\n'
+		f'\tlasm_debug_assert(seeds != NULL);\n'
+		f'\tlasm_debug_assert(slots != NULL);\n'
+		f'\tlasm_debug_assert(name != NULL);\n'
+		f'\n'
+		f'\t// note: the first hash of the name picks its bucket, and the seed of the\n'
+		f'\t// bucket displaces the hash to the slot of the name.\n'
+		f'\tconst uint64_t hash = lasm_common_hash(lasm_common_hash_seed, name, lasm_common_strlen(name));\n'
+		f'\tconst uint64_t bucket = ((hash * _mix_multiplier) >> 32) % seeds_count;\n'
+		f'\tconst uint64_t slot = (((hash ^ seeds[bucket]) * _mix_multiplier) >> 32) % slots_count;\n'
+		f'\tconst uint64_t index = slots[slot];\n'
+		f'\n'
+		f'\treturn (((index < count) && (lasm_common_strcmp(names[index], name) == 0)) ? index : count);\n'
+		f'}}\n'
+	)
+
+	return text
+
+
+def write_if_changed(path: str, text: str) -> None:
+	if os.path.isfile(path):
+		with open(path, f'r') as file:
+			if file.read() == text:
+				return
+
+	print(f'info : writing {path}.')
+	with open(path, f'w') as file:
+		file.write(text)
+
+
+def main() -> None:
+	parser: argparse.ArgumentParser = argparse.ArgumentParser(description=f'Generate the perfect hash lookup tables of the architectures\' names.')
+	parser.parse_args()
+
+	project_dir: str = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+	os.chdir(project_dir)
+
+	try:
+		archs: dict[str, dict[str, list[str]]] = parse_isa(isa_file_name)
+		for arch, lists in archs.items():
+			write_if_changed(os.path.join(f'include', f'lasm', f'archs', f'{arch}_names.h'), make_header(arch, lists))
+			write_if_changed(os.path.join(f'source', f'lasm', f'archs', f'{arch}_names.c'), make_source(arch, lists))
+	except ValueError as error:
+		print(f'error: {error}')
+		sys.exit(1)
+
+
+if __name__ == f'__main__':
+	main()
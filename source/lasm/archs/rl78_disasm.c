@@ -0,0 +1,327 @@
+
+/**
+ * @file rl78_disasm.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-03
+ */
+
+#include "lasm/archs/rl78_disasm.h"
+#include "lasm/debug.h"
+
+#include <stdio.h>
+
+typedef struct
+{
+	const uint8_t* inst;
+	uint16_t form;
+	uint8_t opcode;
+	uint8_t length;
+	uint64_t addr;
+} _rl78_disasm_s;
+
+static bool_t _is_encodable(const _rl78_disasm_s* const disasm, const uint8_t operand, const uint8_t* const field);
+
+static uint64_t _write_operand(const _rl78_disasm_s* const disasm, const uint8_t operand, const uint8_t* const field, char_t* const buffer, const uint64_t capacity);
+
+static rl78_reg_e _fixed_reg(const rl78_pattern_e pattern);
+
+static rl78_pattern_e _fixed_pattern(const rl78_reg_e reg);
+
+static uint64_t _saddr(const uint8_t byte);
+
+uint8_t rl78_disasm_inst(const uint8_t* const inst, const uint64_t length, const uint64_t addr, char_t* const buffer, const uint64_t capacity)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(buffer != NULL);
+	lasm_debug_assert(capacity > 0);
+
+	const uint16_t form = rl78_isa_decode(inst, length);
+
+	if (UINT16_MAX == form)
+	{
+		return 0;
+	}
+
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+	const bool_t extended = (rl78_isa_es_prefix == inst[0]);
+	const uint8_t inst_length = rl78_isa_length(form, extended);
+	uint8_t extended_operand = 2;
+
+	if (inst_length > length)
+	{
+		return 0;
+	}
+
+	// note: the es prefix is written before the first memory operand, that takes
+	// it, and the prefix of an instruction without such operand can not be
+	// written at all.
+	for (uint8_t operand = 0; extended && (operand < 2) && (2 == extended_operand); ++operand)
+	{
+		if (rl78_isa_accepts_es((rl78_pattern_e)encoding->patterns[operand]))
+		{
+			extended_operand = operand;
+		}
+	}
+
+	if (extended && (2 == extended_operand))
+	{
+		return 0;
+	}
+
+	// note: the fields of the operands follow the opcode, and they end the
+	// instruction.
+	const uint8_t fields_width = (uint8_t)(rl78_isa_field_width((rl78_pattern_e)encoding->patterns[0]) +
+		rl78_isa_field_width((rl78_pattern_e)encoding->patterns[1]));
+	const uint8_t* field = inst + inst_length - fields_width;
+
+	const _rl78_disasm_s disasm = (const _rl78_disasm_s)
+	{
+		.inst   = inst,
+		.form   = form,
+		.opcode = field[-1],
+		.length = inst_length,
+		.addr   = addr,
+	};
+
+	// note: the bytes, that the encoder never produces, can not be written as an
+	// instruction, that assembles back into them.
+	for (uint8_t operand = 0, offset = 0; operand < 2; ++operand)
+	{
+		if (!_is_encodable(&disasm, operand, field + offset))
+		{
+			return 0;
+		}
+
+		offset = (uint8_t)(offset + rl78_isa_field_width((rl78_pattern_e)encoding->patterns[operand]));
+	}
+
+	uint64_t written = (uint64_t)snprintf(buffer, capacity, "%s", rl78_isa_mnemonic_name((rl78_mnemonic_e)encoding->mnemonic));
+
+	for (uint8_t operand = 0; (operand < 2) && (encoding->patterns[operand] != rl78_pattern_none); ++operand)
+	{
+		lasm_debug_assert(written < capacity);
+		written += (uint64_t)snprintf(buffer + written, capacity - written, "%s%s",
+			((0 == operand) ? " " : ", "), ((operand == extended_operand) ? "es:" : ""));
+		lasm_debug_assert(written < capacity);
+		written += _write_operand(&disasm, operand, field, buffer + written, capacity - written);
+		field += rl78_isa_field_width((rl78_pattern_e)encoding->patterns[operand]);
+	}
+
+	lasm_debug_assert(written < capacity);
+	return disasm.length;
+}
+
+static bool_t _is_encodable(const _rl78_disasm_s* const disasm, const uint8_t operand, const uint8_t* const field)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(field != NULL);
+
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[disasm->form];
+	const rl78_pattern_e pattern = (rl78_pattern_e)encoding->patterns[operand];
+	rl78_pattern_e shorter = rl78_pattern_none;
+
+	switch (pattern)
+	{
+		// note: the word operands of the short direct addressing windows are always
+		// even, and the absolute addresses have only 20 bits.
+		case rl78_pattern_saddrp: { return (0 == (field[0] & 1)); } break;
+		case rl78_pattern_abs20:  { return (field[2] <= 0x0F);    } break;
+
+		// note: the targets, that are only reached by wrapping around the address
+		// space, have no address to write.
+		case rl78_pattern_rel8:
+		case rl78_pattern_rel16:
+		{
+			const bool_t wide = (rl78_pattern_rel16 == pattern);
+			const int64_t distance = (wide ? (int64_t)(int16_t)((uint32_t)field[0] | ((uint32_t)field[1] << 8)) : (int64_t)(int8_t)field[0]);
+			const int64_t target = (int64_t)(disasm->addr + (uint64_t)(field - disasm->inst) + (wide ? 2 : 1)) + distance;
+			return (target >= 0) && (target <= 0xFFFFF);
+		} break;
+
+		// note: the sfr addresses, that are also in the saddr window, and the zero
+		// displacements take the shorter forms, when the mnemonic has them, and
+		// the encoder tries them first.
+		case rl78_pattern_sfr:     { shorter = ((field[0] < 0x20) ? rl78_pattern_saddr     : rl78_pattern_none); } break;
+		case rl78_pattern_sfr_bit: { shorter = ((field[0] < 0x20) ? rl78_pattern_saddr_bit : rl78_pattern_none); } break;
+		case rl78_pattern_de_byte: { shorter = ((0 == field[0])   ? rl78_pattern_ind_de    : rl78_pattern_none); } break;
+		case rl78_pattern_hl_byte: { shorter = ((0 == field[0])   ? rl78_pattern_ind_hl    : rl78_pattern_none); } break;
+
+		case rl78_pattern_sfrp:
+		{
+			if (field[0] & 1)
+			{
+				return false;
+			}
+
+			shorter = ((field[0] < 0x20) ? rl78_pattern_saddrp : rl78_pattern_none);
+		} break;
+
+		// note: the coded registers, that have forms of their own, take them.
+		case rl78_pattern_r8:
+		case rl78_pattern_r8_not_a:
+		case rl78_pattern_r8_xacb:  { shorter = _fixed_pattern((rl78_reg_e)(rl78_register_x + rl78_isa_operand_code(disasm->form, disasm->opcode, operand)));  } break;
+		case rl78_pattern_rp:
+		case rl78_pattern_rp_not_ax: { shorter = _fixed_pattern((rl78_reg_e)(rl78_register_ax + rl78_isa_operand_code(disasm->form, disasm->opcode, operand))); } break;
+
+		default: { } break;
+	}
+
+	if (rl78_pattern_none == shorter)
+	{
+		return true;
+	}
+
+	const rl78_pattern_e first = ((0 == operand) ? shorter : (rl78_pattern_e)encoding->patterns[0]);
+	const rl78_pattern_e second = ((1 == operand) ? shorter : (rl78_pattern_e)encoding->patterns[1]);
+	const uint16_t form = rl78_isa_find_form((rl78_mnemonic_e)encoding->mnemonic, first, second);
+	return (UINT16_MAX == form) || (form > disasm->form);
+}
+
+static uint64_t _write_operand(const _rl78_disasm_s* const disasm, const uint8_t operand, const uint8_t* const field, char_t* const buffer, const uint64_t capacity)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(field != NULL);
+	lasm_debug_assert(buffer != NULL);
+
+	const rl78_pattern_e pattern = (rl78_pattern_e)rl78_isa_encodings[disasm->form].patterns[operand];
+	const uint8_t code = rl78_isa_operand_code(disasm->form, disasm->opcode, operand);
+	const uint8_t width = rl78_isa_field_width(pattern);
+	uint64_t value = 0;
+
+	for (uint8_t byte = 0; byte < width; ++byte)
+	{
+		value |= ((uint64_t)field[byte] << (byte * 8));
+	}
+
+	switch (pattern)
+	{
+		case rl78_pattern_r8:
+		case rl78_pattern_r8_not_a:
+		case rl78_pattern_r8_xacb:   { return (uint64_t)snprintf(buffer, capacity, "%s", rl78_isa_reg_name((rl78_reg_e)(rl78_register_x + code)));   } break;
+		case rl78_pattern_rp:
+		case rl78_pattern_rp_not_ax: { return (uint64_t)snprintf(buffer, capacity, "%s", rl78_isa_reg_name((rl78_reg_e)(rl78_register_ax + code)));  } break;
+		case rl78_pattern_rb:        { return (uint64_t)snprintf(buffer, capacity, "%s", rl78_isa_reg_name((rl78_reg_e)(rl78_register_rb0 + code))); } break;
+
+		case rl78_pattern_x:
+		case rl78_pattern_a:
+		case rl78_pattern_b:
+		case rl78_pattern_c:
+		case rl78_pattern_ax:
+		case rl78_pattern_bc:
+		case rl78_pattern_de:
+		case rl78_pattern_hl:
+		case rl78_pattern_sp:
+		case rl78_pattern_es:
+		case rl78_pattern_psw:
+		case rl78_pattern_cy:        { return (uint64_t)snprintf(buffer, capacity, "%s", rl78_isa_reg_name(_fixed_reg(pattern))); } break;
+
+		// note: the counts are written without the '#', as in 'shl a, 3'.
+		case rl78_pattern_imm8:      { return (uint64_t)snprintf(buffer, capacity, "#0x%02lX", value); } break;
+		case rl78_pattern_imm16:     { return (uint64_t)snprintf(buffer, capacity, "#0x%04lX", value); } break;
+		case rl78_pattern_one:       { return (uint64_t)snprintf(buffer, capacity, "1");               } break;
+		case rl78_pattern_shift8:
+		case rl78_pattern_shift16:   { return (uint64_t)snprintf(buffer, capacity, "%u", code);        } break;
+
+		case rl78_pattern_saddr:
+		case rl78_pattern_saddrp:    { return (uint64_t)snprintf(buffer, capacity, "0x%05lX", _saddr(field[0]));                 } break;
+		case rl78_pattern_saddr_bit: { return (uint64_t)snprintf(buffer, capacity, "0x%05lX.%u", _saddr(field[0]), code);        } break;
+		case rl78_pattern_sfr:
+		case rl78_pattern_sfrp:      { return (uint64_t)snprintf(buffer, capacity, "0x%05lX", rl78_isa_sfr_first + value);       } break;
+		case rl78_pattern_sfr_bit:   { return (uint64_t)snprintf(buffer, capacity, "0x%05lX.%u", rl78_isa_sfr_first + value, code); } break;
+
+		case rl78_pattern_abs16:
+		case rl78_pattern_code16:    { return (uint64_t)snprintf(buffer, capacity, "!0x%04lX", value);       } break;
+		case rl78_pattern_abs16_bit: { return (uint64_t)snprintf(buffer, capacity, "!0x%04lX.%u", value, code); } break;
+		case rl78_pattern_abs20:     { return (uint64_t)snprintf(buffer, capacity, "!!0x%05lX", value);      } break;
+
+		case rl78_pattern_rel8:
+		case rl78_pattern_rel16:
+		{
+			// note: the distance is counted from the end of the field, and it is
+			// written as the absolute address of the target.
+			const bool_t wide = (rl78_pattern_rel16 == pattern);
+			const int64_t distance = (wide ? (int64_t)(int16_t)value : (int64_t)(int8_t)value);
+			const uint64_t end = disasm->addr + (uint64_t)(field - disasm->inst) + width;
+			return (uint64_t)snprintf(buffer, capacity, "%s0x%05lX", (wide ? "$!" : "$"), (uint64_t)((int64_t)end + distance));
+		} break;
+
+		case rl78_pattern_ind_de:    { return (uint64_t)snprintf(buffer, capacity, "[de]");               } break;
+		case rl78_pattern_ind_hl:    { return (uint64_t)snprintf(buffer, capacity, "[hl]");               } break;
+		case rl78_pattern_de_byte:   { return (uint64_t)snprintf(buffer, capacity, "[de+0x%02lX]", value); } break;
+		case rl78_pattern_hl_byte:   { return (uint64_t)snprintf(buffer, capacity, "[hl+0x%02lX]", value); } break;
+		case rl78_pattern_sp_byte:   { return (uint64_t)snprintf(buffer, capacity, "[sp+0x%02lX]", value); } break;
+		case rl78_pattern_hl_b:      { return (uint64_t)snprintf(buffer, capacity, "[hl+b]");             } break;
+		case rl78_pattern_hl_c:      { return (uint64_t)snprintf(buffer, capacity, "[hl+c]");             } break;
+		case rl78_pattern_word_b:    { return (uint64_t)snprintf(buffer, capacity, "0x%04lX[b]", value);  } break;
+		case rl78_pattern_word_c:    { return (uint64_t)snprintf(buffer, capacity, "0x%04lX[c]", value);  } break;
+		case rl78_pattern_word_bc:   { return (uint64_t)snprintf(buffer, capacity, "0x%04lX[bc]", value); } break;
+		case rl78_pattern_a_bit:     { return (uint64_t)snprintf(buffer, capacity, "a.%u", code);         } break;
+		case rl78_pattern_hl_bit:    { return (uint64_t)snprintf(buffer, capacity, "[hl].%u", code);      } break;
+
+		case rl78_pattern_table:
+		{
+			// note: the code 0b0nnn00mm is the callt table entry at 0x80 + (mm * 16)
+			// + (nnn * 2).
+			return (uint64_t)snprintf(buffer, capacity, "[0x%02X]", 0x80 + (((code >> 4) & 0x07) * 2) + ((code & 0x03) * 16));
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static rl78_reg_e _fixed_reg(const rl78_pattern_e pattern)
+{
+	switch (pattern)
+	{
+		case rl78_pattern_x:   { return rl78_register_x;   } break;
+		case rl78_pattern_a:   { return rl78_register_a;   } break;
+		case rl78_pattern_b:   { return rl78_register_b;   } break;
+		case rl78_pattern_c:   { return rl78_register_c;   } break;
+		case rl78_pattern_ax:  { return rl78_register_ax;  } break;
+		case rl78_pattern_bc:  { return rl78_register_bc;  } break;
+		case rl78_pattern_de:  { return rl78_register_de;  } break;
+		case rl78_pattern_hl:  { return rl78_register_hl;  } break;
+		case rl78_pattern_sp:  { return rl78_register_sp;  } break;
+		case rl78_pattern_es:  { return rl78_register_es;  } break;
+		case rl78_pattern_psw: { return rl78_register_psw; } break;
+		case rl78_pattern_cy:  { return rl78_register_cy;  } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return rl78_registers_count;
+		} break;
+	}
+}
+
+static rl78_pattern_e _fixed_pattern(const rl78_reg_e reg)
+{
+	switch (reg)
+	{
+		case rl78_register_x:  { return rl78_pattern_x;  } break;
+		case rl78_register_a:  { return rl78_pattern_a;  } break;
+		case rl78_register_b:  { return rl78_pattern_b;  } break;
+		case rl78_register_c:  { return rl78_pattern_c;  } break;
+		case rl78_register_ax: { return rl78_pattern_ax; } break;
+		case rl78_register_bc: { return rl78_pattern_bc; } break;
+		case rl78_register_de: { return rl78_pattern_de; } break;
+		case rl78_register_hl: { return rl78_pattern_hl; } break;
+		default:               { return rl78_pattern_none; } break;
+	}
+}
+
+static uint64_t _saddr(const uint8_t byte)
+{
+	// note: the saddr window spans from 0xFFE20 to 0xFFF1F, so the low bytes
+	// below 0x20 are at the top of the window.
+	return ((byte < 0x20) ? 0xFFF00 : 0xFFE00) + (uint64_t)byte;
+}
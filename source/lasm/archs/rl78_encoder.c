@@ -0,0 +1,450 @@
+
+/**
+ * @file rl78_encoder.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-25
+ */
+
+#include "lasm/archs/rl78_encoder.h"
+#include "lasm/archs/rl78_isa.h"
+#include "lasm/fixup.h"
+#include "lasm/data.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <stdio.h>
+
+#define _log_rl78_encoder_error(_location, _format, ...)                       \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+typedef struct
+{
+	uint8_t long_opcode;   // note: opcode of the '!!addr20' form.
+	uint8_t short_opcode;  // note: opcode of the relative form.
+	uint8_t short_width;   // note: width of the relative form's field.
+} _rl78_branch_pair_s;
+
+// note: the branches and the calls to labels, that have both the absolute
+// '!!addr20' and the relative '$addr20' or '$!addr20' forms.
+static const _rl78_branch_pair_s _g_rl78_branch_pairs[] =
+{
+	{ .long_opcode = 0xEC, .short_opcode = 0xEF, .short_width = 1, },
+	{ .long_opcode = 0xFC, .short_opcode = 0xFE, .short_width = 2, },
+};
+
+static bool_t _relax_direct(const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form);
+
+static bool_t _is_code(const rl78_pattern_e pattern);
+
+static bool_t _is_relaxable(const lasm_ir_inst_s* const inst, const uint8_t operand_index);
+
+static void _encode_operand(lasm_ir_inst_s* const inst, const rl78_isa_encoding_s* const encoding, const uint8_t operand_index, uint8_t* const opcode, uint8_t* const fields, uint8_t* const fields_width);
+
+static uint64_t _fit_value(const lasm_ir_inst_s* const inst, const lasm_ir_operand_s* const operand, const rl78_pattern_e pattern);
+
+void rl78_encoder_encode(lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	for (uint64_t index = 0; index < label->ir.count; ++index)
+	{
+		lasm_ir_inst_s* const inst = lasm_ir_insts_vector_at(&label->ir, index);
+
+		if (lasm_ir_opcode_data == inst->opcode)
+		{
+			lasm_data_encode(label, inst);
+			continue;
+		}
+
+		const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[inst->opcode];
+
+		uint8_t bytes[8] = {0};
+		uint8_t length = 0;
+		uint8_t opcode = encoding->opcode;
+		uint8_t fields[5] = {0};
+		uint8_t fields_width = 0;
+		bool_t extended = false;
+
+		for (uint8_t operand_index = 0; operand_index < inst->operands_count; ++operand_index)
+		{
+			extended |= ((inst->operands[operand_index].mode & rl78_mode_flag_es) != 0);
+		}
+
+		// note: the es prefix goes first, followed by the prefixes of the maps.
+		if (extended)
+		{
+			bytes[length++] = rl78_isa_es_prefix;
+		}
+
+		for (uint8_t prefix = 0; (prefix < 2) && (encoding->prefix[prefix] != 0); ++prefix)
+		{
+			bytes[length++] = encoding->prefix[prefix];
+		}
+
+		const uint8_t fields_offset = (uint8_t)(length + 1);
+
+		// note: the fields of the operands follow the opcode in the order of the
+		// operands.
+		for (uint8_t operand_index = 0; operand_index < inst->operands_count; ++operand_index)
+		{
+			lasm_ir_operand_s* const operand = &inst->operands[operand_index];
+			const uint8_t offset = fields_width;
+			_encode_operand(inst, encoding, operand_index, &opcode, fields, &fields_width);
+
+			if (operand->fixup_width > 0)
+			{
+				// note: only the fields of the code addresses are the targets of the
+				// control transfers, and not the tested bits of the bit branches.
+				const bool_t code = _is_code((rl78_pattern_e)encoding->patterns[operand_index]);
+				operand->fixup_offset = (uint8_t)(fields_offset + offset);
+				operand->fixup_flow = (uint8_t)((code && ((encoding->flags & rl78_isa_flag_call) != 0)) ? lasm_ir_flow_call :
+					((code && ((encoding->flags & rl78_isa_flag_jump) != 0)) ? lasm_ir_flow_jump : lasm_ir_flow_none));
+
+				if (_is_relaxable(inst, operand_index))
+				{
+					operand->fixup_relax = 1;
+				}
+			}
+		}
+
+		bytes[length++] = opcode;
+
+		if (fields_width > 0)
+		{
+			lasm_common_memcpy(bytes + length, fields, fields_width);
+			length = (uint8_t)(length + fields_width);
+		}
+
+		const uint64_t offset = label->body.count;
+		lasm_bytes_vector_append(&label->body, bytes, length);
+		inst->size = length;
+		lasm_fixups_collect(label, inst, offset);
+	}
+}
+
+bool_t rl78_encoder_relax(const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(length != NULL);
+	lasm_debug_assert(form != NULL);
+
+	if ((kind != lasm_ir_fixup_kind_abs) && (kind != lasm_ir_fixup_kind_rel))
+	{
+		return _relax_direct(inst, kind, length, form);
+	}
+
+	const bool_t grow = (lasm_ir_fixup_kind_abs == kind);
+
+	for (uint64_t index = 0; index < (sizeof(_g_rl78_branch_pairs) / sizeof(_g_rl78_branch_pairs[0])); ++index)
+	{
+		const _rl78_branch_pair_s* const pair = &_g_rl78_branch_pairs[index];
+
+		if (inst[0] == (grow ? pair->short_opcode : pair->long_opcode))
+		{
+			*length = (uint8_t)(grow ? 1 + pair->short_width : 4);
+			*form = (lasm_relax_form_s)
+			{
+				.bytes        = { (grow ? pair->long_opcode : pair->short_opcode), },
+				.length       = (uint8_t)(grow ? 4 : 1 + pair->short_width),
+				.field_offset = 1,
+				.field_width  = (grow ? 3 : pair->short_width),
+				.kind         = kind,
+			};
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool_t _relax_direct(const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(length != NULL);
+	lasm_debug_assert(form != NULL);
+
+	const uint16_t current = rl78_isa_decode(inst, lasm_relax_form_capacity);
+
+	if (UINT16_MAX == current)
+	{
+		return false;
+	}
+
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[current];
+	const uint8_t direct = ((rl78_isa_direct_kind((rl78_pattern_e)encoding->patterns[0]) != lasm_ir_fixup_kinds_count) ? 0 : 1);
+
+	if (rl78_isa_direct_kind((rl78_pattern_e)encoding->patterns[direct]) == lasm_ir_fixup_kinds_count)
+	{
+		return false;
+	}
+
+	const uint16_t other = rl78_isa_direct_form(current, direct, kind);
+
+	if ((UINT16_MAX == other) || (other == current))
+	{
+		return false;
+	}
+
+	// note: the other form keeps the es prefix, the codes of the operands in
+	// the opcode, and the fields of the other operand.
+	const rl78_isa_encoding_s* const target = &rl78_isa_encodings[other];
+	const bool_t extended = (rl78_isa_es_prefix == inst[0]);
+	uint64_t read = (extended ? 1 : 0);
+	uint8_t written = 0;
+
+	*form = (lasm_relax_form_s) { .kind = kind, };
+
+	if (extended)
+	{
+		form->bytes[written++] = rl78_isa_es_prefix;
+	}
+
+	for (uint8_t prefix = 0; (prefix < 2) && (encoding->prefix[prefix] != 0); ++prefix)
+	{
+		++read;
+	}
+
+	for (uint8_t prefix = 0; (prefix < 2) && (target->prefix[prefix] != 0); ++prefix)
+	{
+		form->bytes[written++] = target->prefix[prefix];
+	}
+
+	form->bytes[written++] = (uint8_t)(target->opcode | (inst[read++] - encoding->opcode));
+
+	for (uint8_t operand = 0; operand < 2; ++operand)
+	{
+		const uint8_t width = rl78_isa_field_width((rl78_pattern_e)encoding->patterns[operand]);
+
+		if (operand == direct)
+		{
+			form->field_offset = written;
+			form->field_width = rl78_isa_field_width((rl78_pattern_e)target->patterns[operand]);
+			written = (uint8_t)(written + form->field_width);
+		}
+		else if (width > 0)
+		{
+			lasm_common_memcpy(form->bytes + written, inst + read, width);
+			written = (uint8_t)(written + width);
+		}
+
+		read += width;
+	}
+
+	*length = rl78_isa_length(current, extended);
+	form->length = written;
+	lasm_debug_assert(read == *length);
+	return true;
+}
+
+static bool_t _is_code(const rl78_pattern_e pattern)
+{
+	return (rl78_pattern_code16 == pattern) || (rl78_pattern_abs20 == pattern) ||
+		(rl78_pattern_rel8 == pattern) || (rl78_pattern_rel16 == pattern);
+}
+
+static bool_t _is_relaxable(const lasm_ir_inst_s* const inst, const uint8_t operand_index)
+{
+	lasm_debug_assert(inst != NULL);
+
+	const lasm_ir_operand_s* const operand = &inst->operands[operand_index];
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[inst->opcode];
+	const rl78_pattern_e pattern = (rl78_pattern_e)encoding->patterns[operand_index];
+
+	// note: only the operands, that are written as plain addresses of labels,
+	// are relaxed, as the explicit addressing keeps the form, that it selects.
+	if (!lasm_ir_operand_is_symbolic(operand))
+	{
+		return false;
+	}
+
+	if ((encoding->flags & rl78_isa_flag_relax) != 0)
+	{
+		return _is_code(pattern);
+	}
+
+	switch (rl78_isa_direct_kind(pattern))
+	{
+		case lasm_ir_fixup_kind_lo16:
+		{
+			return ((operand->mode & rl78_mode_mask) == rl78_mode_addr) &&
+				((rl78_isa_direct_form(inst->opcode, operand_index, lasm_ir_fixup_kind_saddr) != UINT16_MAX) ||
+				(rl78_isa_direct_form(inst->opcode, operand_index, lasm_ir_fixup_kind_sfr) != UINT16_MAX));
+		} break;
+
+		case lasm_ir_fixup_kind_saddr:
+		{
+			return (rl78_isa_direct_form(inst->opcode, operand_index, lasm_ir_fixup_kind_sfr) != UINT16_MAX);
+		} break;
+
+		default:
+		{
+			return false;
+		} break;
+	}
+}
+
+static void _encode_operand(lasm_ir_inst_s* const inst, const rl78_isa_encoding_s* const encoding, const uint8_t operand_index, uint8_t* const opcode, uint8_t* const fields, uint8_t* const fields_width)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(encoding != NULL);
+	lasm_debug_assert(opcode != NULL);
+	lasm_debug_assert(fields != NULL);
+	lasm_debug_assert(fields_width != NULL);
+
+	lasm_ir_operand_s* const operand = &inst->operands[operand_index];
+	const rl78_pattern_e pattern = (rl78_pattern_e)encoding->patterns[operand_index];
+	const uint8_t shift = encoding->shifts[operand_index];
+
+	if (shift != rl78_isa_no_shift)
+	{
+		if ((rl78_pattern_table == pattern) || (rl78_pattern_shift8 == pattern) || (rl78_pattern_shift16 == pattern))
+		{
+			(void)_fit_value(inst, operand, pattern);
+		}
+
+		*opcode = (uint8_t)(*opcode | (rl78_isa_code(pattern, operand) << shift));
+	}
+
+	const uint8_t width = rl78_isa_field_width(pattern);
+	const lasm_ir_fixup_kind_e direct_kind = rl78_isa_direct_kind(pattern);
+	lasm_ir_fixup_kind_e kind = lasm_ir_fixup_kind_abs;
+
+	if ((rl78_pattern_rel8 == pattern) || (rl78_pattern_rel16 == pattern))
+	{
+		kind = lasm_ir_fixup_kind_rel;
+	}
+	else if (direct_kind != lasm_ir_fixup_kinds_count)
+	{
+		kind = direct_kind;
+	}
+	else if ((rl78_pattern_imm16 == pattern) || (rl78_pattern_word_b == pattern) ||
+		(rl78_pattern_word_c == pattern) || (rl78_pattern_word_bc == pattern))
+	{
+		// note: the 16 bit addresses of the data are the low 16 bits of the
+		// addresses, as they are extended with 0xF or with the es register.
+		kind = lasm_ir_fixup_kind_lo16;
+	}
+
+	if (0 == width)
+	{
+		return;
+	}
+
+	operand->fixup_width = width;
+	operand->fixup_kind = (uint8_t)kind;
+
+	// note: the relative fields are filled in by the fixups, even when their
+	// targets are constant.
+	const uint64_t value = ((lasm_ir_operand_is_symbolic(operand) || (lasm_ir_fixup_kind_rel == kind)) ? 0 : _fit_value(inst, operand, pattern));
+
+	for (uint8_t byte = 0; byte < width; ++byte)
+	{
+		fields[*fields_width + byte] = (uint8_t)(value >> (byte * 8));
+	}
+
+	*fields_width = (uint8_t)(*fields_width + width);
+}
+
+static uint64_t _fit_value(const lasm_ir_inst_s* const inst, const lasm_ir_operand_s* const operand, const rl78_pattern_e pattern)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(operand != NULL);
+
+	// note: the special function registers, that are written as registers, are
+	// addressed through their fixed addresses.
+	const uint64_t value = ((lasm_ir_operand_type_reg == operand->type) ? rl78_isa_sfr_reg_addr((rl78_reg_e)operand->id) : operand->value);
+	const int64_t signed_value = (int64_t)value;
+
+	switch (pattern)
+	{
+		case rl78_pattern_imm8:
+		case rl78_pattern_imm16:
+		{
+			// note: the immediates may be written as negative numbers, which are
+			// stored in two's complement.
+			const bool_t wide = (rl78_pattern_imm16 == pattern);
+			const bool_t fits = (wide ? ((value <= UINT16_MAX) || ((signed_value >= INT16_MIN) && (signed_value < 0))) :
+				((value <= UINT8_MAX) || ((signed_value >= INT8_MIN) && (signed_value < 0))));
+
+			if (!fits)
+			{
+				_log_rl78_encoder_error(inst->location,
+					"value 0x%lX does not fit into the %u byte field of the instruction.",
+					value, (wide ? 2 : 1)
+				);
+			}
+		} break;
+
+		case rl78_pattern_abs16:
+		case rl78_pattern_abs16_bit:
+		case rl78_pattern_word_b:
+		case rl78_pattern_word_c:
+		case rl78_pattern_word_bc:
+		{
+			if ((value > UINT16_MAX) && ((value < 0xF0000) || (value > 0xFFFFF)))
+			{
+				_log_rl78_encoder_error(inst->location,
+					"address 0x%lX is not addressable with 16 bits. expected an address below 0x10000, or from 0xF0000 to 0xFFFFF.",
+					value
+				);
+			}
+		} break;
+
+		case rl78_pattern_code16:
+		case rl78_pattern_abs20:
+		{
+			const uint64_t limit = ((rl78_pattern_code16 == pattern) ? UINT16_MAX : 0xFFFFF);
+
+			if (value > limit)
+			{
+				_log_rl78_encoder_error(inst->location,
+					"address 0x%lX of the target does not fit into the range from 0x0 to 0x%lX.",
+					value, limit
+				);
+			}
+		} break;
+
+		case rl78_pattern_shift8:
+		case rl78_pattern_shift16:
+		{
+			const uint64_t limit = ((rl78_pattern_shift8 == pattern) ? 7 : 15);
+
+			if ((value < 1) || (value > limit))
+			{
+				_log_rl78_encoder_error(inst->location,
+					"shift count %lu does not fit into the range from 1 to %lu.",
+					value, limit
+				);
+			}
+		} break;
+
+		case rl78_pattern_table:
+		{
+			if (lasm_ir_operand_is_symbolic(operand) || (value < 0x80) || (value > 0xBE) || ((value % 2) != 0))
+			{
+				_log_rl78_encoder_error(inst->location,
+					"callt table entry must be a constant, even address from 0x80 to 0xBE."
+				);
+			}
+		} break;
+
+		default:
+		{
+			// note: the saddr and sfr addresses, and the displacements, were
+			// checked when the operands were matched and parsed.
+		} break;
+	}
+
+	return value;
+}
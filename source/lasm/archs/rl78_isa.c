@@ -0,0 +1,1009 @@
+
+/**
+ * @file rl78_isa.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#include "lasm/archs/rl78_isa.h"
+#include "lasm/debug.h"
+
+#define _ns rl78_isa_no_shift
+
+#define _jump  rl78_isa_flag_jump
+#define _call  rl78_isa_flag_call
+#define _relax rl78_isa_flag_relax
+
+// note: the 1st map has no prefix, the 2nd, the 3rd, and the 4th maps have the
+// 0x61, 0x71, and 0x31 prefixes, and the multiply and divide instructions of
+// the extended cores have the 0xCE 0xFB prefix.
+#define _map1 0x00, 0x00
+#define _map2 0x61, 0x00
+#define _map3 0x71, 0x00
+#define _map4 0x31, 0x00
+#define _mul  0xCE, 0xFB
+#define _ei   0x71, 0x7A  // note: 'set1 psw.7'.
+#define _di   0x71, 0x7B  // note: 'clr1 psw.7'.
+
+#define _form(_mnemonic, _pattern0, _pattern1, _prefix, _opcode, _shift0, _shift1, _flags, _cycles0, _cycles1) \
+	{                                                                          \
+		.mnemonic = (uint8_t)rl78_mnemonic_##_mnemonic,                        \
+		.patterns = { (uint8_t)rl78_pattern_##_pattern0, (uint8_t)rl78_pattern_##_pattern1, }, \
+		.prefix   = { _prefix, },                                              \
+		.opcode   = _opcode,                                                   \
+		.shifts   = { _shift0, _shift1, },                                     \
+		.flags    = _flags,                                                    \
+		.cycles   = { _cycles0, _cycles1, },                                   \
+	}
+
+// note: the 8 bit arithmetic and logic instructions share the same layout in
+// the 1st and the 2nd maps, with one row of the map per instruction.
+#define _alu(_mnemonic, _row)                                                  \
+	_form(_mnemonic, a,      ind_hl,   _map1, (_row) + 0x0D, _ns, _ns, 0, 1, 1), \
+	_form(_mnemonic, a,      imm8,     _map1, (_row) + 0x0C, _ns, _ns, 0, 1, 1), \
+	_form(_mnemonic, a,      saddr,    _map1, (_row) + 0x0B, _ns, _ns, 0, 1, 1), \
+	_form(_mnemonic, a,      hl_byte,  _map1, (_row) + 0x0E, _ns, _ns, 0, 1, 1), \
+	_form(_mnemonic, a,      r8_not_a, _map2, (_row) + 0x08, _ns, 0,   0, 1, 1), \
+	_form(_mnemonic, r8,     a,        _map2, (_row) + 0x00, 0,   _ns, 0, 1, 1), \
+	_form(_mnemonic, a,      hl_b,     _map2, (_row) + 0x80, _ns, _ns, 0, 1, 1), \
+	_form(_mnemonic, a,      hl_c,     _map2, (_row) + 0x82, _ns, _ns, 0, 1, 1), \
+	_form(_mnemonic, a,      abs16,    _map1, (_row) + 0x0F, _ns, _ns, 0, 1, 1), \
+	_form(_mnemonic, saddr,  imm8,     _map1, (_row) + 0x0A, _ns, _ns, 0, 2, 2)
+
+// note: the bit manipulation instructions of the 3rd map, with the bit number
+// in the high nibble of the opcode.
+#define _bit_cy(_mnemonic, _column)                                            \
+	_form(_mnemonic, cy,     a_bit,     _map3, 0x88 + (_column), _ns, 4,   0, 1, 1), \
+	_form(_mnemonic, cy,     hl_bit,    _map3, 0x80 + (_column), _ns, 4,   0, 1, 1), \
+	_form(_mnemonic, cy,     saddr_bit, _map3, 0x00 + (_column), _ns, 4,   0, 1, 1), \
+	_form(_mnemonic, cy,     sfr_bit,   _map3, 0x08 + (_column), _ns, 4,   0, 1, 1)
+
+// note: the bit tests of the 4th map, with the bit number in the high nibble of
+// the opcode, and the relative target after the address.
+#define _bit_test(_mnemonic, _column)                                          \
+	_form(_mnemonic, a_bit,     rel8,  _map4, 0x01 + (_column), 4,   _ns, _jump, 5, 3), \
+	_form(_mnemonic, hl_bit,    rel8,  _map4, 0x81 + (_column), 4,   _ns, _jump, 5, 3), \
+	_form(_mnemonic, saddr_bit, rel8,  _map4, 0x00 + (_column), 4,   _ns, _jump, 5, 3), \
+	_form(_mnemonic, sfr_bit,   rel8,  _map4, 0x80 + (_column), 4,   _ns, _jump, 5, 3)
+
+// note: the forms are grouped by their mnemonics in the order of the enum, and
+// the forms of a mnemonic are matched in the listed order, so the shorter forms
+// go before the longer ones, that accept the same operands. the last columns
+// are the clocks of the forms on the rl78-s3 core, which are listed in the
+// rl78 family user's manual.
+const rl78_isa_encoding_s rl78_isa_encodings[] =
+{
+	_alu(add,  0x00),
+	_alu(addc, 0x10),
+	_form(addw,  ax,        rp,        _map1, 0x01, _ns, 1,   0,              1, 1),
+	_form(addw,  ax,        imm16,     _map1, 0x04, _ns, _ns, 0,              1, 1),
+	_form(addw,  ax,        saddrp,    _map1, 0x06, _ns, _ns, 0,              1, 1),
+	_form(addw,  ax,        hl_byte,   _map2, 0x09, _ns, _ns, 0,              1, 1),
+	_form(addw,  ax,        abs16,     _map1, 0x02, _ns, _ns, 0,              1, 1),
+	_form(addw,  sp,        imm8,      _map1, 0x10, _ns, _ns, 0,              1, 1),
+	_alu(and,  0x50),
+	_bit_cy(and1, 0x05),
+	_form(bc,    rel8,      none,      _map1, 0xDC, _ns, _ns, _jump,          4, 2),
+	_bit_test(bf, 0x04),
+	_form(bh,    rel8,      none,      _map2, 0xC3, _ns, _ns, _jump,          5, 3),
+	_form(bnc,   rel8,      none,      _map1, 0xDE, _ns, _ns, _jump,          4, 2),
+	_form(bnh,   rel8,      none,      _map2, 0xD3, _ns, _ns, _jump,          5, 3),
+	_form(bnz,   rel8,      none,      _map1, 0xDF, _ns, _ns, _jump,          4, 2),
+	_form(br,    ax,        none,      _map2, 0xCB, _ns, _ns, 0,              3, 3),
+	_form(br,    code16,    none,      _map1, 0xED, _ns, _ns, _jump,          3, 3),
+	_form(br,    abs20,     none,      _map1, 0xEC, _ns, _ns, _jump | _relax, 3, 3),
+	_form(br,    rel16,     none,      _map1, 0xEE, _ns, _ns, _jump,          3, 3),
+	_form(br,    rel8,      none,      _map1, 0xEF, _ns, _ns, _jump,          3, 3),
+	_form(brk,   none,      none,      _map2, 0xCC, _ns, _ns, 0,              5, 5),
+	_bit_test(bt, 0x02),
+	_bit_test(btclr, 0x00),
+	_form(bz,    rel8,      none,      _map1, 0xDD, _ns, _ns, _jump,          4, 2),
+	_form(call,  rp,        none,      _map2, 0xCA, 4,   _ns, 0,              3, 3),
+	_form(call,  code16,    none,      _map1, 0xFD, _ns, _ns, _call,          3, 3),
+	_form(call,  abs20,     none,      _map1, 0xFC, _ns, _ns, _call | _relax, 3, 3),
+	_form(call,  rel16,     none,      _map1, 0xFE, _ns, _ns, _call,          3, 3),
+	_form(callt, table,     none,      _map2, 0x84, 0,   _ns, 0,              5, 5),
+	_form(clr1,  cy,        none,      _map3, 0x88, _ns, _ns, 0,              1, 1),
+	_form(clr1,  a_bit,     none,      _map3, 0x8B, 4,   _ns, 0,              1, 1),
+	_form(clr1,  hl_bit,    none,      _map3, 0x83, 4,   _ns, 0,              2, 2),
+	_form(clr1,  saddr_bit, none,      _map3, 0x03, 4,   _ns, 0,              2, 2),
+	_form(clr1,  sfr_bit,   none,      _map3, 0x0B, 4,   _ns, 0,              2, 2),
+	_form(clr1,  abs16_bit, none,      _map3, 0x08, 4,   _ns, 0,              2, 2),
+	_form(clrb,  r8_xacb,   none,      _map1, 0xF0, 0,   _ns, 0,              1, 1),
+	_form(clrb,  saddr,     none,      _map1, 0xF4, _ns, _ns, 0,              1, 1),
+	_form(clrb,  abs16,     none,      _map1, 0xF5, _ns, _ns, 0,              1, 1),
+	_form(clrw,  ax,        none,      _map1, 0xF6, _ns, _ns, 0,              1, 1),
+	_form(clrw,  bc,        none,      _map1, 0xF7, _ns, _ns, 0,              1, 1),
+	_alu(cmp,  0x40),
+	_form(cmp,   abs16,     imm8,      _map1, 0x40, _ns, _ns, 0,              1, 1),
+	_form(cmp0,  r8_xacb,   none,      _map1, 0xD0, 0,   _ns, 0,              1, 1),
+	_form(cmp0,  saddr,     none,      _map1, 0xD4, _ns, _ns, 0,              1, 1),
+	_form(cmp0,  abs16,     none,      _map1, 0xD5, _ns, _ns, 0,              1, 1),
+	_form(cmps,  x,         hl_byte,   _map2, 0xDE, _ns, _ns, 0,              1, 1),
+	_form(cmpw,  ax,        rp_not_ax, _map1, 0x41, _ns, 1,   0,              1, 1),
+	_form(cmpw,  ax,        imm16,     _map1, 0x44, _ns, _ns, 0,              1, 1),
+	_form(cmpw,  ax,        saddrp,    _map1, 0x46, _ns, _ns, 0,              1, 1),
+	_form(cmpw,  ax,        hl_byte,   _map2, 0x49, _ns, _ns, 0,              1, 1),
+	_form(cmpw,  ax,        abs16,     _map1, 0x42, _ns, _ns, 0,              1, 1),
+	_form(dec,   r8,        none,      _map1, 0x90, 0,   _ns, 0,              1, 1),
+	_form(dec,   saddr,     none,      _map1, 0xB4, _ns, _ns, 0,              2, 2),
+	_form(dec,   hl_byte,   none,      _map2, 0x69, _ns, _ns, 0,              2, 2),
+	_form(dec,   abs16,     none,      _map1, 0xB0, _ns, _ns, 0,              2, 2),
+	_form(decw,  rp,        none,      _map1, 0xB1, 1,   _ns, 0,              1, 1),
+	_form(decw,  saddrp,    none,      _map1, 0xB6, _ns, _ns, 0,              2, 2),
+	_form(decw,  hl_byte,   none,      _map2, 0x89, _ns, _ns, 0,              2, 2),
+	_form(decw,  abs16,     none,      _map1, 0xB2, _ns, _ns, 0,              2, 2),
+	_form(di,    none,      none,      _di,   0xFA, _ns, _ns, 0,              4, 4),
+	_form(divhu, none,      none,      _mul,  0x03, _ns, _ns, 0,              9, 9),
+	_form(divwu, none,      none,      _mul,  0x0B, _ns, _ns, 0,              17, 17),
+	_form(ei,    none,      none,      _ei,   0xFA, _ns, _ns, 0,              4, 4),
+	_form(halt,  none,      none,      _map2, 0xED, _ns, _ns, 0,              3, 3),
+	_form(inc,   r8,        none,      _map1, 0x80, 0,   _ns, 0,              1, 1),
+	_form(inc,   saddr,     none,      _map1, 0xA4, _ns, _ns, 0,              2, 2),
+	_form(inc,   hl_byte,   none,      _map2, 0x59, _ns, _ns, 0,              2, 2),
+	_form(inc,   abs16,     none,      _map1, 0xA0, _ns, _ns, 0,              2, 2),
+	_form(incw,  rp,        none,      _map1, 0xA1, 1,   _ns, 0,              1, 1),
+	_form(incw,  saddrp,    none,      _map1, 0xA6, _ns, _ns, 0,              2, 2),
+	_form(incw,  hl_byte,   none,      _map2, 0x79, _ns, _ns, 0,              2, 2),
+	_form(incw,  abs16,     none,      _map1, 0xA2, _ns, _ns, 0,              2, 2),
+	_form(mach,  none,      none,      _mul,  0x06, _ns, _ns, 0,              3, 3),
+	_form(machu, none,      none,      _mul,  0x05, _ns, _ns, 0,              3, 3),
+	_form(mov,   a,         r8_not_a,  _map1, 0x60, _ns, 0,   0,              1, 1),
+	_form(mov,   r8_not_a,  a,         _map1, 0x70, 0,   _ns, 0,              1, 1),
+	_form(mov,   a,         ind_de,    _map1, 0x89, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         ind_hl,    _map1, 0x8B, _ns, _ns, 0,              1, 1),
+	_form(mov,   ind_de,    a,         _map1, 0x99, _ns, _ns, 0,              1, 1),
+	_form(mov,   ind_hl,    a,         _map1, 0x9B, _ns, _ns, 0,              1, 1),
+	_form(mov,   r8,        imm8,      _map1, 0x50, 0,   _ns, 0,              1, 1),
+	_form(mov,   es,        imm8,      _map1, 0x41, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         saddr,     _map1, 0x8D, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         sfr,       _map1, 0x8E, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         de_byte,   _map1, 0x8A, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         hl_byte,   _map1, 0x8C, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         sp_byte,   _map1, 0x88, _ns, _ns, 0,              1, 1),
+	_form(mov,   saddr,     a,         _map1, 0x9D, _ns, _ns, 0,              1, 1),
+	_form(mov,   sfr,       a,         _map1, 0x9E, _ns, _ns, 0,              1, 1),
+	_form(mov,   de_byte,   a,         _map1, 0x9A, _ns, _ns, 0,              1, 1),
+	_form(mov,   hl_byte,   a,         _map1, 0x9C, _ns, _ns, 0,              1, 1),
+	_form(mov,   sp_byte,   a,         _map1, 0x98, _ns, _ns, 0,              1, 1),
+	_form(mov,   x,         saddr,     _map1, 0xD8, _ns, _ns, 0,              1, 1),
+	_form(mov,   b,         saddr,     _map1, 0xE8, _ns, _ns, 0,              1, 1),
+	_form(mov,   c,         saddr,     _map1, 0xF8, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         hl_b,      _map2, 0xC9, _ns, _ns, 0,              1, 1),
+	_form(mov,   hl_b,      a,         _map2, 0xD9, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         hl_c,      _map2, 0xE9, _ns, _ns, 0,              1, 1),
+	_form(mov,   hl_c,      a,         _map2, 0xF9, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         abs16,     _map1, 0x8F, _ns, _ns, 0,              1, 1),
+	_form(mov,   abs16,     a,         _map1, 0x9F, _ns, _ns, 0,              1, 1),
+	_form(mov,   x,         abs16,     _map1, 0xD9, _ns, _ns, 0,              1, 1),
+	_form(mov,   b,         abs16,     _map1, 0xE9, _ns, _ns, 0,              1, 1),
+	_form(mov,   c,         abs16,     _map1, 0xF9, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         word_b,    _map1, 0x09, _ns, _ns, 0,              1, 1),
+	_form(mov,   word_b,    a,         _map1, 0x18, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         word_c,    _map1, 0x29, _ns, _ns, 0,              1, 1),
+	_form(mov,   word_c,    a,         _map1, 0x28, _ns, _ns, 0,              1, 1),
+	_form(mov,   a,         word_bc,   _map1, 0x49, _ns, _ns, 0,              1, 1),
+	_form(mov,   word_bc,   a,         _map1, 0x48, _ns, _ns, 0,              1, 1),
+	_form(mov,   es,        saddr,     _map2, 0xB8, _ns, _ns, 0,              1, 1),
+	_form(mov,   saddr,     imm8,      _map1, 0xCD, _ns, _ns, 0,              1, 1),
+	_form(mov,   sfr,       imm8,      _map1, 0xCE, _ns, _ns, 0,              1, 1),
+	_form(mov,   de_byte,   imm8,      _map1, 0xCA, _ns, _ns, 0,              1, 1),
+	_form(mov,   hl_byte,   imm8,      _map1, 0xCC, _ns, _ns, 0,              1, 1),
+	_form(mov,   sp_byte,   imm8,      _map1, 0xC8, _ns, _ns, 0,              1, 1),
+	_form(mov,   abs16,     imm8,      _map1, 0xCF, _ns, _ns, 0,              1, 1),
+	_form(mov,   word_b,    imm8,      _map1, 0x19, _ns, _ns, 0,              1, 1),
+	_form(mov,   word_c,    imm8,      _map1, 0x38, _ns, _ns, 0,              1, 1),
+	_form(mov,   word_bc,   imm8,      _map1, 0x39, _ns, _ns, 0,              1, 1),
+	_form(mov1,  cy,        a_bit,     _map3, 0x8C, _ns, 4,   0,              1, 1),
+	_form(mov1,  cy,        hl_bit,    _map3, 0x84, _ns, 4,   0,              1, 1),
+	_form(mov1,  cy,        saddr_bit, _map3, 0x04, _ns, 4,   0,              1, 1),
+	_form(mov1,  cy,        sfr_bit,   _map3, 0x0C, _ns, 4,   0,              1, 1),
+	_form(mov1,  a_bit,     cy,        _map3, 0x89, 4,   _ns, 0,              1, 1),
+	_form(mov1,  hl_bit,    cy,        _map3, 0x81, 4,   _ns, 0,              2, 2),
+	_form(mov1,  saddr_bit, cy,        _map3, 0x01, 4,   _ns, 0,              2, 2),
+	_form(mov1,  sfr_bit,   cy,        _map3, 0x09, 4,   _ns, 0,              2, 2),
+	_form(movs,  hl_byte,   x,         _map2, 0xCE, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        rp_not_ax, _map1, 0x11, _ns, 1,   0,              1, 1),
+	_form(movw,  rp_not_ax, ax,        _map1, 0x10, 1,   _ns, 0,              1, 1),
+	_form(movw,  ax,        ind_de,    _map1, 0xA9, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        ind_hl,    _map1, 0xAB, _ns, _ns, 0,              1, 1),
+	_form(movw,  ind_de,    ax,        _map1, 0xB9, _ns, _ns, 0,              1, 1),
+	_form(movw,  ind_hl,    ax,        _map1, 0xBB, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        saddrp,    _map1, 0xAD, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        sfrp,      _map1, 0xAE, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        de_byte,   _map1, 0xAA, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        hl_byte,   _map1, 0xAC, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        sp_byte,   _map1, 0xA8, _ns, _ns, 0,              1, 1),
+	_form(movw,  saddrp,    ax,        _map1, 0xBD, _ns, _ns, 0,              1, 1),
+	_form(movw,  sfrp,      ax,        _map1, 0xBE, _ns, _ns, 0,              1, 1),
+	_form(movw,  de_byte,   ax,        _map1, 0xBA, _ns, _ns, 0,              1, 1),
+	_form(movw,  hl_byte,   ax,        _map1, 0xBC, _ns, _ns, 0,              1, 1),
+	_form(movw,  sp_byte,   ax,        _map1, 0xB8, _ns, _ns, 0,              1, 1),
+	_form(movw,  bc,        saddrp,    _map1, 0xDA, _ns, _ns, 0,              1, 1),
+	_form(movw,  de,        saddrp,    _map1, 0xEA, _ns, _ns, 0,              1, 1),
+	_form(movw,  hl,        saddrp,    _map1, 0xFA, _ns, _ns, 0,              1, 1),
+	_form(movw,  rp,        imm16,     _map1, 0x30, 1,   _ns, 0,              1, 1),
+	_form(movw,  ax,        abs16,     _map1, 0xAF, _ns, _ns, 0,              1, 1),
+	_form(movw,  abs16,     ax,        _map1, 0xBF, _ns, _ns, 0,              1, 1),
+	_form(movw,  bc,        abs16,     _map1, 0xDB, _ns, _ns, 0,              1, 1),
+	_form(movw,  de,        abs16,     _map1, 0xEB, _ns, _ns, 0,              1, 1),
+	_form(movw,  hl,        abs16,     _map1, 0xFB, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        word_b,    _map1, 0x59, _ns, _ns, 0,              1, 1),
+	_form(movw,  word_b,    ax,        _map1, 0x58, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        word_c,    _map1, 0x69, _ns, _ns, 0,              1, 1),
+	_form(movw,  word_c,    ax,        _map1, 0x68, _ns, _ns, 0,              1, 1),
+	_form(movw,  ax,        word_bc,   _map1, 0x79, _ns, _ns, 0,              1, 1),
+	_form(movw,  word_bc,   ax,        _map1, 0x78, _ns, _ns, 0,              1, 1),
+	_form(movw,  saddrp,    imm16,     _map1, 0xC9, _ns, _ns, 0,              1, 1),
+	_form(movw,  sfrp,      imm16,     _map1, 0xCB, _ns, _ns, 0,              1, 1),
+	_form(mulh,  none,      none,      _mul,  0x02, _ns, _ns, 0,              2, 2),
+	_form(mulhu, none,      none,      _mul,  0x01, _ns, _ns, 0,              2, 2),
+	_form(mulu,  x,         none,      _map1, 0xD6, _ns, _ns, 0,              1, 1),
+	_form(nop,   none,      none,      _map1, 0x00, _ns, _ns, 0,              1, 1),
+	_form(not1,  cy,        none,      _map3, 0xC0, _ns, _ns, 0,              1, 1),
+	_form(oneb,  r8_xacb,   none,      _map1, 0xE0, 0,   _ns, 0,              1, 1),
+	_form(oneb,  saddr,     none,      _map1, 0xE4, _ns, _ns, 0,              1, 1),
+	_form(oneb,  abs16,     none,      _map1, 0xE5, _ns, _ns, 0,              1, 1),
+	_form(onew,  ax,        none,      _map1, 0xE6, _ns, _ns, 0,              1, 1),
+	_form(onew,  bc,        none,      _map1, 0xE7, _ns, _ns, 0,              1, 1),
+	_alu(or,   0x60),
+	_bit_cy(or1, 0x06),
+	_form(pop,   rp,        none,      _map1, 0xC0, 1,   _ns, 0,              1, 1),
+	_form(pop,   psw,       none,      _map2, 0xCD, _ns, _ns, 0,              3, 3),
+	_form(push,  rp,        none,      _map1, 0xC1, 1,   _ns, 0,              1, 1),
+	_form(push,  psw,       none,      _map2, 0xDD, _ns, _ns, 0,              1, 1),
+	_form(ret,   none,      none,      _map1, 0xD7, _ns, _ns, 0,              6, 6),
+	_form(retb,  none,      none,      _map2, 0xEC, _ns, _ns, 0,              6, 6),
+	_form(reti,  none,      none,      _map2, 0xFC, _ns, _ns, 0,              6, 6),
+	_form(rol,   a,         one,       _map2, 0xEB, _ns, _ns, 0,              1, 1),
+	_form(rolc,  a,         one,       _map2, 0xDC, _ns, _ns, 0,              1, 1),
+	_form(rolwc, ax,        one,       _map2, 0xEE, _ns, _ns, 0,              1, 1),
+	_form(rolwc, bc,        one,       _map2, 0xFE, _ns, _ns, 0,              1, 1),
+	_form(ror,   a,         one,       _map2, 0xDB, _ns, _ns, 0,              1, 1),
+	_form(rorc,  a,         one,       _map2, 0xFB, _ns, _ns, 0,              1, 1),
+	_form(sar,   a,         shift8,    _map4, 0x0B, _ns, 4,   0,              1, 1),
+	_form(sarw,  ax,        shift16,   _map4, 0x0F, _ns, 4,   0,              1, 1),
+	_form(sel,   rb,        none,      _map2, 0xCF, 4,   _ns, 0,              1, 1),
+	_form(set1,  cy,        none,      _map3, 0x80, _ns, _ns, 0,              1, 1),
+	_form(set1,  a_bit,     none,      _map3, 0x8A, 4,   _ns, 0,              1, 1),
+	_form(set1,  hl_bit,    none,      _map3, 0x82, 4,   _ns, 0,              2, 2),
+	_form(set1,  saddr_bit, none,      _map3, 0x02, 4,   _ns, 0,              2, 2),
+	_form(set1,  sfr_bit,   none,      _map3, 0x0A, 4,   _ns, 0,              2, 2),
+	_form(set1,  abs16_bit, none,      _map3, 0x00, 4,   _ns, 0,              2, 2),
+	_form(shl,   a,         shift8,    _map4, 0x09, _ns, 4,   0,              1, 1),
+	_form(shl,   b,         shift8,    _map4, 0x08, _ns, 4,   0,              1, 1),
+	_form(shl,   c,         shift8,    _map4, 0x07, _ns, 4,   0,              1, 1),
+	_form(shlw,  ax,        shift16,   _map4, 0x0D, _ns, 4,   0,              1, 1),
+	_form(shlw,  bc,        shift16,   _map4, 0x0C, _ns, 4,   0,              1, 1),
+	_form(shr,   a,         shift8,    _map4, 0x0A, _ns, 4,   0,              1, 1),
+	_form(shrw,  ax,        shift16,   _map4, 0x0E, _ns, 4,   0,              1, 1),
+	_form(skc,   none,      none,      _map2, 0xC8, _ns, _ns, 0,              1, 1),
+	_form(skh,   none,      none,      _map2, 0xE3, _ns, _ns, 0,              1, 1),
+	_form(sknc,  none,      none,      _map2, 0xD8, _ns, _ns, 0,              1, 1),
+	_form(sknh,  none,      none,      _map2, 0xF3, _ns, _ns, 0,              1, 1),
+	_form(sknz,  none,      none,      _map2, 0xF8, _ns, _ns, 0,              1, 1),
+	_form(skz,   none,      none,      _map2, 0xE8, _ns, _ns, 0,              1, 1),
+	_form(stop,  none,      none,      _map2, 0xFD, _ns, _ns, 0,              3, 3),
+	_alu(sub,  0x20),
+	_alu(subc, 0x30),
+	_form(subw,  ax,        rp_not_ax, _map1, 0x21, _ns, 1,   0,              1, 1),
+	_form(subw,  ax,        imm16,     _map1, 0x24, _ns, _ns, 0,              1, 1),
+	_form(subw,  ax,        saddrp,    _map1, 0x26, _ns, _ns, 0,              1, 1),
+	_form(subw,  ax,        hl_byte,   _map2, 0x29, _ns, _ns, 0,              1, 1),
+	_form(subw,  ax,        abs16,     _map1, 0x22, _ns, _ns, 0,              1, 1),
+	_form(subw,  sp,        imm8,      _map1, 0x20, _ns, _ns, 0,              1, 1),
+	_form(xch,   a,         x,         _map1, 0x08, _ns, _ns, 0,              1, 1),
+	_form(xch,   a,         r8_not_a,  _map2, 0x88, _ns, 0,   0,              1, 1),
+	_form(xch,   a,         saddr,     _map2, 0xA8, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         sfr,       _map2, 0xAB, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         ind_de,    _map2, 0xAE, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         ind_hl,    _map2, 0xAC, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         de_byte,   _map2, 0xAF, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         hl_byte,   _map2, 0xAD, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         hl_b,      _map2, 0xB9, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         hl_c,      _map2, 0xA9, _ns, _ns, 0,              2, 2),
+	_form(xch,   a,         abs16,     _map2, 0xAA, _ns, _ns, 0,              2, 2),
+	_form(xchw,  ax,        rp_not_ax, _map1, 0x31, _ns, 1,   0,              1, 1),
+	_alu(xor,  0x70),
+	_bit_cy(xor1, 0x07),
+};
+
+#define _rl78_isa_encodings_count (sizeof(rl78_isa_encodings) / sizeof(rl78_isa_encodings[0]))
+
+// note: forms of the decoded first two bytes of the instructions, that are kept
+// as their index plus one, with 0 for the bytes, that were not decoded yet.
+#define _rl78_isa_decoded_none ((uint16_t)0xFFFF)
+#define _rl78_isa_decoded_long ((uint16_t)0xFFFE)  // note: the bytes are a two byte prefix.
+
+static uint16_t _g_rl78_isa_decoded[256 * 256];
+
+_Static_assert(
+	_rl78_isa_encodings_count < UINT16_MAX,
+	"rl78_isa_encodings does not fit into the opcode ids of the instructions!"
+);
+
+static bool_t _is_imm(const lasm_ir_operand_s* const operand);
+
+static bool_t _is_const(const lasm_ir_operand_s* const operand);
+
+static bool_t _in_window(const lasm_ir_operand_s* const operand, const uint64_t first, const uint64_t last, const bool_t even, const bool_t symbolic);
+
+static bool_t _accepts_bit(const rl78_pattern_e pattern);
+
+static bool_t _match_operand(const rl78_pattern_e pattern, const lasm_ir_operand_s* const operand, const bool_t symbolic);
+
+static uint8_t _code_mask(const rl78_pattern_e pattern);
+
+static uint8_t _prefix_length(const rl78_isa_encoding_s* const encoding);
+
+static uint16_t _decode_forms(const uint8_t* const inst, const uint64_t length);
+
+static bool_t _is_long_prefix(const uint8_t* const inst);
+
+static lasm_cycles_end_e _cycles_end(const rl78_isa_encoding_s* const encoding);
+
+uint16_t rl78_isa_match(const rl78_mnemonic_e mnemonic, const lasm_ir_operand_s* const operands, const uint8_t operands_count)
+{
+	lasm_debug_assert(mnemonic < rl78_mnemonics_count);
+	lasm_debug_assert(operands != NULL);
+	lasm_debug_assert(operands_count <= 2);
+
+	// note: the forms are sorted by their mnemonics, so the first form of the
+	// mnemonic is found with a binary search.
+	uint64_t low = 0, high = _rl78_isa_encodings_count;
+
+	while (low < high)
+	{
+		const uint64_t middle = low + ((high - low) / 2);
+
+		if (rl78_isa_encodings[middle].mnemonic < mnemonic)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	// note: the symbolic addresses take the saddr forms only when none of the
+	// other forms match, as their values are not known until the layout.
+	for (uint8_t pass = 0; pass < 2; ++pass)
+	{
+		for (uint64_t form = low; (form < _rl78_isa_encodings_count) && (rl78_isa_encodings[form].mnemonic == mnemonic); ++form)
+		{
+			const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+			const uint8_t count = (uint8_t)((encoding->patterns[0] != rl78_pattern_none) + (encoding->patterns[1] != rl78_pattern_none));
+
+			if (count != operands_count)
+			{
+				continue;
+			}
+
+			bool_t matched = true;
+
+			for (uint8_t operand = 0; matched && (operand < operands_count); ++operand)
+			{
+				const rl78_pattern_e pattern = (rl78_pattern_e)encoding->patterns[operand];
+				const uint8_t flags = operands[operand].mode & (uint8_t)~rl78_mode_mask;
+
+				matched = (!(flags & rl78_mode_flag_es) || rl78_isa_accepts_es(pattern)) &&
+					(((flags & rl78_mode_flag_bit) != 0) == _accepts_bit(pattern)) &&
+					_match_operand(pattern, &operands[operand], (1 == pass));
+			}
+
+			if (matched)
+			{
+				return (uint16_t)form;
+			}
+		}
+	}
+
+	return UINT16_MAX;
+}
+
+uint16_t rl78_isa_find_form(const rl78_mnemonic_e mnemonic, const rl78_pattern_e first, const rl78_pattern_e second)
+{
+	lasm_debug_assert(mnemonic < rl78_mnemonics_count);
+
+	uint64_t low = 0, high = _rl78_isa_encodings_count;
+
+	while (low < high)
+	{
+		const uint64_t middle = low + ((high - low) / 2);
+
+		if (rl78_isa_encodings[middle].mnemonic < mnemonic)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	for (uint64_t form = low; (form < _rl78_isa_encodings_count) && (rl78_isa_encodings[form].mnemonic == mnemonic); ++form)
+	{
+		if ((rl78_isa_encodings[form].patterns[0] == first) && (rl78_isa_encodings[form].patterns[1] == second))
+		{
+			return (uint16_t)form;
+		}
+	}
+
+	return UINT16_MAX;
+}
+
+uint16_t rl78_isa_decode(const uint8_t* const inst, const uint64_t length)
+{
+	lasm_debug_assert(inst != NULL);
+
+	uint64_t skip = 0;
+
+	if ((length > 0) && (rl78_isa_es_prefix == inst[0]))
+	{
+		skip = 1;
+	}
+
+	if ((length - skip) < 3)
+	{
+		return _decode_forms(inst + skip, length - skip);
+	}
+
+	// note: unless the first two bytes after the es prefix are a two byte prefix,
+	// the form depends only on them, so the forms are remembered by those bytes,
+	// and the whole images are decoded without searching the encodings for every
+	// instruction.
+	uint16_t* const decoded = &_g_rl78_isa_decoded[((uint16_t)inst[skip] << 8) | inst[skip + 1]];
+
+	if (0 == *decoded)
+	{
+		const uint16_t form = _decode_forms(inst + skip, length - skip);
+		*decoded = (_is_long_prefix(inst + skip) ? _rl78_isa_decoded_long : ((UINT16_MAX == form) ? _rl78_isa_decoded_none : (uint16_t)(form + 1)));
+		return form;
+	}
+
+	switch (*decoded)
+	{
+		case _rl78_isa_decoded_long: { return _decode_forms(inst + skip, length - skip); } break;
+		case _rl78_isa_decoded_none: { return UINT16_MAX;                                } break;
+		default:                     { return (uint16_t)(*decoded - 1);                  } break;
+	}
+}
+
+uint8_t rl78_isa_length(const uint16_t form, const bool_t extended)
+{
+	lasm_debug_assert(form < _rl78_isa_encodings_count);
+
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+	uint8_t length = (uint8_t)((extended ? 1 : 0) + _prefix_length(encoding) + 1);
+
+	for (uint8_t operand = 0; operand < 2; ++operand)
+	{
+		length = (uint8_t)(length + rl78_isa_field_width((rl78_pattern_e)encoding->patterns[operand]));
+	}
+
+	return length;
+}
+
+bool_t rl78_isa_cycles(const uint8_t* const inst, const uint64_t length, lasm_cycles_inst_s* const cost)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(cost != NULL);
+
+	const uint16_t form = rl78_isa_decode(inst, length);
+
+	if (UINT16_MAX == form)
+	{
+		return false;
+	}
+
+	const uint8_t inst_length = rl78_isa_length(form, (rl78_isa_es_prefix == inst[0]));
+
+	if (inst_length > length)
+	{
+		return false;
+	}
+
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+
+	*cost = (lasm_cycles_inst_s)
+	{
+		.length    = inst_length,
+		.taken     = encoding->cycles[0],
+		.not_taken = encoding->cycles[1],
+		.end       = _cycles_end(encoding),
+	};
+
+	return true;
+}
+
+uint8_t rl78_isa_field_width(const rl78_pattern_e pattern)
+{
+	switch (pattern)
+	{
+		case rl78_pattern_imm8:
+		case rl78_pattern_saddr:
+		case rl78_pattern_saddrp:
+		case rl78_pattern_sfr:
+		case rl78_pattern_sfrp:
+		case rl78_pattern_saddr_bit:
+		case rl78_pattern_sfr_bit:
+		case rl78_pattern_de_byte:
+		case rl78_pattern_hl_byte:
+		case rl78_pattern_sp_byte:
+		case rl78_pattern_rel8:
+		{
+			return 1;
+		} break;
+
+		case rl78_pattern_imm16:
+		case rl78_pattern_abs16:
+		case rl78_pattern_abs16_bit:
+		case rl78_pattern_code16:
+		case rl78_pattern_word_b:
+		case rl78_pattern_word_c:
+		case rl78_pattern_word_bc:
+		case rl78_pattern_rel16:
+		{
+			return 2;
+		} break;
+
+		case rl78_pattern_abs20:
+		{
+			return 3;
+		} break;
+
+		default:
+		{
+			// note: the registers, and the memory operands without displacements,
+			// are implied by the opcode.
+			return 0;
+		} break;
+	}
+}
+
+lasm_ir_fixup_kind_e rl78_isa_direct_kind(const rl78_pattern_e pattern)
+{
+	switch (pattern)
+	{
+		case rl78_pattern_abs16:
+		case rl78_pattern_abs16_bit:
+		{
+			return lasm_ir_fixup_kind_lo16;
+		} break;
+
+		case rl78_pattern_saddr:
+		case rl78_pattern_saddrp:
+		case rl78_pattern_saddr_bit:
+		{
+			return lasm_ir_fixup_kind_saddr;
+		} break;
+
+		case rl78_pattern_sfr:
+		case rl78_pattern_sfrp:
+		case rl78_pattern_sfr_bit:
+		{
+			return lasm_ir_fixup_kind_sfr;
+		} break;
+
+		default:
+		{
+			return lasm_ir_fixup_kinds_count;
+		} break;
+	}
+}
+
+uint16_t rl78_isa_direct_form(const uint16_t form, const uint8_t operand, const lasm_ir_fixup_kind_e kind)
+{
+	lasm_debug_assert(form < _rl78_isa_encodings_count);
+	lasm_debug_assert(operand < 2);
+
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+	const rl78_pattern_e pattern = (rl78_pattern_e)encoding->patterns[operand];
+	const uint8_t other = (uint8_t)(1 - operand);
+	lasm_debug_assert(rl78_isa_direct_kind(pattern) != lasm_ir_fixup_kinds_count);
+
+	// note: the forms of a mnemonic are adjacent, so the search starts from the
+	// first form of the mnemonic, that precedes the given form.
+	uint64_t first = form;
+
+	while ((first > 0) && (rl78_isa_encodings[first - 1].mnemonic == encoding->mnemonic))
+	{
+		--first;
+	}
+
+	for (uint64_t index = first; (index < _rl78_isa_encodings_count) && (rl78_isa_encodings[index].mnemonic == encoding->mnemonic); ++index)
+	{
+		const rl78_isa_encoding_s* const candidate = &rl78_isa_encodings[index];
+		const rl78_pattern_e candidate_pattern = (rl78_pattern_e)candidate->patterns[operand];
+
+		if ((candidate->patterns[other] == encoding->patterns[other]) &&
+			(rl78_isa_direct_kind(candidate_pattern) == kind) && (_accepts_bit(candidate_pattern) == _accepts_bit(pattern)))
+		{
+			return (uint16_t)index;
+		}
+	}
+
+	return UINT16_MAX;
+}
+
+uint8_t rl78_isa_code(const rl78_pattern_e pattern, const lasm_ir_operand_s* const operand)
+{
+	lasm_debug_assert(operand != NULL);
+
+	switch (pattern)
+	{
+		case rl78_pattern_r8:
+		case rl78_pattern_r8_not_a:
+		case rl78_pattern_r8_xacb:
+		{
+			return (uint8_t)(operand->id - rl78_register_x);
+		} break;
+
+		case rl78_pattern_rp:
+		case rl78_pattern_rp_not_ax:
+		{
+			return (uint8_t)(operand->id - rl78_register_ax);
+		} break;
+
+		case rl78_pattern_rb:
+		{
+			return (uint8_t)(operand->id - rl78_register_rb0);
+		} break;
+
+		case rl78_pattern_shift8:
+		case rl78_pattern_shift16:
+		{
+			return (uint8_t)operand->value;
+		} break;
+
+		case rl78_pattern_table:
+		{
+			// note: the callt table entries at 0x80 + (mm * 16) + (nnn * 2) are
+			// encoded as 0b0nnn00mm.
+			const uint64_t entry = operand->value - 0x80;
+			return (uint8_t)((((entry >> 1) & 0x07) << 4) | ((entry >> 4) & 0x03));
+		} break;
+
+		case rl78_pattern_a_bit:
+		case rl78_pattern_hl_bit:
+		case rl78_pattern_saddr_bit:
+		case rl78_pattern_sfr_bit:
+		case rl78_pattern_abs16_bit:
+		{
+			return operand->bit;
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+uint8_t rl78_isa_operand_code(const uint16_t form, const uint8_t opcode, const uint8_t operand)
+{
+	lasm_debug_assert(form < _rl78_isa_encodings_count);
+	lasm_debug_assert(operand < 2);
+
+	const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+
+	if (rl78_isa_no_shift == encoding->shifts[operand])
+	{
+		return 0;
+	}
+
+	return (uint8_t)((opcode >> encoding->shifts[operand]) & _code_mask((rl78_pattern_e)encoding->patterns[operand]));
+}
+
+uint64_t rl78_isa_sfr_reg_addr(const rl78_reg_e reg)
+{
+	switch (reg)
+	{
+		case rl78_register_sp:  { return 0xFFFF8; } break;
+		case rl78_register_psw: { return 0xFFFFA; } break;
+		case rl78_register_cs:  { return 0xFFFFC; } break;
+		case rl78_register_es:  { return 0xFFFFD; } break;
+		case rl78_register_pmc: { return 0xFFFFE; } break;
+		case rl78_register_mem: { return 0xFFFFF; } break;
+		default:                { return 0;       } break;
+	}
+}
+
+bool_t rl78_isa_accepts_es(const rl78_pattern_e pattern)
+{
+	switch (pattern)
+	{
+		case rl78_pattern_abs16:
+		case rl78_pattern_ind_de:
+		case rl78_pattern_ind_hl:
+		case rl78_pattern_de_byte:
+		case rl78_pattern_hl_byte:
+		case rl78_pattern_hl_b:
+		case rl78_pattern_hl_c:
+		case rl78_pattern_word_b:
+		case rl78_pattern_word_c:
+		case rl78_pattern_word_bc:
+		case rl78_pattern_hl_bit:
+		case rl78_pattern_abs16_bit:
+		{
+			return true;
+		} break;
+
+		default:
+		{
+			return false;
+		} break;
+	}
+}
+
+static bool_t _is_imm(const lasm_ir_operand_s* const operand)
+{
+	lasm_debug_assert(operand != NULL);
+	return (lasm_ir_operand_type_imm == operand->type) ||
+		((lasm_ir_operand_type_sym == operand->type) && (lasm_ir_operand_type_imm == operand->id));
+}
+
+static bool_t _is_const(const lasm_ir_operand_s* const operand)
+{
+	lasm_debug_assert(operand != NULL);
+	return (operand->type != lasm_ir_operand_type_sym);
+}
+
+static bool_t _in_window(const lasm_ir_operand_s* const operand, const uint64_t first, const uint64_t last, const bool_t even, const bool_t symbolic)
+{
+	lasm_debug_assert(operand != NULL);
+
+	// note: the special function registers, that are written as registers, are
+	// in the sfr window at their fixed addresses.
+	if (lasm_ir_operand_type_reg == operand->type)
+	{
+		const uint64_t addr = rl78_isa_sfr_reg_addr((rl78_reg_e)operand->id);
+		return (addr >= first) && (addr <= last) && (!even || (0 == (addr % 2)));
+	}
+
+	if ((operand->mode & rl78_mode_mask) != rl78_mode_addr)
+	{
+		return false;
+	}
+
+	// note: a symbolic address is checked against the window by its fixup,
+	// once the address is known.
+	if (!_is_const(operand))
+	{
+		return symbolic;
+	}
+
+	return (operand->value >= first) && (operand->value <= last) && (!even || (0 == (operand->value % 2)));
+}
+
+static bool_t _accepts_bit(const rl78_pattern_e pattern)
+{
+	return (rl78_pattern_a_bit == pattern) || (rl78_pattern_hl_bit == pattern) || (rl78_pattern_saddr_bit == pattern) ||
+		(rl78_pattern_sfr_bit == pattern) || (rl78_pattern_abs16_bit == pattern);
+}
+
+static bool_t _match_operand(const rl78_pattern_e pattern, const lasm_ir_operand_s* const operand, const bool_t symbolic)
+{
+	lasm_debug_assert(operand != NULL);
+
+	const bool_t is_reg = (lasm_ir_operand_type_reg == operand->type);
+	const rl78_reg_e reg = (is_reg ? (rl78_reg_e)operand->id : rl78_registers_count);
+	const rl78_mode_e mode = (rl78_mode_e)(operand->mode & rl78_mode_mask);
+	const bool_t is_zero = _is_const(operand) && (0 == operand->value);
+
+	switch (pattern)
+	{
+		case rl78_pattern_r8:        { return is_reg && (reg <= rl78_register_h); } break;
+		case rl78_pattern_r8_not_a:  { return is_reg && (reg <= rl78_register_h) && (reg != rl78_register_a); } break;
+		case rl78_pattern_r8_xacb:   { return is_reg && (reg <= rl78_register_b); } break;
+		case rl78_pattern_rp:        { return is_reg && (reg >= rl78_register_ax) && (reg <= rl78_register_hl); } break;
+		case rl78_pattern_rp_not_ax: { return is_reg && (reg >= rl78_register_bc) && (reg <= rl78_register_hl); } break;
+		case rl78_pattern_rb:        { return is_reg && (reg >= rl78_register_rb0) && (reg <= rl78_register_rb3); } break;
+		case rl78_pattern_x:         { return is_reg && (rl78_register_x   == reg); } break;
+		case rl78_pattern_a:         { return is_reg && (rl78_register_a   == reg); } break;
+		case rl78_pattern_b:         { return is_reg && (rl78_register_b   == reg); } break;
+		case rl78_pattern_c:         { return is_reg && (rl78_register_c   == reg); } break;
+		case rl78_pattern_ax:        { return is_reg && (rl78_register_ax  == reg); } break;
+		case rl78_pattern_bc:        { return is_reg && (rl78_register_bc  == reg); } break;
+		case rl78_pattern_de:        { return is_reg && (rl78_register_de  == reg); } break;
+		case rl78_pattern_hl:        { return is_reg && (rl78_register_hl  == reg); } break;
+		case rl78_pattern_sp:        { return is_reg && (rl78_register_sp  == reg); } break;
+		case rl78_pattern_es:        { return is_reg && (rl78_register_es  == reg); } break;
+		case rl78_pattern_psw:       { return is_reg && (rl78_register_psw == reg); } break;
+		case rl78_pattern_cy:        { return is_reg && (rl78_register_cy  == reg); } break;
+		case rl78_pattern_a_bit:     { return is_reg && (rl78_register_a   == reg); } break;
+
+		case rl78_pattern_imm8:
+		case rl78_pattern_imm16:     { return _is_imm(operand); } break;
+
+		// note: the counts are written without the '#', as in 'shl a, 3'.
+		case rl78_pattern_one:       { return ((rl78_mode_addr == mode) || _is_imm(operand)) && _is_const(operand) && (1 == operand->value); } break;
+		case rl78_pattern_shift8:
+		case rl78_pattern_shift16:   { return ((rl78_mode_addr == mode) || _is_imm(operand)) && _is_const(operand); } break;
+
+		case rl78_pattern_saddr:
+		case rl78_pattern_saddr_bit: { return _in_window(operand, rl78_isa_saddr_first, rl78_isa_saddr_last, false, symbolic); } break;
+		case rl78_pattern_saddrp:    { return _in_window(operand, rl78_isa_saddr_first, rl78_isa_saddr_last, true, symbolic);  } break;
+		case rl78_pattern_sfr:
+		case rl78_pattern_sfr_bit:   { return (reg != rl78_register_sp) && _in_window(operand, rl78_isa_sfr_first, rl78_isa_sfr_last, false, false); } break;
+		case rl78_pattern_sfrp:      { return _in_window(operand, rl78_isa_sfr_first, rl78_isa_sfr_last, true, false); } break;
+
+		case rl78_pattern_abs16:
+		case rl78_pattern_abs16_bit: { return (rl78_mode_abs16 == mode) || (rl78_mode_addr == mode); } break;
+		case rl78_pattern_code16:    { return (rl78_mode_abs16 == mode) || ((rl78_mode_addr == mode) && _is_const(operand) && (operand->value <= UINT16_MAX)); } break;
+		case rl78_pattern_abs20:     { return (rl78_mode_abs20 == mode) || (rl78_mode_addr == mode); } break;
+		case rl78_pattern_rel8:      { return (rl78_mode_rel8  == mode) || (rl78_mode_addr == mode); } break;
+		case rl78_pattern_rel16:     { return (rl78_mode_rel16 == mode); } break;
+
+		// note: a zero displacement takes the shorter form without it, and the
+		// forms with the displacement also take the operands without it.
+		case rl78_pattern_ind_de:    { return (rl78_mode_de == mode) || ((rl78_mode_de_byte == mode) && is_zero); } break;
+		case rl78_pattern_ind_hl:
+		case rl78_pattern_hl_bit:    { return (rl78_mode_hl == mode) || ((rl78_mode_hl_byte == mode) && is_zero); } break;
+		case rl78_pattern_de_byte:   { return (rl78_mode_de_byte == mode) || (rl78_mode_de == mode); } break;
+		case rl78_pattern_hl_byte:   { return (rl78_mode_hl_byte == mode) || (rl78_mode_hl == mode); } break;
+		case rl78_pattern_sp_byte:   { return (rl78_mode_sp_byte == mode); } break;
+		case rl78_pattern_hl_b:      { return (rl78_mode_hl_b == mode); } break;
+		case rl78_pattern_hl_c:      { return (rl78_mode_hl_c == mode); } break;
+		case rl78_pattern_word_b:    { return (rl78_mode_word_b == mode); } break;
+		case rl78_pattern_word_c:    { return (rl78_mode_word_c == mode); } break;
+		case rl78_pattern_word_bc:   { return (rl78_mode_word_bc == mode); } break;
+		case rl78_pattern_table:     { return (rl78_mode_table == mode); } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return false;
+		} break;
+	}
+}
+
+static uint8_t _code_mask(const rl78_pattern_e pattern)
+{
+	switch (pattern)
+	{
+		case rl78_pattern_r8:
+		case rl78_pattern_r8_not_a:
+		case rl78_pattern_shift8:
+		case rl78_pattern_a_bit:
+		case rl78_pattern_hl_bit:
+		case rl78_pattern_saddr_bit:
+		case rl78_pattern_sfr_bit:
+		case rl78_pattern_abs16_bit: { return 0x07; } break;
+		case rl78_pattern_r8_xacb:
+		case rl78_pattern_rp:
+		case rl78_pattern_rp_not_ax:
+		case rl78_pattern_rb:        { return 0x03; } break;
+		case rl78_pattern_shift16:   { return 0x0F; } break;
+		case rl78_pattern_table:     { return 0x73; } break;
+		default:                     { return 0x00; } break;
+	}
+}
+
+static uint8_t _prefix_length(const rl78_isa_encoding_s* const encoding)
+{
+	lasm_debug_assert(encoding != NULL);
+	return (uint8_t)((encoding->prefix[0] != 0) + (encoding->prefix[1] != 0));
+}
+
+static lasm_cycles_end_e _cycles_end(const rl78_isa_encoding_s* const encoding)
+{
+	lasm_debug_assert(encoding != NULL);
+
+	switch (encoding->mnemonic)
+	{
+		case rl78_mnemonic_br:
+		case rl78_mnemonic_ret:
+		case rl78_mnemonic_reti:
+		case rl78_mnemonic_retb:  { return lasm_cycles_end_exit;   } break;
+
+		case rl78_mnemonic_bc:
+		case rl78_mnemonic_bnc:
+		case rl78_mnemonic_bz:
+		case rl78_mnemonic_bnz:
+		case rl78_mnemonic_bh:
+		case rl78_mnemonic_bnh:
+		case rl78_mnemonic_bt:
+		case rl78_mnemonic_bf:
+		case rl78_mnemonic_btclr: { return lasm_cycles_end_branch; } break;
+
+		case rl78_mnemonic_skc:
+		case rl78_mnemonic_sknc:
+		case rl78_mnemonic_skz:
+		case rl78_mnemonic_sknz:
+		case rl78_mnemonic_skh:
+		case rl78_mnemonic_sknh:  { return lasm_cycles_end_skip;   } break;
+
+		default:                  { return lasm_cycles_end_none;   } break;
+	}
+}
+
+static uint16_t _decode_forms(const uint8_t* const inst, const uint64_t length)
+{
+	lasm_debug_assert(inst != NULL);
+
+	// note: the forms with the longer prefixes are tried first, as the 0xCE 0xFB
+	// prefix of the multiply and divide instructions is also a 'mov sfr, #byte'.
+	for (uint8_t prefix_length = 3; prefix_length-- > 0; )
+	{
+		if (prefix_length >= length)
+		{
+			continue;
+		}
+
+		for (uint64_t form = 0; form < _rl78_isa_encodings_count; ++form)
+		{
+			const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+			uint8_t mask = 0;
+
+			// note: the opcode is read only after its prefixes match, so the bytes
+			// past the end of a shorter instruction are never read.
+			if ((_prefix_length(encoding) != prefix_length) ||
+				((prefix_length > 0) && (lasm_common_memcmp(encoding->prefix, inst, prefix_length) != 0)))
+			{
+				continue;
+			}
+
+			const uint8_t opcode = inst[prefix_length];
+
+			for (uint8_t operand = 0; operand < 2; ++operand)
+			{
+				if (encoding->shifts[operand] != rl78_isa_no_shift)
+				{
+					mask = (uint8_t)(mask | (_code_mask((rl78_pattern_e)encoding->patterns[operand]) << encoding->shifts[operand]));
+				}
+			}
+
+			if ((opcode & (uint8_t)~mask) != encoding->opcode)
+			{
+				continue;
+			}
+
+			// note: the codes, that the patterns exclude, belong to other forms,
+			// or to the prefixes.
+			bool_t valid = true;
+
+			for (uint8_t operand = 0; operand < 2; ++operand)
+			{
+				const rl78_pattern_e pattern = (rl78_pattern_e)encoding->patterns[operand];
+				const uint8_t code = rl78_isa_operand_code((uint16_t)form, opcode, operand);
+
+				valid &= ((rl78_pattern_r8_not_a != pattern) || (code != (rl78_register_a - rl78_register_x)));
+				valid &= ((rl78_pattern_rp_not_ax != pattern) || (code != 0));
+				valid &= ((rl78_pattern_shift8 != pattern) || (code != 0));
+				valid &= ((rl78_pattern_shift16 != pattern) || (code != 0));
+			}
+
+			if (valid)
+			{
+				return (uint16_t)form;
+			}
+		}
+	}
+
+	return UINT16_MAX;
+}
+
+static bool_t _is_long_prefix(const uint8_t* const inst)
+{
+	lasm_debug_assert(inst != NULL);
+
+	for (uint64_t form = 0; form < _rl78_isa_encodings_count; ++form)
+	{
+		const rl78_isa_encoding_s* const encoding = &rl78_isa_encodings[form];
+
+		if ((2 == _prefix_length(encoding)) && (lasm_common_memcmp(encoding->prefix, inst, 2) == 0))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
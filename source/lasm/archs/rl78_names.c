@@ -0,0 +1,216 @@
+
+/**
+ * @file rl78_names.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+// note: this file is generated by './scripts/gen_isa.py' from './source/lasm/archs/archs.isa'.
+// do not edit it by hand!
+
+#include "lasm/archs/rl78_names.h"
+#include "lasm/debug.h"
+
+#define _mix_multiplier ((uint64_t)0x9E3779B97F4A7C15)
+
+static const char_t* const _g_rl78_mnemonic_names[rl78_mnemonics_count] =
+{
+	[rl78_mnemonic_add]   = "add",
+	[rl78_mnemonic_addc]  = "addc",
+	[rl78_mnemonic_addw]  = "addw",
+	[rl78_mnemonic_and]   = "and",
+	[rl78_mnemonic_and1]  = "and1",
+	[rl78_mnemonic_bc]    = "bc",
+	[rl78_mnemonic_bf]    = "bf",
+	[rl78_mnemonic_bh]    = "bh",
+	[rl78_mnemonic_bnc]   = "bnc",
+	[rl78_mnemonic_bnh]   = "bnh",
+	[rl78_mnemonic_bnz]   = "bnz",
+	[rl78_mnemonic_br]    = "br",
+	[rl78_mnemonic_brk]   = "brk",
+	[rl78_mnemonic_bt]    = "bt",
+	[rl78_mnemonic_btclr] = "btclr",
+	[rl78_mnemonic_bz]    = "bz",
+	[rl78_mnemonic_call]  = "call",
+	[rl78_mnemonic_callt] = "callt",
+	[rl78_mnemonic_clr1]  = "clr1",
+	[rl78_mnemonic_clrb]  = "clrb",
+	[rl78_mnemonic_clrw]  = "clrw",
+	[rl78_mnemonic_cmp]   = "cmp",
+	[rl78_mnemonic_cmp0]  = "cmp0",
+	[rl78_mnemonic_cmps]  = "cmps",
+	[rl78_mnemonic_cmpw]  = "cmpw",
+	[rl78_mnemonic_dec]   = "dec",
+	[rl78_mnemonic_decw]  = "decw",
+	[rl78_mnemonic_di]    = "di",
+	[rl78_mnemonic_divhu] = "divhu",
+	[rl78_mnemonic_divwu] = "divwu",
+	[rl78_mnemonic_ei]    = "ei",
+	[rl78_mnemonic_halt]  = "halt",
+	[rl78_mnemonic_inc]   = "inc",
+	[rl78_mnemonic_incw]  = "incw",
+	[rl78_mnemonic_mach]  = "mach",
+	[rl78_mnemonic_machu] = "machu",
+	[rl78_mnemonic_mov]   = "mov",
+	[rl78_mnemonic_mov1]  = "mov1",
+	[rl78_mnemonic_movs]  = "movs",
+	[rl78_mnemonic_movw]  = "movw",
+	[rl78_mnemonic_mulh]  = "mulh",
+	[rl78_mnemonic_mulhu] = "mulhu",
+	[rl78_mnemonic_mulu]  = "mulu",
+	[rl78_mnemonic_nop]   = "nop",
+	[rl78_mnemonic_not1]  = "not1",
+	[rl78_mnemonic_oneb]  = "oneb",
+	[rl78_mnemonic_onew]  = "onew",
+	[rl78_mnemonic_or]    = "or",
+	[rl78_mnemonic_or1]   = "or1",
+	[rl78_mnemonic_pop]   = "pop",
+	[rl78_mnemonic_push]  = "push",
+	[rl78_mnemonic_ret]   = "ret",
+	[rl78_mnemonic_retb]  = "retb",
+	[rl78_mnemonic_reti]  = "reti",
+	[rl78_mnemonic_rol]   = "rol",
+	[rl78_mnemonic_rolc]  = "rolc",
+	[rl78_mnemonic_rolwc] = "rolwc",
+	[rl78_mnemonic_ror]   = "ror",
+	[rl78_mnemonic_rorc]  = "rorc",
+	[rl78_mnemonic_sar]   = "sar",
+	[rl78_mnemonic_sarw]  = "sarw",
+	[rl78_mnemonic_sel]   = "sel",
+	[rl78_mnemonic_set1]  = "set1",
+	[rl78_mnemonic_shl]   = "shl",
+	[rl78_mnemonic_shlw]  = "shlw",
+	[rl78_mnemonic_shr]   = "shr",
+	[rl78_mnemonic_shrw]  = "shrw",
+	[rl78_mnemonic_skc]   = "skc",
+	[rl78_mnemonic_skh]   = "skh",
+	[rl78_mnemonic_sknc]  = "sknc",
+	[rl78_mnemonic_sknh]  = "sknh",
+	[rl78_mnemonic_sknz]  = "sknz",
+	[rl78_mnemonic_skz]   = "skz",
+	[rl78_mnemonic_stop]  = "stop",
+	[rl78_mnemonic_sub]   = "sub",
+	[rl78_mnemonic_subc]  = "subc",
+	[rl78_mnemonic_subw]  = "subw",
+	[rl78_mnemonic_xch]   = "xch",
+	[rl78_mnemonic_xchw]  = "xchw",
+	[rl78_mnemonic_xor]   = "xor",
+	[rl78_mnemonic_xor1]  = "xor1",
+};
+
+static const uint32_t _g_rl78_mnemonic_seeds[41] =
+{
+	0x00000001, 0x00000000, 0x00000000, 0x00000001, 0x00000001, 0x00000000, 0x00000001, 0x00000002,
+	0x00000000, 0x00000003, 0x00000000, 0x00000000, 0x00000001, 0x00000000, 0x00000000, 0x00000002,
+	0x00000000, 0x00000000, 0x00000000, 0x00000001, 0x00000000, 0x00000004, 0x00000001, 0x00000000,
+	0x00000000, 0x00000004, 0x00000000, 0x00000000, 0x00000006, 0x00000003, 0x00000005, 0x00000002,
+	0x00000003, 0x0000000A, 0x00000004, 0x00000002, 0x00000001, 0x00000007, 0x00000000, 0x00000004,
+	0x00000011,
+};
+
+// note: rl78_mnemonics_count marks the empty slots.
+static const uint8_t _g_rl78_mnemonic_slots[128] =
+{
+	 81,  81,  12,  72,  61,  81,  39,  31,  44,  81,  59,  81,  81,  58,  28,  71,
+	 81,  81,  81,  56,  81,  50,  77,  25,  81,  53,  37,  81,  81,  70,  46,  63,
+	 23,  81,  66,  81,  14,   9,  30,  81,  78,  81,  81,  51,  81,  43,  60,  26,
+	 18,  81,  19,  81,  81,  62,  81,  20,  57,  48,  81,  81,  54,  29,  76,  81,
+	 52,  35,  68,  81,  81,  81,  81,   6,  49,  80,  81,  81,  16,  75,  36,  27,
+	 81,  81,  81,  24,  81,  81,  15,  10,   8,  17,  32,  81,  67,   2,  65,   1,
+	 38,  81,  81,  34,  69,  73,  81,  47,  79,  81,  45,   3,  55,  42,  13,  81,
+	 81,   4,  64,   5,  22,  11,  81,  33,  41,  21,   7,  74,  81,  81,   0,  40,
+};
+
+static const char_t* const _g_rl78_register_names[rl78_registers_count] =
+{
+	[rl78_register_x]   = "x",
+	[rl78_register_a]   = "a",
+	[rl78_register_c]   = "c",
+	[rl78_register_b]   = "b",
+	[rl78_register_e]   = "e",
+	[rl78_register_d]   = "d",
+	[rl78_register_l]   = "l",
+	[rl78_register_h]   = "h",
+	[rl78_register_ax]  = "ax",
+	[rl78_register_bc]  = "bc",
+	[rl78_register_de]  = "de",
+	[rl78_register_hl]  = "hl",
+	[rl78_register_sp]  = "sp",
+	[rl78_register_psw] = "psw",
+	[rl78_register_cs]  = "cs",
+	[rl78_register_es]  = "es",
+	[rl78_register_pmc] = "pmc",
+	[rl78_register_mem] = "mem",
+	[rl78_register_cy]  = "cy",
+	[rl78_register_rb0] = "rb0",
+	[rl78_register_rb1] = "rb1",
+	[rl78_register_rb2] = "rb2",
+	[rl78_register_rb3] = "rb3",
+};
+
+static const uint32_t _g_rl78_register_seeds[12] =
+{
+	0x00000002, 0x00000003, 0x00000001, 0x00000000, 0x00000000, 0x00000006, 0x00000002, 0x00000000,
+	0x00000001, 0x00000002, 0x00000003, 0x00000001,
+};
+
+// note: rl78_registers_count marks the empty slots.
+static const uint8_t _g_rl78_register_slots[32] =
+{
+	  9,  19,  12,   1,   6,  23,  20,  15,  23,   4,   3,  23,  11,  16,  23,  23,
+	  2,   8,  13,  23,  21,  23,  14,  18,  23,   0,  22,  17,  10,   5,   7,  23,
+};
+
+static uint64_t _find_name(const char_t* const* const names, const uint64_t count, const uint32_t* const seeds, const uint64_t seeds_count,
+	const uint8_t* const slots, const uint64_t slots_count, const char_t* const name);
+
+rl78_mnemonic_e rl78_isa_find_mnemonic(const char_t* const name)
+{
+	lasm_debug_assert(name != NULL);
+	return (rl78_mnemonic_e)_find_name(_g_rl78_mnemonic_names, rl78_mnemonics_count,
+		_g_rl78_mnemonic_seeds, sizeof(_g_rl78_mnemonic_seeds) / sizeof(_g_rl78_mnemonic_seeds[0]),
+		_g_rl78_mnemonic_slots, sizeof(_g_rl78_mnemonic_slots) / sizeof(_g_rl78_mnemonic_slots[0]), name);
+}
+
+const char_t* rl78_isa_mnemonic_name(const rl78_mnemonic_e mnemonic)
+{
+	lasm_debug_assert(mnemonic < rl78_mnemonics_count);
+	return _g_rl78_mnemonic_names[mnemonic];
+}
+
+rl78_reg_e rl78_isa_find_reg(const char_t* const name)
+{
+	lasm_debug_assert(name != NULL);
+	return (rl78_reg_e)_find_name(_g_rl78_register_names, rl78_registers_count,
+		_g_rl78_register_seeds, sizeof(_g_rl78_register_seeds) / sizeof(_g_rl78_register_seeds[0]),
+		_g_rl78_register_slots, sizeof(_g_rl78_register_slots) / sizeof(_g_rl78_register_slots[0]), name);
+}
+
+const char_t* rl78_isa_reg_name(const rl78_reg_e reg)
+{
+	lasm_debug_assert(reg < rl78_registers_count);
+	return _g_rl78_register_names[reg];
+}
+
+static uint64_t _find_name(const char_t* const* const names, const uint64_t count, const uint32_t* const seeds, const uint64_t seeds_count,
+	const uint8_t* const slots, const uint64_t slots_count, const char_t* const name)
+{
+	lasm_debug_assert(names != NULL);
+	lasm_debug_assert(seeds != NULL);
+	lasm_debug_assert(slots != NULL);
+	lasm_debug_assert(name != NULL);
+
+	// note: the first hash of the name picks its bucket, and the seed of the
+	// bucket displaces the hash to the slot of the name.
+	const uint64_t hash = lasm_common_hash(lasm_common_hash_seed, name, lasm_common_strlen(name));
+	const uint64_t bucket = ((hash * _mix_multiplier) >> 32) % seeds_count;
+	const uint64_t slot = (((hash ^ seeds[bucket]) * _mix_multiplier) >> 32) % slots_count;
+	const uint64_t index = slots[slot];
+
+	return (((index < count) && (lasm_common_strcmp(names[index], name) == 0)) ? index : count);
+}
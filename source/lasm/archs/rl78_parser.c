@@ -11,20 +11,363 @@
  */
 
 #include "lasm/archs/rl78_parser.h"
+#include "lasm/expr.h"
+#include "lasm/local.h"
+#include "lasm/data.h"
 #include "lasm/debug.h"
 #include "lasm/logger.h"
 
+#include <stdio.h>
+
+#define _log_rl78_parser_error(_location, _format, ...)                        \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+// note: https://llvm-gcc-renesas.com/pdf/r01us0015ej0220_rl78.pdf.
+
+static bool_t _is_same_line(const lasm_tokens_vector_s* const tokens, const uint64_t index, const lasm_token_s* const mnemonic);
+
+static bool_t _is_token(const lasm_tokens_vector_s* const tokens, const uint64_t index, const lasm_token_type_e type);
+
+static rl78_reg_e _reg_from_token(const lasm_token_s* const token);
+
+static void _expect_token(const lasm_tokens_vector_s* const tokens, uint64_t* const index, const lasm_token_type_e type, const lasm_token_s* const start);
+
+static lasm_ir_operand_s _parse_indirect(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index);
+
+static lasm_ir_operand_s _parse_operand(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index);
+
+static void _parse_inst(lasm_lexer_s* const lexer, lasm_ast_label_s* const label, uint64_t* const index);
+
 void rl78_parser_parse_tokens(lasm_lexer_s* const lexer, lasm_labels_vector_s* const labels, lasm_ast_label_s* const label)
 {
 	lasm_debug_assert(lexer != NULL);
 	lasm_debug_assert(labels != NULL);
 	lasm_debug_assert(label != NULL);
 
-	// note: https://llvm-gcc-renesas.com/pdf/r01us0015ej0220_rl78.pdf.
+	for (uint64_t index = 0; index < label->body_tokens.count;)
+	{
+		if (!lasm_local_parse(lexer->arena, label, &index) && !lasm_data_parse(lexer, label, &index))
+		{
+			_parse_inst(lexer, label, &index);
+		}
+	}
+}
+
+static bool_t _is_same_line(const lasm_tokens_vector_s* const tokens, const uint64_t index, const lasm_token_s* const mnemonic)
+{
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(mnemonic != NULL);
+	return (index < tokens->count) && (tokens->data[index].location.line == mnemonic->location.line);
+}
+
+static bool_t _is_token(const lasm_tokens_vector_s* const tokens, const uint64_t index, const lasm_token_type_e type)
+{
+	lasm_debug_assert(tokens != NULL);
+	return (index < tokens->count) && (tokens->data[index].type == type);
+}
+
+static rl78_reg_e _reg_from_token(const lasm_token_s* const token)
+{
+	lasm_debug_assert(token != NULL);
+	return ((lasm_token_type_ident == token->type) ? rl78_isa_find_reg(token->as.ident.data) : rl78_registers_count);
+}
+
+static void _expect_token(const lasm_tokens_vector_s* const tokens, uint64_t* const index, const lasm_token_type_e type, const lasm_token_s* const start)
+{
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+	lasm_debug_assert(start != NULL);
+
+	if (!_is_token(tokens, *index, type))
+	{
+		_log_rl78_parser_error(start->location,
+			"expected '%s' to close the operand.",
+			lasm_token_type_to_string(type)
+		);
+	}
+
+	++*index;
+}
+
+static lasm_ir_operand_s _parse_indirect(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+
+	const lasm_token_s* const start = &tokens->data[(*index)++];
+
+	if (*index >= tokens->count)
+	{
+		_log_rl78_parser_error(start->location,
+			"expected a register or an address after '[', but found the end of the label's body."
+		);
+	}
+
+	const rl78_reg_e base = _reg_from_token(&tokens->data[*index]);
+	lasm_ir_operand_s operand = {0};
+
+	// note: an address in brackets is an entry of the callt table.
+	if (rl78_registers_count == base)
+	{
+		operand = lasm_ir_operand_from_expr(lasm_ir_operand_type_mem, lasm_expr_parse(lexer->arena, tokens, index));
+		operand.mode = (uint8_t)rl78_mode_table;
+		_expect_token(tokens, index, lasm_token_type_symbolic_right_bracket, start);
+		return operand;
+	}
+
+	if ((base != rl78_register_de) && (base != rl78_register_hl) && (base != rl78_register_sp))
+	{
+		_log_rl78_parser_error(tokens->data[*index].location,
+			"register '%s' can not be used as the base of a memory operand. expected one of 'de', 'hl', and 'sp'.",
+			tokens->data[*index].as.ident.data
+		);
+	}
+
+	++*index;
+	operand = (lasm_ir_operand_s) { .type = (uint8_t)lasm_ir_operand_type_mem, };
+
+	if (_is_token(tokens, *index, lasm_token_type_symbolic_plus))
+	{
+		++*index;
+		const rl78_reg_e index_reg = ((*index < tokens->count) ? _reg_from_token(&tokens->data[*index]) : rl78_registers_count);
+
+		if ((rl78_register_hl == base) && ((rl78_register_b == index_reg) || (rl78_register_c == index_reg)))
+		{
+			++*index;
+			operand.mode = (uint8_t)((rl78_register_b == index_reg) ? rl78_mode_hl_b : rl78_mode_hl_c);
+		}
+		else
+		{
+			const lasm_ast_expr_s* const expr = lasm_expr_parse(lexer->arena, tokens, index);
+
+			if (!expr->folded)
+			{
+				_log_rl78_parser_error(start->location,
+					"displacement of the base register must be a constant expression, that does not reference any labels."
+				);
+			}
+
+			if (expr->value > UINT8_MAX)
+			{
+				_log_rl78_parser_error(start->location,
+					"displacement 0x%lX of the base register does not fit into the range from 0 to 255.",
+					expr->value
+				);
+			}
+
+			operand.value = expr->value;
+			operand.mode = (uint8_t)((rl78_register_de == base) ? rl78_mode_de_byte : ((rl78_register_hl == base) ? rl78_mode_hl_byte : rl78_mode_sp_byte));
+		}
+	}
+	else if (rl78_register_sp == base)
+	{
+		operand.mode = (uint8_t)rl78_mode_sp_byte;
+	}
+	else
+	{
+		operand.mode = (uint8_t)((rl78_register_de == base) ? rl78_mode_de : rl78_mode_hl);
+	}
+
+	_expect_token(tokens, index, lasm_token_type_symbolic_right_bracket, start);
+	return operand;
+}
+
+static lasm_ir_operand_s _parse_operand(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+	lasm_debug_assert(*index < tokens->count);
+
+	uint8_t flags = 0;
+
+	// note: the 'es:' prefix extends the 16 bit addresses of the memory operands
+	// with the es register.
+	if ((rl78_register_es == _reg_from_token(&tokens->data[*index])) && _is_token(tokens, *index + 1, lasm_token_type_symbolic_colon))
+	{
+		flags |= rl78_mode_flag_es;
+		*index += 2;
+
+		if (*index >= tokens->count)
+		{
+			_log_rl78_parser_error(tokens->data[*index - 1].location,
+				"expected a memory operand after 'es:', but found the end of the label's body."
+			);
+		}
+	}
+
+	const lasm_token_s* const token = &tokens->data[*index];
+	lasm_ir_operand_s operand = {0};
+
+	switch (token->type)
+	{
+		case lasm_token_type_symbolic_hash:
+		{
+			++*index;
+			operand = lasm_ir_operand_from_expr(lasm_ir_operand_type_imm, lasm_expr_parse(lexer->arena, tokens, index));
+		} break;
+
+		case lasm_token_type_symbolic_exclamation:
+		case lasm_token_type_symbolic_dollar:
+		{
+			// note: '!addr16' and '!!addr20' are the absolute addresses, and '$addr20'
+			// and '$!addr20' are the 8 bit and 16 bit relative addresses.
+			const bool_t relative = (lasm_token_type_symbolic_dollar == token->type);
+			const bool_t wide = _is_token(tokens, ++*index, lasm_token_type_symbolic_exclamation);
+			*index += (wide ? 1 : 0);
+
+			if (*index >= tokens->count)
+			{
+				_log_rl78_parser_error(token->location,
+					"expected an address after '%s', but found the end of the label's body.",
+					lasm_token_type_to_string(token->type)
+				);
+			}
+
+			operand = lasm_ir_operand_from_expr(lasm_ir_operand_type_mem, lasm_expr_parse(lexer->arena, tokens, index));
+			operand.mode = (uint8_t)(relative ? (wide ? rl78_mode_rel16 : rl78_mode_rel8) : (wide ? rl78_mode_abs20 : rl78_mode_abs16));
+		} break;
+
+		case lasm_token_type_symbolic_left_bracket:
+		{
+			operand = _parse_indirect(lexer, tokens, index);
+		} break;
+
+		default:
+		{
+			const rl78_reg_e reg = _reg_from_token(token);
+
+			if (reg != rl78_registers_count)
+			{
+				++*index;
+				operand = (lasm_ir_operand_s) { .type = (uint8_t)lasm_ir_operand_type_reg, .id = (uint8_t)reg, };
+				break;
+			}
+
+			operand = lasm_ir_operand_from_expr(lasm_ir_operand_type_mem, lasm_expr_parse(lexer->arena, tokens, index));
+			operand.mode = (uint8_t)rl78_mode_addr;
+
+			// note: 'word[b]', 'word[c]', and 'word[bc]' index the 16 bit base
+			// address with the register.
+			if (_is_token(tokens, *index, lasm_token_type_symbolic_left_bracket))
+			{
+				const lasm_token_s* const start = &tokens->data[(*index)++];
+				const rl78_reg_e index_reg = ((*index < tokens->count) ? _reg_from_token(&tokens->data[*index]) : rl78_registers_count);
+
+				switch (index_reg)
+				{
+					case rl78_register_b:  { operand.mode = (uint8_t)rl78_mode_word_b;  } break;
+					case rl78_register_c:  { operand.mode = (uint8_t)rl78_mode_word_c;  } break;
+					case rl78_register_bc: { operand.mode = (uint8_t)rl78_mode_word_bc; } break;
+
+					default:
+					{
+						_log_rl78_parser_error(start->location,
+							"expected one of 'b', 'c', and 'bc' registers to index the base address."
+						);
+					} break;
+				}
+
+				++*index;
+				_expect_token(tokens, index, lasm_token_type_symbolic_right_bracket, start);
+			}
+		} break;
+	}
+
+	// note: the '.bit' suffix addresses a single bit of the operand.
+	if (_is_token(tokens, *index, lasm_token_type_symbolic_dot))
+	{
+		const lasm_token_s* const dot = &tokens->data[(*index)++];
+
+		if (!_is_token(tokens, *index, lasm_token_type_literal_uval) || (tokens->data[*index].as.uval > 7))
+		{
+			_log_rl78_parser_error(dot->location,
+				"expected a bit number from 0 to 7 after '.'."
+			);
+		}
+
+		operand.bit = (uint8_t)tokens->data[(*index)++].as.uval;
+		flags |= rl78_mode_flag_bit;
+	}
+
+	operand.mode = (uint8_t)(operand.mode | flags);
+	return operand;
+}
+
+static void _parse_inst(lasm_lexer_s* const lexer, lasm_ast_label_s* const label, uint64_t* const index)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(index != NULL);
+
+	const lasm_tokens_vector_s* const tokens = &label->body_tokens;
+	const lasm_token_s* const token = &tokens->data[(*index)++];
 
-	for (uint64_t index = 0; index < label->body_tokens.count; ++index)
+	if (token->type != lasm_token_type_ident)
 	{
-		lasm_token_s* const token = lasm_tokens_vector_at(&label->body_tokens, index);
-		(void)token;
+		_log_rl78_parser_error(token->location,
+			"expected a mnemonic, but found '%s' token.",
+			lasm_token_type_to_string(token->type)
+		);
 	}
+
+	const rl78_mnemonic_e mnemonic = rl78_isa_find_mnemonic(token->as.ident.data);
+
+	if (rl78_mnemonics_count == mnemonic)
+	{
+		_log_rl78_parser_error(token->location,
+			"unknown mnemonic '%s'.",
+			token->as.ident.data
+		);
+	}
+
+	lasm_ir_inst_s inst = lasm_ir_inst_new(0, token->location);
+
+	if (_is_same_line(tokens, *index, token))
+	{
+		while (true)
+		{
+			if (inst.operands_count >= 2)
+			{
+				_log_rl78_parser_error(token->location,
+					"too many operands for the '%s' mnemonic. rl78 instructions take at most 2 operands.",
+					token->as.ident.data
+				);
+			}
+
+			lasm_ir_inst_push_operand(&inst, _parse_operand(lexer, tokens, index));
+
+			if (!_is_token(tokens, *index, lasm_token_type_symbolic_comma))
+			{
+				break;
+			}
+
+			if (++*index >= tokens->count)
+			{
+				_log_rl78_parser_error(tokens->data[*index - 1].location,
+					"expected an operand after ',', but found the end of the label's body."
+				);
+			}
+		}
+	}
+
+	const uint16_t form = rl78_isa_match(mnemonic, inst.operands, inst.operands_count);
+
+	if (UINT16_MAX == form)
+	{
+		_log_rl78_parser_error(token->location,
+			"operands of the '%s' mnemonic do not match any of its forms.",
+			token->as.ident.data
+		);
+	}
+
+	inst.opcode = form;
+	lasm_ir_insts_vector_push(&label->ir, inst);
 }
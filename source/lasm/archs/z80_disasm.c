@@ -0,0 +1,201 @@
+
+/**
+ * @file z80_disasm.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-03
+ */
+
+#include "lasm/archs/z80_disasm.h"
+#include "lasm/debug.h"
+
+#include <stdio.h>
+
+typedef struct
+{
+	const uint8_t* inst;
+	uint16_t form;
+	uint8_t opcode;
+	uint8_t length;
+	z80_reg_e index;  // note: z80_register_ix, z80_register_iy, or z80_register_none.
+	uint64_t addr;
+} _z80_disasm_s;
+
+// note: registers of the codes of the r8, dd, and qq patterns, with the code 6
+// of the r8 pattern being the (hl) memory operand.
+static const z80_reg_e _g_z80_r8_regs[8] =
+{
+	z80_register_b, z80_register_c, z80_register_d, z80_register_e,
+	z80_register_h, z80_register_l, z80_register_none, z80_register_a,
+};
+
+static const z80_reg_e _g_z80_dd_regs[4] = { z80_register_bc, z80_register_de, z80_register_hl, z80_register_sp, };
+
+static const z80_reg_e _g_z80_qq_regs[4] = { z80_register_bc, z80_register_de, z80_register_hl, z80_register_af, };
+
+static uint64_t _write_operand(const _z80_disasm_s* const disasm, const uint8_t operand, char_t* const buffer, const uint64_t capacity);
+
+static uint64_t _write_reg(const _z80_disasm_s* const disasm, const z80_reg_e reg, const bool_t memory, char_t* const buffer, const uint64_t capacity);
+
+static uint64_t _write_indexed(const _z80_disasm_s* const disasm, char_t* const buffer, const uint64_t capacity);
+
+uint8_t z80_disasm_inst(const uint8_t* const inst, const uint64_t length, const uint64_t addr, char_t* const buffer, const uint64_t capacity)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(buffer != NULL);
+	lasm_debug_assert(capacity > 0);
+
+	const uint16_t form = z80_isa_decode(inst, length);
+
+	if ((UINT16_MAX == form) || (z80_isa_length(inst, form) > length))
+	{
+		return 0;
+	}
+
+	const z80_isa_encoding_s* const encoding = &z80_isa_encodings[form];
+	const bool_t indexed = ((0xDD == inst[0]) || (0xFD == inst[0]));
+
+	// note: the displacement of the indexed 0xCB prefixed forms goes before
+	// their opcode.
+	const _z80_disasm_s disasm = (const _z80_disasm_s)
+	{
+		.inst   = inst,
+		.form   = form,
+		.opcode = inst[(indexed ? 1 : 0) + ((encoding->prefix != 0) ? 1 : 0) + ((indexed && (0xCB == encoding->prefix)) ? 1 : 0)],
+		.length = z80_isa_length(inst, form),
+		.index  = (!indexed ? z80_register_none : ((0xDD == inst[0]) ? z80_register_ix : z80_register_iy)),
+		.addr   = addr,
+	};
+
+	// note: the relative targets, that are only reached by wrapping around the
+	// address space, have no address to write, and the 0xED prefixed loads of hl
+	// are always encoded through their shorter forms, so neither is written as an
+	// instruction, that assembles back into the same bytes.
+	for (uint8_t operand = 0; operand < 2; ++operand)
+	{
+		if ((z80_mnemonic_ld == (z80_mnemonic_e)encoding->mnemonic) && (z80_pattern_dd == (z80_pattern_e)encoding->patterns[operand]) &&
+			(0xED == encoding->prefix) && (z80_register_hl == _g_z80_dd_regs[z80_isa_operand_code(form, disasm.opcode, operand)]))
+		{
+			return 0;
+		}
+
+		if (z80_pattern_rel == (z80_pattern_e)encoding->patterns[operand])
+		{
+			const int64_t target = (int64_t)(addr + disasm.length) + (int8_t)inst[disasm.length - 1];
+
+			if ((target < 0) || (target > UINT16_MAX))
+			{
+				return 0;
+			}
+		}
+	}
+
+	uint64_t written = (uint64_t)snprintf(buffer, capacity, "%s", z80_isa_mnemonic_name((z80_mnemonic_e)encoding->mnemonic));
+
+	for (uint8_t operand = 0; (operand < 2) && (encoding->patterns[operand] != z80_pattern_none); ++operand)
+	{
+		lasm_debug_assert(written < capacity);
+		written += (uint64_t)snprintf(buffer + written, capacity - written, "%s", ((0 == operand) ? " " : ", "));
+		lasm_debug_assert(written < capacity);
+		written += _write_operand(&disasm, operand, buffer + written, capacity - written);
+	}
+
+	lasm_debug_assert(written < capacity);
+	return disasm.length;
+}
+
+static uint64_t _write_operand(const _z80_disasm_s* const disasm, const uint8_t operand, char_t* const buffer, const uint64_t capacity)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(buffer != NULL);
+
+	const z80_pattern_e pattern = (z80_pattern_e)z80_isa_encodings[disasm->form].patterns[operand];
+	const uint8_t code = z80_isa_operand_code(disasm->form, disasm->opcode, operand);
+
+	// note: the immediate, the address, or the relative target is the only field
+	// of an instruction, and it ends the instruction.
+	const uint8_t* const end = disasm->inst + disasm->length;
+
+	switch (pattern)
+	{
+		case z80_pattern_r8:
+		case z80_pattern_r8_reg:
+		{
+			if (6 == code)
+			{
+				return ((z80_register_none == disasm->index) ? (uint64_t)snprintf(buffer, capacity, "(hl)") : _write_indexed(disasm, buffer, capacity));
+			}
+
+			return _write_reg(disasm, _g_z80_r8_regs[code], false, buffer, capacity);
+		} break;
+
+		case z80_pattern_dd:     { return _write_reg(disasm, _g_z80_dd_regs[code], false, buffer, capacity); } break;
+		case z80_pattern_qq:     { return _write_reg(disasm, _g_z80_qq_regs[code], false, buffer, capacity); } break;
+		case z80_pattern_a:      { return _write_reg(disasm, z80_register_a, false, buffer, capacity);       } break;
+		case z80_pattern_i:      { return _write_reg(disasm, z80_register_i, false, buffer, capacity);       } break;
+		case z80_pattern_r:      { return _write_reg(disasm, z80_register_r, false, buffer, capacity);       } break;
+		case z80_pattern_hl:     { return _write_reg(disasm, z80_register_hl, false, buffer, capacity);      } break;
+		case z80_pattern_de:     { return _write_reg(disasm, z80_register_de, false, buffer, capacity);      } break;
+		case z80_pattern_sp:     { return _write_reg(disasm, z80_register_sp, false, buffer, capacity);      } break;
+		case z80_pattern_af:     { return _write_reg(disasm, z80_register_af, false, buffer, capacity);      } break;
+		case z80_pattern_ind_bc: { return _write_reg(disasm, z80_register_bc, true, buffer, capacity);       } break;
+		case z80_pattern_ind_de: { return _write_reg(disasm, z80_register_de, true, buffer, capacity);       } break;
+		case z80_pattern_ind_hl: { return _write_reg(disasm, z80_register_hl, true, buffer, capacity);       } break;
+		case z80_pattern_ind_sp: { return _write_reg(disasm, z80_register_sp, true, buffer, capacity);       } break;
+		case z80_pattern_ind_c:  { return _write_reg(disasm, z80_register_c, true, buffer, capacity);        } break;
+		case z80_pattern_ind_nn: { return (uint64_t)snprintf(buffer, capacity, "(0x%04X)", (uint32_t)end[-2] | ((uint32_t)end[-1] << 8)); } break;
+		case z80_pattern_ind_n:  { return (uint64_t)snprintf(buffer, capacity, "(0x%02X)", end[-1]); } break;
+		case z80_pattern_n:      { return (uint64_t)snprintf(buffer, capacity, "0x%02X", end[-1]);   } break;
+		case z80_pattern_nn:     { return (uint64_t)snprintf(buffer, capacity, "0x%04X", (uint32_t)end[-2] | ((uint32_t)end[-1] << 8)); } break;
+
+		case z80_pattern_rel:
+		{
+			// note: the distance is counted from the end of the instruction.
+			const uint64_t target = (uint64_t)((int64_t)(disasm->addr + disasm->length) + (int8_t)end[-1]);
+			return (uint64_t)snprintf(buffer, capacity, "0x%04lX", target);
+		} break;
+
+		case z80_pattern_cc:
+		case z80_pattern_jcc:    { return (uint64_t)snprintf(buffer, capacity, "%s", z80_isa_cond_name((z80_cond_e)code)); } break;
+		case z80_pattern_bit:    { return (uint64_t)snprintf(buffer, capacity, "%u", code);   } break;
+		case z80_pattern_rst:    { return (uint64_t)snprintf(buffer, capacity, "0x%02X", code); } break;
+
+		case z80_pattern_im:
+		{
+			// note: the interrupt modes 1 and 2 are encoded as 2 and 3.
+			return (uint64_t)snprintf(buffer, capacity, "%u", ((code > 0) ? code - 1 : 0));
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static uint64_t _write_reg(const _z80_disasm_s* const disasm, const z80_reg_e reg, const bool_t memory, char_t* const buffer, const uint64_t capacity)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(buffer != NULL);
+
+	// note: with the index prefix, the index register takes the place of hl.
+	const z80_reg_e actual = (((z80_register_hl == reg) && (disasm->index != z80_register_none)) ? disasm->index : reg);
+	return (uint64_t)snprintf(buffer, capacity, (memory ? "(%s)" : "%s"), z80_isa_reg_name(actual));
+}
+
+static uint64_t _write_indexed(const _z80_disasm_s* const disasm, char_t* const buffer, const uint64_t capacity)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(buffer != NULL);
+
+	// note: the displacement follows the index prefix and the opcode, or the
+	// 0xCB prefix, so it is always the third byte.
+	const int32_t displacement = (int8_t)disasm->inst[2];
+	return (uint64_t)snprintf(buffer, capacity, "(%s%c%d)", z80_isa_reg_name(disasm->index),
+		((displacement < 0) ? '-' : '+'), ((displacement < 0) ? -displacement : displacement));
+}
@@ -0,0 +1,329 @@
+
+/**
+ * @file z80_encoder.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-25
+ */
+
+#include "lasm/archs/z80_encoder.h"
+#include "lasm/archs/z80_isa.h"
+#include "lasm/fixup.h"
+#include "lasm/data.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <stdio.h>
+
+#define _log_z80_encoder_error(_location, _format, ...)                        \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+typedef struct
+{
+	uint8_t jp;
+	uint8_t jr;
+} _z80_branch_pair_s;
+
+// note: the unconditional jump, and the conditional jumps, that have both the
+// absolute 'jp' and the relative 'jr' forms.
+static const _z80_branch_pair_s _g_z80_branch_pairs[] =
+{
+	{ .jp = 0xC3, .jr = 0x18, },
+	{ .jp = 0xC2, .jr = 0x20, },
+	{ .jp = 0xCA, .jr = 0x28, },
+	{ .jp = 0xD2, .jr = 0x30, },
+	{ .jp = 0xDA, .jr = 0x38, },
+};
+
+static void _encode_operand(lasm_ir_inst_s* const inst, const z80_isa_encoding_s* const encoding, const uint8_t operand_index, uint8_t* const opcode, uint8_t* const field, uint8_t* const field_width);
+
+void z80_encoder_encode(lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	for (uint64_t index = 0; index < label->ir.count; ++index)
+	{
+		lasm_ir_inst_s* const inst = lasm_ir_insts_vector_at(&label->ir, index);
+
+		if (lasm_ir_opcode_data == inst->opcode)
+		{
+			lasm_data_encode(label, inst);
+			continue;
+		}
+
+		const z80_isa_encoding_s* const encoding = &z80_isa_encodings[inst->opcode];
+		const z80_reg_e index_reg = z80_isa_index_reg(inst->operands, inst->operands_count);
+
+		uint8_t bytes[4] = {0};
+		uint8_t length = 0;
+		uint8_t opcode = encoding->opcode;
+		uint8_t field[2] = {0};
+		uint8_t field_width = 0;
+		bool_t displaced = false;
+		uint8_t displacement = 0;
+
+		for (uint8_t operand_index = 0; operand_index < inst->operands_count; ++operand_index)
+		{
+			const lasm_ir_operand_s* const operand = &inst->operands[operand_index];
+			_encode_operand(inst, encoding, operand_index, &opcode, field, &field_width);
+
+			// note: the (ix+d) and (iy+d) operands take the place of (hl), and they
+			// carry a displacement, except for the target of 'jp (ix)'.
+			if ((index_reg != z80_register_none) && (lasm_ir_operand_type_mem == operand->type) && (operand->id == index_reg) &&
+				(encoding->patterns[operand_index] != z80_pattern_ind_hl))
+			{
+				displaced = true;
+				displacement = (uint8_t)operand->value;
+			}
+		}
+
+		// note: the index prefix goes first, and the displacement of the 0xCB
+		// prefixed forms goes before their opcode.
+		if (index_reg != z80_register_none)
+		{
+			bytes[length++] = ((z80_register_ix == index_reg) ? 0xDD : 0xFD);
+		}
+
+		if (encoding->prefix != 0)
+		{
+			bytes[length++] = encoding->prefix;
+		}
+
+		if (displaced && (0xCB == encoding->prefix))
+		{
+			bytes[length++] = displacement;
+		}
+
+		bytes[length++] = opcode;
+
+		if (displaced && (encoding->prefix != 0xCB))
+		{
+			bytes[length++] = displacement;
+		}
+
+		const uint8_t field_offset = length;
+
+		if (field_width > 0)
+		{
+			lasm_common_memcpy(bytes + length, field, field_width);
+			length = (uint8_t)(length + field_width);
+		}
+
+		bool_t relaxable = ((encoding->flags & z80_isa_flag_relax) != 0);
+
+		for (uint8_t operand_index = 0; operand_index < inst->operands_count; ++operand_index)
+		{
+			lasm_ir_operand_s* const operand = &inst->operands[operand_index];
+
+			if (lasm_ir_operand_type_cond == operand->type)
+			{
+				relaxable &= (operand->id <= z80_cond_c);
+				continue;
+			}
+
+			if (0 == operand->fixup_width)
+			{
+				continue;
+			}
+
+			operand->fixup_offset = field_offset;
+			operand->fixup_flow = (uint8_t)(((encoding->flags & z80_isa_flag_call) != 0) ? lasm_ir_flow_call :
+				(((encoding->flags & z80_isa_flag_jump) != 0) ? lasm_ir_flow_jump : lasm_ir_flow_none));
+
+			// note: only the jumps to labels are relaxed, as a jump to an explicit
+			// address is kept in the form, that it was written in.
+			if (relaxable && lasm_ir_operand_is_symbolic(operand))
+			{
+				operand->fixup_relax = 1;
+			}
+		}
+
+		const uint64_t offset = label->body.count;
+		lasm_bytes_vector_append(&label->body, bytes, length);
+		inst->size = length;
+		lasm_fixups_collect(label, inst, offset);
+	}
+}
+
+bool_t z80_encoder_relax(const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(length != NULL);
+	lasm_debug_assert(form != NULL);
+
+	if ((kind != lasm_ir_fixup_kind_abs) && (kind != lasm_ir_fixup_kind_rel))
+	{
+		return false;
+	}
+
+	const bool_t grow = (lasm_ir_fixup_kind_abs == kind);
+
+	for (uint64_t index = 0; index < (sizeof(_g_z80_branch_pairs) / sizeof(_g_z80_branch_pairs[0])); ++index)
+	{
+		const _z80_branch_pair_s* const pair = &_g_z80_branch_pairs[index];
+
+		if (inst[0] == (grow ? pair->jr : pair->jp))
+		{
+			*length = (grow ? 2 : 3);
+			*form = (lasm_relax_form_s)
+			{
+				.bytes        = { (grow ? pair->jp : pair->jr), },
+				.length       = (grow ? 3 : 2),
+				.field_offset = 1,
+				.field_width  = (grow ? 2 : 1),
+				.kind         = kind,
+			};
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void z80_encoder_trampoline(const uint64_t bank, const uint64_t port, const uint64_t restore, lasm_bank_trampoline_s* const trampoline)
+{
+	lasm_debug_assert(bank <= UINT8_MAX);
+	lasm_debug_assert(port <= UINT8_MAX);
+	lasm_debug_assert((lasm_ast_bank_none == restore) || (restore <= UINT8_MAX));
+	lasm_debug_assert(trampoline != NULL);
+
+	// note: push af; ld a, bank; out (port), a; pop af; followed by either a
+	// 'jp target', or a 'call target' and the same sequence for the caller's
+	// bank before 'ret'.
+	const uint8_t select[] = { 0xF5, 0x3E, (uint8_t)bank, 0xD3, (uint8_t)port, 0xF1, };
+	lasm_common_memcpy(trampoline->bytes, select, sizeof(select));
+	trampoline->field_offset = sizeof(select) + 1;
+
+	if (lasm_ast_bank_none == restore)
+	{
+		const uint8_t jump[] = { 0xC3, 0x00, 0x00, };
+		lasm_common_memcpy(trampoline->bytes + sizeof(select), jump, sizeof(jump));
+		trampoline->length = sizeof(select) + sizeof(jump);
+		return;
+	}
+
+	const uint8_t call[] = { 0xCD, 0x00, 0x00, 0xF5, 0x3E, (uint8_t)restore, 0xD3, (uint8_t)port, 0xF1, 0xC9, };
+	lasm_common_memcpy(trampoline->bytes + sizeof(select), call, sizeof(call));
+	trampoline->length = sizeof(select) + sizeof(call);
+}
+
+static void _encode_operand(lasm_ir_inst_s* const inst, const z80_isa_encoding_s* const encoding, const uint8_t operand_index, uint8_t* const opcode, uint8_t* const field, uint8_t* const field_width)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(encoding != NULL);
+	lasm_debug_assert(opcode != NULL);
+	lasm_debug_assert(field != NULL);
+	lasm_debug_assert(field_width != NULL);
+
+	lasm_ir_operand_s* const operand = &inst->operands[operand_index];
+	const z80_pattern_e pattern = (z80_pattern_e)encoding->patterns[operand_index];
+	const uint8_t shift = encoding->shifts[operand_index];
+	const bool_t symbolic = lasm_ir_operand_is_symbolic(operand);
+
+	switch (pattern)
+	{
+		case z80_pattern_r8:
+		case z80_pattern_r8_reg:
+		case z80_pattern_dd:
+		case z80_pattern_qq:
+		case z80_pattern_cc:
+		case z80_pattern_jcc:
+		{
+			lasm_debug_assert(shift != z80_isa_no_shift);
+			*opcode = (uint8_t)(*opcode | (z80_isa_reg_code(pattern, operand) << shift));
+		} break;
+
+		case z80_pattern_bit:
+		case z80_pattern_rst:
+		case z80_pattern_im:
+		{
+			if (symbolic)
+			{
+				_log_z80_encoder_error(inst->location,
+					"operand of the instruction must be a constant expression, that does not reference any labels."
+				);
+			}
+
+			if ((z80_pattern_bit == pattern) && (operand->value > 7))
+			{
+				_log_z80_encoder_error(inst->location,
+					"bit number %lu does not fit into the range from 0 to 7.",
+					operand->value
+				);
+			}
+
+			if ((z80_pattern_rst == pattern) && ((operand->value > 0x38) || ((operand->value % 8) != 0)))
+			{
+				_log_z80_encoder_error(inst->location,
+					"restart vector 0x%lX must be one of 0x00, 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, and 0x38.",
+					operand->value
+				);
+			}
+
+			if ((z80_pattern_im == pattern) && (operand->value > 2))
+			{
+				_log_z80_encoder_error(inst->location,
+					"interrupt mode %lu must be one of 0, 1, and 2.",
+					operand->value
+				);
+			}
+
+			// note: the interrupt modes 1 and 2 are encoded as 2 and 3.
+			const uint64_t code = ((z80_pattern_im == pattern) && (operand->value > 0) ? operand->value + 1 : operand->value);
+			*opcode = (uint8_t)(*opcode | (code << shift));
+		} break;
+
+		case z80_pattern_n:
+		case z80_pattern_ind_n:
+		case z80_pattern_nn:
+		case z80_pattern_ind_nn:
+		case z80_pattern_rel:
+		{
+			const bool_t wide = (z80_pattern_nn == pattern) || (z80_pattern_ind_nn == pattern);
+			const bool_t relative = (z80_pattern_rel == pattern);
+
+			operand->fixup_width = (wide ? 2 : 1);
+			operand->fixup_kind = (uint8_t)(relative ? lasm_ir_fixup_kind_rel : lasm_ir_fixup_kind_abs);
+			*field_width = operand->fixup_width;
+
+			// note: the relative fields are filled in by the fixups, even when their
+			// targets are constant.
+			if (symbolic || relative)
+			{
+				break;
+			}
+
+			// note: the immediate bytes may be written as negative numbers, which
+			// are stored in two's complement.
+			const bool_t fits = (wide ? (operand->value <= UINT16_MAX) : ((operand->value <= UINT8_MAX) ||
+				((z80_pattern_n == pattern) && ((int64_t)operand->value >= INT8_MIN) && ((int64_t)operand->value < 0))));
+
+			if (!fits)
+			{
+				_log_z80_encoder_error(inst->location,
+					"value 0x%lX does not fit into the %u byte field of the instruction.",
+					operand->value, operand->fixup_width
+				);
+			}
+
+			field[0] = (uint8_t)operand->value;
+			field[1] = (uint8_t)(operand->value >> 8);
+		} break;
+
+		default:
+		{
+			// note: the fixed registers and the memory operands through registers
+			// are implied by the opcode.
+		} break;
+	}
+}
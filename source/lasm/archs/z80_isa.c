@@ -0,0 +1,657 @@
+
+/**
+ * @file z80_isa.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#include "lasm/archs/z80_isa.h"
+#include "lasm/debug.h"
+
+#define _ns z80_isa_no_shift
+
+#define _idx   z80_isa_flag_index
+#define _jump  z80_isa_flag_jump
+#define _call  z80_isa_flag_call
+#define _relax z80_isa_flag_relax
+
+#define _form(_mnemonic, _pattern0, _pattern1, _prefix, _opcode, _shift0, _shift1, _flags, _cycles0, _cycles1) \
+	{                                                                          \
+		.mnemonic = (uint8_t)z80_mnemonic_##_mnemonic,                         \
+		.patterns = { (uint8_t)z80_pattern_##_pattern0, (uint8_t)z80_pattern_##_pattern1, }, \
+		.prefix   = _prefix,                                                   \
+		.opcode   = _opcode,                                                   \
+		.shifts   = { _shift0, _shift1, },                                     \
+		.flags    = _flags,                                                    \
+		.cycles   = { _cycles0, _cycles1, },                                   \
+	}
+
+// note: the forms are grouped by their mnemonics in the order of the enum, and
+// the forms of a mnemonic are matched in the listed order, so the shorter forms
+// go before the longer ones, that accept the same operands. the last columns
+// are the T-states of the forms, which are listed in the z80 user manual.
+const z80_isa_encoding_s z80_isa_encodings[] =
+{
+	_form(adc,  a,      r8,     0x00, 0x88, _ns, 0,   _idx,           4,  7),
+	_form(adc,  a,      n,      0x00, 0xCE, _ns, _ns, 0,              7,  7),
+	_form(adc,  hl,     dd,     0xED, 0x4A, _ns, 4,   0,              15, 15),
+	_form(adc,  r8,     none,   0x00, 0x88, 0,   _ns, _idx,           4,  7),
+	_form(adc,  n,      none,   0x00, 0xCE, _ns, _ns, 0,              7,  7),
+	_form(add,  a,      r8,     0x00, 0x80, _ns, 0,   _idx,           4,  7),
+	_form(add,  a,      n,      0x00, 0xC6, _ns, _ns, 0,              7,  7),
+	_form(add,  hl,     dd,     0x00, 0x09, _ns, 4,   _idx,           11, 11),
+	_form(add,  r8,     none,   0x00, 0x80, 0,   _ns, _idx,           4,  7),
+	_form(add,  n,      none,   0x00, 0xC6, _ns, _ns, 0,              7,  7),
+	_form(and,  r8,     none,   0x00, 0xA0, 0,   _ns, _idx,           4,  7),
+	_form(and,  n,      none,   0x00, 0xE6, _ns, _ns, 0,              7,  7),
+	_form(and,  a,      r8,     0x00, 0xA0, _ns, 0,   _idx,           4,  7),
+	_form(and,  a,      n,      0x00, 0xE6, _ns, _ns, 0,              7,  7),
+	_form(bit,  bit,    r8,     0xCB, 0x40, 3,   0,   _idx,           8,  12),
+	_form(call, nn,     none,   0x00, 0xCD, _ns, _ns, _call,          17, 17),
+	_form(call, cc,     nn,     0x00, 0xC4, 3,   _ns, _call,          17, 10),
+	_form(ccf,  none,   none,   0x00, 0x3F, _ns, _ns, 0,              4,  4),
+	_form(cp,   r8,     none,   0x00, 0xB8, 0,   _ns, _idx,           4,  7),
+	_form(cp,   n,      none,   0x00, 0xFE, _ns, _ns, 0,              7,  7),
+	_form(cp,   a,      r8,     0x00, 0xB8, _ns, 0,   _idx,           4,  7),
+	_form(cp,   a,      n,      0x00, 0xFE, _ns, _ns, 0,              7,  7),
+	_form(cpd,  none,   none,   0xED, 0xA9, _ns, _ns, 0,              16, 16),
+	_form(cpdr, none,   none,   0xED, 0xB9, _ns, _ns, 0,              21, 16),
+	_form(cpi,  none,   none,   0xED, 0xA1, _ns, _ns, 0,              16, 16),
+	_form(cpir, none,   none,   0xED, 0xB1, _ns, _ns, 0,              21, 16),
+	_form(cpl,  none,   none,   0x00, 0x2F, _ns, _ns, 0,              4,  4),
+	_form(daa,  none,   none,   0x00, 0x27, _ns, _ns, 0,              4,  4),
+	_form(dec,  r8,     none,   0x00, 0x05, 3,   _ns, _idx,           4,  11),
+	_form(dec,  dd,     none,   0x00, 0x0B, 4,   _ns, _idx,           6,  6),
+	_form(di,   none,   none,   0x00, 0xF3, _ns, _ns, 0,              4,  4),
+	_form(djnz, rel,    none,   0x00, 0x10, _ns, _ns, _jump,          13, 8),
+	_form(ei,   none,   none,   0x00, 0xFB, _ns, _ns, 0,              4,  4),
+	_form(ex,   af,     af,     0x00, 0x08, _ns, _ns, 0,              4,  4),
+	_form(ex,   de,     hl,     0x00, 0xEB, _ns, _ns, 0,              4,  4),
+	_form(ex,   ind_sp, hl,     0x00, 0xE3, _ns, _ns, _idx,           19, 19),
+	_form(exx,  none,   none,   0x00, 0xD9, _ns, _ns, 0,              4,  4),
+	_form(halt, none,   none,   0x00, 0x76, _ns, _ns, 0,              4,  4),
+	_form(im,   im,     none,   0xED, 0x46, 3,   _ns, 0,              8,  8),
+	_form(in,   a,      ind_n,  0x00, 0xDB, _ns, _ns, 0,              11, 11),
+	_form(in,   r8_reg, ind_c,  0xED, 0x40, 3,   _ns, 0,              12, 12),
+	_form(inc,  r8,     none,   0x00, 0x04, 3,   _ns, _idx,           4,  11),
+	_form(inc,  dd,     none,   0x00, 0x03, 4,   _ns, _idx,           6,  6),
+	_form(ind,  none,   none,   0xED, 0xAA, _ns, _ns, 0,              16, 16),
+	_form(indr, none,   none,   0xED, 0xBA, _ns, _ns, 0,              21, 16),
+	_form(ini,  none,   none,   0xED, 0xA2, _ns, _ns, 0,              16, 16),
+	_form(inir, none,   none,   0xED, 0xB2, _ns, _ns, 0,              21, 16),
+	_form(jp,   nn,     none,   0x00, 0xC3, _ns, _ns, _jump | _relax, 10, 10),
+	_form(jp,   cc,     nn,     0x00, 0xC2, 3,   _ns, _jump | _relax, 10, 10),
+	_form(jp,   ind_hl, none,   0x00, 0xE9, _ns, _ns, _idx,           4,  4),
+	_form(jr,   rel,    none,   0x00, 0x18, _ns, _ns, _jump,          12, 12),
+	_form(jr,   jcc,    rel,    0x00, 0x20, 3,   _ns, _jump,          12, 7),
+	_form(ld,   r8,     r8,     0x00, 0x40, 3,   0,   _idx,           4,  7),
+	_form(ld,   r8,     n,      0x00, 0x06, 3,   _ns, _idx,           7,  10),
+	_form(ld,   a,      ind_bc, 0x00, 0x0A, _ns, _ns, 0,              7,  7),
+	_form(ld,   a,      ind_de, 0x00, 0x1A, _ns, _ns, 0,              7,  7),
+	_form(ld,   a,      ind_nn, 0x00, 0x3A, _ns, _ns, 0,              13, 13),
+	_form(ld,   ind_bc, a,      0x00, 0x02, _ns, _ns, 0,              7,  7),
+	_form(ld,   ind_de, a,      0x00, 0x12, _ns, _ns, 0,              7,  7),
+	_form(ld,   ind_nn, a,      0x00, 0x32, _ns, _ns, 0,              13, 13),
+	_form(ld,   a,      i,      0xED, 0x57, _ns, _ns, 0,              9,  9),
+	_form(ld,   a,      r,      0xED, 0x5F, _ns, _ns, 0,              9,  9),
+	_form(ld,   i,      a,      0xED, 0x47, _ns, _ns, 0,              9,  9),
+	_form(ld,   r,      a,      0xED, 0x4F, _ns, _ns, 0,              9,  9),
+	_form(ld,   dd,     nn,     0x00, 0x01, 4,   _ns, _idx,           10, 10),
+	_form(ld,   hl,     ind_nn, 0x00, 0x2A, _ns, _ns, _idx,           16, 16),
+	_form(ld,   dd,     ind_nn, 0xED, 0x4B, 4,   _ns, 0,              20, 20),
+	_form(ld,   ind_nn, hl,     0x00, 0x22, _ns, _ns, _idx,           16, 16),
+	_form(ld,   ind_nn, dd,     0xED, 0x43, _ns, 4,   0,              20, 20),
+	_form(ld,   sp,     hl,     0x00, 0xF9, _ns, _ns, _idx,           6,  6),
+	_form(ldd,  none,   none,   0xED, 0xA8, _ns, _ns, 0,              16, 16),
+	_form(lddr, none,   none,   0xED, 0xB8, _ns, _ns, 0,              21, 16),
+	_form(ldi,  none,   none,   0xED, 0xA0, _ns, _ns, 0,              16, 16),
+	_form(ldir, none,   none,   0xED, 0xB0, _ns, _ns, 0,              21, 16),
+	_form(neg,  none,   none,   0xED, 0x44, _ns, _ns, 0,              8,  8),
+	_form(nop,  none,   none,   0x00, 0x00, _ns, _ns, 0,              4,  4),
+	_form(or,   r8,     none,   0x00, 0xB0, 0,   _ns, _idx,           4,  7),
+	_form(or,   n,      none,   0x00, 0xF6, _ns, _ns, 0,              7,  7),
+	_form(or,   a,      r8,     0x00, 0xB0, _ns, 0,   _idx,           4,  7),
+	_form(or,   a,      n,      0x00, 0xF6, _ns, _ns, 0,              7,  7),
+	_form(otdr, none,   none,   0xED, 0xBB, _ns, _ns, 0,              21, 16),
+	_form(otir, none,   none,   0xED, 0xB3, _ns, _ns, 0,              21, 16),
+	_form(out,  ind_n,  a,      0x00, 0xD3, _ns, _ns, 0,              11, 11),
+	_form(out,  ind_c,  r8_reg, 0xED, 0x41, _ns, 3,   0,              12, 12),
+	_form(outd, none,   none,   0xED, 0xAB, _ns, _ns, 0,              16, 16),
+	_form(outi, none,   none,   0xED, 0xA3, _ns, _ns, 0,              16, 16),
+	_form(pop,  qq,     none,   0x00, 0xC1, 4,   _ns, _idx,           10, 10),
+	_form(push, qq,     none,   0x00, 0xC5, 4,   _ns, _idx,           11, 11),
+	_form(res,  bit,    r8,     0xCB, 0x80, 3,   0,   _idx,           8,  15),
+	_form(ret,  none,   none,   0x00, 0xC9, _ns, _ns, 0,              10, 10),
+	_form(ret,  cc,     none,   0x00, 0xC0, 3,   _ns, 0,              11, 5),
+	_form(reti, none,   none,   0xED, 0x4D, _ns, _ns, 0,              14, 14),
+	_form(retn, none,   none,   0xED, 0x45, _ns, _ns, 0,              14, 14),
+	_form(rl,   r8,     none,   0xCB, 0x10, 0,   _ns, _idx,           8,  15),
+	_form(rla,  none,   none,   0x00, 0x17, _ns, _ns, 0,              4,  4),
+	_form(rlc,  r8,     none,   0xCB, 0x00, 0,   _ns, _idx,           8,  15),
+	_form(rlca, none,   none,   0x00, 0x07, _ns, _ns, 0,              4,  4),
+	_form(rld,  none,   none,   0xED, 0x6F, _ns, _ns, 0,              18, 18),
+	_form(rr,   r8,     none,   0xCB, 0x18, 0,   _ns, _idx,           8,  15),
+	_form(rra,  none,   none,   0x00, 0x1F, _ns, _ns, 0,              4,  4),
+	_form(rrc,  r8,     none,   0xCB, 0x08, 0,   _ns, _idx,           8,  15),
+	_form(rrca, none,   none,   0x00, 0x0F, _ns, _ns, 0,              4,  4),
+	_form(rrd,  none,   none,   0xED, 0x67, _ns, _ns, 0,              18, 18),
+	_form(rst,  rst,    none,   0x00, 0xC7, 0,   _ns, 0,              11, 11),
+	_form(sbc,  a,      r8,     0x00, 0x98, _ns, 0,   _idx,           4,  7),
+	_form(sbc,  a,      n,      0x00, 0xDE, _ns, _ns, 0,              7,  7),
+	_form(sbc,  hl,     dd,     0xED, 0x42, _ns, 4,   0,              15, 15),
+	_form(sbc,  r8,     none,   0x00, 0x98, 0,   _ns, _idx,           4,  7),
+	_form(sbc,  n,      none,   0x00, 0xDE, _ns, _ns, 0,              7,  7),
+	_form(scf,  none,   none,   0x00, 0x37, _ns, _ns, 0,              4,  4),
+	_form(set,  bit,    r8,     0xCB, 0xC0, 3,   0,   _idx,           8,  15),
+	_form(sla,  r8,     none,   0xCB, 0x20, 0,   _ns, _idx,           8,  15),
+	_form(sra,  r8,     none,   0xCB, 0x28, 0,   _ns, _idx,           8,  15),
+	_form(srl,  r8,     none,   0xCB, 0x38, 0,   _ns, _idx,           8,  15),
+	_form(sub,  r8,     none,   0x00, 0x90, 0,   _ns, _idx,           4,  7),
+	_form(sub,  n,      none,   0x00, 0xD6, _ns, _ns, 0,              7,  7),
+	_form(sub,  a,      r8,     0x00, 0x90, _ns, 0,   _idx,           4,  7),
+	_form(sub,  a,      n,      0x00, 0xD6, _ns, _ns, 0,              7,  7),
+	_form(xor,  r8,     none,   0x00, 0xA8, 0,   _ns, _idx,           4,  7),
+	_form(xor,  n,      none,   0x00, 0xEE, _ns, _ns, 0,              7,  7),
+	_form(xor,  a,      r8,     0x00, 0xA8, _ns, 0,   _idx,           4,  7),
+	_form(xor,  a,      n,      0x00, 0xEE, _ns, _ns, 0,              7,  7),
+};
+
+#define _z80_isa_encodings_count (sizeof(z80_isa_encodings) / sizeof(z80_isa_encodings[0]))
+
+_Static_assert(
+	_z80_isa_encodings_count < UINT16_MAX,
+	"z80_isa_encodings does not fit into the opcode ids of the instructions!"
+);
+
+static bool_t _is_imm(const lasm_ir_operand_s* const operand);
+
+static bool_t _is_abs_mem(const lasm_ir_operand_s* const operand);
+
+static bool_t _is_r8(const z80_reg_e reg);
+
+static z80_reg_e _normalize_reg(const z80_reg_e reg, const z80_reg_e index);
+
+static bool_t _match_operand(const z80_pattern_e pattern, const lasm_ir_operand_s* const operand, const z80_reg_e index);
+
+static uint8_t _code_mask(const z80_pattern_e pattern);
+
+static uint8_t _code(const z80_isa_encoding_s* const encoding, const uint8_t opcode, const uint8_t operand);
+
+static bool_t _is_memory(const z80_isa_encoding_s* const encoding, const uint8_t opcode);
+
+static bool_t _takes_index(const z80_isa_encoding_s* const encoding, const uint8_t opcode);
+
+static lasm_cycles_end_e _cycles_end(const z80_isa_encoding_s* const encoding);
+
+bool_t z80_isa_takes_cond(const z80_mnemonic_e mnemonic)
+{
+	return (z80_mnemonic_jp == mnemonic) || (z80_mnemonic_jr == mnemonic) || (z80_mnemonic_call == mnemonic) || (z80_mnemonic_ret == mnemonic);
+}
+
+uint16_t z80_isa_match(const z80_mnemonic_e mnemonic, const lasm_ir_operand_s* const operands, const uint8_t operands_count)
+{
+	lasm_debug_assert(mnemonic < z80_mnemonics_count);
+	lasm_debug_assert(operands != NULL);
+	lasm_debug_assert(operands_count <= 2);
+
+	const z80_reg_e index = z80_isa_index_reg(operands, operands_count);
+
+	// note: the forms are sorted by their mnemonics, so the first form of the
+	// mnemonic is found with a binary search.
+	uint64_t low = 0, high = _z80_isa_encodings_count;
+
+	while (low < high)
+	{
+		const uint64_t middle = low + ((high - low) / 2);
+
+		if (z80_isa_encodings[middle].mnemonic < mnemonic)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	for (uint64_t form = low; (form < _z80_isa_encodings_count) && (z80_isa_encodings[form].mnemonic == mnemonic); ++form)
+	{
+		const z80_isa_encoding_s* const encoding = &z80_isa_encodings[form];
+		const uint8_t count = (uint8_t)((encoding->patterns[0] != z80_pattern_none) + (encoding->patterns[1] != z80_pattern_none));
+
+		if ((count != operands_count) || ((index != z80_register_none) && !(encoding->flags & z80_isa_flag_index)))
+		{
+			continue;
+		}
+
+		bool_t matched = true;
+
+		for (uint8_t operand = 0; matched && (operand < operands_count); ++operand)
+		{
+			matched = _match_operand((z80_pattern_e)encoding->patterns[operand], &operands[operand], index);
+		}
+
+		// note: 'ld (hl), (hl)' is encoded as 'halt', so it is not a valid load.
+		if (matched && (z80_mnemonic_ld == mnemonic) && (z80_pattern_r8 == encoding->patterns[0]) && (z80_pattern_r8 == encoding->patterns[1]) &&
+			(lasm_ir_operand_type_mem == operands[0].type) && (lasm_ir_operand_type_mem == operands[1].type))
+		{
+			matched = false;
+		}
+
+		if (matched)
+		{
+			return (uint16_t)form;
+		}
+	}
+
+	return UINT16_MAX;
+}
+
+uint16_t z80_isa_decode(const uint8_t* const inst, const uint64_t length)
+{
+	lasm_debug_assert(inst != NULL);
+
+	const bool_t indexed = (length > 0) && ((0xDD == inst[0]) || (0xFD == inst[0]));
+	uint64_t skip = (indexed ? 1 : 0);
+
+	if (skip >= length)
+	{
+		return UINT16_MAX;
+	}
+
+	// note: the displacement of the indexed 0xCB prefixed forms goes before
+	// their opcode.
+	const uint8_t prefix = (((0xCB == inst[skip]) || (0xED == inst[skip])) ? inst[skip] : 0);
+	skip += (uint64_t)(((prefix != 0) ? 1 : 0) + ((indexed && (0xCB == prefix)) ? 1 : 0));
+
+	if (skip >= length)
+	{
+		return UINT16_MAX;
+	}
+
+	const uint8_t opcode = inst[skip];
+
+	for (uint64_t form = 0; form < _z80_isa_encodings_count; ++form)
+	{
+		const z80_isa_encoding_s* const encoding = &z80_isa_encodings[form];
+		uint8_t mask = 0;
+
+		if ((encoding->prefix != prefix) || (indexed && !(encoding->flags & z80_isa_flag_index)))
+		{
+			continue;
+		}
+
+		for (uint8_t operand = 0; operand < 2; ++operand)
+		{
+			if (encoding->shifts[operand] != z80_isa_no_shift)
+			{
+				mask = (uint8_t)(mask | (_code_mask((z80_pattern_e)encoding->patterns[operand]) << encoding->shifts[operand]));
+			}
+		}
+
+		if ((opcode & (uint8_t)~mask) != encoding->opcode)
+		{
+			continue;
+		}
+
+		// note: the codes, that the patterns exclude, belong to the undocumented
+		// instructions, and the index prefix applies only to the forms, which
+		// operands are hl or (hl).
+		bool_t valid = (!indexed || _takes_index(encoding, opcode));
+
+		for (uint8_t operand = 0; operand < 2; ++operand)
+		{
+			const z80_pattern_e pattern = (z80_pattern_e)encoding->patterns[operand];
+			const uint8_t code = _code(encoding, opcode, operand);
+
+			valid &= ((z80_pattern_r8_reg != pattern) || (code != 6));
+			valid &= ((z80_pattern_im != pattern) || (code != 1));
+			valid &= (!indexed || (prefix != 0xCB) || (z80_pattern_r8 != pattern) || (6 == code));
+		}
+
+		// note: 'ld (hl), (hl)' is encoded as 'halt', which goes before it.
+		valid &= ((z80_mnemonic_ld != encoding->mnemonic) || (z80_pattern_r8 != encoding->patterns[0]) ||
+			(z80_pattern_r8 != encoding->patterns[1]) || (_code(encoding, opcode, 0) != 6) || (_code(encoding, opcode, 1) != 6));
+
+		if (valid)
+		{
+			return (uint16_t)form;
+		}
+	}
+
+	return UINT16_MAX;
+}
+
+uint8_t z80_isa_length(const uint8_t* const inst, const uint16_t form)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(form < _z80_isa_encodings_count);
+
+	const z80_isa_encoding_s* const encoding = &z80_isa_encodings[form];
+	const bool_t indexed = ((0xDD == inst[0]) || (0xFD == inst[0]));
+	const uint8_t opcode = inst[(indexed ? 1 : 0) + ((encoding->prefix != 0) ? 1 : 0) + ((indexed && (0xCB == encoding->prefix)) ? 1 : 0)];
+	uint8_t length = (uint8_t)((indexed ? 1 : 0) + ((encoding->prefix != 0) ? 1 : 0) + 1);
+
+	if (indexed && _is_memory(encoding, opcode))
+	{
+		++length;
+	}
+
+	for (uint8_t operand = 0; operand < 2; ++operand)
+	{
+		switch (encoding->patterns[operand])
+		{
+			case z80_pattern_n:
+			case z80_pattern_ind_n:
+			case z80_pattern_rel:    { length = (uint8_t)(length + 1); } break;
+			case z80_pattern_nn:
+			case z80_pattern_ind_nn: { length = (uint8_t)(length + 2); } break;
+			default:                 {                                 } break;
+		}
+	}
+
+	return length;
+}
+
+uint8_t z80_isa_operand_code(const uint16_t form, const uint8_t opcode, const uint8_t operand)
+{
+	lasm_debug_assert(form < _z80_isa_encodings_count);
+	lasm_debug_assert(operand < 2);
+	return _code(&z80_isa_encodings[form], opcode, operand);
+}
+
+bool_t z80_isa_cycles(const uint8_t* const inst, const uint64_t length, lasm_cycles_inst_s* const cost)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(cost != NULL);
+
+	const uint16_t form = z80_isa_decode(inst, length);
+
+	if ((UINT16_MAX == form) || (z80_isa_length(inst, form) > length))
+	{
+		return false;
+	}
+
+	const z80_isa_encoding_s* const encoding = &z80_isa_encodings[form];
+	const bool_t indexed = ((0xDD == inst[0]) || (0xFD == inst[0]));
+	const uint8_t opcode = inst[(indexed ? 1 : 0) + ((encoding->prefix != 0) ? 1 : 0) + ((indexed && (0xCB == encoding->prefix)) ? 1 : 0)];
+	const bool_t r8 = (z80_pattern_r8 == encoding->patterns[0]) || (z80_pattern_r8 == encoding->patterns[1]);
+	const bool_t memory = _is_memory(encoding, opcode);
+
+	*cost = (lasm_cycles_inst_s)
+	{
+		.length    = z80_isa_length(inst, form),
+		.taken     = encoding->cycles[memory ? 1 : 0],
+		.not_taken = encoding->cycles[(memory || !r8) ? 1 : 0],
+		.end       = _cycles_end(encoding),
+	};
+
+	if (indexed)
+	{
+		// note: 'ld (ix+d), n' reads its displacement and its immediate byte in
+		// the same machine cycles, so it takes 3 T-states less.
+		const uint16_t extra = (!memory ? 4 : ((0xCB == encoding->prefix) ? 8 : ((z80_pattern_n == encoding->patterns[1]) ? 9 : 12)));
+		cost->taken = (uint16_t)(cost->taken + extra);
+		cost->not_taken = (uint16_t)(cost->not_taken + extra);
+	}
+
+	return true;
+}
+
+z80_reg_e z80_isa_index_reg(const lasm_ir_operand_s* const operands, const uint8_t operands_count)
+{
+	lasm_debug_assert(operands != NULL);
+
+	z80_reg_e index = z80_register_none;
+
+	for (uint8_t operand = 0; operand < operands_count; ++operand)
+	{
+		const lasm_ir_operand_s* const current = &operands[operand];
+
+		if (((current->type != lasm_ir_operand_type_reg) && (current->type != lasm_ir_operand_type_mem)) ||
+			((current->id != z80_register_ix) && (current->id != z80_register_iy)))
+		{
+			continue;
+		}
+
+		// note: when both of the index registers are used, the second one is not
+		// replaced with hl, so it matches none of the patterns.
+		if (z80_register_none == index)
+		{
+			index = (z80_reg_e)current->id;
+		}
+	}
+
+	return index;
+}
+
+uint8_t z80_isa_reg_code(const z80_pattern_e pattern, const lasm_ir_operand_s* const operand)
+{
+	lasm_debug_assert(operand != NULL);
+
+	static const uint8_t r8_codes[z80_registers_count] =
+	{
+		[z80_register_b] = 0, [z80_register_c] = 1, [z80_register_d] = 2, [z80_register_e] = 3,
+		[z80_register_h] = 4, [z80_register_l] = 5, [z80_register_a] = 7,
+	};
+
+	switch (pattern)
+	{
+		case z80_pattern_r8:
+		case z80_pattern_r8_reg:
+		{
+			return ((lasm_ir_operand_type_mem == operand->type) ? 6 : r8_codes[operand->id]);
+		} break;
+
+		case z80_pattern_dd:
+		case z80_pattern_qq:
+		{
+			switch (operand->id)
+			{
+				case z80_register_bc: { return 0; } break;
+				case z80_register_de: { return 1; } break;
+				case z80_register_sp: { return 3; } break;
+				case z80_register_af: { return 3; } break;
+				default:         { return 2; } break;  // note: hl, ix, or iy.
+			}
+		} break;
+
+		case z80_pattern_cc:
+		case z80_pattern_jcc:
+		{
+			return operand->id;
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static bool_t _is_imm(const lasm_ir_operand_s* const operand)
+{
+	lasm_debug_assert(operand != NULL);
+	return (lasm_ir_operand_type_imm == operand->type) ||
+		((lasm_ir_operand_type_sym == operand->type) && (lasm_ir_operand_type_imm == operand->id));
+}
+
+static bool_t _is_abs_mem(const lasm_ir_operand_s* const operand)
+{
+	lasm_debug_assert(operand != NULL);
+	return ((lasm_ir_operand_type_mem == operand->type) && (z80_register_none == operand->id)) ||
+		((lasm_ir_operand_type_sym == operand->type) && (lasm_ir_operand_type_mem == operand->id));
+}
+
+static bool_t _is_r8(const z80_reg_e reg)
+{
+	return (z80_register_a == reg) || (z80_register_b == reg) || (z80_register_c == reg) || (z80_register_d == reg) ||
+		(z80_register_e == reg) || (z80_register_h == reg) || (z80_register_l == reg);
+}
+
+static z80_reg_e _normalize_reg(const z80_reg_e reg, const z80_reg_e index)
+{
+	// note: with an index register, it takes the place of hl, and hl itself is
+	// not available.
+	if (index != z80_register_none)
+	{
+		if (reg == index)
+		{
+			return z80_register_hl;
+		}
+
+		if (z80_register_hl == reg)
+		{
+			return z80_register_none;
+		}
+	}
+
+	return reg;
+}
+
+static bool_t _match_operand(const z80_pattern_e pattern, const lasm_ir_operand_s* const operand, const z80_reg_e index)
+{
+	lasm_debug_assert(operand != NULL);
+
+	const bool_t is_reg = (lasm_ir_operand_type_reg == operand->type);
+	const bool_t is_mem = (lasm_ir_operand_type_mem == operand->type) && (operand->id != z80_register_none);
+	const z80_reg_e reg = ((is_reg || is_mem) ? _normalize_reg((z80_reg_e)operand->id, index) : z80_register_none);
+
+	switch (pattern)
+	{
+		case z80_pattern_r8:
+		{
+			return (is_reg && _is_r8(reg)) || (is_mem && (z80_register_hl == reg));
+		} break;
+
+		case z80_pattern_r8_reg:
+		{
+			return is_reg && _is_r8(reg);
+		} break;
+
+		case z80_pattern_a:      { return is_reg && (z80_register_a  == reg); } break;
+		case z80_pattern_i:      { return is_reg && (z80_register_i  == reg); } break;
+		case z80_pattern_r:      { return is_reg && (z80_register_r  == reg); } break;
+		case z80_pattern_hl:     { return is_reg && (z80_register_hl == reg); } break;
+		case z80_pattern_de:     { return is_reg && (z80_register_de == reg); } break;
+		case z80_pattern_sp:     { return is_reg && (z80_register_sp == reg); } break;
+		case z80_pattern_af:     { return is_reg && (z80_register_af == reg); } break;
+		case z80_pattern_dd:     { return is_reg && ((z80_register_bc == reg) || (z80_register_de == reg) || (z80_register_hl == reg) || (z80_register_sp == reg)); } break;
+		case z80_pattern_qq:     { return is_reg && ((z80_register_bc == reg) || (z80_register_de == reg) || (z80_register_hl == reg) || (z80_register_af == reg)); } break;
+		case z80_pattern_ind_bc: { return is_mem && (z80_register_bc == reg); } break;
+		case z80_pattern_ind_de: { return is_mem && (z80_register_de == reg); } break;
+		case z80_pattern_ind_hl: { return is_mem && (z80_register_hl == reg) && (0 == operand->value); } break;
+		case z80_pattern_ind_sp: { return is_mem && (z80_register_sp == reg); } break;
+		case z80_pattern_ind_c:  { return is_mem && (z80_register_c  == reg); } break;
+		case z80_pattern_ind_nn:
+		case z80_pattern_ind_n:  { return _is_abs_mem(operand); } break;
+
+		case z80_pattern_n:
+		case z80_pattern_nn:
+		case z80_pattern_rel:
+		case z80_pattern_bit:
+		case z80_pattern_rst:
+		case z80_pattern_im:     { return _is_imm(operand); } break;
+
+		case z80_pattern_cc:     { return (lasm_ir_operand_type_cond == operand->type); } break;
+		case z80_pattern_jcc:    { return (lasm_ir_operand_type_cond == operand->type) && (operand->id <= z80_cond_c); } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return false;
+		} break;
+	}
+}
+
+static uint8_t _code_mask(const z80_pattern_e pattern)
+{
+	switch (pattern)
+	{
+		case z80_pattern_r8:
+		case z80_pattern_r8_reg:
+		case z80_pattern_cc:
+		case z80_pattern_bit: { return 0x07; } break;
+		case z80_pattern_dd:
+		case z80_pattern_qq:
+		case z80_pattern_jcc:
+		case z80_pattern_im:  { return 0x03; } break;
+		case z80_pattern_rst: { return 0x38; } break;  // note: the restart vector is the code itself.
+		default:              { return 0x00; } break;
+	}
+}
+
+static uint8_t _code(const z80_isa_encoding_s* const encoding, const uint8_t opcode, const uint8_t operand)
+{
+	lasm_debug_assert(encoding != NULL);
+	lasm_debug_assert(operand < 2);
+
+	if (z80_isa_no_shift == encoding->shifts[operand])
+	{
+		return 0;
+	}
+
+	return (uint8_t)((opcode >> encoding->shifts[operand]) & _code_mask((z80_pattern_e)encoding->patterns[operand]));
+}
+
+static bool_t _is_memory(const z80_isa_encoding_s* const encoding, const uint8_t opcode)
+{
+	lasm_debug_assert(encoding != NULL);
+
+	for (uint8_t operand = 0; operand < 2; ++operand)
+	{
+		if ((z80_pattern_r8 == encoding->patterns[operand]) && (6 == _code(encoding, opcode, operand)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool_t _takes_index(const z80_isa_encoding_s* const encoding, const uint8_t opcode)
+{
+	lasm_debug_assert(encoding != NULL);
+
+	for (uint8_t operand = 0; operand < 2; ++operand)
+	{
+		const uint8_t code = _code(encoding, opcode, operand);
+
+		switch (encoding->patterns[operand])
+		{
+			case z80_pattern_r8:     { if (6 == code) { return true; } } break;
+			case z80_pattern_dd:
+			case z80_pattern_qq:     { if (2 == code) { return true; } } break;
+			case z80_pattern_hl:
+			case z80_pattern_ind_hl: { return true;                    } break;
+			default:                 {                                 } break;
+		}
+	}
+
+	return false;
+}
+
+static lasm_cycles_end_e _cycles_end(const z80_isa_encoding_s* const encoding)
+{
+	lasm_debug_assert(encoding != NULL);
+
+	const z80_mnemonic_e mnemonic = (z80_mnemonic_e)encoding->mnemonic;
+	const bool_t transfer = ((encoding->flags & z80_isa_flag_jump) != 0) || (z80_mnemonic_jp == mnemonic) ||
+		(z80_mnemonic_ret == mnemonic) || (z80_mnemonic_reti == mnemonic) || (z80_mnemonic_retn == mnemonic);
+
+	if (!transfer)
+	{
+		return lasm_cycles_end_none;
+	}
+
+	const bool_t conditional = (z80_pattern_cc == encoding->patterns[0]) || (z80_pattern_jcc == encoding->patterns[0]) ||
+		(z80_mnemonic_djnz == mnemonic);
+
+	return (conditional ? lasm_cycles_end_branch : lasm_cycles_end_exit);
+}
@@ -0,0 +1,229 @@
+
+/**
+ * @file z80_names.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+// note: this file is generated by './scripts/gen_isa.py' from './source/lasm/archs/archs.isa'.
+// do not edit it by hand!
+
+#include "lasm/archs/z80_names.h"
+#include "lasm/debug.h"
+
+#define _mix_multiplier ((uint64_t)0x9E3779B97F4A7C15)
+
+static const char_t* const _g_z80_mnemonic_names[z80_mnemonics_count] =
+{
+	[z80_mnemonic_adc]  = "adc",
+	[z80_mnemonic_add]  = "add",
+	[z80_mnemonic_and]  = "and",
+	[z80_mnemonic_bit]  = "bit",
+	[z80_mnemonic_call] = "call",
+	[z80_mnemonic_ccf]  = "ccf",
+	[z80_mnemonic_cp]   = "cp",
+	[z80_mnemonic_cpd]  = "cpd",
+	[z80_mnemonic_cpdr] = "cpdr",
+	[z80_mnemonic_cpi]  = "cpi",
+	[z80_mnemonic_cpir] = "cpir",
+	[z80_mnemonic_cpl]  = "cpl",
+	[z80_mnemonic_daa]  = "daa",
+	[z80_mnemonic_dec]  = "dec",
+	[z80_mnemonic_di]   = "di",
+	[z80_mnemonic_djnz] = "djnz",
+	[z80_mnemonic_ei]   = "ei",
+	[z80_mnemonic_ex]   = "ex",
+	[z80_mnemonic_exx]  = "exx",
+	[z80_mnemonic_halt] = "halt",
+	[z80_mnemonic_im]   = "im",
+	[z80_mnemonic_in]   = "in",
+	[z80_mnemonic_inc]  = "inc",
+	[z80_mnemonic_ind]  = "ind",
+	[z80_mnemonic_indr] = "indr",
+	[z80_mnemonic_ini]  = "ini",
+	[z80_mnemonic_inir] = "inir",
+	[z80_mnemonic_jp]   = "jp",
+	[z80_mnemonic_jr]   = "jr",
+	[z80_mnemonic_ld]   = "ld",
+	[z80_mnemonic_ldd]  = "ldd",
+	[z80_mnemonic_lddr] = "lddr",
+	[z80_mnemonic_ldi]  = "ldi",
+	[z80_mnemonic_ldir] = "ldir",
+	[z80_mnemonic_neg]  = "neg",
+	[z80_mnemonic_nop]  = "nop",
+	[z80_mnemonic_or]   = "or",
+	[z80_mnemonic_otdr] = "otdr",
+	[z80_mnemonic_otir] = "otir",
+	[z80_mnemonic_out]  = "out",
+	[z80_mnemonic_outd] = "outd",
+	[z80_mnemonic_outi] = "outi",
+	[z80_mnemonic_pop]  = "pop",
+	[z80_mnemonic_push] = "push",
+	[z80_mnemonic_res]  = "res",
+	[z80_mnemonic_ret]  = "ret",
+	[z80_mnemonic_reti] = "reti",
+	[z80_mnemonic_retn] = "retn",
+	[z80_mnemonic_rl]   = "rl",
+	[z80_mnemonic_rla]  = "rla",
+	[z80_mnemonic_rlc]  = "rlc",
+	[z80_mnemonic_rlca] = "rlca",
+	[z80_mnemonic_rld]  = "rld",
+	[z80_mnemonic_rr]   = "rr",
+	[z80_mnemonic_rra]  = "rra",
+	[z80_mnemonic_rrc]  = "rrc",
+	[z80_mnemonic_rrca] = "rrca",
+	[z80_mnemonic_rrd]  = "rrd",
+	[z80_mnemonic_rst]  = "rst",
+	[z80_mnemonic_sbc]  = "sbc",
+	[z80_mnemonic_scf]  = "scf",
+	[z80_mnemonic_set]  = "set",
+	[z80_mnemonic_sla]  = "sla",
+	[z80_mnemonic_sra]  = "sra",
+	[z80_mnemonic_srl]  = "srl",
+	[z80_mnemonic_sub]  = "sub",
+	[z80_mnemonic_xor]  = "xor",
+};
+
+static const uint32_t _g_z80_mnemonic_seeds[34] =
+{
+	0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+	0x00000000, 0x00000002, 0x00000000, 0x00000001, 0x00000006, 0x00000001, 0x00000001, 0x00000000,
+	0x00000001, 0x00000001, 0x00000003, 0x00000007, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+	0x00000001, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+	0x00000002, 0x00000000,
+};
+
+// note: z80_mnemonics_count marks the empty slots.
+static const uint8_t _g_z80_mnemonic_slots[128] =
+{
+	 67,  67,   7,   6,  28,  67,  67,  19,  67,  21,  67,  67,  67,  25,  42,  67,
+	 67,  67,  67,  67,  22,  67,  67,  48,  67,  60,  17,  38,  67,  27,  45,  55,
+	 51,  49,  52,  67,  67,  67,  67,  23,  67,  26,  67,   1,  46,  35,  66,  67,
+	 67,  44,  67,  40,  67,  67,  67,  33,  54,  67,  67,  50,   9,  67,  67,  67,
+	 29,  67,   5,  67,  12,  31,  67,  58,  67,  67,  67,  47,  67,  64,  65,  67,
+	 67,  13,  67,  63,  37,  67,  20,  34,  67,  67,  41,  67,  14,  67,  67,  16,
+	 67,  24,  67,  18,  67,  57,  67,  36,  67,  43,  15,   2,   8,  39,   4,  67,
+	 67,  32,  30,  67,  67,  11,  59,  10,   0,  62,  56,   3,  53,  67,  67,  61,
+};
+
+static const char_t* const _g_z80_register_names[z80_registers_count] =
+{
+	[z80_register_a]  = "a",
+	[z80_register_af] = "af",
+	[z80_register_b]  = "b",
+	[z80_register_bc] = "bc",
+	[z80_register_c]  = "c",
+	[z80_register_d]  = "d",
+	[z80_register_de] = "de",
+	[z80_register_e]  = "e",
+	[z80_register_h]  = "h",
+	[z80_register_hl] = "hl",
+	[z80_register_i]  = "i",
+	[z80_register_ix] = "ix",
+	[z80_register_iy] = "iy",
+	[z80_register_l]  = "l",
+	[z80_register_r]  = "r",
+	[z80_register_sp] = "sp",
+};
+
+static const uint32_t _g_z80_register_seeds[8] =
+{
+	0x00000003, 0x0000000A, 0x00000041, 0x00000003, 0x00000002, 0x00000000, 0x00000000, 0x00000000,
+};
+
+// note: z80_registers_count marks the empty slots.
+static const uint8_t _g_z80_register_slots[16] =
+{
+	  0,  13,   5,   3,   4,  11,   7,   1,   9,  14,   8,  12,   6,   2,  10,  15,
+};
+
+static const char_t* const _g_z80_cond_names[z80_conds_count] =
+{
+	[z80_cond_nz] = "nz",
+	[z80_cond_z]  = "z",
+	[z80_cond_nc] = "nc",
+	[z80_cond_c]  = "c",
+	[z80_cond_po] = "po",
+	[z80_cond_pe] = "pe",
+	[z80_cond_p]  = "p",
+	[z80_cond_m]  = "m",
+};
+
+static const uint32_t _g_z80_cond_seeds[4] =
+{
+	0x00000001, 0x00000000, 0x0000002E, 0x0000000E,
+};
+
+// note: z80_conds_count marks the empty slots.
+static const uint8_t _g_z80_cond_slots[8] =
+{
+	  4,   3,   7,   1,   2,   5,   6,   0,
+};
+
+static uint64_t _find_name(const char_t* const* const names, const uint64_t count, const uint32_t* const seeds, const uint64_t seeds_count,
+	const uint8_t* const slots, const uint64_t slots_count, const char_t* const name);
+
+z80_mnemonic_e z80_isa_find_mnemonic(const char_t* const name)
+{
+	lasm_debug_assert(name != NULL);
+	return (z80_mnemonic_e)_find_name(_g_z80_mnemonic_names, z80_mnemonics_count,
+		_g_z80_mnemonic_seeds, sizeof(_g_z80_mnemonic_seeds) / sizeof(_g_z80_mnemonic_seeds[0]),
+		_g_z80_mnemonic_slots, sizeof(_g_z80_mnemonic_slots) / sizeof(_g_z80_mnemonic_slots[0]), name);
+}
+
+const char_t* z80_isa_mnemonic_name(const z80_mnemonic_e mnemonic)
+{
+	lasm_debug_assert(mnemonic < z80_mnemonics_count);
+	return _g_z80_mnemonic_names[mnemonic];
+}
+
+z80_reg_e z80_isa_find_reg(const char_t* const name)
+{
+	lasm_debug_assert(name != NULL);
+	return (z80_reg_e)_find_name(_g_z80_register_names, z80_registers_count,
+		_g_z80_register_seeds, sizeof(_g_z80_register_seeds) / sizeof(_g_z80_register_seeds[0]),
+		_g_z80_register_slots, sizeof(_g_z80_register_slots) / sizeof(_g_z80_register_slots[0]), name);
+}
+
+const char_t* z80_isa_reg_name(const z80_reg_e reg)
+{
+	lasm_debug_assert(reg < z80_registers_count);
+	return _g_z80_register_names[reg];
+}
+
+z80_cond_e z80_isa_find_cond(const char_t* const name)
+{
+	lasm_debug_assert(name != NULL);
+	return (z80_cond_e)_find_name(_g_z80_cond_names, z80_conds_count,
+		_g_z80_cond_seeds, sizeof(_g_z80_cond_seeds) / sizeof(_g_z80_cond_seeds[0]),
+		_g_z80_cond_slots, sizeof(_g_z80_cond_slots) / sizeof(_g_z80_cond_slots[0]), name);
+}
+
+const char_t* z80_isa_cond_name(const z80_cond_e cond)
+{
+	lasm_debug_assert(cond < z80_conds_count);
+	return _g_z80_cond_names[cond];
+}
+
+static uint64_t _find_name(const char_t* const* const names, const uint64_t count, const uint32_t* const seeds, const uint64_t seeds_count,
+	const uint8_t* const slots, const uint64_t slots_count, const char_t* const name)
+{
+	lasm_debug_assert(names != NULL);
+	lasm_debug_assert(seeds != NULL);
+	lasm_debug_assert(slots != NULL);
+	lasm_debug_assert(name != NULL);
+
+	// note: the first hash of the name picks its bucket, and the seed of the
+	// bucket displaces the hash to the slot of the name.
+	const uint64_t hash = lasm_common_hash(lasm_common_hash_seed, name, lasm_common_strlen(name));
+	const uint64_t bucket = ((hash * _mix_multiplier) >> 32) % seeds_count;
+	const uint64_t slot = (((hash ^ seeds[bucket]) * _mix_multiplier) >> 32) % slots_count;
+	const uint64_t index = slots[slot];
+
+	return (((index < count) && (lasm_common_strcmp(names[index], name) == 0)) ? index : count);
+}
@@ -11,26 +11,326 @@
  */
 
 #include "lasm/archs/z80_parser.h"
+#include "lasm/expr.h"
+#include "lasm/local.h"
+#include "lasm/data.h"
 #include "lasm/debug.h"
 #include "lasm/logger.h"
 
+#include <stdio.h>
+
+#define _log_z80_parser_error(_location, _format, ...)                         \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+
+static bool_t _is_same_line(const lasm_tokens_vector_s* const tokens, const uint64_t index, const lasm_token_s* const mnemonic);
+
+static z80_reg_e _reg_from_token(const lasm_token_s* const token);
+
+static z80_cond_e _cond_from_token(const lasm_token_s* const token);
+
+static bool_t _parse_number(const char_t* const string, uint64_t* const value);
+
+static uint64_t _parse_displacement(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index, const lasm_token_s* const base);
+
+static lasm_ir_operand_s _parse_operand(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index);
+
+static void _parse_inst(lasm_lexer_s* const lexer, lasm_ast_label_s* const label, uint64_t* const index);
+
 void z80_parser_parse_tokens(lasm_lexer_s* const lexer, lasm_labels_vector_s* const labels, lasm_ast_label_s* const label)
 {
 	lasm_debug_assert(lexer != NULL);
 	lasm_debug_assert(labels != NULL);
 	lasm_debug_assert(label != NULL);
 
-	for (uint64_t index = 0; index < label->body_tokens.count; ++index)
+	for (uint64_t index = 0; index < label->body_tokens.count;)
+	{
+		if (!lasm_local_parse(lexer->arena, label, &index) && !lasm_data_parse(lexer, label, &index))
+		{
+			_parse_inst(lexer, label, &index);
+		}
+	}
+}
+
+static bool_t _is_same_line(const lasm_tokens_vector_s* const tokens, const uint64_t index, const lasm_token_s* const mnemonic)
+{
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(mnemonic != NULL);
+	return (index < tokens->count) && (tokens->data[index].location.line == mnemonic->location.line);
+}
+
+static z80_reg_e _reg_from_token(const lasm_token_s* const token)
+{
+	lasm_debug_assert(token != NULL);
+
+	// note: the 'r' register is lexed as the keyword of the read only permission.
+	if (lasm_token_type_keyword_r == token->type)
+	{
+		return z80_register_r;
+	}
+
+	return ((lasm_token_type_ident == token->type) ? z80_isa_find_reg(token->as.ident.data) : z80_register_none);
+}
+
+static z80_cond_e _cond_from_token(const lasm_token_s* const token)
+{
+	lasm_debug_assert(token != NULL);
+	return ((lasm_token_type_ident == token->type) ? z80_isa_find_cond(token->as.ident.data) : z80_conds_count);
+}
+
+static bool_t _parse_number(const char_t* const string, uint64_t* const value)
+{
+	lasm_debug_assert(string != NULL);
+	lasm_debug_assert(value != NULL);
+
+	const bool_t hex = ('0' == string[0]) && (('x' == string[1]) || ('X' == string[1]));
+	const char_t* digit = (hex ? string + 2 : string);
+	*value = 0;
+
+	if ('\0' == *digit)
+	{
+		return false;
+	}
+
+	for (; *digit != '\0'; ++digit)
+	{
+		const char_t c = *digit;
+		uint64_t nibble = 0;
+
+		if ((c >= '0') && (c <= '9'))                { nibble = (uint64_t)(c - '0'); }
+		else if (hex && (c >= 'a') && (c <= 'f'))    { nibble = (uint64_t)(c - 'a' + 10); }
+		else if (hex && (c >= 'A') && (c <= 'F'))    { nibble = (uint64_t)(c - 'A' + 10); }
+		else                                         { return false; }
+
+		*value = (*value * (hex ? 16 : 10)) + nibble;
+	}
+
+	return true;
+}
+
+static uint64_t _parse_displacement(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index, const lasm_token_s* const base)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+	lasm_debug_assert(base != NULL);
+
+	uint64_t displacement = 0;
+
+	// note: identifiers may contain dashes, so '(ix-5)' is lexed as a single
+	// identifier, and its displacement is parsed from the identifier itself.
+	if ((lasm_token_type_ident == base->type) && (lasm_common_strlen(base->as.ident.data) > 3) && ('-' == base->as.ident.data[2]))
+	{
+		if (!_parse_number(base->as.ident.data + 3, &displacement))
+		{
+			_log_z80_parser_error(base->location,
+				"invalid displacement in '%s' operand. expected a number after the index register.",
+				base->as.ident.data
+			);
+		}
+
+		displacement = (~displacement) + 1;
+	}
+	else if ((*index < tokens->count) && ((lasm_token_type_symbolic_plus == tokens->data[*index].type) || (lasm_token_type_symbolic_minus == tokens->data[*index].type)))
+	{
+		const bool_t negative = (lasm_token_type_symbolic_minus == tokens->data[(*index)++].type);
+		const lasm_ast_expr_s* const expr = lasm_expr_parse(lexer->arena, tokens, index);
+
+		if (!expr->folded)
+		{
+			_log_z80_parser_error(base->location,
+				"displacement of the index register must be a constant expression, that does not reference any labels."
+			);
+		}
+
+		displacement = (negative ? (~expr->value) + 1 : expr->value);
+	}
+
+	const int64_t signed_displacement = (int64_t)displacement;
+
+	if ((signed_displacement < INT8_MIN) || (signed_displacement > INT8_MAX))
+	{
+		_log_z80_parser_error(base->location,
+			"displacement %ld of the index register does not fit into the range from -128 to 127.",
+			signed_displacement
+		);
+	}
+
+	return displacement;
+}
+
+static lasm_ir_operand_s _parse_operand(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+	lasm_debug_assert(*index < tokens->count);
+
+	const lasm_token_s* const token = &tokens->data[*index];
+	const z80_reg_e reg = _reg_from_token(token);
+
+	if (reg != z80_register_none)
+	{
+		++*index;
+		return (lasm_ir_operand_s) { .type = (uint8_t)lasm_ir_operand_type_reg, .id = (uint8_t)reg, };
+	}
+
+	if (token->type != lasm_token_type_symbolic_left_paren)
+	{
+		return lasm_ir_operand_from_expr(lasm_ir_operand_type_imm, lasm_expr_parse(lexer->arena, tokens, index));
+	}
+
+	// note: an operand in parentheses is always a memory operand, either through
+	// a register, or at an absolute address.
+	++*index;
+
+	if (*index >= tokens->count)
+	{
+		_log_z80_parser_error(token->location,
+			"expected a register or an address after '(', but found the end of the label's body."
+		);
+	}
+
+	const lasm_token_s* const base = &tokens->data[*index];
+	z80_reg_e base_reg = _reg_from_token(base);
+	lasm_ir_operand_s operand = {0};
+
+	if ((z80_register_none == base_reg) && (lasm_token_type_ident == base->type) && (lasm_common_strlen(base->as.ident.data) > 3) &&
+		((lasm_common_strncmp(base->as.ident.data, "ix-", 3) == 0) || (lasm_common_strncmp(base->as.ident.data, "iy-", 3) == 0)))
+	{
+		base_reg = (('x' == base->as.ident.data[1]) ? z80_register_ix : z80_register_iy);
+	}
+
+	if (base_reg != z80_register_none)
+	{
+		++*index;
+		operand = (lasm_ir_operand_s) { .type = (uint8_t)lasm_ir_operand_type_mem, .id = (uint8_t)base_reg, };
+
+		if ((z80_register_ix == base_reg) || (z80_register_iy == base_reg))
+		{
+			operand.value = _parse_displacement(lexer, tokens, index, base);
+		}
+	}
+	else
+	{
+		operand = lasm_ir_operand_from_expr(lasm_ir_operand_type_mem, lasm_expr_parse(lexer->arena, tokens, index));
+
+		if (lasm_ir_operand_type_mem == operand.type)
+		{
+			operand.id = (uint8_t)z80_register_none;
+		}
+	}
+
+	if ((*index >= tokens->count) || (tokens->data[*index].type != lasm_token_type_symbolic_right_paren))
+	{
+		_log_z80_parser_error(token->location,
+			"expected ')' to close the memory operand."
+		);
+	}
+
+	++*index;
+	return operand;
+}
+
+static void _parse_inst(lasm_lexer_s* const lexer, lasm_ast_label_s* const label, uint64_t* const index)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(index != NULL);
+
+	const lasm_tokens_vector_s* const tokens = &label->body_tokens;
+	const lasm_token_s* const token = &tokens->data[(*index)++];
+
+	if (token->type != lasm_token_type_ident)
+	{
+		_log_z80_parser_error(token->location,
+			"expected a mnemonic, but found '%s' token.",
+			lasm_token_type_to_string(token->type)
+		);
+	}
+
+	const z80_mnemonic_e mnemonic = z80_isa_find_mnemonic(token->as.ident.data);
+
+	if (z80_mnemonics_count == mnemonic)
+	{
+		_log_z80_parser_error(token->location,
+			"unknown mnemonic '%s'.",
+			token->as.ident.data
+		);
+	}
+
+	lasm_ir_inst_s inst = lasm_ir_inst_new(0, token->location);
+
+	// note: a condition is an identifier, that is followed by a comma, so a label
+	// with the same name as a condition can still be used as the target. the
+	// condition of a return is not followed by a comma, as the return has no
+	// other operands.
+	if (z80_isa_takes_cond(mnemonic) && _is_same_line(tokens, *index, token))
 	{
-		lasm_token_s* const token = lasm_tokens_vector_at(&label->body_tokens, index);
+		const z80_cond_e cond = _cond_from_token(&tokens->data[*index]);
+		const bool_t comma = ((*index + 1) < tokens->count) && (lasm_token_type_symbolic_comma == tokens->data[*index + 1].type);
 
-		// todo: implement!
-		if ((lasm_token_type_ident == token->type) && (lasm_common_strcmp(token->as.ident.data, "nop") == 0))
+		if ((cond != z80_conds_count) && ((z80_mnemonic_ret == mnemonic) || comma))
 		{
-			// todo: implement!
-			lasm_bytes_vector_push(&label->body, 0x00);
-			// todo: implement!
+			lasm_ir_inst_push_operand(&inst, (lasm_ir_operand_s) { .type = (uint8_t)lasm_ir_operand_type_cond, .id = (uint8_t)cond, });
+			*index += (comma ? 2 : 1);
+
+			if ((z80_mnemonic_ret != mnemonic) && (*index >= tokens->count))
+			{
+				_log_z80_parser_error(token->location,
+					"expected a target address after the condition of the '%s' mnemonic, but found the end of the label's body.",
+					token->as.ident.data
+				);
+			}
 		}
-		// todo: implement!
 	}
+
+	const bool_t cond_parsed = (inst.operands_count > 0);
+
+	if ((cond_parsed && (z80_mnemonic_ret != mnemonic)) || (!cond_parsed && _is_same_line(tokens, *index, token)))
+	{
+		while (true)
+		{
+			if (inst.operands_count >= 2)
+			{
+				_log_z80_parser_error(token->location,
+					"too many operands for the '%s' mnemonic. z80 instructions take at most 2 operands.",
+					token->as.ident.data
+				);
+			}
+
+			lasm_ir_inst_push_operand(&inst, _parse_operand(lexer, tokens, index));
+
+			if ((*index >= tokens->count) || (tokens->data[*index].type != lasm_token_type_symbolic_comma))
+			{
+				break;
+			}
+
+			if (++*index >= tokens->count)
+			{
+				_log_z80_parser_error(tokens->data[*index - 1].location,
+					"expected an operand after ',', but found the end of the label's body."
+				);
+			}
+		}
+	}
+
+	const uint16_t form = z80_isa_match(mnemonic, inst.operands, inst.operands_count);
+
+	if (UINT16_MAX == form)
+	{
+		_log_z80_parser_error(token->location,
+			"operands of the '%s' mnemonic do not match any of its forms.",
+			token->as.ident.data
+		);
+	}
+
+	inst.opcode = form;
+	lasm_ir_insts_vector_push(&label->ir, inst);
 }
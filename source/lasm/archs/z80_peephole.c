@@ -0,0 +1,361 @@
+
+/**
+ * @file z80_peephole.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-30
+ */
+
+#include "lasm/archs/z80_peephole.h"
+#include "lasm/archs/z80_isa.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+#include "lasm/local.h"
+
+#define _z80_peephole_window 2
+
+typedef struct
+{
+	const char_t* description;  // note: description of the rewrite for the report.
+	uint8_t window;             // note: count of the instructions, that the pattern matches.
+	bool_t banks;               // note: the rewrite is only valid, when the caller and the callee share a bank.
+	bool_t (*rewrite)(lasm_ir_inst_s* const insts, uint8_t* const count);
+} _z80_peephole_pattern_s;
+
+static bool_t _rewrite_ld_a_zero(lasm_ir_inst_s* const insts, uint8_t* const count);
+
+static bool_t _rewrite_push_pop(lasm_ir_inst_s* const insts, uint8_t* const count);
+
+static bool_t _rewrite_call_ret(lasm_ir_inst_s* const insts, uint8_t* const count);
+
+static bool_t _is_form(const lasm_ir_inst_s* const inst, const z80_mnemonic_e mnemonic, const z80_pattern_e pattern0, const z80_pattern_e pattern1);
+
+static bool_t _is_flags_overwrite(const lasm_ir_inst_s* const inst);
+
+static const lasm_ast_local_s* _find_jump_to_next(const lasm_ast_label_s* const label, const uint64_t read);
+
+// note: a rewrite replaces the matched instructions with fewer or as many
+// instructions, so the instructions IR is rewritten in place.
+static const _z80_peephole_pattern_s _g_z80_peephole_patterns[] =
+{
+	{ .description = "'ld a, 0' is rewritten into 'xor a'",                   .window = 2, .banks = false, .rewrite = _rewrite_ld_a_zero, },
+	{ .description = "'push' followed by 'pop' of the same register is removed", .window = 2, .banks = false, .rewrite = _rewrite_push_pop,  },
+	{ .description = "'call' followed by 'ret' is rewritten into 'jp'",        .window = 2, .banks = true,  .rewrite = _rewrite_call_ret,  },
+};
+
+#define _z80_peephole_patterns_count (sizeof(_g_z80_peephole_patterns) / sizeof(_g_z80_peephole_patterns[0]))
+
+_Static_assert(
+	_z80_peephole_patterns_count > 0,
+	"_g_z80_peephole_patterns must not be empty!"
+);
+
+bool_t z80_peephole_rewrite(lasm_ast_label_s* const label, const bool_t banked)
+{
+	lasm_debug_assert(label != NULL);
+
+	bool_t changed = true, transient = false;
+
+	// note: a rewrite may bring two other instructions together (e.g. the outer
+	// pair of 'push hl; push de; pop de; pop hl'), so the passes are repeated
+	// until none of the patterns match.
+	while (changed)
+	{
+		uint64_t read = 0, write = 0, local = 0;
+		changed = false;
+
+		while (read < label->ir.count)
+		{
+			bool_t matched = false;
+
+			// note: the local labels move along with the instructions, that they
+			// precede, and a pattern never matches across a local label, as the
+			// instructions after it may be reached without the ones before it.
+			for (; (local < label->locals.count) && (label->locals.data[local].inst <= read); ++local)
+			{
+				label->locals.data[local].inst = write;
+			}
+
+			// note: a jump to the local label, that directly follows it, lands where
+			// the execution continues without it.
+			const lasm_ast_local_s* const next = _find_jump_to_next(label, read);
+
+			if (next != NULL)
+			{
+				lasm_logger_info("peephole: " lasm_location_fmt ": jump to the local label '%.*s', that follows it, is removed.",
+					lasm_location_arg(label->ir.data[read].location), (int32_t)next->length, next->name
+				);
+
+				++read;
+				changed = true;
+				continue;
+			}
+
+			for (uint64_t index = 0; !matched && (index < _z80_peephole_patterns_count); ++index)
+			{
+				const _z80_peephole_pattern_s* const pattern = &_g_z80_peephole_patterns[index];
+				lasm_ir_inst_s window[_z80_peephole_window] = {0};
+				uint8_t count = 0;
+				lasm_debug_assert(pattern->window <= _z80_peephole_window);
+
+				if (((read + pattern->window) > label->ir.count) ||
+					((local < label->locals.count) && (label->locals.data[local].inst < (read + pattern->window))))
+				{
+					continue;
+				}
+
+				lasm_common_memcpy(window, label->ir.data + read, pattern->window * sizeof(lasm_ir_inst_s));
+
+				if (!pattern->rewrite(window, &count))
+				{
+					continue;
+				}
+
+				// note: the banks of the labels are known only after the layout, and a
+				// 'jp' into another bank would skip the far call trampoline, that the
+				// 'call' gets routed through, so such rewrites are skipped, when any
+				// region is banked. the regions are not part of the label's fingerprint,
+				// so the label is not cached either way.
+				transient |= pattern->banks;
+
+				if (pattern->banks && banked)
+				{
+					continue;
+				}
+
+				lasm_debug_assert(count <= pattern->window);
+				lasm_logger_info("peephole: " lasm_location_fmt ": %s.", lasm_location_arg(label->ir.data[read].location), pattern->description);
+
+				for (uint8_t inst = 0; inst < count; ++inst)
+				{
+					label->ir.data[write++] = window[inst];
+				}
+
+				read += pattern->window;
+				matched = true;
+				changed = true;
+			}
+
+			if (!matched)
+			{
+				label->ir.data[write++] = label->ir.data[read++];
+			}
+		}
+
+		for (; local < label->locals.count; ++local)
+		{
+			label->locals.data[local].inst = write;
+		}
+
+		label->ir.count = write;
+	}
+
+	return transient;
+}
+
+void z80_peephole_fallthrough(const lasm_config_build_s* const config, lasm_labels_vector_s* const labels)
+{
+	lasm_debug_assert(config != NULL);
+	lasm_debug_assert(labels != NULL);
+
+	// note: the packing and the folding move the labels away from the labels,
+	// that precede them in the source.
+	if (config->pack || config->fold)
+	{
+		return;
+	}
+
+	for (uint64_t index = 0; (index + 1) < labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(labels, index);
+		const lasm_ast_label_s* const next = &labels->data[index + 1];
+
+		if ((0 == label->fixups.count) || (label->alias != lasm_ast_label_none) || !label->attrs[lasm_ast_attr_type_size].inferred ||
+			(label->blob.path != NULL))
+		{
+			continue;
+		}
+
+		const lasm_ast_attr_s* const next_attrs = next->attrs;
+
+		if (!next_attrs[lasm_ast_attr_type_addr].inferred || !next_attrs[lasm_ast_attr_type_region].inferred ||
+			next_attrs[lasm_ast_attr_type_align].inferred || !next_attrs[lasm_ast_attr_type_align].expr->folded ||
+			(next_attrs[lasm_ast_attr_type_align].expr->value != 1))
+		{
+			continue;
+		}
+
+		// note: the fixups are ordered by their offsets, so the jump, that ends
+		// the body, has the last fixup.
+		const lasm_ast_fixup_s* const fixup = &label->fixups.data[label->fixups.count - 1];
+
+		if ((fixup->target != (index + 1)) || (fixup->addend != 0) || (fixup->kind != lasm_ir_fixup_kind_abs) ||
+			(fixup->flow != lasm_ir_flow_jump) || (fixup->field_offset != 1) || (fixup->width != 2) ||
+			((fixup->offset + fixup->width) != label->body.count) || (label->body.data[fixup->offset - 1] != 0xC3))
+		{
+			continue;
+		}
+
+		lasm_logger_info("peephole: " lasm_location_fmt ": 'jp' to the label '%s', that follows it, is removed.",
+			lasm_location_arg(fixup->location), next->name
+		);
+
+		label->body.count -= 3;
+		label->fixups.count -= 1;
+
+		// note: the local labels at the removed jump now address the label, that
+		// follows it, through the end of the body.
+		for (uint64_t local = 0; local < label->locals.count; ++local)
+		{
+			lasm_ast_local_s* const entry = lasm_locals_vector_at(&label->locals, local);
+			entry->offset = ((entry->offset > label->body.count) ? label->body.count : entry->offset);
+		}
+	}
+}
+
+static bool_t _rewrite_ld_a_zero(lasm_ir_inst_s* const insts, uint8_t* const count)
+{
+	lasm_debug_assert(insts != NULL);
+	lasm_debug_assert(count != NULL);
+
+	const lasm_ir_operand_s* const operands = insts[0].operands;
+
+	// note: 'xor a' sets the flags, that 'ld a, 0' keeps, so it is only used,
+	// when the next instruction sets all of the flags without reading them.
+	if (!_is_form(&insts[0], z80_mnemonic_ld, z80_pattern_r8, z80_pattern_n) ||
+		(operands[0].type != lasm_ir_operand_type_reg) || (operands[0].id != z80_register_a) ||
+		lasm_ir_operand_is_symbolic(&operands[1]) || (operands[1].value != 0) ||
+		!_is_flags_overwrite(&insts[1]))
+	{
+		return false;
+	}
+
+	const uint16_t form = z80_isa_match(z80_mnemonic_xor, operands, 1);
+	lasm_debug_assert(form != UINT16_MAX);
+
+	lasm_ir_inst_s inst = lasm_ir_inst_new(form, insts[0].location);
+	lasm_ir_inst_push_operand(&inst, operands[0]);
+	insts[0] = inst;
+	*count = 2;
+	return true;
+}
+
+static bool_t _rewrite_push_pop(lasm_ir_inst_s* const insts, uint8_t* const count)
+{
+	lasm_debug_assert(insts != NULL);
+	lasm_debug_assert(count != NULL);
+
+	if (!_is_form(&insts[0], z80_mnemonic_push, z80_pattern_qq, z80_pattern_none) ||
+		!_is_form(&insts[1], z80_mnemonic_pop, z80_pattern_qq, z80_pattern_none) ||
+		(insts[0].operands[0].id != insts[1].operands[0].id))
+	{
+		return false;
+	}
+
+	*count = 0;
+	return true;
+}
+
+static bool_t _rewrite_call_ret(lasm_ir_inst_s* const insts, uint8_t* const count)
+{
+	lasm_debug_assert(insts != NULL);
+	lasm_debug_assert(count != NULL);
+
+	if (!_is_form(&insts[0], z80_mnemonic_call, z80_pattern_nn, z80_pattern_none) ||
+		!_is_form(&insts[1], z80_mnemonic_ret, z80_pattern_none, z80_pattern_none))
+	{
+		return false;
+	}
+
+	const uint16_t form = z80_isa_match(z80_mnemonic_jp, insts[0].operands, 1);
+	lasm_debug_assert(form != UINT16_MAX);
+
+	lasm_ir_inst_s inst = lasm_ir_inst_new(form, insts[0].location);
+	lasm_ir_inst_push_operand(&inst, insts[0].operands[0]);
+	insts[0] = inst;
+	*count = 1;
+	return true;
+}
+
+static bool_t _is_form(const lasm_ir_inst_s* const inst, const z80_mnemonic_e mnemonic, const z80_pattern_e pattern0, const z80_pattern_e pattern1)
+{
+	lasm_debug_assert(inst != NULL);
+
+	if (lasm_ir_opcode_data == inst->opcode)
+	{
+		return false;
+	}
+
+	const z80_isa_encoding_s* const encoding = &z80_isa_encodings[inst->opcode];
+	return (encoding->mnemonic == mnemonic) && (encoding->patterns[0] == pattern0) && (encoding->patterns[1] == pattern1);
+}
+
+static bool_t _is_flags_overwrite(const lasm_ir_inst_s* const inst)
+{
+	lasm_debug_assert(inst != NULL);
+
+	if (lasm_ir_opcode_data == inst->opcode)
+	{
+		return false;
+	}
+
+	const z80_isa_encoding_s* const encoding = &z80_isa_encodings[inst->opcode];
+
+	// note: only the 8 bit arithmetic and logic instructions without the carry
+	// set all of the flags, as 'inc' and 'dec' keep the carry, and the 16 bit
+	// 'add' keeps the sign, the zero, and the parity flags.
+	switch (encoding->mnemonic)
+	{
+		case z80_mnemonic_add:
+		{
+			return (encoding->patterns[0] != z80_pattern_hl);
+		} break;
+
+		case z80_mnemonic_sub:
+		case z80_mnemonic_and:
+		case z80_mnemonic_or:
+		case z80_mnemonic_xor:
+		case z80_mnemonic_cp:
+		case z80_mnemonic_neg:
+		{
+			return true;
+		} break;
+
+		default:
+		{
+			return false;
+		} break;
+	}
+}
+
+static const lasm_ast_local_s* _find_jump_to_next(const lasm_ast_label_s* const label, const uint64_t read)
+{
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(read < label->ir.count);
+
+	const lasm_ir_inst_s* const inst = &label->ir.data[read];
+
+	if (!_is_form(inst, z80_mnemonic_jp, z80_pattern_nn, z80_pattern_none) &&
+		!_is_form(inst, z80_mnemonic_jr, z80_pattern_rel, z80_pattern_none))
+	{
+		return NULL;
+	}
+
+	const lasm_ast_expr_s* const expr = inst->operands[0].expr;
+	uint64_t index = 0;
+
+	if ((NULL == expr) || (expr->type != lasm_ast_expr_type_symbol) || (expr->as.symbol.name[0] != '.') ||
+		!lasm_local_find(label, expr->as.symbol.name, expr->as.symbol.length, &index))
+	{
+		return NULL;
+	}
+
+	// note: the local labels before the instruction already hold their new
+	// indices, which never exceed the instruction's index.
+	const lasm_ast_local_s* const local = &label->locals.data[index];
+	return ((local->inst == (read + 1)) ? local : NULL);
+}
@@ -14,6 +14,8 @@
 #include "lasm/logger.h"
 #include "lasm/arena.h"
 
+static lasm_arena_stats_s _g_arena_stats = {0};
+
 lasm_arena_node_s* lasm_arena_node_new(const uint64_t size)
 {
 	lasm_debug_assert(size > 0);
@@ -31,6 +33,14 @@ lasm_arena_node_s* lasm_arena_node_new(const uint64_t size)
 		.next = NULL,
 	};
 
+	_g_arena_stats.live += size + sizeof(lasm_arena_node_s);
+	_g_arena_stats.total += size + sizeof(lasm_arena_node_s);
+
+	if (_g_arena_stats.live > _g_arena_stats.peak)
+	{
+		_g_arena_stats.peak = _g_arena_stats.live;
+	}
+
 	return node;
 }
 
@@ -38,9 +48,10 @@ void lasm_arena_node_drop(lasm_arena_node_s* node)
 {
 	lasm_debug_assert(node != NULL);
 	lasm_debug_assert(node->pointer != NULL);
+	lasm_debug_assert(_g_arena_stats.live >= node->size + sizeof(lasm_arena_node_s));
+	_g_arena_stats.live -= node->size + sizeof(lasm_arena_node_s);
 	lasm_common_free(node->pointer);
 	lasm_common_free(node);
-	*node = (lasm_arena_node_s) {0};
 }
 
 lasm_arena_s lasm_arena_new(void)
@@ -63,6 +74,12 @@ void lasm_arena_drop(lasm_arena_s* const arena)
 
 	arena->begin = NULL;
 	arena->end = NULL;
+	arena->size = 0;
+}
+
+lasm_arena_stats_s lasm_arena_stats(void)
+{
+	return _g_arena_stats;
 }
 
 void* lasm_arena_alloc(lasm_arena_s* const arena, const uint64_t size)
@@ -89,6 +106,7 @@ void* lasm_arena_alloc(lasm_arena_s* const arena, const uint64_t size)
 		arena->end = arena->end->next;
 	}
 
+	arena->size += size;
 	void* const result = arena->end->pointer;
 	lasm_debug_assert(result != NULL);
 	return result;
@@ -35,6 +35,23 @@ const char_t* lasm_ast_perm_type_to_string(const lasm_ast_perm_type_e type)
 	}
 }
 
+bool_t lasm_ast_perm_type_allows(const lasm_ast_perm_type_e region, const lasm_ast_perm_type_e label)
+{
+	lasm_debug_assert(region < lasm_ast_perm_type_none);
+	lasm_debug_assert(label < lasm_ast_perm_type_none);
+
+	// note: bits are read, write and execute permissions.
+	static const uint8_t bits[lasm_ast_perm_type_none] =
+	{
+		[lasm_ast_perm_type_r]   = 0x1,
+		[lasm_ast_perm_type_rw]  = 0x3,
+		[lasm_ast_perm_type_rx]  = 0x5,
+		[lasm_ast_perm_type_rwx] = 0x7,
+	};
+
+	return ((bits[label] & ~bits[region]) == 0);
+}
+
 const char_t* lasm_ast_label_to_string(const lasm_ast_label_s* const label)
 {
 	lasm_debug_assert(label != NULL);
@@ -45,34 +62,82 @@ const char_t* lasm_ast_label_to_string(const lasm_ast_label_s* const label)
 
 	const lasm_ast_attr_s addr_attr = label->attrs[lasm_ast_attr_type_addr];
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "[addr=");
-	if (addr_attr.inferred) { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "auto"); }
-	else { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%lu", addr_attr.as.addr.value); }
+	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%lu", addr_attr.as.addr.value);
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", ", ");
 
 	const lasm_ast_attr_s align_attr = label->attrs[lasm_ast_attr_type_align];
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "align=");
-	if (align_attr.inferred) { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "auto"); }
-	else { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%lu", align_attr.as.align.value); }
+	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%lu", align_attr.as.align.value);
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", ", ");
 
 	const lasm_ast_attr_s size_attr = label->attrs[lasm_ast_attr_type_size];
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "size=");
-	if (size_attr.inferred) { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "auto"); }
-	else { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%lu", size_attr.as.size.value); }
+	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%lu", size_attr.as.size.value);
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", ", ");
 
 	const lasm_ast_attr_s perm_attr = label->attrs[lasm_ast_attr_type_perm];
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "perm=");
-	if (perm_attr.inferred) { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "auto"); }
-	else { written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", lasm_ast_perm_type_to_string(perm_attr.as.perm.value)); }
-	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", ",]\n");
+	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", lasm_ast_perm_type_to_string(perm_attr.as.perm.value));
+	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", ",");
+
+	const lasm_ast_attr_s region_attr = label->attrs[lasm_ast_attr_type_region];
+	if (region_attr.as.region.name != NULL)
+	{
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", " region=");
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", region_attr.as.region.name);
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", ",");
+	}
+
+	const lasm_ast_attr_s cycles_attr = label->attrs[lasm_ast_attr_type_cycles];
+	if (!cycles_attr.inferred)
+	{
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", " cycles=");
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%lu", cycles_attr.as.cycles.value);
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", ",");
+	}
+
+	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "]\n");
 
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s:\n", label->name);
-	for (uint64_t index = 0; index < label->body.count; ++index) { written += (uint64_t)snprintf(label_string_buffer + written,
-	label_string_buffer_capacity - written, "    0x%02X\n", *lasm_bytes_vector_at((lasm_bytes_vector_s* const)&label->body, index)); }
+
+	// note: the bytes of the long bodies are cut off, so the rest of the label
+	// always fits into the buffer.
+	for (uint64_t index = 0; index < label->body.count; ++index)
+	{
+		if ((written + 64) >= label_string_buffer_capacity)
+		{
+			written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "    ... %lu more bytes\n", label->body.count - index);
+			break;
+		}
+
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "    0x%02X\n", *lasm_bytes_vector_at((lasm_bytes_vector_s* const)&label->body, index));
+	}
+
+	if (label->blob.path != NULL)
+	{
+		written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "    incbin %lu bytes at offset %lu of %.256s\n",
+			label->blob.length, label->blob.offset, label->blob.path);
+	}
+
 	written += (uint64_t)snprintf(label_string_buffer + written, label_string_buffer_capacity - written, "%s", "end");
 
 	return label_string_buffer;
 }
 
+uint64_t lasm_ast_label_length(const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+	return label->body.count + ((NULL == label->blob.path) ? 0 : label->blob.length);
+}
+
+lasm_implement_vector_type(lasm_fixups_vector, lasm_ast_fixup_s);
+
+lasm_implement_vector_type(lasm_locals_vector, lasm_ast_local_s);
+
+lasm_implement_vector_type(lasm_data_values_vector, lasm_ast_data_value_s);
+
+lasm_implement_vector_type(lasm_data_vector, lasm_ast_data_s);
+
 lasm_implement_vector_type(lasm_labels_vector, lasm_ast_label_s);
+
+lasm_implement_vector_type(lasm_regions_vector, lasm_ast_region_s);
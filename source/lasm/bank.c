@@ -0,0 +1,349 @@
+
+/**
+ * @file bank.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#include "lasm/bank.h"
+#include "lasm/symtab.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+#include "lasm/archs/z80_encoder.h"
+
+#include <stdio.h>
+
+#define _log_bank_error_noexit(_location, _format, ...)                        \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+	} while (0)
+
+#define _log_bank_error(_location, _format, ...)                               \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+typedef struct
+{
+	lasm_arena_s* arena;
+	lasm_arch_type_e arch;
+	lasm_labels_vector_s* labels;
+	const lasm_regions_vector_s* regions;
+	lasm_symtab_s trampolines;  // note: names of the generated trampolines, mapped to their labels.
+	uint64_t home;              // note: region of the trampolines, or lasm_ast_region_none until it is needed.
+	uint64_t bytes;
+} _banks_s;
+
+static uint64_t* _label_regions(const _banks_s* const banks);
+
+static bool_t _same_bank(const _banks_s* const banks, const uint64_t left, const uint64_t right);
+
+static uint64_t _find_home(const _banks_s* const banks, const lasm_location_s location);
+
+static uint64_t _get_trampoline(_banks_s* const banks, const lasm_ast_fixup_s* const fixup, const uint64_t target_region, const uint64_t restore_region);
+
+static void _build_trampoline(const _banks_s* const banks, const lasm_ast_region_s* const target, const lasm_ast_region_s* const restore, lasm_bank_trampoline_s* const trampoline);
+
+void lasm_banks_route(lasm_arena_s* const arena, const lasm_config_build_s* const config, lasm_labels_vector_s* const labels, const lasm_regions_vector_s* const regions)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(regions != NULL);
+
+	uint64_t banked = 0;
+
+	for (uint64_t index = 0; index < regions->count; ++index)
+	{
+		banked += (uint64_t)(regions->data[index].bank != lasm_ast_bank_none);
+	}
+
+	if (0 == banked)
+	{
+		return;
+	}
+
+	_banks_s banks = (_banks_s)
+	{
+		.arena       = arena,
+		.arch        = config->arch,
+		.labels      = labels,
+		.regions     = regions,
+		.trampolines = lasm_symtab_new(arena),
+		.home        = lasm_ast_region_none,
+		.bytes       = 0,
+	};
+
+	uint64_t* const label_regions = _label_regions(&banks);
+	const uint64_t count = labels->count;  // note: the trampolines are appended after the labels, and are not routed.
+	uint64_t routed = 0, errors = 0;
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		for (uint64_t fixup_index = 0; fixup_index < labels->data[index].fixups.count; ++fixup_index)
+		{
+			lasm_ast_fixup_s* const fixup = &labels->data[index].fixups.data[fixup_index];
+
+			if ((lasm_ast_label_none == fixup->target) || (lasm_ir_flow_none == fixup->flow))
+			{
+				continue;
+			}
+
+			const uint64_t caller = label_regions[index];
+			const uint64_t target = label_regions[fixup->target];
+
+			if ((lasm_ast_region_none == target) || (lasm_ast_bank_none == regions->data[target].bank) || _same_bank(&banks, caller, target))
+			{
+				continue;
+			}
+
+			const bool_t caller_banked = (caller != lasm_ast_region_none) && (regions->data[caller].bank != lasm_ast_bank_none);
+
+			// note: a jump from the memory outside of the banks may enter a bank,
+			// that the caller has selected, but a jump from one bank can never
+			// reach another one, as it would not return to select the bank back.
+			if (lasm_ir_flow_jump == fixup->flow)
+			{
+				if (caller_banked)
+				{
+					_log_bank_error_noexit(fixup->location,
+						"label '%s' in bank %lu jumps to label '%s' in bank %lu. only the calls are routed through far call trampolines across the banks.",
+						labels->data[index].name, regions->data[caller].bank,
+						labels->data[fixup->target].name, regions->data[target].bank
+					);
+					++errors;
+				}
+
+				continue;
+			}
+
+			// note: the caller's bank is selected back only when the target's bank
+			// is selected with the same port, as the other ports do not unmap it.
+			const bool_t restore = caller_banked && (regions->data[caller].port == regions->data[target].port);
+			const uint64_t trampoline = _get_trampoline(&banks, fixup, target, (restore ? caller : lasm_ast_region_none));
+
+			fixup->target = trampoline;
+			fixup->symbol = labels->data[trampoline].name;
+			fixup->symbol_length = lasm_common_strlen(fixup->symbol);
+			fixup->addend = 0;
+			++routed;
+		}
+	}
+
+	if (errors > 0)
+	{
+		lasm_logger_error("bank routing failed with %lu errors.", errors);
+		lasm_common_exit(1);
+	}
+
+	lasm_logger_info("banks: %lu far calls are routed through %lu trampolines, which take %lu bytes%s%s%s.",
+		routed, labels->count - count, banks.bytes,
+		((banks.home != lasm_ast_region_none) ? " in region '" : ""),
+		((banks.home != lasm_ast_region_none) ? regions->data[banks.home].name : ""),
+		((banks.home != lasm_ast_region_none) ? "'" : "")
+	);
+}
+
+static uint64_t* _label_regions(const _banks_s* const banks)
+{
+	lasm_debug_assert(banks != NULL);
+
+	const lasm_labels_vector_s* const labels = banks->labels;
+	uint64_t* const regions = (uint64_t* const)lasm_arena_alloc(banks->arena, (labels->count + 1) * sizeof(uint64_t));
+	lasm_debug_assert(regions != NULL);
+
+	uint64_t region = lasm_ast_region_none;
+
+	// note: mirrors the region inference of the layout, except that a label with
+	// an explicit address is left without a region, as it is never placed into
+	// a banked region by its address.
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_attr_s* const attrs = labels->data[index].attrs;
+
+		if (!attrs[lasm_ast_attr_type_region].inferred)
+		{
+			region = attrs[lasm_ast_attr_type_region].as.region.value;
+		}
+		else if (!attrs[lasm_ast_attr_type_addr].inferred)
+		{
+			region = lasm_ast_region_none;
+		}
+
+		regions[index] = region;
+	}
+
+	return regions;
+}
+
+static bool_t _same_bank(const _banks_s* const banks, const uint64_t left, const uint64_t right)
+{
+	lasm_debug_assert(banks != NULL);
+
+	if ((lasm_ast_region_none == left) || (lasm_ast_region_none == right))
+	{
+		return false;
+	}
+
+	const lasm_ast_region_s* const left_region = &banks->regions->data[left];
+	const lasm_ast_region_s* const right_region = &banks->regions->data[right];
+	return (left_region->bank == right_region->bank) && (left_region->port == right_region->port);
+}
+
+static uint64_t _find_home(const _banks_s* const banks, const lasm_location_s location)
+{
+	lasm_debug_assert(banks != NULL);
+
+	for (uint64_t index = 0; index < banks->regions->count; ++index)
+	{
+		const lasm_ast_region_s* const region = &banks->regions->data[index];
+
+		if ((lasm_ast_bank_none == region->bank) && lasm_ast_perm_type_allows(region->perm, lasm_ast_perm_type_rx))
+		{
+			return index;
+		}
+	}
+
+	_log_bank_error(location,
+		"a far call trampoline is needed for the call across the banks, but there is no executable region outside of the banks to place it in. declare a region with 'rx' permissions and without a bank."
+	);
+	return lasm_ast_region_none;
+}
+
+static uint64_t _get_trampoline(_banks_s* const banks, const lasm_ast_fixup_s* const fixup, const uint64_t target_region, const uint64_t restore_region)
+{
+	lasm_debug_assert(banks != NULL);
+	lasm_debug_assert(fixup != NULL);
+
+	const lasm_ast_label_s* const target = &banks->labels->data[fixup->target];
+	const lasm_ast_region_s* const restore = ((lasm_ast_region_none == restore_region) ? NULL : &banks->regions->data[restore_region]);
+
+	// note: the names of the trampolines contain a '@', so they can never clash
+	// with the names of the labels.
+	#define name_buffer_capacity 512
+	static char_t name_buffer[name_buffer_capacity + 1];
+	int32_t length = snprintf(name_buffer, name_buffer_capacity, "%s", target->name);
+
+	if (fixup->addend != 0)
+	{
+		length += snprintf(name_buffer + length, name_buffer_capacity - (uint64_t)length, "+%lu", fixup->addend);
+	}
+
+	if (NULL == restore)
+	{
+		length += snprintf(name_buffer + length, name_buffer_capacity - (uint64_t)length, "@far");
+	}
+	else
+	{
+		length += snprintf(name_buffer + length, name_buffer_capacity - (uint64_t)length, "@far%lu", restore->bank);
+	}
+
+	lasm_debug_assert((length > 0) && (length < name_buffer_capacity));
+	uint64_t index = 0;
+
+	if (lasm_symtab_find(&banks->trampolines, name_buffer, (uint64_t)length, &index))
+	{
+		return index;
+	}
+
+	if (lasm_ast_region_none == banks->home)
+	{
+		banks->home = _find_home(banks, fixup->location);
+	}
+
+	char_t* const name = (char_t* const)lasm_arena_alloc(banks->arena, (uint64_t)length + 1);
+	lasm_debug_assert(name != NULL);
+	lasm_common_memcpy(name, name_buffer, (uint64_t)length + 1);
+
+	lasm_bank_trampoline_s trampoline = {0};
+	_build_trampoline(banks, &banks->regions->data[target_region], restore, &trampoline);
+
+	const lasm_ast_region_s* const home = &banks->regions->data[banks->home];
+	lasm_ast_label_s label = (lasm_ast_label_s)
+	{
+		.location     = target->location,
+		.name         = name,
+		.fingerprint  = 0,
+		.body         = lasm_bytes_vector_new(banks->arena, trampoline.length),
+		.fixups       = lasm_fixups_vector_new(banks->arena, 1),
+		.locals       = lasm_locals_vector_new(banks->arena, 1),
+		.cached       = false,
+		.transient    = false,
+		.strings      = false,
+		.symbolic     = true,
+		.alias        = lasm_ast_label_none,
+		.alias_offset = 0,
+	};
+
+	label.attrs[lasm_ast_attr_type_addr]   = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_addr,  .inferred = true, };
+	label.attrs[lasm_ast_attr_type_align]  = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_align, .inferred = true, };
+	label.attrs[lasm_ast_attr_type_size]   = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_size,  .inferred = true, };
+	label.attrs[lasm_ast_attr_type_perm]   = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_perm,  .as.perm.value = lasm_ast_perm_type_rx, };
+	label.attrs[lasm_ast_attr_type_region] = (lasm_ast_attr_s)
+	{
+		.type      = lasm_ast_attr_type_region,
+		.inferred  = false,
+		.as.region = { .value = banks->home, .name = home->name, .bank = lasm_ast_bank_none, },
+	};
+	label.attrs[lasm_ast_attr_type_cycles] = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_cycles, .inferred = true, };
+
+	index = banks->labels->count;
+	lasm_bytes_vector_append(&label.body, trampoline.bytes, trampoline.length);
+	lasm_fixups_vector_push(&label.fixups, (lasm_ast_fixup_s)
+	{
+		.location      = fixup->location,
+		.kind          = lasm_ir_fixup_kind_abs,
+		.width         = 2,
+		.field_offset  = trampoline.field_offset,
+		.relax         = false,
+		.flow          = lasm_ir_flow_none,
+		.offset        = trampoline.field_offset,
+		.symbol        = target->name,
+		.symbol_length = lasm_common_strlen(target->name),
+		.addend        = fixup->addend,
+		.label         = index,
+		.target        = fixup->target,
+		.local         = lasm_ast_label_none,
+	});
+
+	lasm_labels_vector_push(banks->labels, label);
+	uint64_t existing = 0;
+	(void)lasm_symtab_insert(&banks->trampolines, name, (uint64_t)length, index, &existing);
+	banks->bytes += trampoline.length;
+	return index;
+}
+
+static void _build_trampoline(const _banks_s* const banks, const lasm_ast_region_s* const target, const lasm_ast_region_s* const restore, lasm_bank_trampoline_s* const trampoline)
+{
+	lasm_debug_assert(banks != NULL);
+	lasm_debug_assert(target != NULL);
+	lasm_debug_assert(trampoline != NULL);
+
+	switch (banks->arch)
+	{
+		case lasm_arch_type_z80:
+		{
+			z80_encoder_trampoline(target->bank, target->port, ((NULL == restore) ? lasm_ast_bank_none : restore->bank), trampoline);
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: the parser accepts the banked regions only for z80.
+		} break;
+	}
+
+	lasm_debug_assert((trampoline->length > 0) && (trampoline->length <= lasm_bank_trampoline_capacity));
+	lasm_debug_assert((trampoline->field_offset + 2) <= trampoline->length);
+}
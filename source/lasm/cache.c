@@ -0,0 +1,514 @@
+
+/**
+ * @file cache.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-23
+ */
+
+#include "lasm/cache.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#define _cache_magic   ((uint64_t)0x686361636D73616C)  // note: "lasmcach" in little endian.
+#define _cache_version ((uint64_t)11)
+
+// note: the smallest encodings of the cached records, that bound the counts
+// and the lengths read from the file by the bytes left in it.
+#define _cache_entry_min_size ((uint64_t)(6 * sizeof(uint64_t)))
+#define _cache_fixup_min_size ((uint64_t)(11 * sizeof(uint64_t)))
+#define _cache_local_min_size ((uint64_t)sizeof(uint64_t))
+
+static const char_t* _make_cache_path(lasm_arena_s* const arena, const char_t* const output, const char_t* const extension);
+
+static bool_t _read_u64(FILE* const file, uint64_t* const value);
+
+static bool_t _read_length(FILE* const file, const uint64_t size, const uint64_t unit, uint64_t* const value);
+
+static bool_t _write_u64(FILE* const file, const uint64_t value);
+
+static bool_t _read_fixups(lasm_arena_s* const arena, FILE* const file, const uint64_t size, lasm_fixups_vector_s* const fixups);
+
+static bool_t _write_fixups(FILE* const file, const lasm_fixups_vector_s* const fixups);
+
+static bool_t _read_locals(lasm_arena_s* const arena, FILE* const file, const uint64_t size, lasm_locals_vector_s* const locals);
+
+static bool_t _write_locals(FILE* const file, const lasm_locals_vector_s* const locals);
+
+static bool_t _read_blob(lasm_arena_s* const arena, FILE* const file, const uint64_t size, lasm_ast_blob_s* const blob);
+
+static bool_t _write_blob(FILE* const file, const lasm_ast_blob_s* const blob);
+
+static uint64_t _count_stored(const lasm_labels_vector_s* const labels);
+
+static bool_t _is_entry_valid(const lasm_cache_entry_s* const entry);
+
+static int32_t _compare_entries(const void* const left, const void* const right);
+
+lasm_implement_vector_type(lasm_cache_entries_vector, lasm_cache_entry_s);
+
+lasm_cache_s lasm_cache_load(lasm_arena_s* const arena, lasm_config_build_s* const config)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+
+	lasm_cache_s cache = (lasm_cache_s)
+	{
+		.arena   = arena,
+		.config  = config,
+		.path    = _make_cache_path(arena, config->output, ".cache"),
+		.entries = lasm_cache_entries_vector_new(arena, 1),
+		.hits    = 0,
+		.misses  = 0,
+	};
+
+	if (!config->cache)
+	{
+		return cache;
+	}
+
+	FILE* const file = fopen(cache.path, "rb");
+
+	if (NULL == file)
+	{
+		return cache;
+	}
+
+	uint64_t magic = 0, version = 0, arch = 0, peephole = 0, count = 0;
+	const long end = ((0 == fseek(file, 0, SEEK_END)) ? ftell(file) : -1);
+
+	if ((end < 0) || (fseek(file, 0, SEEK_SET) != 0))
+	{
+		(void)fclose(file);
+		return cache;
+	}
+
+	const uint64_t size = (uint64_t)end;
+
+	// note: the peephole rewrites change the encoded bodies, so the bodies are
+	// reused only by the builds with the same setting.
+	if (!_read_u64(file, &magic)    || (magic != _cache_magic)                   ||
+		!_read_u64(file, &version)  || (version != _cache_version)               ||
+		!_read_u64(file, &arch)     || (arch != (uint64_t)config->arch)          ||
+		!_read_u64(file, &peephole) || (peephole != (uint64_t)config->peephole)  ||
+		!_read_length(file, size, _cache_entry_min_size, &count))
+	{
+		(void)fclose(file);
+		return cache;
+	}
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		lasm_cache_entry_s entry = {0};
+		uint64_t symbolic = 0, length = 0;
+
+		if (!_read_u64(file, &entry.fingerprint) || !_read_u64(file, &symbolic) || !_read_length(file, size, sizeof(uint8_t), &length))
+		{
+			lasm_logger_warn("ignoring corrupted cache file %s.", cache.path);
+			cache.entries.count = 0;
+			break;
+		}
+
+		entry.symbolic = (symbolic != 0);
+		entry.body = lasm_bytes_vector_new(arena, length + 1);
+		entry.body.count = length;
+
+		if ((fread(entry.body.data, sizeof(uint8_t), (size_t)length, file) != (size_t)length) ||
+			!_read_fixups(arena, file, size, &entry.fixups) || !_read_locals(arena, file, size, &entry.locals) ||
+			!_read_blob(arena, file, size, &entry.blob) || !_is_entry_valid(&entry))
+		{
+			lasm_logger_warn("ignoring corrupted cache file %s.", cache.path);
+			cache.entries.count = 0;
+			break;
+		}
+
+		lasm_cache_entries_vector_push(&cache.entries, entry);
+	}
+
+	(void)fclose(file);
+
+	if (cache.entries.count > 0)
+	{
+		qsort(cache.entries.data, (size_t)cache.entries.count, sizeof(lasm_cache_entry_s), _compare_entries);
+	}
+
+	return cache;
+}
+
+const lasm_cache_entry_s* lasm_cache_find(lasm_cache_s* const cache, const uint64_t fingerprint)
+{
+	lasm_debug_assert(cache != NULL);
+
+	const lasm_cache_entry_s key = (const lasm_cache_entry_s)
+	{
+		.fingerprint = fingerprint,
+	};
+
+	const lasm_cache_entry_s* const entry = (cache->entries.count > 0) ? (const lasm_cache_entry_s*)bsearch(
+		&key, cache->entries.data, (size_t)cache->entries.count, sizeof(lasm_cache_entry_s), _compare_entries) : NULL;
+
+	if (NULL == entry)
+	{
+		++cache->misses;
+		return NULL;
+	}
+
+	++cache->hits;
+	return entry;
+}
+
+void lasm_cache_store(lasm_cache_s* const cache, const lasm_labels_vector_s* const labels)
+{
+	lasm_debug_assert(cache != NULL);
+	lasm_debug_assert(labels != NULL);
+
+	if (!cache->config->cache)
+	{
+		return;
+	}
+
+	// note: the cache is written next to the old one and renamed over it only
+	// when it is complete, so a failed write never leaves a truncated cache.
+	const char_t* const temp_path = _make_cache_path(cache->arena, cache->config->output, ".cache.tmp");
+	FILE* const file = fopen(temp_path, "wb");
+
+	if (NULL == file)
+	{
+		lasm_logger_warn("unable to open cache file %s for writing.", temp_path);
+		return;
+	}
+
+	bool_t written = _write_u64(file, _cache_magic)                           &&
+		_write_u64(file, _cache_version)                                      &&
+		_write_u64(file, (uint64_t)cache->config->arch)                       &&
+		_write_u64(file, (uint64_t)cache->config->peephole)                   &&
+		_write_u64(file, _count_stored(labels));
+
+	for (uint64_t index = 0; written && (index < labels->count); ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+
+		if (label->transient)
+		{
+			continue;
+		}
+
+		written = _write_u64(file, label->fingerprint)                        &&
+			_write_u64(file, (uint64_t)label->symbolic)                       &&
+			_write_u64(file, label->body.count)                               &&
+			((0 == label->body.count) || (fwrite(label->body.data, sizeof(uint8_t), (size_t)label->body.count, file) == (size_t)label->body.count)) &&
+			_write_fixups(file, &label->fixups)                               &&
+			_write_locals(file, &label->locals)                               &&
+			_write_blob(file, &label->blob);
+	}
+
+	written = (fclose(file) == 0) && written;
+
+	if (!written || (rename(temp_path, cache->path) != 0))
+	{
+		lasm_logger_warn("unable to write cache file %s.", cache->path);
+		(void)remove(temp_path);
+	}
+}
+
+static const char_t* _make_cache_path(lasm_arena_s* const arena, const char_t* const output, const char_t* const extension)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(output != NULL);
+	lasm_debug_assert(extension != NULL);
+
+	const uint64_t output_length = lasm_common_strlen(output);
+	const uint64_t extension_length = lasm_common_strlen(extension);
+	lasm_debug_assert(output_length > 0);
+
+	char_t* const path = (char_t* const)lasm_arena_alloc(arena, output_length + extension_length + 1);
+	lasm_debug_assert(path != NULL);
+
+	lasm_common_memcpy(path, output, output_length);
+	lasm_common_memcpy(path + output_length, extension, extension_length + 1);
+	return path;
+}
+
+static bool_t _read_u64(FILE* const file, uint64_t* const value)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(value != NULL);
+	return (fread(value, sizeof(uint64_t), 1, file) == 1);
+}
+
+static bool_t _read_length(FILE* const file, const uint64_t size, const uint64_t unit, uint64_t* const value)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(unit > 0);
+	lasm_debug_assert(value != NULL);
+
+	if (!_read_u64(file, value))
+	{
+		return false;
+	}
+
+	// note: a count or a length, that needs more bytes than are left in the
+	// file, is corrupted, and is never used to allocate the records.
+	const long position = ftell(file);
+	return (position >= 0) && ((uint64_t)position <= size) && (*value <= ((size - (uint64_t)position) / unit));
+}
+
+static bool_t _write_u64(FILE* const file, const uint64_t value)
+{
+	lasm_debug_assert(file != NULL);
+	return (fwrite(&value, sizeof(uint64_t), 1, file) == 1);
+}
+
+static bool_t _read_fixups(lasm_arena_s* const arena, FILE* const file, const uint64_t size, lasm_fixups_vector_s* const fixups)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(fixups != NULL);
+
+	uint64_t count = 0;
+
+	if (!_read_length(file, size, _cache_fixup_min_size, &count))
+	{
+		return false;
+	}
+
+	*fixups = lasm_fixups_vector_new(arena, count + 1);
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		uint64_t kind = 0, width = 0, field_offset = 0, relax = 0, flow = 0;
+		lasm_ast_fixup_s fixup = {0};
+
+		if (!_read_u64(file, &kind)                  || (kind >= lasm_ir_fixup_kinds_count) ||
+			!_read_u64(file, &width)                 || (0 == width) || (width > 8)         ||
+			!_read_u64(file, &field_offset)          || (field_offset > UINT8_MAX)          ||
+			!_read_u64(file, &relax)                 ||
+			!_read_u64(file, &flow)                  || (flow >= lasm_ir_flows_count)       ||
+			!_read_u64(file, &fixup.offset)          ||
+			!_read_u64(file, &fixup.addend)          ||
+			!_read_u64(file, &fixup.local)           ||
+			!_read_u64(file, &fixup.location.line)   ||
+			!_read_u64(file, &fixup.location.column) ||
+			!_read_length(file, size, sizeof(char_t), &fixup.symbol_length))
+		{
+			return false;
+		}
+
+		char_t* const symbol = (char_t* const)lasm_arena_alloc(arena, fixup.symbol_length + 1);
+		lasm_debug_assert(symbol != NULL);
+
+		if (fread(symbol, sizeof(char_t), (size_t)fixup.symbol_length, file) != (size_t)fixup.symbol_length)
+		{
+			return false;
+		}
+
+		symbol[fixup.symbol_length] = 0;
+		fixup.kind = (lasm_ir_fixup_kind_e)kind;
+		fixup.width = (uint8_t)width;
+		fixup.field_offset = (uint8_t)field_offset;
+		fixup.relax = (relax != 0);
+		fixup.flow = (lasm_ir_flow_e)flow;
+		fixup.symbol = symbol;
+		fixup.label = lasm_ast_label_none;
+		fixup.target = lasm_ast_label_none;
+		lasm_fixups_vector_push(fixups, fixup);
+	}
+
+	return true;
+}
+
+static bool_t _write_fixups(FILE* const file, const lasm_fixups_vector_s* const fixups)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(fixups != NULL);
+
+	if (!_write_u64(file, fixups->count))
+	{
+		return false;
+	}
+
+	for (uint64_t index = 0; index < fixups->count; ++index)
+	{
+		const lasm_ast_fixup_s* const fixup = &fixups->data[index];
+
+		if (!_write_u64(file, (uint64_t)fixup->kind)    ||
+			!_write_u64(file, fixup->width)             ||
+			!_write_u64(file, fixup->field_offset)      ||
+			!_write_u64(file, (uint64_t)fixup->relax)   ||
+			!_write_u64(file, (uint64_t)fixup->flow)    ||
+			!_write_u64(file, fixup->offset)            ||
+			!_write_u64(file, fixup->addend)            ||
+			!_write_u64(file, fixup->local)             ||
+			!_write_u64(file, fixup->location.line)     ||
+			!_write_u64(file, fixup->location.column)   ||
+			!_write_u64(file, fixup->symbol_length)     ||
+			(fwrite(fixup->symbol, sizeof(char_t), (size_t)fixup->symbol_length, file) != (size_t)fixup->symbol_length))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool_t _read_locals(lasm_arena_s* const arena, FILE* const file, const uint64_t size, lasm_locals_vector_s* const locals)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(locals != NULL);
+
+	uint64_t count = 0;
+
+	if (!_read_length(file, size, _cache_local_min_size, &count))
+	{
+		return false;
+	}
+
+	*locals = lasm_locals_vector_new(arena, count + 1);
+
+	// note: the fixups of the cached bodies are already bound to their local
+	// labels, so only the offsets of the local labels are cached.
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		lasm_ast_local_s local = {0};
+
+		if (!_read_u64(file, &local.offset))
+		{
+			return false;
+		}
+
+		lasm_locals_vector_push(locals, local);
+	}
+
+	return true;
+}
+
+static bool_t _write_locals(FILE* const file, const lasm_locals_vector_s* const locals)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(locals != NULL);
+
+	bool_t written = _write_u64(file, locals->count);
+
+	for (uint64_t index = 0; written && (index < locals->count); ++index)
+	{
+		written = _write_u64(file, locals->data[index].offset);
+	}
+
+	return written;
+}
+
+static bool_t _read_blob(lasm_arena_s* const arena, FILE* const file, const uint64_t size, lasm_ast_blob_s* const blob)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(blob != NULL);
+
+	uint64_t length = 0;
+	*blob = (lasm_ast_blob_s) {0};
+
+	if (!_read_length(file, size, sizeof(char_t), &length))
+	{
+		return false;
+	}
+
+	// note: the bodies, that do not end with included bytes, have no path.
+	if (0 == length)
+	{
+		return true;
+	}
+
+	char_t* const path = (char_t* const)lasm_arena_alloc(arena, length + 1);
+	lasm_debug_assert(path != NULL);
+
+	if ((fread(path, sizeof(char_t), (size_t)length, file) != (size_t)length) ||
+		!_read_u64(file, &blob->offset)                                      ||
+		!_read_u64(file, &blob->length)                                      ||
+		!_read_u64(file, &blob->location.line)                               ||
+		!_read_u64(file, &blob->location.column))
+	{
+		return false;
+	}
+
+	path[length] = 0;
+	blob->path = path;
+	return true;
+}
+
+static bool_t _write_blob(FILE* const file, const lasm_ast_blob_s* const blob)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(blob != NULL);
+
+	if (NULL == blob->path)
+	{
+		return _write_u64(file, 0);
+	}
+
+	const uint64_t length = lasm_common_strlen(blob->path);
+	return _write_u64(file, length)                                                         &&
+		(fwrite(blob->path, sizeof(char_t), (size_t)length, file) == (size_t)length)        &&
+		_write_u64(file, blob->offset)                                                      &&
+		_write_u64(file, blob->length)                                                      &&
+		_write_u64(file, blob->location.line)                                               &&
+		_write_u64(file, blob->location.column);
+}
+
+static uint64_t _count_stored(const lasm_labels_vector_s* const labels)
+{
+	lasm_debug_assert(labels != NULL);
+
+	uint64_t count = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		count += (uint64_t)!labels->data[index].transient;
+	}
+
+	return count;
+}
+
+static bool_t _is_entry_valid(const lasm_cache_entry_s* const entry)
+{
+	lasm_debug_assert(entry != NULL);
+
+	// note: the fixups and the local labels are applied to the body without
+	// any further checks, so they must stay within it.
+	for (uint64_t index = 0; index < entry->locals.count; ++index)
+	{
+		if (entry->locals.data[index].offset > entry->body.count)
+		{
+			return false;
+		}
+	}
+
+	for (uint64_t index = 0; index < entry->fixups.count; ++index)
+	{
+		const lasm_ast_fixup_s* const fixup = &entry->fixups.data[index];
+
+		if ((fixup->offset > entry->body.count) || (fixup->width > (entry->body.count - fixup->offset)) ||
+			((fixup->local != lasm_ast_label_none) && (fixup->local >= entry->locals.count)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int32_t _compare_entries(const void* const left, const void* const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	const uint64_t left_fingerprint  = ((const lasm_cache_entry_s*)left)->fingerprint;
+	const uint64_t right_fingerprint = ((const lasm_cache_entry_s*)right)->fingerprint;
+	return (left_fingerprint > right_fingerprint) - (left_fingerprint < right_fingerprint);
+}
@@ -100,3 +100,18 @@ char_t* lasm_common_strchr(const char_t* const string, const int32_t c)
 	lasm_debug_assert(string != NULL);
 	return strchr(string, c);
 }
+
+uint64_t lasm_common_hash(const uint64_t seed, const void* const data, const uint64_t length)
+{
+	lasm_debug_assert(data != NULL);
+	const uint8_t* const bytes = (const uint8_t* const)data;
+	uint64_t hash = seed;
+
+	for (uint64_t index = 0; index < length; ++index)
+	{
+		hash ^= (uint64_t)bytes[index];
+		hash *= (uint64_t)0x00000100000001B3;
+	}
+
+	return hash;
+}
@@ -15,33 +15,51 @@
 #include "lasm/logger.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 
 static const char_t* _g_program = NULL;
 
 const char_t _g_usage_banner[] =
-	"usage: %s <command>                                                                                                                                                           \n" \
-	"                                                                                                                                                                              \n" \
-	"commands:                                                                                                                                                                     \n" \
+	"usage: %s <command>\n" \
+	"\n" \
+	"commands:\n" \
 	"    init <-t template> <directory>      initialize provided directory with a specified template. warning: it will overwrite the existing build script and the entry.lasm file!\n" \
-	"        required:                                                                                                                                                             \n" \
-	"            -t, --template <name>       set the build system script template format to create a build script file in the provided directory. supported templates are: %s.     \n" \
-	"            <directory>                 directory to use as a root of the project.                                                                                            \n" \
-	"                                                                                                                                                                              \n" \
-	"    build [options] <source.lasm>       build the project with provided source file.                                                                                          \n" \
-	"        required:                                                                                                                                                             \n" \
-	"            -a, --arch <name>           set the target architecture for the executable. supported architectures are: %s.                                                      \n" \
-	"            -f, --format <name>         set the target format for the executable. supported formats are: %s.                                                                  \n" \
-	"            <source.lasm>               source file to build.                                                                                                                 \n" \
-	"        optional:                                                                                                                                                             \n" \
-	"            -e, --entry <name>          set the entry name symbol for the executable. defaults to the name \'main\'.                                                          \n" \
-	"            -o, --output <path>         set the output path for the executable. defaults to the name of provided source file with extension removed if not provided.          \n" \
-	"                                                                                                                                                                              \n" \
-	"    help                                print this help message banner.                                                                                                       \n" \
-	"                                                                                                                                                                              \n" \
-	"    version                             print the version of this executable.                                                                                                 \n" \
-	"                                                                                                                                                                              \n" \
-	"notice:                                                                                                                                                                       \n" \
-	"    this executable is distributed under the \"lasm gplv1\" license.                                                                                                          \n";
+	"        required:\n" \
+	"            -t, --template <name>       set the build system script template format to create a build script file in the provided directory. supported templates are: %s.\n" \
+	"            <directory>                 directory to use as a root of the project.\n" \
+	"\n" \
+	"    build [options] <source.lasm>       build the project with provided source file.\n" \
+	"        required:\n" \
+	"            -a, --arch <name>           set the target architecture for the executable. supported architectures are: %s.\n" \
+	"            -f, --format <name>         set the target format for the executable. supported formats are: %s.\n" \
+	"            <source.lasm>               source file to build.\n" \
+	"        optional:\n" \
+	"            -e, --entry <name>          set the entry name symbol for the executable. defaults to the name \'main\'.\n" \
+	"            -o, --output <path>         set the output path for the executable. defaults to the name of provided source file with extension removed if not provided.\n" \
+	"            -n, --no-cache              do not reuse nor update the encoding cache, that is stored next to the output file with a '.cache' extension.\n" \
+	"            -s, --stats                 print the memory and the encoding cache statistics after the build.\n" \
+	"            -p, --pack                  place the labels with inferred addresses into the free gaps around the labels with explicit addresses, instead of placing them in the source order.\n" \
+	"            -i, --fold                  fold the read only labels with identical bodies into one copy, and make the others aliases of it.\n" \
+	"            -l, --pool-strings          share the memory of the read only string labels, which are identical to, or suffixes of, other string labels.\n" \
+	"            -r, --relax                 start the relaxable long branches in their short forms, and grow only the ones, which targets are out of the short range.\n" \
+	"            -O, --peephole              rewrite the known wasteful instruction sequences into shorter ones, and report each rewrite. supported only for the z80 architecture.\n" \
+	"            -c, --cycles                print the best and the worst case cycles of the executable labels, and of their basic blocks.\n" \
+	"\n" \
+	"    disasm [options] <input>            write the canonical source of the label bodies of a source file, or of a raw image. the bodies are decoded with the same encodings tables, that the build uses.\n" \
+	"        required:\n" \
+	"            -a, --arch <name>           set the architecture of the input. supported architectures are: %s.\n" \
+	"            <input>                     source file to build and disassemble, when it ends with '.lasm', or a raw image otherwise.\n" \
+	"        optional:\n" \
+	"            -o, --output <path>         set the output path for the disassembly. defaults to the name of provided input file with a '.disasm.lasm' extension.\n" \
+	"            -b, --base <addr>           set the load address of the raw image. defaults to 0x0.\n" \
+	"            -r, --round-trip            assemble the disassembly back, and report the bytes, that differ from the original ones.\n" \
+	"\n" \
+	"    help                                print this help message banner.\n" \
+	"\n" \
+	"    version                             print the version of this executable.\n" \
+	"\n" \
+	"notice:\n" \
+	"    this executable is distributed under the \"lasm gplv1\" license.\n";
 
 static const char_t* _g_supported_templates[lasm_template_types_count] =
 {
@@ -69,13 +87,10 @@ static const char_t* _g_supported_formats[lasm_format_types_count] =
 	[lasm_format_type_elf]      = "elf"  ,
 	[lasm_format_type_elf32]    = "elf32",
 	[lasm_format_type_elf64]    = "elf64",
-	[lasm_format_type_pe]       = "pe"   ,
-	[lasm_format_type_pe32]     = "pe32" ,
-	[lasm_format_type_pe32plus] = "pe32+",
 };
 
 _Static_assert(
-	lasm_format_types_count == 6,
+	lasm_format_types_count == 3,
 	"_g_supported_formats is not in sync with lasm_format_type_e enum!"
 );
 
@@ -99,6 +114,8 @@ static lasm_config_s _parse_init_command(lasm_arena_s* const arena, int32_t* con
 
 static lasm_config_s _parse_build_command(lasm_arena_s* const arena, int32_t* const argc, const char_t*** const argv);
 
+static lasm_config_s _parse_disasm_command(lasm_arena_s* const arena, int32_t* const argc, const char_t*** const argv);
+
 lasm_template_type_e lasm_template_type_from_string(const char_t* const template_as_string)
 {
 	lasm_debug_assert(template_as_string != NULL);
@@ -199,6 +216,10 @@ lasm_config_s lasm_config_from_cli(lasm_arena_s* const arena, int32_t* const arg
 	{
 		return _parse_build_command(arena, argc, argv);
 	}
+	else if (lasm_common_strcmp(command, "disasm") == 0)
+	{
+		return _parse_disasm_command(arena, argc, argv);
+	}
 	else if (lasm_common_strcmp(command, "help") == 0)
 	{
 		_print_usage_banner();
@@ -343,7 +364,7 @@ static void _print_usage_banner(void)
 {
 	lasm_debug_assert(_g_usage_banner != NULL);
 	lasm_debug_assert(_g_program != NULL);
-	lasm_logger_log(_g_usage_banner, _g_program, _supported_templates_to_string(), _supported_archs_to_string(), _supported_formats_to_string());
+	lasm_logger_log(_g_usage_banner, _g_program, _supported_templates_to_string(), _supported_archs_to_string(), _supported_formats_to_string(), _supported_archs_to_string());
 }
 
 static const char_t* _shift_cli_args(int32_t* const argc, const char_t*** const argv)
@@ -488,6 +509,14 @@ static lasm_config_s _parse_build_command(lasm_arena_s* const arena, int32_t* co
 	const char_t* entry  = NULL;
 	const char_t* output = NULL;
 	const char_t* source = NULL;
+	bool_t cache = true;
+	bool_t stats = false;
+	bool_t pack = false;
+	bool_t fold = false;
+	bool_t pool = false;
+	bool_t relax = false;
+	bool_t peephole = false;
+	bool_t cycles = false;
 
 	for (uint64_t index = 0; true; ++index)
 	{
@@ -550,6 +579,38 @@ static lasm_config_s _parse_build_command(lasm_arena_s* const arena, int32_t* co
 			lasm_debug_assert(output_as_string != NULL);
 			output = output_as_string;
 		}
+		else if (_match_cli_option(option, "--no-cache", "-n"))
+		{
+			cache = false;
+		}
+		else if (_match_cli_option(option, "--stats", "-s"))
+		{
+			stats = true;
+		}
+		else if (_match_cli_option(option, "--pack", "-p"))
+		{
+			pack = true;
+		}
+		else if (_match_cli_option(option, "--fold", "-i"))
+		{
+			fold = true;
+		}
+		else if (_match_cli_option(option, "--pool-strings", "-l"))
+		{
+			pool = true;
+		}
+		else if (_match_cli_option(option, "--relax", "-r"))
+		{
+			relax = true;
+		}
+		else if (_match_cli_option(option, "--peephole", "-O"))
+		{
+			peephole = true;
+		}
+		else if (_match_cli_option(option, "--cycles", "-c"))
+		{
+			cycles = true;
+		}
 		else
 		{
 			if (source != NULL)
@@ -579,6 +640,12 @@ static lasm_config_s _parse_build_command(lasm_arena_s* const arena, int32_t* co
 		}
 	}
 
+	if (peephole && (lasm_arch_type_from_string(arch) != lasm_arch_type_z80))
+	{
+		lasm_logger_warn("the peephole optimization is supported only for the z80 architecture, so --peephole, -O is ignored.");
+		peephole = false;
+	}
+
 	if (NULL == format)
 	{
 		lasm_logger_error("no format was provided in the command line arguments in 'build' command. supported formats are: %s.", _supported_formats_to_string());
@@ -611,12 +678,13 @@ static lasm_config_s _parse_build_command(lasm_arena_s* const arena, int32_t* co
 		const uint64_t format_length = lasm_common_strlen(format);
 		lasm_debug_assert(format_length > 0);
 
-		char_t* const output_path = (char_t* const)lasm_arena_alloc(arena, source_name_length + 1 + format_length);
+		char_t* const output_path = (char_t* const)lasm_arena_alloc(arena, source_name_length + 1 + format_length + 1);
 		lasm_debug_assert(output_path != NULL);
 
 		lasm_common_memcpy(output_path, source_name, source_name_length);
 		lasm_common_memcpy(output_path + source_name_length, ".", 1);
 		lasm_common_memcpy(output_path + source_name_length + 1, format, format_length);
+		output_path[source_name_length + 1 + format_length] = 0;
 		output = output_path;
 	}
 
@@ -634,6 +702,14 @@ static lasm_config_s _parse_build_command(lasm_arena_s* const arena, int32_t* co
 		.entry      = entry                               ,
 		.output     = output                              ,
 		.source     = source                              ,
+		.cache      = cache                               ,
+		.stats      = stats                               ,
+		.pack       = pack                                ,
+		.fold       = fold                                ,
+		.pool       = pool                                ,
+		.relax      = relax                               ,
+		.peephole   = peephole                            ,
+		.cycles     = cycles                              ,
 	};
 
 	return (const lasm_config_s)
@@ -642,3 +718,154 @@ static lasm_config_s _parse_build_command(lasm_arena_s* const arena, int32_t* co
 		.as.build = build_config          ,
 	};
 }
+
+static lasm_config_s _parse_disasm_command(lasm_arena_s* const arena, int32_t* const argc, const char_t*** const argv)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(argc != NULL);
+	lasm_debug_assert(argv != NULL);
+
+	const char_t* arch   = NULL;
+	const char_t* output = NULL;
+	const char_t* source = NULL;
+	const char_t* base   = NULL;
+	bool_t round_trip = false;
+
+	for (uint64_t index = 0; true; ++index)
+	{
+		const char_t* const option = _shift_cli_args(argc, argv);
+
+		if (NULL == option)
+		{
+			break;
+		}
+
+		if (_match_cli_option(option, "--arch", "-a"))
+		{
+			if (arch != NULL)
+			{
+				lasm_logger_error("multiple --arch, -a arguments found in the command line arguments in 'disasm' command.");
+				_print_usage_banner();
+				lasm_common_exit(1);
+			}
+
+			const char_t* const arch_as_string = _get_option_argument(option, argc, argv);
+			lasm_debug_assert(arch_as_string != NULL);
+			arch = arch_as_string;
+		}
+		else if (_match_cli_option(option, "--output", "-o"))
+		{
+			if (output != NULL)
+			{
+				lasm_logger_error("multiple --output, -o arguments found in the command line arguments in 'disasm' command.");
+				_print_usage_banner();
+				lasm_common_exit(1);
+			}
+
+			const char_t* const output_as_string = _get_option_argument(option, argc, argv);
+			lasm_debug_assert(output_as_string != NULL);
+			output = output_as_string;
+		}
+		else if (_match_cli_option(option, "--base", "-b"))
+		{
+			if (base != NULL)
+			{
+				lasm_logger_error("multiple --base, -b arguments found in the command line arguments in 'disasm' command.");
+				_print_usage_banner();
+				lasm_common_exit(1);
+			}
+
+			const char_t* const base_as_string = _get_option_argument(option, argc, argv);
+			lasm_debug_assert(base_as_string != NULL);
+			base = base_as_string;
+		}
+		else if (_match_cli_option(option, "--round-trip", "-r"))
+		{
+			round_trip = true;
+		}
+		else
+		{
+			if (source != NULL)
+			{
+				lasm_logger_error("multiple input files found in the command line arguments in 'disasm' command: %s.", option);
+				_print_usage_banner();
+				lasm_common_exit(1);
+			}
+
+			source = option;
+		}
+	}
+
+	if (NULL == arch)
+	{
+		lasm_logger_error("no architecture was provided in the command line arguments in 'disasm' command. supported architectures are: %s.", _supported_archs_to_string());
+		_print_usage_banner();
+		lasm_common_exit(1);
+	}
+	else
+	{
+		if (lasm_arch_type_none == lasm_arch_type_from_string(arch))
+		{
+			lasm_logger_error("an invalid architecture was provided in the command line arguments in 'disasm' command: %s. supported architectures are: %s.", arch, _supported_archs_to_string());
+			_print_usage_banner();
+			lasm_common_exit(1);
+		}
+	}
+
+	if (NULL == source)
+	{
+		lasm_logger_error("input file was not provided in 'disasm' command.");
+		_print_usage_banner();
+		lasm_common_exit(1);
+	}
+
+	uint64_t base_addr = 0;
+
+	if (base != NULL)
+	{
+		char_t* end = NULL;
+		base_addr = (uint64_t)strtoull(base, &end, 0);
+
+		if ((0 == base[0]) || ((end != NULL) && (*end != 0)))
+		{
+			lasm_logger_error("an invalid base address was provided in the command line arguments in 'disasm' command: %s.", base);
+			_print_usage_banner();
+			lasm_common_exit(1);
+		}
+	}
+
+	if (NULL == output)
+	{
+		const char_t* const source_name = _get_file_name_from_path(source);
+		lasm_debug_assert(source_name != NULL);
+
+		const uint64_t source_name_length = lasm_common_strlen(source_name);
+		lasm_debug_assert(source_name_length > 0);
+
+		const char_t extension[] = ".disasm.lasm";
+		const uint64_t extension_length = sizeof(extension) - 1;
+
+		char_t* const output_path = (char_t* const)lasm_arena_alloc(arena, source_name_length + extension_length + 1);
+		lasm_debug_assert(output_path != NULL);
+
+		lasm_common_memcpy(output_path, source_name, source_name_length);
+		lasm_common_memcpy(output_path + source_name_length, extension, extension_length);
+		output_path[source_name_length + extension_length] = 0;
+		output = output_path;
+	}
+
+	const lasm_config_disasm_s disasm_config = (const lasm_config_disasm_s)
+	{
+		.arch       = lasm_arch_type_from_string(arch),
+		.output     = output                          ,
+		.source     = source                          ,
+		.base       = base_addr                       ,
+		.round_trip = round_trip                      ,
+	};
+
+	return (const lasm_config_s)
+	{
+		.type      = lasm_config_type_disasm,
+		.as.disasm = disasm_config          ,
+	};
+}
@@ -0,0 +1,249 @@
+
+/**
+ * @file cycles.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-31
+ */
+
+#include "lasm/cycles.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+#include "lasm/archs/z80_isa.h"
+#include "lasm/archs/rl78_isa.h"
+
+#include <stdio.h>
+
+#define _log_cycles_warn(_location, _format, ...)                              \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_warn(_format, ## __VA_ARGS__);                             \
+	} while (0)
+
+#define _log_cycles_error_noexit(_location, _format, ...)                      \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+	} while (0)
+
+typedef struct
+{
+	uint64_t best;
+	uint64_t worst;
+	uint64_t blocks;    // note: count of the basic blocks of the label.
+	uint64_t straight;  // note: count of the basic blocks on the straight line path.
+	uint64_t failed;    // note: offset of the bytes, that do not decode into an instruction, or the length of the body.
+} _cycles_label_s;
+
+static const char_t* const _g_cycles_end_descriptions[lasm_cycles_ends_count] =
+{
+	[lasm_cycles_end_none]   = "falls through to the next label",
+	[lasm_cycles_end_branch] = "ends with a conditional branch",
+	[lasm_cycles_end_exit]   = "ends with a jump or a return",
+	[lasm_cycles_end_skip]   = "ends with a skip",
+};
+
+_Static_assert(
+	lasm_cycles_ends_count == 4,
+	"_g_cycles_end_descriptions is not in sync with lasm_cycles_end_e enum!"
+);
+
+static bool_t _inst_cycles(const lasm_arch_type_e arch, const uint8_t* const inst, const uint64_t length, lasm_cycles_inst_s* const cost);
+
+static _cycles_label_s _count_label(const lasm_arch_type_e arch, const lasm_ast_label_s* const label, const bool_t report);
+
+void lasm_cycles_check(const lasm_config_build_s* const config, const lasm_labels_vector_s* const labels)
+{
+	lasm_debug_assert(config != NULL);
+	lasm_debug_assert(labels != NULL);
+
+	uint64_t counted = 0;
+	uint64_t budgets = 0;
+	uint64_t met = 0;
+	uint64_t errors = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+		const lasm_ast_attr_s* const budget = &label->attrs[lasm_ast_attr_type_cycles];
+		const lasm_ast_perm_type_e perm = label->attrs[lasm_ast_attr_type_perm].as.perm.value;
+		const bool_t executable = (lasm_ast_perm_type_rx == perm) || (lasm_ast_perm_type_rwx == perm);
+
+		// note: the folded and the string labels hold only data, and the aliases
+		// share the bodies of other labels.
+		if ((label->alias != lasm_ast_label_none) || label->strings || (budget->inferred && (!config->cycles || !executable)))
+		{
+			continue;
+		}
+
+		const _cycles_label_s cycles = _count_label(config->arch, label, false);
+
+		if (cycles.failed < label->body.count)
+		{
+			if (!budget->inferred)
+			{
+				_log_cycles_error_noexit(label->location,
+					"bytes at offset 0x%lX of label '%s' do not decode into an instruction, so its budget of %lu cycles cannot be verified.",
+					cycles.failed, label->name, budget->as.cycles.value
+				);
+				++errors;
+			}
+			else
+			{
+				_log_cycles_warn(label->location,
+					"bytes at offset 0x%lX of label '%s' do not decode into an instruction, so its cycles are not counted.",
+					cycles.failed, label->name
+				);
+			}
+
+			continue;
+		}
+
+		++counted;
+
+		if (config->cycles)
+		{
+			lasm_logger_info("cycles: " lasm_location_fmt ": label '%s' takes from %lu to %lu cycles on its straight line path through %lu of its %lu basic blocks.",
+				lasm_location_arg(label->location), label->name, cycles.best, cycles.worst, cycles.straight, cycles.blocks);
+			(void)_count_label(config->arch, label, true);
+		}
+
+		if (budget->inferred)
+		{
+			continue;
+		}
+
+		++budgets;
+
+		if (cycles.worst > budget->as.cycles.value)
+		{
+			_log_cycles_error_noexit(label->location,
+				"label '%s' takes up to %lu cycles on its straight line path, which exceeds its budget of %lu cycles set with the 'cycles' attribute.",
+				label->name, cycles.worst, budget->as.cycles.value
+			);
+			++errors;
+			continue;
+		}
+
+		++met;
+	}
+
+	if (config->cycles)
+	{
+		lasm_logger_info("cycles: %lu labels are counted, and %lu of %lu cycle budgets are met.", counted, met, budgets);
+	}
+
+	if (errors > 0)
+	{
+		lasm_common_exit(1);
+	}
+}
+
+static bool_t _inst_cycles(const lasm_arch_type_e arch, const uint8_t* const inst, const uint64_t length, lasm_cycles_inst_s* const cost)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(cost != NULL);
+
+	switch (arch)
+	{
+		case lasm_arch_type_z80:  { return z80_isa_cycles(inst, length, cost);  } break;
+		case lasm_arch_type_rl78: { return rl78_isa_cycles(inst, length, cost); } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return false;
+		} break;
+	}
+}
+
+static _cycles_label_s _count_label(const lasm_arch_type_e arch, const lasm_ast_label_s* const label, const bool_t report)
+{
+	lasm_debug_assert(label != NULL);
+
+	_cycles_label_s cycles = { .best = UINT64_MAX, .worst = 0, .blocks = 0, .straight = 0, .failed = label->body.count, };
+	uint64_t path_best = 0, path_worst = 0;
+	bool_t straight = true;
+	bool_t skipped = false;
+
+	uint64_t block_offset = 0, block_insts = 0, block_best = 0, block_worst = 0;
+	bool_t block_straight = true;
+	lasm_cycles_end_e end = lasm_cycles_end_none;
+
+	for (uint64_t offset = 0; offset < label->body.count; )
+	{
+		lasm_cycles_inst_s cost = {0};
+
+		if (0 == block_insts)
+		{
+			block_straight = straight;
+		}
+
+		if (!_inst_cycles(arch, label->body.data + offset, label->body.count - offset, &cost))
+		{
+			cycles.failed = offset;
+			return cycles;
+		}
+
+		const uint64_t low = ((cost.taken < cost.not_taken) ? cost.taken : cost.not_taken);
+		const uint64_t high = ((cost.taken > cost.not_taken) ? cost.taken : cost.not_taken);
+		end = cost.end;
+
+		++block_insts;
+		block_best += low;
+		block_worst += high;
+
+		// note: the taken branches and the jumps leave the straight line path,
+		// and the instruction after a skip may not be executed at all.
+		if (straight)
+		{
+			if ((lasm_cycles_end_branch == end) || (lasm_cycles_end_exit == end))
+			{
+				cycles.best = (((path_best + cost.taken) < cycles.best) ? (path_best + cost.taken) : cycles.best);
+				cycles.worst = (((path_worst + cost.taken) > cycles.worst) ? (path_worst + cost.taken) : cycles.worst);
+			}
+
+			const bool_t branch = (lasm_cycles_end_branch == end);
+			path_best += (skipped ? 0 : (branch ? cost.not_taken : low));
+			path_worst += (branch ? cost.not_taken : high);
+			straight = (end != lasm_cycles_end_exit);
+		}
+
+		skipped = (lasm_cycles_end_skip == end);
+		offset += cost.length;
+
+		if ((end != lasm_cycles_end_none) || (offset >= label->body.count))
+		{
+			if (report)
+			{
+				lasm_logger_info("cycles:     block at offset 0x%lX of %lu instruction%s takes from %lu to %lu cycles, and %s%s.",
+					block_offset, block_insts, ((1 == block_insts) ? "" : "s"), block_best, block_worst, _g_cycles_end_descriptions[end],
+					(block_straight ? "" : ", off the straight line path"));
+			}
+
+			cycles.straight += (block_straight ? 1 : 0);
+			++cycles.blocks;
+			block_offset = offset;
+			block_insts = 0;
+			block_best = 0;
+			block_worst = 0;
+		}
+	}
+
+	// note: the path, that falls through to the next label, ends with the body.
+	if (straight)
+	{
+		cycles.best = ((path_best < cycles.best) ? path_best : cycles.best);
+		cycles.worst = ((path_worst > cycles.worst) ? path_worst : cycles.worst);
+	}
+
+	return cycles;
+}
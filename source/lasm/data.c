@@ -0,0 +1,575 @@
+
+/**
+ * @file data.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-02
+ */
+
+#include "lasm/data.h"
+#include "lasm/expr.h"
+#include "lasm/fixup.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <sys/stat.h>
+
+#include <stdio.h>
+#include <errno.h>
+
+#define _log_data_error(_location, _format, ...)                               \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+typedef struct
+{
+	const char_t* name;
+	lasm_ast_data_type_e type;
+	uint8_t width;      // note: width of each of the values in bytes.
+	uint8_t arguments;  // note: maximum count of the arguments, or 0 for any count of values.
+} _data_directive_s;
+
+static const _data_directive_s _g_data_directives[] =
+{
+	{ .name = "bytes",  .type = lasm_ast_data_type_bytes,  .width = 1, .arguments = 0, },
+	{ .name = "words",  .type = lasm_ast_data_type_words,  .width = 2, .arguments = 0, },
+	{ .name = "dwords", .type = lasm_ast_data_type_dwords, .width = 4, .arguments = 0, },
+	{ .name = "fill",   .type = lasm_ast_data_type_fill,   .width = 1, .arguments = 2, },
+	{ .name = "space",  .type = lasm_ast_data_type_fill,   .width = 1, .arguments = 1, },
+	{ .name = "incbin", .type = lasm_ast_data_type_incbin, .width = 1, .arguments = 3, },
+};
+
+#define _data_directives_count (sizeof(_g_data_directives) / sizeof(_g_data_directives[0]))
+
+typedef struct stat stats_s;
+
+static const _data_directive_s* _find_directive(const lasm_token_s* const token);
+
+static bool_t _fits(const uint64_t value, const uint8_t width);
+
+static void _parse_value(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index, lasm_ast_data_s* const data);
+
+static uint64_t _parse_constant(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index, const char_t* const what, const char_t* const directive);
+
+static const char_t* _resolve_path(lasm_arena_s* const arena, const char_t* const file, const lasm_token_s* const token);
+
+static uint64_t _stat_file(const lasm_location_s location, const char_t* const path);
+
+static uint64_t _hash_file(const uint64_t hash, const char_t* const path);
+
+bool_t lasm_data_parse(lasm_lexer_s* const lexer, lasm_ast_label_s* const label, uint64_t* const index)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(index != NULL);
+
+	const lasm_tokens_vector_s* const tokens = &label->body_tokens;
+	const lasm_token_s* const token = &tokens->data[*index];
+	const _data_directive_s* const directive = _find_directive(token);
+
+	if (NULL == directive)
+	{
+		return false;
+	}
+
+	++*index;
+
+	if ((*index >= tokens->count) || (tokens->data[*index].location.line != token->location.line))
+	{
+		_log_data_error(token->location,
+			"expected a value after the '%s' directive on the same line. data directives must have at least one value.",
+			directive->name
+		);
+	}
+
+	lasm_ast_data_s data = (lasm_ast_data_s)
+	{
+		.location = token->location,
+		.type     = directive->type,
+		.width    = directive->width,
+		.bytes    = lasm_bytes_vector_new(lexer->arena, 1),
+		.values   = lasm_data_values_vector_new(lexer->arena, 1),
+		.length   = 0,
+		.fill     = 0,
+		.path     = NULL,
+		.offset   = 0,
+	};
+
+	uint64_t size = 0;
+
+	switch (directive->type)
+	{
+		case lasm_ast_data_type_bytes:
+		case lasm_ast_data_type_words:
+		case lasm_ast_data_type_dwords:
+		{
+			_parse_value(lexer, tokens, index, &data);
+
+			while ((*index < tokens->count) && (lasm_token_type_symbolic_comma == tokens->data[*index].type))
+			{
+				if (++*index >= tokens->count)
+				{
+					_log_data_error(tokens->data[*index - 1].location,
+						"expected a value after ',', but found the end of the label's body."
+					);
+				}
+
+				_parse_value(lexer, tokens, index, &data);
+			}
+
+			size = data.bytes.count;
+		} break;
+
+		case lasm_ast_data_type_fill:
+		{
+			data.length = _parse_constant(lexer, tokens, index, "count", directive->name);
+
+			if ((directive->arguments > 1) && (*index < tokens->count) && (lasm_token_type_symbolic_comma == tokens->data[*index].type))
+			{
+				++*index;
+				const uint64_t fill = _parse_constant(lexer, tokens, index, "value", directive->name);
+
+				if (!_fits(fill, 1))
+				{
+					_log_data_error(token->location,
+						"value 0x%lX of the '%s' directive does not fit into a byte.",
+						fill, directive->name
+					);
+				}
+
+				data.fill = (uint8_t)fill;
+			}
+
+			size = data.length;
+		} break;
+
+		case lasm_ast_data_type_incbin:
+		{
+			const lasm_token_s* const path = &tokens->data[*index];
+
+			if (path->type != lasm_token_type_literal_str)
+			{
+				_log_data_error(path->location,
+					"expected a string literal with the path of the included file after the 'incbin' directive, but found '%s' token.",
+					lasm_token_type_to_string(path->type)
+				);
+			}
+
+			++*index;
+			data.path = _resolve_path(lexer->arena, token->location.file, path);
+			const uint64_t file_size = _stat_file(path->location, data.path);
+
+			if ((*index < tokens->count) && (lasm_token_type_symbolic_comma == tokens->data[*index].type))
+			{
+				++*index;
+				data.offset = _parse_constant(lexer, tokens, index, "offset", directive->name);
+			}
+
+			data.length = ((data.offset < file_size) ? (file_size - data.offset) : 0);
+
+			if ((*index < tokens->count) && (lasm_token_type_symbolic_comma == tokens->data[*index].type))
+			{
+				++*index;
+				data.length = _parse_constant(lexer, tokens, index, "length", directive->name);
+			}
+
+			// note: the bounds are checked against the size of the file at the time
+			// of the parsing, and the file is read only while the label is encoded.
+			if ((data.offset > file_size) || (data.length > (file_size - data.offset)))
+			{
+				_log_data_error(token->location,
+					"included bytes at offset %lu with length %lu are out of the bounds of file %s, which has %lu bytes.",
+					data.offset, data.length, data.path, file_size
+				);
+			}
+
+			size = data.length;
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+		} break;
+	}
+
+	if ((*index < tokens->count) && (lasm_token_type_symbolic_comma == tokens->data[*index].type))
+	{
+		_log_data_error(tokens->data[*index].location,
+			"too many arguments for the '%s' directive. it takes at most %u arguments.",
+			directive->name, (uint32_t)directive->arguments
+		);
+	}
+
+	if (size > UINT32_MAX)
+	{
+		_log_data_error(token->location,
+			"the '%s' directive has %lu bytes, which exceeds the limit of %u bytes of a single directive.",
+			directive->name, size, UINT32_MAX
+		);
+	}
+
+	lasm_data_vector_push(&label->data, data);
+
+	lasm_ir_inst_s inst = lasm_ir_inst_new(lasm_ir_opcode_data, token->location);
+	inst.operands[0].value = label->data.count - 1;
+	inst.size = (uint32_t)size;
+	lasm_ir_insts_vector_push(&label->ir, inst);
+	return true;
+}
+
+void lasm_data_encode(lasm_ast_label_s* const label, lasm_ir_inst_s* const inst)
+{
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(lasm_ir_opcode_data == inst->opcode);
+
+	const lasm_ast_data_s* const data = lasm_data_vector_at(&label->data, inst->operands[0].value);
+	const uint64_t offset = label->body.count;
+
+	switch (data->type)
+	{
+		case lasm_ast_data_type_bytes:
+		case lasm_ast_data_type_words:
+		case lasm_ast_data_type_dwords:
+		{
+			if (data->bytes.count > 0)
+			{
+				lasm_common_memcpy(lasm_bytes_vector_extend(&label->body, data->bytes.count), data->bytes.data, data->bytes.count);
+			}
+
+			for (uint64_t index = 0; index < data->values.count; ++index)
+			{
+				const lasm_ast_data_value_s* const value = &data->values.data[index];
+				lasm_fixups_collect_value(label, value->expr, data->width, offset + value->offset);
+			}
+		} break;
+
+		case lasm_ast_data_type_fill:
+		{
+			lasm_common_memset(lasm_bytes_vector_extend(&label->body, data->length), data->fill, data->length);
+		} break;
+
+		case lasm_ast_data_type_incbin:
+		{
+			// note: the included bytes at the end of the body are only referenced,
+			// and the output writer streams them from their file, so the large
+			// assets are never loaded into the memory of the assembler.
+			if (inst == &label->ir.data[label->ir.count - 1])
+			{
+				label->blob = (lasm_ast_blob_s)
+				{
+					.location = data->location,
+					.path     = data->path,
+					.offset   = data->offset,
+					.length   = data->length,
+				};
+
+				inst->size = (uint32_t)data->length;
+				return;
+			}
+
+			uint8_t* const bytes = lasm_bytes_vector_extend(&label->body, data->length);
+			FILE* const file = fopen(data->path, "rb");
+
+			// note: the included bytes in the middle of the body are read straight
+			// into the body, so they are never staged in an intermediate buffer.
+			if ((NULL == file) || (fseek(file, (long)data->offset, SEEK_SET) != 0) ||
+				(fread(bytes, sizeof(uint8_t), (size_t)data->length, file) != (size_t)data->length))
+			{
+				_log_data_error(data->location,
+					"unable to read %lu bytes at offset %lu of file %s. the file may have changed since it was parsed.",
+					data->length, data->offset, data->path
+				);
+			}
+
+			(void)fclose(file);
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+		} break;
+	}
+
+	inst->size = (uint32_t)(label->body.count - offset);
+}
+
+uint64_t lasm_data_fingerprint(lasm_arena_s* const arena, const lasm_ast_label_s* const label, const uint64_t fingerprint)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(label != NULL);
+
+	const lasm_tokens_vector_s* const tokens = &label->body_tokens;
+	uint64_t hash = fingerprint;
+
+	for (uint64_t index = 0; (index + 1) < tokens->count; ++index)
+	{
+		const lasm_token_s* const token = &tokens->data[index];
+		const lasm_token_s* const path = &tokens->data[index + 1];
+
+		if ((lasm_token_type_ident != token->type) || (lasm_common_strcmp(token->as.ident.data, "incbin") != 0) ||
+			(lasm_token_type_literal_str != path->type))
+		{
+			continue;
+		}
+
+		// note: a file, that cannot be stated, is left out, so the label is never
+		// found in the cache, and the error is reported by the parsing.
+		const char_t* const resolved = _resolve_path(arena, token->location.file, path);
+		stats_s stats = {0};
+
+		if (stat(resolved, &stats) != 0)
+		{
+			continue;
+		}
+
+		const uint64_t keys[] =
+		{
+			(uint64_t)stats.st_size,
+			(uint64_t)stats.st_ino,
+			(uint64_t)stats.st_mtim.tv_sec,
+			(uint64_t)stats.st_mtim.tv_nsec,
+		};
+
+		hash = lasm_common_hash(hash, keys, sizeof(keys));
+
+		// note: the bytes of an 'incbin' in the middle of the body are cached
+		// along with the body, so they are hashed as well, as a file may be
+		// rewritten with the same size and the same modification time. the
+		// 'incbin' at the end of the body (on the last line of its tokens) is
+		// always read from the file, so its size is enough.
+		if (tokens->data[tokens->count - 1].location.line != token->location.line)
+		{
+			hash = _hash_file(hash, resolved);
+		}
+	}
+
+	return hash;
+}
+
+static const _data_directive_s* _find_directive(const lasm_token_s* const token)
+{
+	lasm_debug_assert(token != NULL);
+
+	if (token->type != lasm_token_type_ident)
+	{
+		return NULL;
+	}
+
+	for (uint64_t index = 0; index < _data_directives_count; ++index)
+	{
+		if (lasm_common_strcmp(token->as.ident.data, _g_data_directives[index].name) == 0)
+		{
+			return &_g_data_directives[index];
+		}
+	}
+
+	return NULL;
+}
+
+static bool_t _fits(const uint64_t value, const uint8_t width)
+{
+	lasm_debug_assert((width > 0) && (width <= 8));
+
+	if (8 == width)
+	{
+		return true;
+	}
+
+	// note: the values fit either as unsigned or as sign extended values, so
+	// both 0xFF and -1 fit into a byte.
+	const uint64_t high = value >> ((width * 8) - 1);
+	return (high <= 1) || ((UINT64_MAX >> ((width * 8) - 1)) == high);
+}
+
+static void _parse_value(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index, lasm_ast_data_s* const data)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+	lasm_debug_assert(data != NULL);
+	lasm_debug_assert(*index < tokens->count);
+
+	const lasm_token_s* const token = &tokens->data[*index];
+
+	// note: the string literals are the bytes of their characters, and they are
+	// allowed only in the byte values.
+	if (lasm_token_type_literal_str == token->type)
+	{
+		if (data->type != lasm_ast_data_type_bytes)
+		{
+			_log_data_error(token->location,
+				"string literals are allowed only in the values of the 'bytes' directive."
+			);
+		}
+
+		if (token->as.str.length > 0)
+		{
+			lasm_bytes_vector_append(&data->bytes, (const uint8_t*)token->as.str.data, token->as.str.length);
+		}
+
+		++*index;
+		return;
+	}
+
+	lasm_ast_expr_s* const expr = lasm_expr_parse(lexer->arena, tokens, index);
+	const uint64_t offset = data->bytes.count;
+	uint8_t* const field = lasm_bytes_vector_extend(&data->bytes, data->width);
+	lasm_common_memset(field, 0, data->width);
+
+	if (!expr->folded)
+	{
+		const lasm_ast_data_value_s value = (const lasm_ast_data_value_s)
+		{
+			.offset = offset,
+			.expr   = expr,
+		};
+
+		lasm_data_values_vector_push(&data->values, value);
+		return;
+	}
+
+	if (!_fits(expr->value, data->width))
+	{
+		_log_data_error(expr->location,
+			"value 0x%lX does not fit into a field of %u bytes of the data directive.",
+			expr->value, (uint32_t)data->width
+		);
+	}
+
+	for (uint8_t byte = 0; byte < data->width; ++byte)
+	{
+		field[byte] = (uint8_t)(expr->value >> (byte * 8));
+	}
+}
+
+static uint64_t _parse_constant(lasm_lexer_s* const lexer, const lasm_tokens_vector_s* const tokens, uint64_t* const index, const char_t* const what, const char_t* const directive)
+{
+	lasm_debug_assert(lexer != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+	lasm_debug_assert(what != NULL);
+	lasm_debug_assert(directive != NULL);
+
+	if (*index >= tokens->count)
+	{
+		_log_data_error(tokens->data[*index - 1].location,
+			"expected the %s of the '%s' directive, but found the end of the label's body.",
+			what, directive
+		);
+	}
+
+	const lasm_ast_expr_s* const expr = lasm_expr_parse(lexer->arena, tokens, index);
+
+	if (!expr->folded)
+	{
+		_log_data_error(expr->location,
+			"the %s of the '%s' directive must be a constant expression, that does not reference any labels.",
+			what, directive
+		);
+	}
+
+	return expr->value;
+}
+
+static const char_t* _resolve_path(lasm_arena_s* const arena, const char_t* const file, const lasm_token_s* const token)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(token != NULL);
+
+	uint64_t directory = 0;
+
+	// note: a relative path is relative to the directory of the source file, that
+	// includes it, and not to the working directory of the assembler.
+	if ((0 == token->as.str.length) || (token->as.str.data[0] != '/'))
+	{
+		for (uint64_t index = 0; file[index] != '\0'; ++index)
+		{
+			directory = (('/' == file[index]) ? index + 1 : directory);
+		}
+	}
+
+	char_t* const path = (char_t* const)lasm_arena_alloc(arena, directory + token->as.str.length + 1);
+	lasm_debug_assert(path != NULL);
+
+	if (directory > 0)
+	{
+		lasm_common_memcpy(path, file, directory);
+	}
+
+	if (token->as.str.length > 0)
+	{
+		lasm_common_memcpy(path + directory, token->as.str.data, token->as.str.length);
+	}
+	path[directory + token->as.str.length] = 0;
+	return path;
+}
+
+static uint64_t _stat_file(const lasm_location_s location, const char_t* const path)
+{
+	lasm_debug_assert(path != NULL);
+
+	stats_s stats = {0};
+
+	if (stat(path, &stats) != 0)
+	{
+		switch (errno)
+		{
+			case ENOENT:
+			{
+				_log_data_error(location, "unable to include file %s: file not found.", path);
+			} break;
+
+			case EACCES:
+			{
+				_log_data_error(location, "unable to include file %s: permission denied.", path);
+			} break;
+
+			default:
+			{
+				_log_data_error(location, "unable to include file %s: failed to stat.", path);
+			} break;
+		}
+	}
+
+	if (S_ISDIR(stats.st_mode))
+	{
+		_log_data_error(location, "unable to include file %s: it is a directory.", path);
+	}
+
+	return (uint64_t)stats.st_size;
+}
+
+static uint64_t _hash_file(const uint64_t hash, const char_t* const path)
+{
+	lasm_debug_assert(path != NULL);
+
+	FILE* const file = fopen(path, "rb");
+
+	if (NULL == file)
+	{
+		return hash;
+	}
+
+	uint8_t buffer[4096] = {0};
+	uint64_t result = hash;
+	size_t read = 0;
+
+	while ((read = fread(buffer, sizeof(uint8_t), sizeof(buffer), file)) > 0)
+	{
+		result = lasm_common_hash(result, buffer, (uint64_t)read);
+	}
+
+	(void)fclose(file);
+	return result;
+}
@@ -0,0 +1,459 @@
+
+/**
+ * @file disasm.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-03
+ */
+
+#include "lasm/disasm.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+#include "lasm/archs/z80_disasm.h"
+#include "lasm/archs/rl78_disasm.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define _log_disasm_error_noexit(_location, _format, ...)                      \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+	} while (0)
+
+// note: count of the values of a single 'bytes' directive, the capacity of the
+// text of a single instruction, and the length of the longest instruction.
+#define _disasm_bytes_per_line 16
+#define _disasm_text_capacity 64
+#define _disasm_inst_capacity 8
+
+static const char_t _g_disasm_hex_digits[] = "0123456789ABCDEF";
+
+typedef struct
+{
+	lasm_arch_type_e arch;
+	FILE* file;
+	lasm_disasm_stats_s stats;
+} _disasm_s;
+
+static bool_t _is_written(const lasm_ast_label_s* const label);
+
+static bool_t _is_identifier(const char_t* const name);
+
+static bool_t _follows_ir(const lasm_ast_label_s* const label);
+
+static void _write_label(_disasm_s* const disasm, const lasm_ast_label_s* const label, const uint64_t index, const lasm_regions_vector_s* const regions);
+
+static void _write_code(_disasm_s* const disasm, const uint8_t* const bytes, const uint64_t length, const uint64_t addr);
+
+static void _write_bytes(_disasm_s* const disasm, const uint8_t* const bytes, const uint64_t length);
+
+static void _write_blob(_disasm_s* const disasm, const lasm_ast_blob_s* const blob);
+
+static uint8_t _disasm_inst(const lasm_arch_type_e arch, const uint8_t* const inst, const uint64_t length, const uint64_t addr, char_t* const buffer);
+
+static lasm_location_s _locate(const lasm_ast_label_s* const label, const uint64_t offset);
+
+lasm_labels_vector_s lasm_disasm_read_image(lasm_arena_s* const arena, const lasm_config_disasm_s* const config)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+
+	FILE* const file = fopen(config->source, "rb");
+
+	if (NULL == file)
+	{
+		lasm_logger_error("unable to open image %s for reading.", config->source);
+		lasm_common_exit(1);
+	}
+
+	const int64_t size = ((0 == fseek(file, 0, SEEK_END)) ? (int64_t)ftell(file) : -1);
+
+	if ((size <= 0) || (fseek(file, 0, SEEK_SET) != 0))
+	{
+		lasm_logger_error("unable to read image %s: it is empty, or it is not a regular file.", config->source);
+		lasm_common_exit(1);
+	}
+
+	const lasm_location_s location = (const lasm_location_s) { .file = config->source, .line = 1, .column = 1, };
+	lasm_ast_label_s label = (lasm_ast_label_s)
+	{
+		.location = location,
+		.name     = "image",
+		.body     = lasm_bytes_vector_new(arena, 1),
+		.alias    = lasm_ast_label_none,
+	};
+
+	const uint64_t length = (uint64_t)size;
+	uint8_t* const bytes = lasm_bytes_vector_extend(&label.body, length);
+
+	if (fread(bytes, sizeof(uint8_t), (size_t)length, file) != (size_t)length)
+	{
+		lasm_logger_error("unable to read %lu bytes of image %s.", length, config->source);
+		lasm_common_exit(1);
+	}
+
+	(void)fclose(file);
+
+	label.attrs[lasm_ast_attr_type_addr]   = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_addr,   .as.addr.value   = config->base, };
+	label.attrs[lasm_ast_attr_type_align]  = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_align,  .as.align.value  = 1, };
+	label.attrs[lasm_ast_attr_type_size]   = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_size,   .as.size.value   = length, };
+	label.attrs[lasm_ast_attr_type_perm]   = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_perm,   .as.perm.value   = lasm_ast_perm_type_rx, };
+	label.attrs[lasm_ast_attr_type_region] = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_region, .as.region.value = lasm_ast_region_none, .as.region.bank = lasm_ast_bank_none, };
+
+	lasm_labels_vector_s labels = lasm_labels_vector_new(arena, 2);
+	lasm_labels_vector_push(&labels, label);
+	return labels;
+}
+
+lasm_disasm_stats_s lasm_disasm_write(lasm_arena_s* const arena, const lasm_config_disasm_s* const config, const lasm_labels_vector_s* const labels, const lasm_regions_vector_s* const regions)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(regions != NULL);
+
+	_disasm_s disasm = (_disasm_s)
+	{
+		.arch  = config->arch,
+		.file  = fopen(config->output, "w"),
+		.stats = (lasm_disasm_stats_s) {0},
+	};
+
+	if (NULL == disasm.file)
+	{
+		lasm_logger_error("unable to open output file %s for writing.", config->output);
+		lasm_common_exit(1);
+	}
+
+	(void)fprintf(disasm.file, "; disassembly of %s.\n", config->source);
+
+	for (uint64_t index = 0; index < regions->count; ++index)
+	{
+		const lasm_ast_region_s* const region = &regions->data[index];
+		(void)fprintf(disasm.file, "%sregion %s [origin=0x%lX, length=0x%lX, perm=%s,", ((0 == index) ? "\n" : ""),
+			region->name, region->origin, region->length, lasm_ast_perm_type_to_string(region->perm));
+
+		if (region->bank != lasm_ast_bank_none)
+		{
+			(void)fprintf(disasm.file, " bank=%lu, port=0x%lX,", region->bank, region->port);
+		}
+
+		(void)fprintf(disasm.file, "]\n");
+	}
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+
+		if (_is_written(label))
+		{
+			_write_label(&disasm, label, index, regions);
+		}
+	}
+
+	if (ferror(disasm.file) != 0)
+	{
+		lasm_logger_error("failed to write output file %s.", config->output);
+		lasm_common_exit(1);
+	}
+
+	(void)fclose(disasm.file);
+	return disasm.stats;
+}
+
+uint64_t lasm_disasm_compare(const lasm_labels_vector_s* const labels, const lasm_labels_vector_s* const reassembled)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(reassembled != NULL);
+
+	uint64_t mismatches = 0;
+	uint64_t other = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+
+		if (!_is_written(label))
+		{
+			continue;
+		}
+
+		// note: the written labels are reassembled in the same order, and no other
+		// labels are written, so they are matched by their order.
+		if (other >= reassembled->count)
+		{
+			_log_disasm_error_noexit(label->location, "label '%s' is missing from the reassembled labels.", label->name);
+			++mismatches;
+			continue;
+		}
+
+		const lasm_ast_label_s* const copy = &reassembled->data[other++];
+		const uint64_t length = ((label->body.count < copy->body.count) ? label->body.count : copy->body.count);
+		uint64_t offset = 0;
+
+		while ((offset < length) && (label->body.data[offset] == copy->body.data[offset]))
+		{
+			++offset;
+		}
+
+		const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+
+		if (offset < length)
+		{
+			_log_disasm_error_noexit(_locate(copy, offset), "label '%s' differs at 0x%lX after the round trip: its byte 0x%02X is reassembled as 0x%02X.",
+				label->name, addr + offset, label->body.data[offset], copy->body.data[offset]);
+			++mismatches;
+		}
+		else if ((label->body.count != copy->body.count) || (lasm_ast_label_length(label) != lasm_ast_label_length(copy)) ||
+			(addr != copy->attrs[lasm_ast_attr_type_addr].as.addr.value))
+		{
+			_log_disasm_error_noexit(_locate(copy, offset), "label '%s' at 0x%lX is %lu bytes long, but it is reassembled into %lu bytes at 0x%lX.",
+				label->name, addr, lasm_ast_label_length(label), lasm_ast_label_length(copy), copy->attrs[lasm_ast_attr_type_addr].as.addr.value);
+			++mismatches;
+		}
+	}
+
+	return mismatches;
+}
+
+static bool_t _is_written(const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+	return (lasm_ast_label_none == label->alias) && (lasm_ast_label_length(label) > 0);
+}
+
+static bool_t _is_identifier(const char_t* const name)
+{
+	lasm_debug_assert(name != NULL);
+
+	if (!isalpha((uint8_t)name[0]) && (name[0] != '_'))
+	{
+		return false;
+	}
+
+	for (const char_t* c = name + 1; *c != 0; ++c)
+	{
+		if (!isalnum((uint8_t)*c) && (*c != '_') && (*c != '-'))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool_t _follows_ir(const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	uint64_t length = 0;
+
+	for (uint64_t index = 0; index < label->ir.count; ++index)
+	{
+		length += label->ir.data[index].size;
+	}
+
+	return (label->ir.count > 0) && (length == lasm_ast_label_length(label));
+}
+
+static void _write_label(_disasm_s* const disasm, const lasm_ast_label_s* const label, const uint64_t index, const lasm_regions_vector_s* const regions)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(regions != NULL);
+
+	const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+	const uint64_t region = label->attrs[lasm_ast_attr_type_region].as.region.value;
+	const lasm_ast_perm_type_e perm = label->attrs[lasm_ast_attr_type_perm].as.perm.value;
+
+	(void)fprintf(disasm->file, "\n[addr=0x%lX, align=1, size=%lu, perm=%s,", addr,
+		label->attrs[lasm_ast_attr_type_size].as.size.value, lasm_ast_perm_type_to_string(perm));
+
+	if (region != lasm_ast_region_none)
+	{
+		(void)fprintf(disasm->file, " region=%s,", regions->data[region].name);
+	}
+
+	// note: the generated names, such as the ones of the bank trampolines, are not
+	// valid identifiers, so they are replaced with the index of the label.
+	if (_is_identifier(label->name))
+	{
+		(void)fprintf(disasm->file, "]\n%s:\n", label->name);
+	}
+	else
+	{
+		(void)fprintf(disasm->file, "]\ndisasm_%lu:  ; %s\n", index, label->name);
+	}
+
+	const bool_t code = ((lasm_ast_perm_type_rx == perm) || (lasm_ast_perm_type_rwx == perm));
+
+	if (!_follows_ir(label))
+	{
+		if (code)
+		{
+			_write_code(disasm, label->body.data, label->body.count, addr);
+		}
+		else
+		{
+			_write_bytes(disasm, label->body.data, label->body.count);
+		}
+
+		if (label->blob.path != NULL)
+		{
+			_write_blob(disasm, &label->blob);
+		}
+	}
+	else
+	{
+		uint64_t offset = 0;
+
+		for (uint64_t inst = 0; inst < label->ir.count; ++inst)
+		{
+			const lasm_ir_inst_s* const ir = &label->ir.data[inst];
+
+			if ((lasm_ir_opcode_data == ir->opcode) && ((inst + 1) == label->ir.count) && (label->blob.path != NULL))
+			{
+				_write_blob(disasm, &label->blob);
+			}
+			else if ((lasm_ir_opcode_data == ir->opcode) || !code)
+			{
+				_write_bytes(disasm, label->body.data + offset, ir->size);
+			}
+			else
+			{
+				_write_code(disasm, label->body.data + offset, ir->size, addr + offset);
+			}
+
+			offset += ir->size;
+		}
+	}
+
+	(void)fprintf(disasm->file, "end\n");
+	++disasm->stats.labels;
+}
+
+static void _write_code(_disasm_s* const disasm, const uint8_t* const bytes, const uint64_t length, const uint64_t addr)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(bytes != NULL);
+
+	char_t text[_disasm_text_capacity];
+	uint64_t undecoded = 0;
+	uint64_t offset = 0;
+
+	while (offset < length)
+	{
+		const uint8_t inst_length = _disasm_inst(disasm->arch, bytes + offset, length - offset, addr + offset, text);
+
+		// note: the bytes, that do not decode, are collected until the next
+		// instruction, so they are written with as few directives as possible.
+		if (0 == inst_length)
+		{
+			++undecoded;
+			++offset;
+			continue;
+		}
+
+		if (undecoded > 0)
+		{
+			_write_bytes(disasm, bytes + offset - undecoded, undecoded);
+			undecoded = 0;
+		}
+
+		// note: the encoded bytes are formatted by hand, as a single formatted
+		// write for each of them is the most of the time spent on large images.
+		char_t encoded[(_disasm_inst_capacity * 3) + 1];
+		lasm_debug_assert(inst_length <= _disasm_inst_capacity);
+
+		for (uint8_t byte = 0; byte < inst_length; ++byte)
+		{
+			encoded[(byte * 3) + 0] = ' ';
+			encoded[(byte * 3) + 1] = _g_disasm_hex_digits[bytes[offset + byte] >> 4];
+			encoded[(byte * 3) + 2] = _g_disasm_hex_digits[bytes[offset + byte] & 0x0F];
+		}
+
+		encoded[inst_length * 3] = 0;
+		(void)fprintf(disasm->file, "\t%-32s ; 0x%04lX:%s\n", text, addr + offset, encoded);
+		++disasm->stats.insts;
+		offset += inst_length;
+	}
+
+	if (undecoded > 0)
+	{
+		_write_bytes(disasm, bytes + offset - undecoded, undecoded);
+	}
+}
+
+static void _write_bytes(_disasm_s* const disasm, const uint8_t* const bytes, const uint64_t length)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(bytes != NULL);
+
+	for (uint64_t index = 0; index < length; ++index)
+	{
+		const bool_t first = (0 == (index % _disasm_bytes_per_line));
+		const bool_t last = ((index + 1) == length) || (0 == ((index + 1) % _disasm_bytes_per_line));
+		(void)fprintf(disasm->file, "%s0x%02X%s", (first ? "\tbytes " : ""), bytes[index], (last ? "\n" : ", "));
+	}
+
+	disasm->stats.bytes += length;
+}
+
+static void _write_blob(_disasm_s* const disasm, const lasm_ast_blob_s* const blob)
+{
+	lasm_debug_assert(disasm != NULL);
+	lasm_debug_assert(blob != NULL);
+	lasm_debug_assert(blob->path != NULL);
+
+	// note: the path of the included file is relative to the directory of its
+	// source file, so it is written as an absolute path.
+	char_t* const path = realpath(blob->path, NULL);
+	(void)fprintf(disasm->file, "\tincbin \"%s\", %lu, %lu\n", ((NULL == path) ? blob->path : path), blob->offset, blob->length);
+	free(path);
+	disasm->stats.bytes += blob->length;
+}
+
+static uint8_t _disasm_inst(const lasm_arch_type_e arch, const uint8_t* const inst, const uint64_t length, const uint64_t addr, char_t* const buffer)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(buffer != NULL);
+
+	switch (arch)
+	{
+		case lasm_arch_type_z80:  { return z80_disasm_inst(inst, length, addr, buffer, _disasm_text_capacity);  } break;
+		case lasm_arch_type_rl78: { return rl78_disasm_inst(inst, length, addr, buffer, _disasm_text_capacity); } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static lasm_location_s _locate(const lasm_ast_label_s* const label, const uint64_t offset)
+{
+	lasm_debug_assert(label != NULL);
+
+	uint64_t end = 0;
+
+	for (uint64_t index = 0; index < label->ir.count; ++index)
+	{
+		end += label->ir.data[index].size;
+
+		if (offset < end)
+		{
+			return label->ir.data[index].location;
+		}
+	}
+
+	return label->location;
+}
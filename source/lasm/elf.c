@@ -0,0 +1,331 @@
+
+/**
+ * @file elf.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-27
+ */
+
+#include "lasm/elf.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <sys/sendfile.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define _elf_type_exec   ((uint64_t)2)
+#define _elf_phdr_load   ((uint64_t)1)
+#define _elf_version     ((uint64_t)1)
+#define _elf_flag_x      ((uint64_t)0x1)
+#define _elf_flag_w      ((uint64_t)0x2)
+#define _elf_flag_r      ((uint64_t)0x4)
+#define _elf_zeros_size  ((uint64_t)4096)
+#define _elf_send_limit  ((uint64_t)0x7FFFF000)  // note: the most bytes, that a single sendfile call transfers.
+
+typedef struct
+{
+	uint8_t class;
+	uint64_t ehdr_size;
+	uint64_t phdr_size;
+	uint8_t addr_width;
+} _elf_layout_s;
+
+static const _elf_layout_s _g_elf32 = { .class = 1, .ehdr_size = 52, .phdr_size = 32, .addr_width = 4, };
+static const _elf_layout_s _g_elf64 = { .class = 2, .ehdr_size = 64, .phdr_size = 56, .addr_width = 8, };
+
+static const uint16_t _g_elf_machines[lasm_arch_types_count] =
+{
+	[lasm_arch_type_z80]  = 220,  // note: EM_Z80.
+	[lasm_arch_type_rl78] = 197,  // note: EM_RL78.
+};
+
+_Static_assert(
+	lasm_arch_types_count == 2,
+	"_g_elf_machines is not in sync with lasm_arch_type_e enum!"
+);
+
+static void _write_le(FILE* const file, const uint64_t value, const uint8_t width);
+
+static uint64_t _perm_to_flags(const lasm_ast_perm_type_e perm);
+
+static void _write_zeros(FILE* const file, const uint8_t* const zeros, uint64_t count);
+
+static void _write_blob(FILE* const file, const lasm_ast_blob_s* const blob);
+
+static bool_t _write_mapped(FILE* const file, const int32_t source, const uint64_t offset, const uint64_t length);
+
+void lasm_elf_write(lasm_arena_s* const arena, const lasm_config_build_s* const config, const lasm_labels_vector_s* const labels, const lasm_segments_s* const segments, const uint64_t entry)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(segments != NULL);
+
+	const _elf_layout_s* const layout = (lasm_format_type_elf64 == config->format) ? &_g_elf64 : &_g_elf32;
+	const uint64_t count = segments->segments.count;
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		const lasm_segment_s* const segment = &segments->segments.data[index];
+
+		if ((8 != layout->addr_width) && ((segment->addr + segment->mem_size) > UINT32_MAX))
+		{
+			lasm_logger_error("segment at [0x%lX, 0x%lX) does not fit into the address space of elf32 format. use elf64 format instead.",
+				segment->addr, segment->addr + segment->mem_size);
+			lasm_common_exit(1);
+		}
+	}
+
+	FILE* const file = fopen(config->output, "wb");
+
+	if (NULL == file)
+	{
+		lasm_logger_error("unable to open output file %s for writing.", config->output);
+		lasm_common_exit(1);
+	}
+
+	static const uint8_t magic[] = { 0x7F, 'E', 'L', 'F', };
+	(void)fwrite(magic, sizeof(uint8_t), sizeof(magic), file);
+	_write_le(file, layout->class, 1);
+	_write_le(file, 1, 1);  // note: little endian.
+	_write_le(file, _elf_version, 1);
+	_write_le(file, 0, 1);  // note: system v abi.
+	_write_le(file, 0, 8);  // note: abi version and padding of the identification.
+
+	_write_le(file, _elf_type_exec, 2);
+	_write_le(file, _g_elf_machines[config->arch], 2);
+	_write_le(file, _elf_version, 4);
+	_write_le(file, entry, layout->addr_width);
+	_write_le(file, (count > 0) ? layout->ehdr_size : 0, layout->addr_width);
+	_write_le(file, 0, layout->addr_width);  // note: no section headers.
+	_write_le(file, 0, 4);
+	_write_le(file, layout->ehdr_size, 2);
+	_write_le(file, layout->phdr_size, 2);
+	_write_le(file, count, 2);
+	_write_le(file, 0, 2);
+	_write_le(file, 0, 2);
+	_write_le(file, 0, 2);
+
+	uint64_t offset = layout->ehdr_size + (count * layout->phdr_size);
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		const lasm_segment_s* const segment = &segments->segments.data[index];
+		const uint64_t flags = _perm_to_flags(segment->perm);
+
+		_write_le(file, _elf_phdr_load, 4);
+
+		if (8 == layout->addr_width)
+		{
+			_write_le(file, flags, 4);
+		}
+
+		// note: the physical address of a banked segment carries its bank number
+		// above the 16 bit address of its window.
+		const uint64_t paddr = segment->addr + ((lasm_ast_bank_none == segment->bank) ? 0 : (segment->bank << 16));
+
+		_write_le(file, offset, layout->addr_width);
+		_write_le(file, segment->addr, layout->addr_width);
+		_write_le(file, paddr, layout->addr_width);
+		_write_le(file, segment->file_size, layout->addr_width);
+		_write_le(file, segment->mem_size, layout->addr_width);
+
+		if (4 == layout->addr_width)
+		{
+			_write_le(file, flags, 4);
+		}
+
+		_write_le(file, 1, layout->addr_width);
+		offset += segment->file_size;
+	}
+
+	uint8_t* const zeros = (uint8_t* const)lasm_arena_alloc(arena, _elf_zeros_size);
+	lasm_debug_assert(zeros != NULL);
+	lasm_common_memset(zeros, 0, _elf_zeros_size);
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		const lasm_segment_s* const segment = &segments->segments.data[index];
+		uint64_t cursor = segment->addr;
+
+		if (0 == segment->file_size)
+		{
+			continue;
+		}
+
+		// note: the segments are streamed label by label in the order of their
+		// addresses, so no segment is ever staged in memory as a whole. the padding
+		// and the reserved bytes between the bodies of the labels are zero filled.
+		for (uint64_t label_index = segment->first; label_index < (segment->first + segment->count); ++label_index)
+		{
+			const lasm_ast_label_s* const label = &labels->data[segments->order[label_index]];
+			const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+
+			if (0 == lasm_ast_label_length(label))
+			{
+				continue;
+			}
+
+			lasm_debug_assert(addr >= cursor);
+			_write_zeros(file, zeros, addr - cursor);
+
+			if (label->body.count > 0)
+			{
+				(void)fwrite(label->body.data, sizeof(uint8_t), (size_t)label->body.count, file);
+			}
+
+			if (label->blob.path != NULL)
+			{
+				_write_blob(file, &label->blob);
+			}
+
+			cursor = addr + lasm_ast_label_length(label);
+		}
+
+		lasm_debug_assert((segment->addr + segment->file_size) >= cursor);
+		_write_zeros(file, zeros, (segment->addr + segment->file_size) - cursor);
+	}
+
+	if (fclose(file) != 0)
+	{
+		lasm_logger_error("failed to write output file %s.", config->output);
+		lasm_common_exit(1);
+	}
+}
+
+static void _write_le(FILE* const file, const uint64_t value, const uint8_t width)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(width <= 8);
+
+	uint8_t bytes[8] = {0};
+
+	for (uint8_t index = 0; index < width; ++index)
+	{
+		bytes[index] = (uint8_t)(value >> (index * 8));
+	}
+
+	(void)fwrite(bytes, sizeof(uint8_t), width, file);
+}
+
+static void _write_zeros(FILE* const file, const uint8_t* const zeros, uint64_t count)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(zeros != NULL);
+
+	while (count > 0)
+	{
+		const uint64_t chunk = ((count < _elf_zeros_size) ? count : _elf_zeros_size);
+		(void)fwrite(zeros, sizeof(uint8_t), (size_t)chunk, file);
+		count -= chunk;
+	}
+}
+
+static void _write_blob(FILE* const file, const lasm_ast_blob_s* const blob)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(blob != NULL);
+	lasm_debug_assert(blob->path != NULL);
+
+	if (0 == blob->length)
+	{
+		return;
+	}
+
+	const int32_t source = open(blob->path, O_RDONLY);
+
+	if (source < 0)
+	{
+		lasm_logger_error(lasm_location_fmt ": unable to open included file %s for reading.", lasm_location_arg(blob->location), blob->path);
+		lasm_common_exit(1);
+	}
+
+	// note: the buffered bytes go before the included ones, and the included
+	// bytes are sent from the file to the output within the kernel.
+	if (fflush(file) != 0)
+	{
+		lasm_logger_error("failed to write output file.");
+		lasm_common_exit(1);
+	}
+
+	off_t offset = (off_t)blob->offset;
+	uint64_t left = blob->length;
+	ssize_t sent = 0;
+
+	while ((left > 0) && ((sent = sendfile(fileno(file), source, &offset, (size_t)((left < _elf_send_limit) ? left : _elf_send_limit))) > 0))
+	{
+		left -= (uint64_t)sent;
+	}
+
+	// note: the kernels, that cannot send between two regular files, fail before
+	// sending anything, and the included bytes are written from a mapping of the
+	// file instead.
+	const bool_t unsupported = (sent < 0) && ((EINVAL == errno) || (ENOSYS == errno)) && (left == blob->length);
+
+	if (((left > 0) && !(unsupported && _write_mapped(file, source, blob->offset, left))) ||
+		(fseek(file, 0, SEEK_END) != 0))
+	{
+		lasm_logger_error(lasm_location_fmt ": unable to write %lu bytes at offset %lu of included file %s. the file may have changed since it was parsed.",
+			lasm_location_arg(blob->location), blob->length, blob->offset, blob->path);
+		lasm_common_exit(1);
+	}
+
+	(void)close(source);
+}
+
+static bool_t _write_mapped(FILE* const file, const int32_t source, const uint64_t offset, const uint64_t length)
+{
+	lasm_debug_assert(file != NULL);
+	lasm_debug_assert(length > 0);
+
+	typedef struct stat stats_s;
+	stats_s stats = {0};
+
+	// note: the bytes past the end of a mapped file fault, so a file, that was
+	// shrunk since it was parsed, is reported instead.
+	if ((fstat(source, &stats) != 0) || ((uint64_t)stats.st_size < (offset + length)))
+	{
+		return false;
+	}
+
+	// note: the mapping starts at the page, that holds the first included byte.
+	const uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+	const uint64_t skip = offset % page;
+	uint8_t* const mapping = (uint8_t*)mmap(NULL, (size_t)(skip + length), PROT_READ, MAP_PRIVATE, source, (off_t)(offset - skip));
+
+	if (MAP_FAILED == mapping)
+	{
+		return false;
+	}
+
+	const bool_t written = (fwrite(mapping + skip, sizeof(uint8_t), (size_t)length, file) == (size_t)length);
+	(void)munmap(mapping, (size_t)(skip + length));
+	return written;
+}
+
+static uint64_t _perm_to_flags(const lasm_ast_perm_type_e perm)
+{
+	switch (perm)
+	{
+		case lasm_ast_perm_type_r:   { return _elf_flag_r;                               } break;
+		case lasm_ast_perm_type_rw:  { return _elf_flag_r | _elf_flag_w;                 } break;
+		case lasm_ast_perm_type_rx:  { return _elf_flag_r | _elf_flag_x;                 } break;
+		case lasm_ast_perm_type_rwx: { return _elf_flag_r | _elf_flag_w | _elf_flag_x;   } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
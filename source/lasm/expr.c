@@ -0,0 +1,441 @@
+
+/**
+ * @file expr.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-24
+ */
+
+#include "lasm/expr.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <stdio.h>
+
+#define _log_expr_error(_location, _format, ...)                               \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+typedef struct
+{
+	lasm_arena_s* arena;
+	const lasm_tokens_vector_s* tokens;
+	uint64_t index;
+} _expr_parser_s;
+
+static lasm_ast_expr_s* _new_expr(_expr_parser_s* const parser, const lasm_ast_expr_type_e type, const lasm_location_s location);
+
+static const char_t* _copy_ident(_expr_parser_s* const parser, const lasm_token_s* const token);
+
+static const lasm_token_s* _peek_token(_expr_parser_s* const parser);
+
+static const lasm_token_s* _expect_token(_expr_parser_s* const parser, const lasm_token_type_e type, const char_t* const context);
+
+static uint8_t _binary_precedence(const lasm_token_type_e type);
+
+static uint64_t _apply_unary(const lasm_token_type_e op, const uint64_t operand);
+
+static uint64_t _apply_binary(const lasm_token_type_e op, const uint64_t left, const uint64_t right, const lasm_location_s location);
+
+static lasm_ast_expr_s* _parse_label_reference(_expr_parser_s* const parser, const lasm_token_s* const token, const lasm_ast_expr_type_e type);
+
+static lasm_ast_expr_s* _parse_primary(_expr_parser_s* const parser);
+
+static lasm_ast_expr_s* _parse_unary(_expr_parser_s* const parser);
+
+static lasm_ast_expr_s* _parse_binary(_expr_parser_s* const parser, const uint8_t min_precedence);
+
+lasm_ast_expr_s* lasm_expr_parse(lasm_arena_s* const arena, const lasm_tokens_vector_s* const tokens, uint64_t* const index)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(index != NULL);
+	lasm_debug_assert(*index < tokens->count);
+
+	_expr_parser_s parser = (_expr_parser_s)
+	{
+		.arena  = arena,
+		.tokens = tokens,
+		.index  = *index,
+	};
+
+	lasm_ast_expr_s* const expr = _parse_binary(&parser, 1);
+	*index = parser.index;
+	return expr;
+}
+
+uint64_t lasm_expr_eval(lasm_ast_expr_s* const expr, const lasm_expr_resolver_s* const resolver)
+{
+	lasm_debug_assert(expr != NULL);
+
+	if (expr->folded)
+	{
+		return expr->value;
+	}
+
+	if (expr->visiting)
+	{
+		_log_expr_error(expr->location, "cyclic dependency encountered while evaluating the expression.");
+	}
+
+	expr->visiting = true;
+	uint64_t value = 0;
+
+	switch (expr->type)
+	{
+		case lasm_ast_expr_type_symbol:
+		case lasm_ast_expr_type_sizeof:
+		case lasm_ast_expr_type_addrof:
+		{
+			lasm_debug_assert(resolver != NULL);
+			lasm_debug_assert(resolver->resolve != NULL);
+			value = resolver->resolve(resolver->context, expr);
+		} break;
+
+		case lasm_ast_expr_type_unary:
+		{
+			value = _apply_unary(expr->as.unary.op, lasm_expr_eval(expr->as.unary.operand, resolver));
+		} break;
+
+		case lasm_ast_expr_type_binary:
+		{
+			const uint64_t left = lasm_expr_eval(expr->as.binary.left, resolver);
+			const uint64_t right = lasm_expr_eval(expr->as.binary.right, resolver);
+			value = _apply_binary(expr->as.binary.op, left, right, expr->location);
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: literals are always folded.
+		} break;
+	}
+
+	expr->visiting = false;
+	expr->folded = true;
+	expr->value = value;
+	return value;
+}
+
+bool_t lasm_expr_unfold(lasm_ast_expr_s* const expr)
+{
+	lasm_debug_assert(expr != NULL);
+
+	bool_t dependent = false;
+
+	switch (expr->type)
+	{
+		case lasm_ast_expr_type_uval:
+		{
+			return false;
+		} break;
+
+		case lasm_ast_expr_type_symbol:
+		case lasm_ast_expr_type_sizeof:
+		case lasm_ast_expr_type_addrof:
+		{
+			dependent = true;
+		} break;
+
+		case lasm_ast_expr_type_unary:
+		{
+			dependent = lasm_expr_unfold(expr->as.unary.operand);
+		} break;
+
+		case lasm_ast_expr_type_binary:
+		{
+			// note: both sides are unfolded, even when the left one depends on labels.
+			const bool_t left = lasm_expr_unfold(expr->as.binary.left);
+			const bool_t right = lasm_expr_unfold(expr->as.binary.right);
+			dependent = left || right;
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+		} break;
+	}
+
+	if (dependent)
+	{
+		expr->folded = false;
+	}
+
+	return dependent;
+}
+
+static lasm_ast_expr_s* _new_expr(_expr_parser_s* const parser, const lasm_ast_expr_type_e type, const lasm_location_s location)
+{
+	lasm_debug_assert(parser != NULL);
+
+	lasm_ast_expr_s* const expr = (lasm_ast_expr_s* const)lasm_arena_alloc(parser->arena, sizeof(lasm_ast_expr_s));
+	lasm_debug_assert(expr != NULL);
+
+	*expr = (lasm_ast_expr_s)
+	{
+		.type     = type,
+		.location = location,
+	};
+
+	return expr;
+}
+
+static const char_t* _copy_ident(_expr_parser_s* const parser, const lasm_token_s* const token)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(token != NULL);
+	lasm_debug_assert(lasm_token_type_ident == token->type);
+
+	// note: the tokens may be released before the expression is evaluated, so
+	// the expression keeps its own copy of the identifier.
+	char_t* const name = (char_t* const)lasm_arena_alloc(parser->arena, token->as.ident.length + 1);
+	lasm_debug_assert(name != NULL);
+
+	lasm_common_memcpy(name, token->as.ident.data, token->as.ident.length);
+	name[token->as.ident.length] = 0;
+	return name;
+}
+
+static const lasm_token_s* _peek_token(_expr_parser_s* const parser)
+{
+	lasm_debug_assert(parser != NULL);
+	return ((parser->index < parser->tokens->count) ? &parser->tokens->data[parser->index] : NULL);
+}
+
+static const lasm_token_s* _expect_token(_expr_parser_s* const parser, const lasm_token_type_e type, const char_t* const context)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(context != NULL);
+
+	const lasm_token_s* const token = _peek_token(parser);
+
+	if (NULL == token)
+	{
+		const lasm_token_s* const last = &parser->tokens->data[parser->tokens->count - 1];
+		_log_expr_error(last->location, "expected a '%s' token %s, but the expression ended.", lasm_token_type_to_string(type), context);
+	}
+
+	if (token->type != type)
+	{
+		_log_expr_error(token->location, "expected a '%s' token %s, but found '%s' token.",
+			lasm_token_type_to_string(type), context, lasm_token_type_to_string(token->type)
+		);
+	}
+
+	++parser->index;
+	return token;
+}
+
+static uint8_t _binary_precedence(const lasm_token_type_e type)
+{
+	switch (type)
+	{
+		case lasm_token_type_symbolic_pipe:        { return 1; } break;
+		case lasm_token_type_symbolic_caret:       { return 2; } break;
+		case lasm_token_type_symbolic_ampersand:   { return 3; } break;
+		case lasm_token_type_symbolic_shift_left:  { return 4; } break;
+		case lasm_token_type_symbolic_shift_right: { return 4; } break;
+		case lasm_token_type_symbolic_plus:        { return 5; } break;
+		case lasm_token_type_symbolic_minus:       { return 5; } break;
+		default:                                   { return 0; } break;
+	}
+}
+
+static uint64_t _apply_unary(const lasm_token_type_e op, const uint64_t operand)
+{
+	switch (op)
+	{
+		case lasm_token_type_symbolic_plus:  { return operand;        } break;
+		case lasm_token_type_symbolic_minus: { return (~operand) + 1; } break;
+		case lasm_token_type_symbolic_tilde: { return ~operand;       } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static uint64_t _apply_binary(const lasm_token_type_e op, const uint64_t left, const uint64_t right, const lasm_location_s location)
+{
+	switch (op)
+	{
+		case lasm_token_type_symbolic_plus:      { return left + right; } break;
+		case lasm_token_type_symbolic_minus:     { return left - right; } break;
+		case lasm_token_type_symbolic_ampersand: { return left & right; } break;
+		case lasm_token_type_symbolic_pipe:      { return left | right; } break;
+		case lasm_token_type_symbolic_caret:     { return left ^ right; } break;
+
+		case lasm_token_type_symbolic_shift_left:
+		case lasm_token_type_symbolic_shift_right:
+		{
+			if (right >= 64)
+			{
+				_log_expr_error(location, "shift amount %lu is out of range, it must be less than 64.", right);
+			}
+
+			return ((lasm_token_type_symbolic_shift_left == op) ? (left << right) : (left >> right));
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static lasm_ast_expr_s* _parse_label_reference(_expr_parser_s* const parser, const lasm_token_s* const token, const lasm_ast_expr_type_e type)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(token != NULL);
+
+	const char_t* const keyword = lasm_token_type_to_string(token->type);
+	(void)_expect_token(parser, lasm_token_type_symbolic_left_paren, "after the operator");
+
+	const lasm_token_s* const ident = _peek_token(parser);
+
+	if ((NULL == ident) || (ident->type != lasm_token_type_ident))
+	{
+		_log_expr_error(((NULL == ident) ? token->location : ident->location),
+			"expected a label identifier inside of the '%s(<label>)' operator.", keyword
+		);
+	}
+
+	++parser->index;
+	(void)_expect_token(parser, lasm_token_type_symbolic_right_paren, "after the label identifier");
+
+	lasm_ast_expr_s* const expr = _new_expr(parser, type, ident->location);
+	expr->as.symbol.name = _copy_ident(parser, ident);
+	expr->as.symbol.length = ident->as.ident.length;
+	return expr;
+}
+
+static lasm_ast_expr_s* _parse_primary(_expr_parser_s* const parser)
+{
+	lasm_debug_assert(parser != NULL);
+
+	const lasm_token_s* const token = _peek_token(parser);
+
+	if (NULL == token)
+	{
+		const lasm_token_s* const last = &parser->tokens->data[parser->tokens->count - 1];
+		_log_expr_error(last->location, "expected an operand, but the expression ended.");
+	}
+
+	++parser->index;
+
+	switch (token->type)
+	{
+		case lasm_token_type_literal_uval:
+		case lasm_token_type_literal_rune:
+		{
+			lasm_ast_expr_s* const expr = _new_expr(parser, lasm_ast_expr_type_uval, token->location);
+			expr->as.uval = ((lasm_token_type_literal_uval == token->type) ? token->as.uval : (uint64_t)token->as.rune);
+			expr->folded = true;
+			expr->value = expr->as.uval;
+			return expr;
+		} break;
+
+		case lasm_token_type_ident:
+		{
+			lasm_ast_expr_s* const expr = _new_expr(parser, lasm_ast_expr_type_symbol, token->location);
+			expr->as.symbol.name = _copy_ident(parser, token);
+			expr->as.symbol.length = token->as.ident.length;
+			return expr;
+		} break;
+
+		case lasm_token_type_keyword_sizeof: { return _parse_label_reference(parser, token, lasm_ast_expr_type_sizeof); } break;
+		case lasm_token_type_keyword_addrof: { return _parse_label_reference(parser, token, lasm_ast_expr_type_addrof); } break;
+
+		case lasm_token_type_symbolic_left_paren:
+		{
+			lasm_ast_expr_s* const expr = _parse_binary(parser, 1);
+			(void)_expect_token(parser, lasm_token_type_symbolic_right_paren, "to close the parenthesised expression");
+			return expr;
+		} break;
+
+		default:
+		{
+			_log_expr_error(token->location,
+				"expected a numeric literal, a rune literal, a label identifier, 'sizeof(<label>)', 'addrof(<label>)', or a '(' token, but found '%s' token.",
+				lasm_token_type_to_string(token->type)
+			);
+			return NULL;
+		} break;
+	}
+}
+
+static lasm_ast_expr_s* _parse_unary(_expr_parser_s* const parser)
+{
+	lasm_debug_assert(parser != NULL);
+
+	const lasm_token_s* const token = _peek_token(parser);
+
+	if ((NULL == token) ||
+		((token->type != lasm_token_type_symbolic_plus) &&
+		 (token->type != lasm_token_type_symbolic_minus) &&
+		 (token->type != lasm_token_type_symbolic_tilde)))
+	{
+		return _parse_primary(parser);
+	}
+
+	++parser->index;
+	lasm_ast_expr_s* const operand = _parse_unary(parser);
+
+	if (operand->folded)
+	{
+		operand->value = _apply_unary(token->type, operand->value);
+		operand->location = token->location;
+		return operand;
+	}
+
+	lasm_ast_expr_s* const expr = _new_expr(parser, lasm_ast_expr_type_unary, token->location);
+	expr->as.unary.op = token->type;
+	expr->as.unary.operand = operand;
+	return expr;
+}
+
+static lasm_ast_expr_s* _parse_binary(_expr_parser_s* const parser, const uint8_t min_precedence)
+{
+	lasm_debug_assert(parser != NULL);
+
+	lasm_ast_expr_s* left = _parse_unary(parser);
+	const lasm_token_s* token = NULL;
+
+	while ((token = _peek_token(parser)) != NULL)
+	{
+		const uint8_t precedence = _binary_precedence(token->type);
+
+		if ((0 == precedence) || (precedence < min_precedence))
+		{
+			break;
+		}
+
+		++parser->index;
+		lasm_ast_expr_s* const right = _parse_binary(parser, (uint8_t)(precedence + 1));
+
+		if (left->folded && right->folded)
+		{
+			left->value = _apply_binary(token->type, left->value, right->value, token->location);
+			continue;
+		}
+
+		lasm_ast_expr_s* const expr = _new_expr(parser, lasm_ast_expr_type_binary, token->location);
+		expr->as.binary.op = token->type;
+		expr->as.binary.left = left;
+		expr->as.binary.right = right;
+		left = expr;
+	}
+
+	return left;
+}
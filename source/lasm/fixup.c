@@ -0,0 +1,578 @@
+
+/**
+ * @file fixup.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#include "lasm/fixup.h"
+#include "lasm/local.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+#include "lasm/archs/rl78_isa.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#define _log_fixup_error_noexit(_location, _format, ...)                       \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+	} while (0)
+
+#define _log_fixup_error(_location, _format, ...)                              \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+static bool_t _bind_symbol(const lasm_ast_label_s* const label, const lasm_ast_expr_s* const expr, lasm_ast_fixup_s* const fixup);
+
+static const lasm_ast_expr_s* _split_byte(const lasm_ast_expr_s* const expr, lasm_ir_fixup_kind_e* const kind);
+
+static bool_t _split_expr(const lasm_ast_expr_s* const expr, const bool_t negated, const lasm_ast_expr_s** const symbol, uint64_t* const addend);
+
+static uint64_t _resolve_target(const lasm_labels_vector_s* const labels, const uint64_t target);
+
+static uint64_t _field_value(const lasm_labels_vector_s* const labels, const lasm_ast_fixup_s* const fixup, const uint64_t target_addr);
+
+static int32_t _compare_fixups(const void* const left, const void* const right);
+
+void lasm_fixups_collect(lasm_ast_label_s* const label, const lasm_ir_inst_s* const inst, const uint64_t offset)
+{
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(inst != NULL);
+
+	for (uint8_t index = 0; index < inst->operands_count; ++index)
+	{
+		const lasm_ir_operand_s* const operand = &inst->operands[index];
+
+		// note: a relative field depends on the address of the instruction, so it
+		// is a fixup even when its target is a constant address.
+		if ((0 == operand->fixup_width) ||
+			(!lasm_ir_operand_is_symbolic(operand) && (operand->fixup_kind != lasm_ir_fixup_kind_rel)))
+		{
+			continue;
+		}
+
+		lasm_debug_assert(operand->fixup_width <= 8);
+		lasm_debug_assert(operand->fixup_kind < lasm_ir_fixup_kinds_count);
+		lasm_debug_assert((operand->fixup_kind != lasm_ir_fixup_kind_lo) || (1 == operand->fixup_width));
+		lasm_debug_assert((operand->fixup_kind != lasm_ir_fixup_kind_hi) || (1 == operand->fixup_width));
+		lasm_debug_assert((operand->fixup_kind != lasm_ir_fixup_kind_lo16) || (2 == operand->fixup_width));
+		lasm_debug_assert((operand->fixup_kind != lasm_ir_fixup_kind_saddr) || (1 == operand->fixup_width));
+		lasm_debug_assert((operand->fixup_kind != lasm_ir_fixup_kind_sfr) || (1 == operand->fixup_width));
+
+		lasm_ast_fixup_s fixup = (lasm_ast_fixup_s)
+		{
+			.location      = inst->location,
+			.kind          = (lasm_ir_fixup_kind_e)operand->fixup_kind,
+			.width         = operand->fixup_width,
+			.field_offset  = operand->fixup_offset,
+			.relax         = (operand->fixup_relax != 0),
+			.flow          = (lasm_ir_flow_e)operand->fixup_flow,
+			.offset        = offset + operand->fixup_offset,
+			.symbol        = "",
+			.symbol_length = 0,
+			.addend        = operand->value,
+			.label         = lasm_ast_label_none,
+			.target        = lasm_ast_label_none,
+			.local         = lasm_ast_label_none,
+		};
+
+		if (lasm_ir_operand_is_symbolic(operand) && !_bind_symbol(label, operand->expr, &fixup))
+		{
+			_log_fixup_error(operand->expr->location,
+				"the operand of the instruction in label '%s' cannot be resolved after the layout. an operand, that references a label, must be the label's address or size ('sizeof(<label>)') plus or minus a constant, or the low ('& 0xFF') or the high ('>> 8') byte of its address in a single byte field.",
+				label->name
+			);
+		}
+
+		lasm_fixups_vector_push(&label->fixups, fixup);
+	}
+}
+
+void lasm_fixups_collect_value(lasm_ast_label_s* const label, const lasm_ast_expr_s* const expr, const uint8_t width, const uint64_t offset)
+{
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(expr != NULL);
+	lasm_debug_assert((width > 0) && (width <= 8));
+
+	lasm_ast_fixup_s fixup = (lasm_ast_fixup_s)
+	{
+		.location      = expr->location,
+		.kind          = lasm_ir_fixup_kind_abs,
+		.width         = width,
+		.field_offset  = 0,
+		.relax         = false,
+		.flow          = lasm_ir_flow_none,
+		.offset        = offset,
+		.symbol        = "",
+		.symbol_length = 0,
+		.addend        = 0,
+		.label         = lasm_ast_label_none,
+		.target        = lasm_ast_label_none,
+		.local         = lasm_ast_label_none,
+	};
+
+	if (!_bind_symbol(label, expr, &fixup))
+	{
+		_log_fixup_error(expr->location,
+			"the value of the data directive in label '%s' cannot be resolved after the layout. a value, that references a label, must be the label's address or size ('sizeof(<label>)') plus or minus a constant, or the low ('& 0xFF') or the high ('>> 8') byte of its address in a single byte field.",
+			label->name
+		);
+	}
+
+	lasm_fixups_vector_push(&label->fixups, fixup);
+}
+
+void lasm_fixups_bind(lasm_labels_vector_s* const labels, const lasm_symtab_s* const symtab)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(symtab != NULL);
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(labels, index);
+
+		for (uint64_t fixup_index = 0; fixup_index < label->fixups.count; ++fixup_index)
+		{
+			lasm_ast_fixup_s* const fixup = lasm_fixups_vector_at(&label->fixups, fixup_index);
+			fixup->label = index;
+
+			if (fixup->local != lasm_ast_label_none)
+			{
+				lasm_debug_assert(fixup->local < label->locals.count);
+				fixup->target = index;
+				continue;
+			}
+
+			if ((fixup->symbol_length > 0) && !lasm_symtab_find(symtab, fixup->symbol, fixup->symbol_length, &fixup->target))
+			{
+				_log_fixup_error(fixup->location,
+					"unknown label '%.*s' referenced in the body of label '%s'.",
+					(int32_t)fixup->symbol_length, fixup->symbol, label->name
+				);
+			}
+		}
+	}
+}
+
+void lasm_fixups_apply(lasm_arena_s* const arena, lasm_labels_vector_s* const labels)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(labels != NULL);
+
+	uint64_t count = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		count += labels->data[index].fixups.count;
+	}
+
+	if (0 == count)
+	{
+		return;
+	}
+
+	lasm_ast_fixup_s* const fixups = (lasm_ast_fixup_s* const)lasm_arena_alloc(arena, count * sizeof(lasm_ast_fixup_s));
+	lasm_debug_assert(fixups != NULL);
+
+	uint64_t written = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_fixups_vector_s* const label_fixups = &labels->data[index].fixups;
+
+		if (label_fixups->count > 0)
+		{
+			lasm_common_memcpy(fixups + written, label_fixups->data, label_fixups->count * sizeof(lasm_ast_fixup_s));
+			written += label_fixups->count;
+		}
+	}
+
+	qsort(fixups, (size_t)count, sizeof(lasm_ast_fixup_s), _compare_fixups);
+
+	uint64_t targets = 0, failed = 0;
+	uint64_t target = 0, target_addr = 0;
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		const lasm_ast_fixup_s* const fixup = &fixups[index];
+		lasm_debug_assert(fixup->label < labels->count);
+
+		// note: the fixups are sorted by their targets, so the address of a target
+		// is resolved once for all of the fixups, that reference it. the fixups
+		// with constant targets are sorted last.
+		if ((0 == index) || (fixup->target != target))
+		{
+			target = fixup->target;
+			target_addr = (lasm_ast_label_none == target) ? 0 : _resolve_target(labels, target);
+			targets += (uint64_t)(target != lasm_ast_label_none);
+		}
+
+		lasm_ast_label_s* const label = &labels->data[fixup->label];
+		lasm_debug_assert(lasm_ast_label_none == label->alias);
+		lasm_debug_assert((fixup->offset + fixup->width) <= label->body.count);
+
+		const uint64_t value = _field_value(labels, fixup, target_addr);
+
+		if (!lasm_fixup_fits(fixup, value))
+		{
+			if (lasm_ir_fixup_kind_rel == fixup->kind)
+			{
+				_log_fixup_error_noexit(fixup->location,
+					"the target of the %u byte relative field in the body of label '%s' is %ld bytes away, which is out of the field's range.",
+					fixup->width, label->name, (int64_t)value
+				);
+			}
+			else if (lasm_ir_fixup_kind_size == fixup->kind)
+			{
+				_log_fixup_error_noexit(fixup->location,
+					"size %lu does not fit into the %u byte field in the body of label '%s'.",
+					value, fixup->width, label->name
+				);
+			}
+			else if ((lasm_ir_fixup_kind_saddr == fixup->kind) || (lasm_ir_fixup_kind_sfr == fixup->kind))
+			{
+				_log_fixup_error_noexit(fixup->location,
+					"address 0x%lX in the body of label '%s' is out of the %s window from 0x%X to 0x%X.",
+					value, label->name, ((lasm_ir_fixup_kind_saddr == fixup->kind) ? "saddr" : "sfr"),
+					((lasm_ir_fixup_kind_saddr == fixup->kind) ? rl78_isa_saddr_first : rl78_isa_sfr_first),
+					((lasm_ir_fixup_kind_saddr == fixup->kind) ? rl78_isa_saddr_last : rl78_isa_sfr_last)
+				);
+			}
+			else if (lasm_ir_fixup_kind_lo16 == fixup->kind)
+			{
+				_log_fixup_error_noexit(fixup->location,
+					"address 0x%lX in the body of label '%s' is not addressable with 16 bits. expected an address below 0x10000, or from 0xF0000 to 0xFFFFF.",
+					value, label->name
+				);
+			}
+			else
+			{
+				_log_fixup_error_noexit(fixup->location,
+					"address 0x%lX does not fit into the %u byte field in the body of label '%s'.",
+					value, fixup->width, label->name
+				);
+			}
+
+			++failed;
+		}
+
+		for (uint8_t byte = 0; byte < fixup->width; ++byte)
+		{
+			label->body.data[fixup->offset + byte] = (uint8_t)(value >> (byte * 8));
+		}
+	}
+
+	if (failed > 0)
+	{
+		lasm_logger_error("%lu fixups could not be resolved.", failed);
+		lasm_common_exit(1);
+	}
+
+	lasm_logger_info("fixups: %lu fixups are resolved against %lu target labels.", count, targets);
+}
+
+uint64_t lasm_fixup_value(const lasm_labels_vector_s* const labels, const lasm_ast_fixup_s* const fixup)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(fixup != NULL);
+
+	const uint64_t target_addr = (lasm_ast_label_none == fixup->target) ? 0 : _resolve_target(labels, fixup->target);
+	return _field_value(labels, fixup, target_addr);
+}
+
+bool_t lasm_fixup_fits(const lasm_ast_fixup_s* const fixup, const uint64_t value)
+{
+	lasm_debug_assert(fixup != NULL);
+	lasm_debug_assert(fixup->width > 0);
+
+	if (fixup->width >= 8)
+	{
+		return true;
+	}
+
+	// note: the short direct fields hold the low bytes of the full addresses,
+	// so they fit only when the addresses are in their windows.
+	if (lasm_ir_fixup_kind_saddr == fixup->kind)
+	{
+		return (value >= rl78_isa_saddr_first) && (value <= rl78_isa_saddr_last);
+	}
+
+	if (lasm_ir_fixup_kind_sfr == fixup->kind)
+	{
+		return (value >= rl78_isa_sfr_first) && (value <= rl78_isa_sfr_last);
+	}
+
+	// note: the 16 bit addresses are extended with 0xF, unless they are prefixed
+	// with the es register, so only the first and the last 64 KiB are addressable
+	// without knowing the value of es.
+	if (lasm_ir_fixup_kind_lo16 == fixup->kind)
+	{
+		return (value <= UINT16_MAX) || ((value >= 0xF0000) && (value <= 0xFFFFF));
+	}
+
+	const uint64_t bits = (uint64_t)fixup->width * 8;
+
+	if (fixup->kind != lasm_ir_fixup_kind_rel)
+	{
+		return (0 == (value >> bits));
+	}
+
+	// note: a relative value fits when all of the bits above the field's sign
+	// bit are copies of the sign bit.
+	const uint64_t high = value >> (bits - 1);
+	return (0 == high) || ((UINT64_MAX >> (bits - 1)) == high);
+}
+
+static bool_t _bind_symbol(const lasm_ast_label_s* const label, const lasm_ast_expr_s* const expr, lasm_ast_fixup_s* const fixup)
+{
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(expr != NULL);
+	lasm_debug_assert(fixup != NULL);
+
+	const lasm_ast_expr_s* symbol = NULL;
+	lasm_ir_fixup_kind_e kind = fixup->kind;
+	const lasm_ast_expr_s* const address = _split_byte(expr, &kind);
+	fixup->addend = 0;
+
+	// note: a byte of the address fits only into a single byte field, that is
+	// not a target of a control transfer, and it keeps the field's form fixed.
+	if ((kind != fixup->kind) && ((fixup->kind != lasm_ir_fixup_kind_abs) || (fixup->width != 1) || (fixup->flow != lasm_ir_flow_none)))
+	{
+		return false;
+	}
+
+	if (!_split_expr(address, false, &symbol, &fixup->addend) || (NULL == symbol))
+	{
+		return false;
+	}
+
+	// note: the size of a label is patched in the same way as its address, into
+	// a field, that is not a target of a control transfer (the 16 bit fields of
+	// rl78 immediates hold the low 16 bits of the addresses).
+	if (lasm_ast_expr_type_sizeof == symbol->type)
+	{
+		if ((kind != fixup->kind) || ((fixup->kind != lasm_ir_fixup_kind_abs) && (fixup->kind != lasm_ir_fixup_kind_lo16)) ||
+			(fixup->flow != lasm_ir_flow_none) || ('.' == symbol->as.symbol.name[0]))
+		{
+			return false;
+		}
+
+		kind = lasm_ir_fixup_kind_size;
+	}
+
+	fixup->relax = (fixup->relax && (kind == fixup->kind));
+	fixup->kind = kind;
+
+	fixup->location = symbol->location;
+	fixup->symbol = symbol->as.symbol.name;
+	fixup->symbol_length = symbol->as.symbol.length;
+
+	// note: the local labels are resolved in the label's own table, as the whole
+	// body is parsed before it is encoded.
+	if (('.' == fixup->symbol[0]) && !lasm_local_find(label, fixup->symbol, fixup->symbol_length, &fixup->local))
+	{
+		_log_fixup_error(fixup->location,
+			"unknown local label '%.*s' referenced in the body of label '%s'. a local label is visible only in the body of the label, that defines it.",
+			(int32_t)fixup->symbol_length, fixup->symbol, label->name
+		);
+	}
+
+	return true;
+}
+
+static const lasm_ast_expr_s* _split_byte(const lasm_ast_expr_s* const expr, lasm_ir_fixup_kind_e* const kind)
+{
+	lasm_debug_assert(expr != NULL);
+	lasm_debug_assert(kind != NULL);
+
+	if (expr->folded || (expr->type != lasm_ast_expr_type_binary) || !expr->as.binary.right->folded)
+	{
+		return expr;
+	}
+
+	const lasm_ast_expr_s* const left = expr->as.binary.left;
+	const uint64_t right = expr->as.binary.right->value;
+
+	// note: the high byte may be masked too, as in '(label >> 8) & 0xFF'.
+	if ((lasm_token_type_symbolic_ampersand == expr->as.binary.op) && (0xFF == right))
+	{
+		const lasm_ir_fixup_kind_e outer = *kind;
+		const lasm_ast_expr_s* const inner = _split_byte(left, kind);
+
+		if (*kind == outer)
+		{
+			*kind = lasm_ir_fixup_kind_lo;
+		}
+
+		return inner;
+	}
+
+	if ((lasm_token_type_symbolic_shift_right == expr->as.binary.op) && (8 == right))
+	{
+		*kind = lasm_ir_fixup_kind_hi;
+		return left;
+	}
+
+	return expr;
+}
+
+static bool_t _split_expr(const lasm_ast_expr_s* const expr, const bool_t negated, const lasm_ast_expr_s** const symbol, uint64_t* const addend)
+{
+	lasm_debug_assert(expr != NULL);
+	lasm_debug_assert(symbol != NULL);
+	lasm_debug_assert(addend != NULL);
+
+	if (expr->folded)
+	{
+		*addend += (negated ? ((~expr->value) + 1) : expr->value);
+		return true;
+	}
+
+	switch (expr->type)
+	{
+		case lasm_ast_expr_type_symbol:
+		case lasm_ast_expr_type_sizeof:
+		case lasm_ast_expr_type_addrof:
+		{
+			// note: only a single, not negated, label address or size can be relocated.
+			if (negated || (*symbol != NULL))
+			{
+				return false;
+			}
+
+			*symbol = expr;
+			return true;
+		} break;
+
+		case lasm_ast_expr_type_unary:
+		{
+			switch (expr->as.unary.op)
+			{
+				case lasm_token_type_symbolic_plus:  { return _split_expr(expr->as.unary.operand, negated, symbol, addend);  } break;
+				case lasm_token_type_symbolic_minus: { return _split_expr(expr->as.unary.operand, !negated, symbol, addend); } break;
+				default:                             { return false;                                                         } break;
+			}
+		} break;
+
+		case lasm_ast_expr_type_binary:
+		{
+			switch (expr->as.binary.op)
+			{
+				case lasm_token_type_symbolic_plus:
+				{
+					return _split_expr(expr->as.binary.left, negated, symbol, addend) &&
+						_split_expr(expr->as.binary.right, negated, symbol, addend);
+				} break;
+
+				case lasm_token_type_symbolic_minus:
+				{
+					return _split_expr(expr->as.binary.left, negated, symbol, addend) &&
+						_split_expr(expr->as.binary.right, !negated, symbol, addend);
+				} break;
+
+				default:
+				{
+					return false;
+				} break;
+			}
+		} break;
+
+		default:
+		{
+			return false;
+		} break;
+	}
+}
+
+static uint64_t _resolve_target(const lasm_labels_vector_s* const labels, const uint64_t target)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(target < labels->count);
+
+	const lasm_ast_label_s* const label = &labels->data[target];
+
+	// note: the address of a folded or pooled label is derived from the address
+	// of the label, that it is folded or pooled into.
+	if (label->alias != lasm_ast_label_none)
+	{
+		return labels->data[label->alias].attrs[lasm_ast_attr_type_addr].as.addr.value + label->alias_offset;
+	}
+
+	return label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+}
+
+static uint64_t _field_value(const lasm_labels_vector_s* const labels, const lasm_ast_fixup_s* const fixup, const uint64_t target_addr)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(fixup != NULL);
+	lasm_debug_assert(fixup->label < labels->count);
+
+	if (lasm_ir_fixup_kind_size == fixup->kind)
+	{
+		lasm_debug_assert(fixup->target < labels->count);
+		return labels->data[fixup->target].attrs[lasm_ast_attr_type_size].as.size.value + fixup->addend;
+	}
+
+	// note: a local label is addressed relative to the label, that defines it.
+	const uint64_t local = (lasm_ast_label_none == fixup->local) ? 0 : labels->data[fixup->target].locals.data[fixup->local].offset;
+	const uint64_t value = target_addr + local + fixup->addend;
+
+	switch (fixup->kind)
+	{
+		case lasm_ir_fixup_kind_abs:   { return value;                 } break;
+		case lasm_ir_fixup_kind_lo:    { return value & 0xFF;          } break;
+		case lasm_ir_fixup_kind_hi:    { return (value >> 8) & 0xFF;   } break;
+		// note: the full address is checked against the window, and only its low
+		// bytes are written into the field.
+		case lasm_ir_fixup_kind_lo16:
+		case lasm_ir_fixup_kind_saddr:
+		case lasm_ir_fixup_kind_sfr:   { return value;                 } break;
+
+		case lasm_ir_fixup_kind_rel:
+		{
+			const uint64_t field_addr = labels->data[fixup->label].attrs[lasm_ast_attr_type_addr].as.addr.value + fixup->offset;
+			return value - (field_addr + fixup->width);
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static int32_t _compare_fixups(const void* const left, const void* const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	const lasm_ast_fixup_s* const left_fixup = (const lasm_ast_fixup_s*)left;
+	const lasm_ast_fixup_s* const right_fixup = (const lasm_ast_fixup_s*)right;
+
+	if (left_fixup->target != right_fixup->target)
+	{
+		return (left_fixup->target > right_fixup->target) - (left_fixup->target < right_fixup->target);
+	}
+
+	if (left_fixup->label != right_fixup->label)
+	{
+		return (left_fixup->label > right_fixup->label) - (left_fixup->label < right_fixup->label);
+	}
+
+	return (left_fixup->offset > right_fixup->offset) - (left_fixup->offset < right_fixup->offset);
+}
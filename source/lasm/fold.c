@@ -0,0 +1,419 @@
+
+/**
+ * @file fold.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#include "lasm/fold.h"
+#include "lasm/debug.h"
+
+#include <stdlib.h>
+
+typedef struct
+{
+	const uint8_t* data;
+	uint64_t length;
+	uint64_t align;
+	uint64_t region;
+	uint64_t index;
+} _string_ref_s;
+
+static bool_t _is_candidate(const lasm_ast_label_s* const label);
+
+static bool_t _is_fixup_foldable(const lasm_ast_fixup_s* const fixup);
+
+static bool_t _are_fixups_identical(const lasm_labels_vector_s* const labels, const lasm_ast_label_s* const left, const lasm_ast_label_s* const right);
+
+static uint64_t _resolve_target(const lasm_labels_vector_s* const labels, const uint64_t target, uint64_t* const offset);
+
+static uint64_t _hash_label(const lasm_labels_vector_s* const labels, const lasm_ast_label_s* const label);
+
+static bool_t _are_identical(const lasm_ast_label_s* const left, const lasm_ast_label_s* const right);
+
+static bool_t _is_poolable(const lasm_ast_label_s* const label);
+
+static int32_t _compare_string_refs(const void* const left, const void* const right);
+
+lasm_fold_s lasm_fold_new(lasm_arena_s* const arena, lasm_labels_vector_s* const labels)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(labels != NULL);
+
+	// note: every label takes at most one slot, so the table never grows and
+	// its load factor stays at or below 1/2.
+	uint64_t capacity = 16;
+
+	while (capacity < (labels->count * 2))
+	{
+		capacity *= 2;
+	}
+
+	lasm_fold_slot_s* const slots = (lasm_fold_slot_s* const)lasm_arena_alloc(arena, capacity * sizeof(lasm_fold_slot_s));
+	lasm_debug_assert(slots != NULL);
+
+	for (uint64_t index = 0; index < capacity; ++index)
+	{
+		slots[index] = (lasm_fold_slot_s) { .hash = 0, .index = lasm_ast_label_none, };
+	}
+
+	return (lasm_fold_s)
+	{
+		.labels   = labels,
+		.slots    = slots,
+		.capacity = capacity,
+		.folded   = 0,
+		.saved    = 0,
+	};
+}
+
+bool_t lasm_fold_label(lasm_fold_s* const fold, const uint64_t index)
+{
+	lasm_debug_assert(fold != NULL);
+	lasm_debug_assert(index < fold->labels->count);
+
+	lasm_ast_label_s* const label = lasm_labels_vector_at(fold->labels, index);
+
+	if (!_is_candidate(label))
+	{
+		return false;
+	}
+
+	const uint64_t hash = _hash_label(fold->labels, label);
+	uint64_t slot = hash & (fold->capacity - 1);
+
+	for (; fold->slots[slot].index != lasm_ast_label_none; slot = (slot + 1) & (fold->capacity - 1))
+	{
+		const lasm_ast_label_s* const other = &fold->labels->data[fold->slots[slot].index];
+
+		if ((fold->slots[slot].hash == hash) && _are_identical(label, other) && _are_fixups_identical(fold->labels, label, other))
+		{
+			// note: the fixups of the folded label are the same as the fixups of
+			// the label, that it is folded into, so only those are applied.
+			label->fixups.count = 0;
+			label->alias = fold->slots[slot].index;
+			++fold->folded;
+			fold->saved += label->attrs[lasm_ast_attr_type_size].as.size.value;
+			return true;
+		}
+	}
+
+	fold->slots[slot] = (lasm_fold_slot_s) { .hash = hash, .index = index, };
+	return false;
+}
+
+void lasm_fold_pool_strings(lasm_arena_s* const arena, lasm_labels_vector_s* const labels, uint64_t* const pooled, uint64_t* const saved)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(pooled != NULL);
+	lasm_debug_assert(saved != NULL);
+
+	*pooled = 0;
+	*saved = 0;
+
+	_string_ref_s* const refs = (_string_ref_s* const)lasm_arena_alloc(arena, (labels->count + 1) * sizeof(_string_ref_s));
+	lasm_debug_assert(refs != NULL);
+
+	uint64_t count = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+
+		if (_is_poolable(label))
+		{
+			const lasm_ast_attr_s* const region = &label->attrs[lasm_ast_attr_type_region];
+
+			refs[count++] = (_string_ref_s)
+			{
+				.data   = label->body.data,
+				.length = label->body.count,
+				.align  = label->attrs[lasm_ast_attr_type_align].as.align.value,
+				.region = (region->inferred ? lasm_ast_region_none : region->as.region.value),
+				.index  = index,
+			};
+		}
+	}
+
+	qsort(refs, (size_t)count, sizeof(_string_ref_s), _compare_string_refs);
+
+	const _string_ref_s* kept = NULL;
+
+	for (uint64_t index = 0; index < count; ++index)
+	{
+		const _string_ref_s* const ref = &refs[index];
+
+		// note: a string, that is not a suffix of the kept string, is not a
+		// suffix of any string sorted before it, so it is kept instead.
+		if ((NULL == kept) || (kept->region != ref->region) || (kept->length < ref->length) ||
+			(lasm_common_memcmp(kept->data + (kept->length - ref->length), ref->data, ref->length) != 0))
+		{
+			kept = ref;
+			continue;
+		}
+
+		const uint64_t offset = kept->length - ref->length;
+
+		if (((offset % ref->align) != 0) || (ref->align > kept->align))
+		{
+			continue;
+		}
+
+		lasm_ast_label_s* const label = lasm_labels_vector_at(labels, ref->index);
+		label->alias = kept->index;
+		label->alias_offset = offset;
+		++*pooled;
+		*saved += ref->length;
+	}
+}
+
+static bool_t _is_candidate(const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	const lasm_ast_perm_type_e perm = label->attrs[lasm_ast_attr_type_perm].as.perm.value;
+
+	// note: writable labels are distinct variables, even when their initial
+	// values are the same, so they are never folded. the included bytes are
+	// not in the memory at all, so they are not folded either.
+	if (!label->attrs[lasm_ast_attr_type_addr].inferred ||
+		((lasm_ast_perm_type_r != perm) && (lasm_ast_perm_type_rx != perm)) ||
+		(0 == label->body.count) || (label->blob.path != NULL))
+	{
+		return false;
+	}
+
+	for (uint64_t index = 0; index < label->fixups.count; ++index)
+	{
+		if (!_is_fixup_foldable(&label->fixups.data[index]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool_t _is_fixup_foldable(const lasm_ast_fixup_s* const fixup)
+{
+	lasm_debug_assert(fixup != NULL);
+
+	// note: a folded label shares the bytes of another label at another address,
+	// so only the fields, which values do not depend on the address of their own
+	// label, can be shared: the addresses of the other labels, and the distances
+	// to the local labels. the short fields, that may still grow into their long
+	// forms after the layout, change the size of the body, so they are not
+	// shared either.
+	if (fixup->relax && ((lasm_ir_fixup_kind_rel == fixup->kind) ||
+		(lasm_ir_fixup_kind_saddr == fixup->kind) || (lasm_ir_fixup_kind_sfr == fixup->kind)))
+	{
+		return false;
+	}
+
+	return ((lasm_ir_fixup_kind_rel == fixup->kind) == (fixup->local != lasm_ast_label_none));
+}
+
+static bool_t _are_fixups_identical(const lasm_labels_vector_s* const labels, const lasm_ast_label_s* const left, const lasm_ast_label_s* const right)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	if (left->fixups.count != right->fixups.count)
+	{
+		return false;
+	}
+
+	for (uint64_t index = 0; index < left->fixups.count; ++index)
+	{
+		const lasm_ast_fixup_s* const left_fixup = &left->fixups.data[index];
+		const lasm_ast_fixup_s* const right_fixup = &right->fixups.data[index];
+
+		if ((left_fixup->offset != right_fixup->offset) || (left_fixup->width != right_fixup->width) ||
+			(left_fixup->kind != right_fixup->kind) || (left_fixup->addend != right_fixup->addend) ||
+			((lasm_ast_label_none == left_fixup->local) != (lasm_ast_label_none == right_fixup->local)))
+		{
+			return false;
+		}
+
+		// note: the local labels are compared by their offsets within the bodies,
+		// and the other labels by the addresses, that they resolve to.
+		if (left_fixup->local != lasm_ast_label_none)
+		{
+			if (left->locals.data[left_fixup->local].offset != right->locals.data[right_fixup->local].offset)
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		uint64_t left_offset = 0, right_offset = 0;
+
+		if ((_resolve_target(labels, left_fixup->target, &left_offset) != _resolve_target(labels, right_fixup->target, &right_offset)) ||
+			(left_offset != right_offset))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static uint64_t _resolve_target(const lasm_labels_vector_s* const labels, const uint64_t target, uint64_t* const offset)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(offset != NULL);
+
+	*offset = 0;
+
+	if ((lasm_ast_label_none == target) || (lasm_ast_label_none == labels->data[target].alias))
+	{
+		return target;
+	}
+
+	// note: the folded and the pooled labels are aliases of the labels, which
+	// are never aliases themselves.
+	*offset = labels->data[target].alias_offset;
+	return labels->data[target].alias;
+}
+
+static uint64_t _hash_label(const lasm_labels_vector_s* const labels, const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(label != NULL);
+
+	const uint64_t shape[] =
+	{
+		label->attrs[lasm_ast_attr_type_size].as.size.value,
+		label->attrs[lasm_ast_attr_type_align].as.align.value,
+		(uint64_t)label->attrs[lasm_ast_attr_type_perm].as.perm.value,
+		label->attrs[lasm_ast_attr_type_region].as.region.value,
+	};
+
+	uint64_t hash = lasm_common_hash(lasm_common_hash_seed, shape, sizeof(shape));
+	hash = lasm_common_hash(hash, label->body.data, label->body.count);
+
+	// note: the fixups are hashed the same way, as they are compared, so the
+	// labels, that differ only in their targets (e.g. many 'jp x' stubs), do not
+	// share their probe chains.
+	for (uint64_t index = 0; index < label->fixups.count; ++index)
+	{
+		const lasm_ast_fixup_s* const fixup = &label->fixups.data[index];
+		uint64_t target = lasm_ast_label_none, offset = 0;
+
+		if (fixup->local != lasm_ast_label_none)
+		{
+			offset = label->locals.data[fixup->local].offset;
+		}
+		else
+		{
+			target = _resolve_target(labels, fixup->target, &offset);
+		}
+
+		const uint64_t key[] =
+		{
+			fixup->offset,
+			(uint64_t)fixup->width,
+			(uint64_t)fixup->kind,
+			fixup->addend,
+			target,
+			offset,
+		};
+
+		hash = lasm_common_hash(hash, key, sizeof(key));
+	}
+
+	return hash;
+}
+
+static bool_t _are_identical(const lasm_ast_label_s* const left, const lasm_ast_label_s* const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	if ((left->attrs[lasm_ast_attr_type_size].as.size.value != right->attrs[lasm_ast_attr_type_size].as.size.value)       ||
+		(left->attrs[lasm_ast_attr_type_align].as.align.value != right->attrs[lasm_ast_attr_type_align].as.align.value)   ||
+		(left->attrs[lasm_ast_attr_type_perm].as.perm.value != right->attrs[lasm_ast_attr_type_perm].as.perm.value)       ||
+		(left->attrs[lasm_ast_attr_type_region].as.region.value != right->attrs[lasm_ast_attr_type_region].as.region.value) ||
+		(left->body.count != right->body.count))
+	{
+		return false;
+	}
+
+	for (uint64_t index = 0; index < left->body.count; ++index)
+	{
+		if (left->body.data[index] != right->body.data[index])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool_t _is_poolable(const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	const lasm_ast_attr_s* const attrs = label->attrs;
+
+	// note: the pooling happens before the layout, so only the attributes, that
+	// do not depend on the layout, are considered.
+	if (!label->strings || !attrs[lasm_ast_attr_type_addr].inferred ||
+		attrs[lasm_ast_attr_type_perm].inferred || (attrs[lasm_ast_attr_type_perm].as.perm.value != lasm_ast_perm_type_r) ||
+		attrs[lasm_ast_attr_type_align].inferred || !attrs[lasm_ast_attr_type_align].expr->folded ||
+		(0 == attrs[lasm_ast_attr_type_align].as.align.value))
+	{
+		return false;
+	}
+
+	if (attrs[lasm_ast_attr_type_size].inferred)
+	{
+		return true;
+	}
+
+	return attrs[lasm_ast_attr_type_size].expr->folded && (attrs[lasm_ast_attr_type_size].as.size.value == label->body.count);
+}
+
+static int32_t _compare_string_refs(const void* const left, const void* const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	const _string_ref_s* const left_ref = (const _string_ref_s*)left;
+	const _string_ref_s* const right_ref = (const _string_ref_s*)right;
+
+	if (left_ref->region != right_ref->region)
+	{
+		return (left_ref->region > right_ref->region) - (left_ref->region < right_ref->region);
+	}
+
+	// note: the strings are compared from their last bytes, and a string goes
+	// after all of the longer strings, that it is a suffix of.
+	const uint64_t length = (left_ref->length < right_ref->length) ? left_ref->length : right_ref->length;
+
+	for (uint64_t index = 1; index <= length; ++index)
+	{
+		const uint8_t left_byte = left_ref->data[left_ref->length - index];
+		const uint8_t right_byte = right_ref->data[right_ref->length - index];
+
+		if (left_byte != right_byte)
+		{
+			return (left_byte > right_byte) - (left_byte < right_byte);
+		}
+	}
+
+	if (left_ref->length != right_ref->length)
+	{
+		return (left_ref->length < right_ref->length) - (left_ref->length > right_ref->length);
+	}
+
+	return (left_ref->index > right_ref->index) - (left_ref->index < right_ref->index);
+}
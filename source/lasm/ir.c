@@ -0,0 +1,63 @@
+
+/**
+ * @file ir.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-25
+ */
+
+#include "lasm/ir.h"
+#include "lasm/ast.h"
+#include "lasm/debug.h"
+
+lasm_implement_vector_type(lasm_ir_insts_vector, lasm_ir_inst_s);
+
+lasm_ir_inst_s lasm_ir_inst_new(const uint16_t opcode, const lasm_location_s location)
+{
+	return (lasm_ir_inst_s)
+	{
+		.opcode         = opcode,
+		.operands_count = 0,
+		.size           = 0,
+		.location       = location,
+	};
+}
+
+void lasm_ir_inst_push_operand(lasm_ir_inst_s* const inst, const lasm_ir_operand_s operand)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(inst->operands_count < lasm_ir_operands_capacity);
+	inst->operands[inst->operands_count++] = operand;
+}
+
+lasm_ir_operand_s lasm_ir_operand_from_expr(const lasm_ir_operand_type_e type, lasm_ast_expr_s* const expr)
+{
+	lasm_debug_assert(expr != NULL);
+	lasm_debug_assert((lasm_ir_operand_type_imm == type) || (lasm_ir_operand_type_mem == type));
+
+	if (expr->folded)
+	{
+		return (lasm_ir_operand_s)
+		{
+			.type  = (uint8_t)type,
+			.value = expr->value,
+		};
+	}
+
+	return (lasm_ir_operand_s)
+	{
+		.type = (uint8_t)lasm_ir_operand_type_sym,
+		.id   = (uint8_t)type,  // note: for symbolic operands the id keeps the operand type, that the resolved value takes.
+		.expr = expr,
+	};
+}
+
+bool_t lasm_ir_operand_is_symbolic(const lasm_ir_operand_s* const operand)
+{
+	lasm_debug_assert(operand != NULL);
+	return (lasm_ir_operand_type_sym == operand->type);
+}
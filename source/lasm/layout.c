@@ -0,0 +1,1607 @@
+
+/**
+ * @file layout.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-26
+ */
+
+#include "lasm/layout.h"
+#include "lasm/expr.h"
+#include "lasm/fold.h"
+#include "lasm/relax.h"
+#include "lasm/archs/z80_peephole.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#define _log_layout_warn(_location, _format, ...)                              \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_warn(_format, ## __VA_ARGS__);                             \
+	} while (0)
+
+#define _log_layout_error_noexit(_location, _format, ...)                      \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+	} while (0)
+
+#define _log_layout_error(_location, _format, ...)                             \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+typedef struct
+{
+	lasm_arena_s* arena;
+	lasm_labels_vector_s* labels;
+	const lasm_symtab_s* symtab;
+	const lasm_regions_vector_s* regions;
+	lasm_fold_s* fold;  // note: folding table, or NULL when folding is disabled.
+	uint64_t placed;  // note: count of labels, that are already placed by the sweep.
+} _layout_s;
+
+typedef struct
+{
+	uint64_t start;
+	uint64_t end;
+	uint64_t index;
+	uint64_t bank;
+} _interval_s;
+
+typedef struct
+{
+	_interval_s* data;
+	uint64_t count;
+} _intervals_heap_s;
+
+typedef struct
+{
+	uint64_t size;
+	uint64_t align;
+	uint64_t region;
+	uint64_t index;
+} _pack_item_s;
+
+#define _gap_aligns_count 7
+
+typedef struct _gap_s _gap_s;
+
+// note: the gaps of a bank are kept in a treap ordered by their starts, where
+// every node holds the longest space of its subtree for each of the common
+// alignments, so the first gap, that a label fits into, is found without
+// visiting the gaps, that are too short for it.
+struct _gap_s
+{
+	uint64_t start;
+	uint64_t end;
+	uint64_t usable[_gap_aligns_count];  // note: 1 + the longest space after an address aligned to 1 << index in the subtree, or 0.
+	uint64_t priority;                   // note: heap priority of the treap, which keeps it balanced.
+	_gap_s* left;
+	_gap_s* right;
+};
+
+typedef struct
+{
+	_gap_s* data;
+	uint64_t count;
+	uint64_t capacity;
+	uint64_t seed;  // note: state of the generator of the priorities, that starts the same in every build.
+} _gaps_pool_s;
+
+typedef struct
+{
+	uint64_t* bases;       // note: index of the label, which end is the base of each label's inferred address, or lasm_ast_label_none.
+	uint64_t* reaches;     // note: 1 + the highest index of the labels, that each label's explicit address and size depend on, or 0.
+	uint64_t* dependents;  // note: indices of the labels, which explicit addresses or sizes depend on other labels.
+	uint64_t dependents_count;
+	uint64_t* aliases;     // note: indices of the folded and the pooled labels.
+	uint64_t aliases_count;
+} _relayout_s;
+
+static uint64_t _resolve_label_shape(_layout_s* const layout, lasm_ast_label_s* const label, uint64_t* const align, lasm_ast_perm_type_e* const perm);
+
+static void _check_label_addr(const lasm_ast_label_s* const label);
+
+static void _assign_label_region(const _layout_s* const layout, lasm_ast_label_s* const label, const uint64_t region);
+
+static uint64_t _find_region(const _layout_s* const layout, const uint64_t addr);
+
+static uint64_t* _new_region_cursors(const _layout_s* const layout);
+
+static void _place_alias(const _layout_s* const layout, lasm_ast_label_s* const label);
+
+static void _layout_in_order(_layout_s* const layout);
+
+static void _layout_packed(_layout_s* const layout);
+
+static void _relax_in_order(_layout_s* const layout, const lasm_arch_type_e arch, const uint64_t relaxable, const uint64_t saved);
+
+static _relayout_s _new_relayout(_layout_s* const layout);
+
+static uint64_t _resolve_reach(_layout_s* const layout, _relayout_s* const relayout, uint8_t* const states, const uint64_t index);
+
+static uint64_t _expr_reach(_layout_s* const layout, _relayout_s* const relayout, uint8_t* const states, const lasm_ast_expr_s* const expr);
+
+static void _update_addrs_in_order(_layout_s* const layout, const _relayout_s* const relayout, const uint64_t first);
+
+static uint64_t _measure_padding(_interval_s* const intervals, const uint64_t count);
+
+static int32_t _compare_pack_items(const void* const left, const void* const right);
+
+static _gap_s* _new_gap(_gaps_pool_s* const pool, const uint64_t start, const uint64_t end);
+
+static void _update_gap(_gap_s* const gap);
+
+static void _split_gaps(_gap_s* const root, const uint64_t start, _gap_s** const left, _gap_s** const right);
+
+static _gap_s* _merge_gaps(_gap_s* const left, _gap_s* const right);
+
+static _gap_s* _insert_gap(_gap_s* const root, _gap_s* const gap);
+
+static _gap_s* _remove_gap(_gap_s* const root, const uint64_t start);
+
+static _gap_s* _find_gap(_gap_s* const root, const _pack_item_s* const item, const uint64_t first, const uint64_t last, uint64_t* const addr);
+
+static uint64_t _resolve_attr(_layout_s* const layout, lasm_ast_label_s* const label, const lasm_ast_attr_type_e type);
+
+static uint64_t _resolve_expr_label(void* const context, const lasm_ast_expr_s* const expr);
+
+static uint64_t _align_up(const uint64_t value, const uint64_t align);
+
+static int32_t _compare_intervals(const void* const left, const void* const right);
+
+static void _heap_push(_intervals_heap_s* const heap, const _interval_s interval);
+
+static void _heap_pop(_intervals_heap_s* const heap);
+
+void lasm_layout_apply(lasm_arena_s* const arena, const lasm_config_build_s* const config, lasm_labels_vector_s* const labels, const lasm_symtab_s* const symtab, const lasm_regions_vector_s* const regions)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(symtab != NULL);
+	lasm_debug_assert(regions != NULL);
+
+	_layout_s layout = (_layout_s)
+	{
+		.arena   = arena,
+		.labels  = labels,
+		.symtab  = symtab,
+		.regions = regions,
+		.fold    = NULL,
+		.placed  = 0,
+	};
+
+	lasm_fold_s fold = {0};
+	uint64_t pooled = 0, pooled_saved = 0;
+	uint64_t relaxable = 0, relax_saved = 0;
+
+	if (config->pool)
+	{
+		lasm_fold_pool_strings(arena, labels, &pooled, &pooled_saved);
+	}
+
+	// note: the jumps to the following labels are found in their 'jp' forms, so
+	// they are removed before the branches are relaxed.
+	if (config->peephole && (lasm_arch_type_z80 == config->arch))
+	{
+		z80_peephole_fallthrough(config, labels);
+	}
+
+	// note: the packing places the labels by their final sizes, so nothing can
+	// grow after the labels are packed, and only the operands, which targets'
+	// addresses are already known, take their short forms.
+	if (config->pack)
+	{
+		if (config->relax)
+		{
+			lasm_logger_warn("branch relaxation is not supported together with packing, so the relaxable branches keep their long forms.");
+		}
+
+		relaxable = lasm_relax_shrink(config->arch, labels, false, false, &relax_saved);
+	}
+	else
+	{
+		relaxable = lasm_relax_shrink(config->arch, labels, config->relax, true, &relax_saved);
+	}
+
+	if (config->fold)
+	{
+		fold = lasm_fold_new(arena, labels);
+		layout.fold = &fold;
+	}
+
+	if (config->pack)
+	{
+		_layout_packed(&layout);
+	}
+	else
+	{
+		_layout_in_order(&layout);
+
+		if (config->relax || (relaxable > 0))
+		{
+			_relax_in_order(&layout, config->arch, relaxable, relax_saved);
+		}
+	}
+
+	if (config->pool)
+	{
+		lasm_logger_info("pooling: %lu string labels are pooled into longer string labels, which saves %lu bytes.", pooled, pooled_saved);
+	}
+
+	if (config->fold)
+	{
+		lasm_logger_info("folding: %lu labels are folded into identical labels, which saves %lu bytes.", fold.folded, fold.saved);
+	}
+}
+
+void lasm_layout_verify(lasm_arena_s* const arena, const lasm_labels_vector_s* const labels, const lasm_regions_vector_s* const regions)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(regions != NULL);
+
+	if (0 == labels->count)
+	{
+		return;
+	}
+
+	uint64_t* const used = (uint64_t* const)lasm_arena_alloc(arena, (regions->count + 1) * sizeof(uint64_t));
+	lasm_debug_assert(used != NULL);
+
+	for (uint64_t index = 0; index < regions->count; ++index)
+	{
+		used[index] = 0;
+	}
+
+	_interval_s* const intervals = (_interval_s* const)lasm_arena_alloc(arena, labels->count * sizeof(_interval_s));
+	lasm_debug_assert(intervals != NULL);
+
+	_intervals_heap_s heap = (_intervals_heap_s)
+	{
+		.data  = (_interval_s*)lasm_arena_alloc(arena, labels->count * sizeof(_interval_s)),
+		.count = 0,
+	};
+	lasm_debug_assert(heap.data != NULL);
+
+	uint64_t intervals_count = 0;
+	uint64_t errors = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+		const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+		const uint64_t size = label->attrs[lasm_ast_attr_type_size].as.size.value;
+
+		if (lasm_ast_label_length(label) > size)
+		{
+			_log_layout_error_noexit(label->location,
+				"the body of label '%s' takes %lu bytes, which exceeds its size of %lu bytes.",
+				label->name, lasm_ast_label_length(label), size
+			);
+			++errors;
+		}
+
+		// note: a folded label shares the memory of the label it is folded into.
+		if (label->alias != lasm_ast_label_none)
+		{
+			continue;
+		}
+
+		const uint64_t region_index = label->attrs[lasm_ast_attr_type_region].as.region.value;
+
+		if (lasm_ast_region_none == region_index)
+		{
+			if ((regions->count > 0) && (size > 0))
+			{
+				_log_layout_error_noexit(label->location,
+					"label '%s' at [0x%lX, 0x%lX) is not placed in any of the declared regions.",
+					label->name, addr, addr + size
+				);
+				++errors;
+			}
+		}
+		else
+		{
+			const lasm_ast_region_s* const region = &regions->data[region_index];
+			const lasm_ast_perm_type_e perm = label->attrs[lasm_ast_attr_type_perm].as.perm.value;
+			used[region_index] += size;
+
+			if ((addr < region->origin) || ((addr + size) > (region->origin + region->length)))
+			{
+				_log_layout_error_noexit(label->location,
+					"label '%s' at [0x%lX, 0x%lX) does not fit into region '%s' at [0x%lX, 0x%lX), which is declared at " lasm_location_fmt ".",
+					label->name, addr, addr + size,
+					region->name, region->origin, region->origin + region->length,
+					lasm_location_arg(region->location)
+				);
+				++errors;
+			}
+
+			if (!lasm_ast_perm_type_allows(region->perm, perm))
+			{
+				_log_layout_error_noexit(label->location,
+					"label '%s' with '%s' permissions cannot be placed in region '%s', which only allows '%s' permissions.",
+					label->name, lasm_ast_perm_type_to_string(perm),
+					region->name, lasm_ast_perm_type_to_string(region->perm)
+				);
+				++errors;
+			}
+		}
+
+		if (size > 0)
+		{
+			intervals[intervals_count++] = (_interval_s)
+			{
+				.start = addr,
+				.end   = addr + size,
+				.index = index,
+				.bank  = label->attrs[lasm_ast_attr_type_region].as.region.bank,
+			};
+		}
+	}
+
+	qsort(intervals, (size_t)intervals_count, sizeof(_interval_s), _compare_intervals);
+
+	for (uint64_t index = 0; index < intervals_count; ++index)
+	{
+		const _interval_s* const interval = &intervals[index];
+
+		// note: the intervals are sorted by their banks first, and the labels of
+		// different banks never overlap, as they are not mapped at the same time.
+		if ((index > 0) && (intervals[index - 1].bank != interval->bank))
+		{
+			heap.count = 0;
+		}
+
+		while ((heap.count > 0) && (heap.data[0].end <= interval->start))
+		{
+			_heap_pop(&heap);
+		}
+
+		// note: every range, that is still open, overlaps the current one.
+		for (uint64_t open = 0; open < heap.count; ++open)
+		{
+			const lasm_ast_label_s* const label = &labels->data[interval->index];
+			const lasm_ast_label_s* const other = &labels->data[heap.data[open].index];
+
+			_log_layout_error_noexit(label->location,
+				"label '%s' at [0x%lX, 0x%lX) overlaps label '%s' at [0x%lX, 0x%lX), which is defined at " lasm_location_fmt ".",
+				label->name, interval->start, interval->end,
+				other->name, heap.data[open].start, heap.data[open].end,
+				lasm_location_arg(other->location)
+			);
+			++errors;
+		}
+
+		_heap_push(&heap, *interval);
+	}
+
+	for (uint64_t index = 0; index < regions->count; ++index)
+	{
+		const lasm_ast_region_s* const region = &regions->data[index];
+
+		if (used[index] > region->length)
+		{
+			_log_layout_error_noexit(region->location,
+				"region '%s' is over capacity: its labels take %lu bytes, which exceeds its length of %lu bytes by %lu bytes.",
+				region->name, used[index], region->length, used[index] - region->length
+			);
+			++errors;
+			continue;
+		}
+
+		const double percent = ((double)used[index] * 100.0) / (double)region->length;
+
+		if (region->bank != lasm_ast_bank_none)
+		{
+			lasm_logger_info("region '%s' in bank %lu at [0x%lX, 0x%lX) with '%s' permissions: %lu of %lu bytes used (%.1f%%), %lu bytes free.",
+				region->name, region->bank, region->origin, region->origin + region->length, lasm_ast_perm_type_to_string(region->perm),
+				used[index], region->length, percent, region->length - used[index]
+			);
+			continue;
+		}
+
+		lasm_logger_info("region '%s' at [0x%lX, 0x%lX) with '%s' permissions: %lu of %lu bytes used (%.1f%%), %lu bytes free.",
+			region->name, region->origin, region->origin + region->length, lasm_ast_perm_type_to_string(region->perm),
+			used[index], region->length, percent, region->length - used[index]
+		);
+	}
+
+	if (errors > 0)
+	{
+		lasm_logger_error("layout verification failed with %lu errors.", errors);
+		lasm_common_exit(1);
+	}
+}
+
+static uint64_t _resolve_label_shape(_layout_s* const layout, lasm_ast_label_s* const label, uint64_t* const align, lasm_ast_perm_type_e* const perm)
+{
+	lasm_debug_assert(layout != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(align != NULL);
+	lasm_debug_assert(perm != NULL);
+
+	lasm_ast_attr_s* const attrs = label->attrs;
+
+	if (attrs[lasm_ast_attr_type_align].inferred)
+	{
+		attrs[lasm_ast_attr_type_align].as.align.value = *align;
+	}
+
+	*align = _resolve_attr(layout, label, lasm_ast_attr_type_align);
+
+	if (attrs[lasm_ast_attr_type_perm].inferred)
+	{
+		attrs[lasm_ast_attr_type_perm].as.perm.value = *perm;
+	}
+
+	*perm = attrs[lasm_ast_attr_type_perm].as.perm.value;
+	return _resolve_attr(layout, label, lasm_ast_attr_type_size);
+}
+
+static void _check_label_addr(const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+	const uint64_t align = label->attrs[lasm_ast_attr_type_align].as.align.value;
+
+	if (!label->attrs[lasm_ast_attr_type_addr].inferred && ((addr % align) != 0))
+	{
+		_log_layout_warn(label->location,
+			"label '%s' is placed at address 0x%lX, which is not aligned to its alignment of %lu.",
+			label->name, addr, align
+		);
+	}
+}
+
+static void _assign_label_region(const _layout_s* const layout, lasm_ast_label_s* const label, const uint64_t region)
+{
+	lasm_debug_assert(layout != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert((lasm_ast_region_none == region) || (region < layout->regions->count));
+
+	lasm_ast_attr_region_s* const attr = &label->attrs[lasm_ast_attr_type_region].as.region;
+	attr->value = region;
+	attr->name = ((lasm_ast_region_none == region) ? NULL : layout->regions->data[region].name);
+	attr->bank = ((lasm_ast_region_none == region) ? lasm_ast_bank_none : layout->regions->data[region].bank);
+}
+
+static uint64_t _find_region(const _layout_s* const layout, const uint64_t addr)
+{
+	lasm_debug_assert(layout != NULL);
+
+	for (uint64_t index = 0; index < layout->regions->count; ++index)
+	{
+		const lasm_ast_region_s* const region = &layout->regions->data[index];
+
+		// note: the address alone does not tell the bank, so a label is placed
+		// into a banked region only by naming it.
+		if (region->bank != lasm_ast_bank_none)
+		{
+			continue;
+		}
+
+		if ((addr >= region->origin) && ((addr - region->origin) < region->length))
+		{
+			return index;
+		}
+	}
+
+	return lasm_ast_region_none;
+}
+
+static uint64_t* _new_region_cursors(const _layout_s* const layout)
+{
+	lasm_debug_assert(layout != NULL);
+
+	uint64_t* const cursors = (uint64_t* const)lasm_arena_alloc(layout->arena, (layout->regions->count + 1) * sizeof(uint64_t));
+	lasm_debug_assert(cursors != NULL);
+
+	for (uint64_t index = 0; index < layout->regions->count; ++index)
+	{
+		cursors[index] = layout->regions->data[index].origin;
+	}
+
+	return cursors;
+}
+
+static void _place_alias(const _layout_s* const layout, lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(layout != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(label->alias != lasm_ast_label_none);
+
+	const lasm_ast_label_s* const target = &layout->labels->data[label->alias];
+	label->attrs[lasm_ast_attr_type_addr].as.addr.value = target->attrs[lasm_ast_attr_type_addr].as.addr.value + label->alias_offset;
+	_assign_label_region(layout, label, target->attrs[lasm_ast_attr_type_region].as.region.value);
+}
+
+static void _layout_in_order(_layout_s* const layout)
+{
+	lasm_debug_assert(layout != NULL);
+
+	uint64_t* const cursors = _new_region_cursors(layout);
+	uint64_t cursor = 0;
+	uint64_t align = 1;
+	uint64_t region = lasm_ast_region_none;
+	lasm_ast_perm_type_e perm = lasm_ast_perm_type_rwx;
+
+	for (uint64_t index = 0; index < layout->labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(layout->labels, index);
+		const lasm_ast_attr_s* const addr_attr = &label->attrs[lasm_ast_attr_type_addr];
+		const lasm_ast_attr_s* const region_attr = &label->attrs[lasm_ast_attr_type_region];
+		const uint64_t size = _resolve_label_shape(layout, label, &align, &perm);
+
+		// note: a pooled label is placed after the sweep, as the label, that it
+		// is pooled into, may be defined after it.
+		if (label->alias != lasm_ast_label_none)
+		{
+			layout->placed = index + 1;
+			continue;
+		}
+
+		// note: a label with an inferred address continues the region of the
+		// previous label, while a label with an explicit address belongs to the
+		// region, that contains its address.
+		if (addr_attr->inferred)
+		{
+			if (region_attr->inferred)
+			{
+				_assign_label_region(layout, label, region);
+			}
+
+			// note: a folded label takes the address of the label, that it is
+			// folded into, and does not move the cursors.
+			if ((layout->fold != NULL) && lasm_fold_label(layout->fold, index))
+			{
+				_place_alias(layout, label);
+				region = region_attr->as.region.value;
+				layout->placed = index + 1;
+				continue;
+			}
+
+			const uint64_t target = region_attr->as.region.value;
+			label->attrs[lasm_ast_attr_type_addr].as.addr.value = _align_up(((lasm_ast_region_none == target) ? cursor : cursors[target]), align);
+		}
+
+		const uint64_t addr = _resolve_attr(layout, label, lasm_ast_attr_type_addr);
+		_check_label_addr(label);
+
+		if (region_attr->inferred && (lasm_ast_region_none == region_attr->as.region.value))
+		{
+			_assign_label_region(layout, label, _find_region(layout, addr));
+		}
+
+		region = region_attr->as.region.value;
+		cursor = addr + size;
+
+		if (region != lasm_ast_region_none)
+		{
+			cursors[region] = cursor;
+		}
+
+		layout->placed = index + 1;
+	}
+
+	for (uint64_t index = 0; index < layout->labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(layout->labels, index);
+
+		if (label->alias != lasm_ast_label_none)
+		{
+			_place_alias(layout, label);
+		}
+	}
+}
+
+static void _layout_packed(_layout_s* const layout)
+{
+	lasm_debug_assert(layout != NULL);
+
+	lasm_labels_vector_s* const labels = layout->labels;
+
+	if (0 == labels->count)
+	{
+		return;
+	}
+
+	// note: while packing, no auto addressed label is placed until all of the
+	// fixed ones are, so only the fixed labels can be referenced by address.
+	layout->placed = 0;
+
+	uint64_t align = 1;
+	lasm_ast_perm_type_e perm = lasm_ast_perm_type_rwx;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		(void)_resolve_label_shape(layout, lasm_labels_vector_at(labels, index), &align, &perm);
+	}
+
+	_interval_s* const intervals = (_interval_s* const)lasm_arena_alloc(layout->arena, labels->count * sizeof(_interval_s));
+	lasm_debug_assert(intervals != NULL);
+
+	_pack_item_s* const items = (_pack_item_s* const)lasm_arena_alloc(layout->arena, labels->count * sizeof(_pack_item_s));
+	lasm_debug_assert(items != NULL);
+
+	uint64_t fixed_count = 0, items_count = 0, cursor = 0;
+	uint64_t region = lasm_ast_region_none;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(labels, index);
+		const lasm_ast_attr_s* const region_attr = &label->attrs[lasm_ast_attr_type_region];
+		const uint64_t size = label->attrs[lasm_ast_attr_type_size].as.size.value;
+		const uint64_t label_align = label->attrs[lasm_ast_attr_type_align].as.align.value;
+
+		if (label->attrs[lasm_ast_attr_type_addr].inferred)
+		{
+			if (region_attr->inferred)
+			{
+				_assign_label_region(layout, label, region);
+			}
+
+			region = region_attr->as.region.value;
+
+			if ((label->alias != lasm_ast_label_none) || ((layout->fold != NULL) && lasm_fold_label(layout->fold, index)))
+			{
+				continue;
+			}
+
+			items[items_count++] = (_pack_item_s) { .size = size, .align = label_align, .region = region, .index = index, };
+			continue;
+		}
+
+		const uint64_t addr = _resolve_attr(layout, label, lasm_ast_attr_type_addr);
+		_check_label_addr(label);
+
+		if (region_attr->inferred)
+		{
+			_assign_label_region(layout, label, _find_region(layout, addr));
+		}
+
+		region = region_attr->as.region.value;
+
+		if (size > 0)
+		{
+			intervals[fixed_count++] = (_interval_s) { .start = addr, .end = addr + size, .index = index, };
+		}
+	}
+
+	// note: the banks share their windows, so every bank keeps the gaps of its
+	// own, that are left around the fixed labels of the bank and of the regions
+	// outside of the banks. the gaps outside of the banks are left around all of
+	// the fixed labels. the last gap of each bank is open ended, and each
+	// placement splits a gap into at most two gaps.
+	uint64_t* const banks = (uint64_t* const)lasm_arena_alloc(layout->arena, (layout->regions->count + 1) * sizeof(uint64_t));
+	lasm_debug_assert(banks != NULL);
+
+	uint64_t* const region_banks = (uint64_t* const)lasm_arena_alloc(layout->arena, (layout->regions->count + 1) * sizeof(uint64_t));
+	lasm_debug_assert(region_banks != NULL);
+
+	uint64_t banks_count = 0;
+	banks[banks_count++] = lasm_ast_bank_none;
+
+	for (uint64_t index = 0; index < layout->regions->count; ++index)
+	{
+		const uint64_t bank = layout->regions->data[index].bank;
+		uint64_t known = 0;
+
+		while ((known < banks_count) && (banks[known] != bank))
+		{
+			++known;
+		}
+
+		if (known >= banks_count)
+		{
+			banks[banks_count++] = bank;
+		}
+
+		region_banks[index] = known;
+	}
+
+	_gaps_pool_s pool = (_gaps_pool_s)
+	{
+		.data     = NULL,
+		.count    = 0,
+		.capacity = (banks_count * (fixed_count + 1)) + items_count,
+		.seed     = 0x9E3779B97F4A7C15,
+	};
+
+	pool.data = (_gap_s*)lasm_arena_alloc(layout->arena, pool.capacity * sizeof(_gap_s));
+	lasm_debug_assert(pool.data != NULL);
+
+	_gap_s** const roots = (_gap_s** const)lasm_arena_alloc(layout->arena, banks_count * sizeof(_gap_s*));
+	lasm_debug_assert(roots != NULL);
+
+	qsort(intervals, (size_t)fixed_count, sizeof(_interval_s), _compare_intervals);
+
+	for (uint64_t bank = 0; bank < banks_count; ++bank)
+	{
+		roots[bank] = NULL;
+		cursor = 0;
+
+		for (uint64_t index = 0; index < fixed_count; ++index)
+		{
+			const uint64_t fixed_bank = labels->data[intervals[index].index].attrs[lasm_ast_attr_type_region].as.region.bank;
+
+			if ((banks[bank] != lasm_ast_bank_none) && (fixed_bank != lasm_ast_bank_none) && (fixed_bank != banks[bank]))
+			{
+				continue;
+			}
+
+			if (intervals[index].start > cursor)
+			{
+				roots[bank] = _insert_gap(roots[bank], _new_gap(&pool, cursor, intervals[index].start));
+			}
+
+			cursor = ((intervals[index].end > cursor) ? intervals[index].end : cursor);
+		}
+
+		roots[bank] = _insert_gap(roots[bank], _new_gap(&pool, cursor, UINT64_MAX));
+	}
+
+	// note: the padding before packing is measured on the in order placement.
+	uint64_t* const cursors = _new_region_cursors(layout);
+	uint64_t intervals_count = fixed_count;
+	cursor = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+		const uint64_t size = label->attrs[lasm_ast_attr_type_size].as.size.value;
+		const uint64_t label_region = label->attrs[lasm_ast_attr_type_region].as.region.value;
+		uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+
+		if (label->alias != lasm_ast_label_none)
+		{
+			continue;
+		}
+
+		if (label->attrs[lasm_ast_attr_type_addr].inferred)
+		{
+			const uint64_t base = ((lasm_ast_region_none == label_region) ? cursor : cursors[label_region]);
+			addr = _align_up(base, label->attrs[lasm_ast_attr_type_align].as.align.value);
+
+			if (size > 0)
+			{
+				intervals[intervals_count++] = (_interval_s) { .start = addr, .end = addr + size, .index = index, };
+			}
+		}
+
+		cursor = addr + size;
+
+		if (label_region != lasm_ast_region_none)
+		{
+			cursors[label_region] = cursor;
+		}
+	}
+
+	const uint64_t padding_before = _measure_padding(intervals, intervals_count);
+
+	// note: first fit decreasing, where the ties are broken by the alignment
+	// and then by the source order to keep the placement deterministic.
+	qsort(items, (size_t)items_count, sizeof(_pack_item_s), _compare_pack_items);
+
+	for (uint64_t index = 0; index < items_count; ++index)
+	{
+		const _pack_item_s* const item = &items[index];
+		const uint64_t bank = ((lasm_ast_region_none == item->region) ? 0 : region_banks[item->region]);
+		uint64_t first = 0, last = UINT64_MAX, addr = 0;
+
+		// note: a label of a region only fits into the part of a gap, that is
+		// inside of the region.
+		if (item->region != lasm_ast_region_none)
+		{
+			const lasm_ast_region_s* const target = &layout->regions->data[item->region];
+			first = target->origin;
+			last = target->origin + target->length;
+		}
+
+		_gap_s* const gap = _find_gap(roots[bank], item, first, last, &addr);
+		lasm_ast_label_s* const label = &labels->data[item->index];
+
+		if (NULL == gap)
+		{
+			// note: only a region can run out of space, as the last gap is open ended.
+			lasm_debug_assert(item->region != lasm_ast_region_none);
+			_log_layout_error(label->location,
+				"label '%s' of %lu bytes does not fit into any free space, that is left in region '%s'.",
+				label->name, item->size, layout->regions->data[item->region].name
+			);
+		}
+
+		label->attrs[lasm_ast_attr_type_addr].as.addr.value = addr;
+
+		if (label->attrs[lasm_ast_attr_type_region].inferred && (lasm_ast_region_none == item->region))
+		{
+			_assign_label_region(layout, label, _find_region(layout, addr));
+		}
+
+		if (0 == item->size)
+		{
+			continue;
+		}
+
+		// note: the gap is taken out of the treap, and it is put back as the head
+		// before the label, while the tail after the label takes a new node.
+		const uint64_t start = gap->start, end = gap->end;
+		roots[bank] = _remove_gap(roots[bank], start);
+
+		if (addr > start)
+		{
+			*gap = (_gap_s) { .start = start, .end = addr, .usable = {0}, .priority = gap->priority, .left = NULL, .right = NULL, };
+			roots[bank] = _insert_gap(roots[bank], gap);
+		}
+
+		if (end > (addr + item->size))
+		{
+			roots[bank] = _insert_gap(roots[bank], _new_gap(&pool, addr + item->size, end));
+		}
+	}
+
+	layout->placed = labels->count;
+	intervals_count = 0;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(labels, index);
+
+		if (label->alias != lasm_ast_label_none)
+		{
+			_place_alias(layout, label);
+			continue;
+		}
+
+		const uint64_t size = label->attrs[lasm_ast_attr_type_size].as.size.value;
+		const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+
+		if (size > 0)
+		{
+			intervals[intervals_count++] = (_interval_s) { .start = addr, .end = addr + size, .index = index, };
+		}
+	}
+
+	lasm_logger_info("packing: padding between labels went from %lu bytes to %lu bytes.",
+		padding_before, _measure_padding(intervals, intervals_count)
+	);
+}
+
+static void _relax_in_order(_layout_s* const layout, const lasm_arch_type_e arch, const uint64_t relaxable, const uint64_t saved)
+{
+	lasm_debug_assert(layout != NULL);
+
+	uint64_t passes = 0, grown = 0, grown_bytes = 0;
+	_relayout_s relayout = {0};
+
+	// note: the fields only grow, so each pass moves the labels forward, and
+	// the passes stop once none of the fields is out of its range or window.
+	while (true)
+	{
+		uint64_t bytes = 0, first = 0;
+		const uint64_t count = lasm_relax_grow(arch, layout->labels, &bytes, &first);
+
+		if (0 == count)
+		{
+			break;
+		}
+
+		if (0 == passes)
+		{
+			relayout = _new_relayout(layout);
+		}
+
+		++passes;
+		grown += count;
+		grown_bytes += bytes;
+		_update_addrs_in_order(layout, &relayout, first);
+	}
+
+	lasm_logger_info("relaxation: %lu of %lu branches and operands are kept in their short forms after %lu growth passes, which saves %lu bytes.",
+		relaxable - grown, relaxable, passes, saved - grown_bytes
+	);
+}
+
+static _relayout_s _new_relayout(_layout_s* const layout)
+{
+	lasm_debug_assert(layout != NULL);
+
+	const lasm_labels_vector_s* const labels = layout->labels;
+	const uint64_t count = labels->count + 1;
+
+	_relayout_s relayout = (_relayout_s)
+	{
+		.bases            = (uint64_t*)lasm_arena_alloc(layout->arena, count * sizeof(uint64_t)),
+		.reaches          = (uint64_t*)lasm_arena_alloc(layout->arena, count * sizeof(uint64_t)),
+		.dependents       = (uint64_t*)lasm_arena_alloc(layout->arena, count * sizeof(uint64_t)),
+		.dependents_count = 0,
+		.aliases          = (uint64_t*)lasm_arena_alloc(layout->arena, count * sizeof(uint64_t)),
+		.aliases_count    = 0,
+	};
+
+	lasm_debug_assert(relayout.bases != NULL);
+	lasm_debug_assert(relayout.reaches != NULL);
+	lasm_debug_assert(relayout.dependents != NULL);
+	lasm_debug_assert(relayout.aliases != NULL);
+
+	uint8_t* const states = (uint8_t* const)lasm_arena_alloc(layout->arena, count * sizeof(uint8_t));
+	lasm_debug_assert(states != NULL);
+	lasm_common_memset(states, 0, count * sizeof(uint8_t));
+
+	uint64_t* const lasts = (uint64_t* const)lasm_arena_alloc(layout->arena, (layout->regions->count + 1) * sizeof(uint64_t));
+	lasm_debug_assert(lasts != NULL);
+
+	for (uint64_t index = 0; index < layout->regions->count; ++index)
+	{
+		lasts[index] = lasm_ast_label_none;
+	}
+
+	// note: the regions, the folds and the order of the labels are kept from the
+	// sweep, so the label, that ends right before each label's inferred address,
+	// is found once for all of the growth passes.
+	uint64_t last = lasm_ast_label_none;
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+		const uint64_t region = label->attrs[lasm_ast_attr_type_region].as.region.value;
+
+		if (_resolve_reach(layout, &relayout, states, index) > 0)
+		{
+			relayout.dependents[relayout.dependents_count++] = index;
+		}
+
+		if (label->alias != lasm_ast_label_none)
+		{
+			relayout.aliases[relayout.aliases_count++] = index;
+			relayout.bases[index] = lasm_ast_label_none;
+			continue;
+		}
+
+		relayout.bases[index] = ((lasm_ast_region_none == region) ? last : lasts[region]);
+		last = index;
+
+		if (region != lasm_ast_region_none)
+		{
+			lasts[region] = index;
+		}
+	}
+
+	return relayout;
+}
+
+static uint64_t _resolve_reach(_layout_s* const layout, _relayout_s* const relayout, uint8_t* const states, const uint64_t index)
+{
+	lasm_debug_assert(layout != NULL);
+	lasm_debug_assert(relayout != NULL);
+	lasm_debug_assert(states != NULL);
+	lasm_debug_assert(index < layout->labels->count);
+
+	// note: the expressions were evaluated by the sweep, so they have no cycles,
+	// and a label, that is being resolved, is only reached again through its
+	// own alias.
+	if (states[index] != 0)
+	{
+		return ((2 == states[index]) ? relayout->reaches[index] : 0);
+	}
+
+	states[index] = 1;
+
+	const lasm_ast_attr_s* const attrs = layout->labels->data[index].attrs;
+	uint64_t reach = 0;
+
+	if (!attrs[lasm_ast_attr_type_addr].inferred)
+	{
+		const uint64_t addr_reach = _expr_reach(layout, relayout, states, attrs[lasm_ast_attr_type_addr].expr);
+		reach = ((addr_reach > reach) ? addr_reach : reach);
+	}
+
+	if (!attrs[lasm_ast_attr_type_size].inferred)
+	{
+		const uint64_t size_reach = _expr_reach(layout, relayout, states, attrs[lasm_ast_attr_type_size].expr);
+		reach = ((size_reach > reach) ? size_reach : reach);
+	}
+
+	relayout->reaches[index] = reach;
+	states[index] = 2;
+	return reach;
+}
+
+static uint64_t _expr_reach(_layout_s* const layout, _relayout_s* const relayout, uint8_t* const states, const lasm_ast_expr_s* const expr)
+{
+	lasm_debug_assert(layout != NULL);
+	lasm_debug_assert(relayout != NULL);
+	lasm_debug_assert(states != NULL);
+	lasm_debug_assert(expr != NULL);
+
+	switch (expr->type)
+	{
+		case lasm_ast_expr_type_symbol:
+		case lasm_ast_expr_type_sizeof:
+		case lasm_ast_expr_type_addrof:
+		{
+			uint64_t index = 0;
+
+			if (!lasm_symtab_find(layout->symtab, expr->as.symbol.name, expr->as.symbol.length, &index))
+			{
+				lasm_debug_assert(0);  // note: the sweep reports the unknown labels.
+				return 0;
+			}
+
+			// note: an expression depends on the labels, that it references, and on
+			// the labels, that their addresses and sizes depend on in turn.
+			const lasm_ast_label_s* const label = &layout->labels->data[index];
+			uint64_t reach = index + 1;
+			uint64_t nested = _resolve_reach(layout, relayout, states, index);
+			reach = ((nested > reach) ? nested : reach);
+
+			if ((expr->type != lasm_ast_expr_type_sizeof) && (label->alias != lasm_ast_label_none))
+			{
+				reach = (((label->alias + 1) > reach) ? (label->alias + 1) : reach);
+				nested = _resolve_reach(layout, relayout, states, label->alias);
+				reach = ((nested > reach) ? nested : reach);
+			}
+
+			return reach;
+		} break;
+
+		case lasm_ast_expr_type_unary:
+		{
+			return _expr_reach(layout, relayout, states, expr->as.unary.operand);
+		} break;
+
+		case lasm_ast_expr_type_binary:
+		{
+			const uint64_t left = _expr_reach(layout, relayout, states, expr->as.binary.left);
+			const uint64_t right = _expr_reach(layout, relayout, states, expr->as.binary.right);
+			return ((left > right) ? left : right);
+		} break;
+
+		default:
+		{
+			return 0;
+		} break;
+	}
+}
+
+static void _update_addrs_in_order(_layout_s* const layout, const _relayout_s* const relayout, const uint64_t first)
+{
+	lasm_debug_assert(layout != NULL);
+	lasm_debug_assert(relayout != NULL);
+
+	lasm_labels_vector_s* const labels = layout->labels;
+	lasm_debug_assert(first < labels->count);
+
+	// note: only the labels from the first grown label on may move, so only the
+	// explicit addresses and sizes, that depend on those labels, are evaluated
+	// again, and the sweep starts at the first of them. the alignments,
+	// permissions, regions and folds of the labels are kept from the sweep.
+	uint64_t start = first;
+
+	for (uint64_t index = 0; index < relayout->dependents_count; ++index)
+	{
+		const uint64_t dependent = relayout->dependents[index];
+
+		if (relayout->reaches[dependent] <= first)
+		{
+			continue;
+		}
+
+		lasm_ast_attr_s* const attrs = labels->data[dependent].attrs;
+
+		if (!attrs[lasm_ast_attr_type_addr].inferred)
+		{
+			(void)lasm_expr_unfold(attrs[lasm_ast_attr_type_addr].expr);
+		}
+
+		if (!attrs[lasm_ast_attr_type_size].inferred)
+		{
+			(void)lasm_expr_unfold(attrs[lasm_ast_attr_type_size].expr);
+		}
+
+		start = ((dependent < start) ? dependent : start);
+	}
+
+	layout->placed = start;
+
+	for (uint64_t index = start; index < labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(labels, index);
+
+		if (label->alias != lasm_ast_label_none)
+		{
+			layout->placed = index + 1;
+			continue;
+		}
+
+		(void)_resolve_attr(layout, label, lasm_ast_attr_type_size);
+
+		// note: the labels before the start keep their addresses and sizes, and
+		// the ones after it are updated in order, so the end of the base label is
+		// always final by the time it is read.
+		if (label->attrs[lasm_ast_attr_type_addr].inferred)
+		{
+			const uint64_t base_index = relayout->bases[index];
+			const uint64_t region = label->attrs[lasm_ast_attr_type_region].as.region.value;
+			uint64_t base = ((lasm_ast_region_none == region) ? 0 : layout->regions->data[region].origin);
+
+			if (base_index != lasm_ast_label_none)
+			{
+				const lasm_ast_attr_s* const base_attrs = labels->data[base_index].attrs;
+				base = base_attrs[lasm_ast_attr_type_addr].as.addr.value + base_attrs[lasm_ast_attr_type_size].as.size.value;
+			}
+
+			label->attrs[lasm_ast_attr_type_addr].as.addr.value = _align_up(base, label->attrs[lasm_ast_attr_type_align].as.align.value);
+		}
+
+		(void)_resolve_attr(layout, label, lasm_ast_attr_type_addr);
+		layout->placed = index + 1;
+	}
+
+	for (uint64_t index = 0; index < relayout->aliases_count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(labels, relayout->aliases[index]);
+
+		if (label->alias >= start)
+		{
+			_place_alias(layout, label);
+		}
+	}
+}
+
+static uint64_t _measure_padding(_interval_s* const intervals, const uint64_t count)
+{
+	lasm_debug_assert(intervals != NULL);
+
+	if (0 == count)
+	{
+		return 0;
+	}
+
+	qsort(intervals, (size_t)count, sizeof(_interval_s), _compare_intervals);
+
+	uint64_t padding = 0;
+	uint64_t cursor = intervals[0].end;
+
+	for (uint64_t index = 1; index < count; ++index)
+	{
+		if (intervals[index].start > cursor)
+		{
+			padding += intervals[index].start - cursor;
+		}
+
+		cursor = ((intervals[index].end > cursor) ? intervals[index].end : cursor);
+	}
+
+	return padding;
+}
+
+static int32_t _compare_pack_items(const void* const left, const void* const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	const _pack_item_s* const left_item = (const _pack_item_s*)left;
+	const _pack_item_s* const right_item = (const _pack_item_s*)right;
+
+	if (left_item->size != right_item->size)
+	{
+		return (left_item->size < right_item->size) - (left_item->size > right_item->size);
+	}
+
+	if (left_item->align != right_item->align)
+	{
+		return (left_item->align < right_item->align) - (left_item->align > right_item->align);
+	}
+
+	return (left_item->index > right_item->index) - (left_item->index < right_item->index);
+}
+
+static _gap_s* _new_gap(_gaps_pool_s* const pool, const uint64_t start, const uint64_t end)
+{
+	lasm_debug_assert(pool != NULL);
+	lasm_debug_assert(pool->count < pool->capacity);
+	lasm_debug_assert(start < end);
+
+	// note: xorshift64 keeps the priorities deterministic between the builds.
+	pool->seed ^= pool->seed << 13;
+	pool->seed ^= pool->seed >> 7;
+	pool->seed ^= pool->seed << 17;
+
+	_gap_s* const gap = &pool->data[pool->count++];
+	*gap = (_gap_s) { .start = start, .end = end, .usable = {0}, .priority = pool->seed, .left = NULL, .right = NULL, };
+	_update_gap(gap);
+	return gap;
+}
+
+static void _update_gap(_gap_s* const gap)
+{
+	lasm_debug_assert(gap != NULL);
+
+	for (uint64_t index = 0; index < _gap_aligns_count; ++index)
+	{
+		const uint64_t addr = _align_up(gap->start, (uint64_t)1 << index);
+		uint64_t usable = 0;
+
+		// note: the space of the open ended gap saturates instead of wrapping.
+		if ((addr >= gap->start) && (addr <= gap->end))
+		{
+			usable = (((gap->end - addr) < UINT64_MAX) ? ((gap->end - addr) + 1) : UINT64_MAX);
+		}
+
+		usable = (((gap->left != NULL) && (gap->left->usable[index] > usable)) ? gap->left->usable[index] : usable);
+		usable = (((gap->right != NULL) && (gap->right->usable[index] > usable)) ? gap->right->usable[index] : usable);
+		gap->usable[index] = usable;
+	}
+}
+
+static void _split_gaps(_gap_s* const root, const uint64_t start, _gap_s** const left, _gap_s** const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	if (NULL == root)
+	{
+		*left = NULL;
+		*right = NULL;
+		return;
+	}
+
+	// note: the gaps, that start before the start, go to the left treap.
+	if (root->start < start)
+	{
+		_split_gaps(root->right, start, &root->right, right);
+		*left = root;
+	}
+	else
+	{
+		_split_gaps(root->left, start, left, &root->left);
+		*right = root;
+	}
+
+	_update_gap(root);
+}
+
+static _gap_s* _merge_gaps(_gap_s* const left, _gap_s* const right)
+{
+	if ((NULL == left) || (NULL == right))
+	{
+		return ((NULL == left) ? right : left);
+	}
+
+	if (left->priority > right->priority)
+	{
+		left->right = _merge_gaps(left->right, right);
+		_update_gap(left);
+		return left;
+	}
+
+	right->left = _merge_gaps(left, right->left);
+	_update_gap(right);
+	return right;
+}
+
+static _gap_s* _insert_gap(_gap_s* const root, _gap_s* const gap)
+{
+	lasm_debug_assert(gap != NULL);
+
+	if ((NULL == root) || (gap->priority > root->priority))
+	{
+		_split_gaps(root, gap->start, &gap->left, &gap->right);
+		_update_gap(gap);
+		return gap;
+	}
+
+	if (gap->start < root->start)
+	{
+		root->left = _insert_gap(root->left, gap);
+	}
+	else
+	{
+		root->right = _insert_gap(root->right, gap);
+	}
+
+	_update_gap(root);
+	return root;
+}
+
+static _gap_s* _remove_gap(_gap_s* const root, const uint64_t start)
+{
+	lasm_debug_assert(root != NULL);
+
+	if (start == root->start)
+	{
+		return _merge_gaps(root->left, root->right);
+	}
+
+	if (start < root->start)
+	{
+		root->left = _remove_gap(root->left, start);
+	}
+	else
+	{
+		root->right = _remove_gap(root->right, start);
+	}
+
+	_update_gap(root);
+	return root;
+}
+
+static _gap_s* _find_gap(_gap_s* const root, const _pack_item_s* const item, const uint64_t first, const uint64_t last, uint64_t* const addr)
+{
+	lasm_debug_assert(item != NULL);
+	lasm_debug_assert(addr != NULL);
+
+	// note: the space after an address aligned to any power of two, that
+	// divides the alignment, is never shorter than the space after an address,
+	// that is aligned to the alignment, so the subtrees without enough space
+	// for it are skipped. the parts of the gaps inside of the region are never
+	// longer either.
+	uint64_t index = 0;
+
+	while (((index + 1) < _gap_aligns_count) && ((item->align % ((uint64_t)1 << (index + 1))) == 0))
+	{
+		++index;
+	}
+
+	if ((NULL == root) || (root->usable[index] <= item->size))
+	{
+		return NULL;
+	}
+
+	// note: the gaps never overlap, so the gaps before a gap, that starts at or
+	// before the first address, end before the first address as well.
+	if (root->start > first)
+	{
+		_gap_s* const gap = _find_gap(root->left, item, first, last, addr);
+
+		if (gap != NULL)
+		{
+			return gap;
+		}
+	}
+
+	if (root->start >= last)
+	{
+		return NULL;
+	}
+
+	const uint64_t start = ((first > root->start) ? first : root->start);
+	const uint64_t end = ((last < root->end) ? last : root->end);
+	*addr = _align_up(start, item->align);
+
+	if ((*addr >= start) && (*addr <= end) && (item->size <= (end - *addr)))
+	{
+		return root;
+	}
+
+	return _find_gap(root->right, item, first, last, addr);
+}
+
+static uint64_t _resolve_attr(_layout_s* const layout, lasm_ast_label_s* const label, const lasm_ast_attr_type_e type)
+{
+	lasm_debug_assert(layout != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(type != lasm_ast_attr_type_perm);
+
+	lasm_ast_attr_s* const attr = &label->attrs[type];
+
+	if (attr->inferred)
+	{
+		if (lasm_ast_attr_type_size == type)
+		{
+			attr->as.size.value = lasm_ast_label_length(label);
+		}
+	}
+	else if (!attr->expr->folded || (lasm_ast_attr_type_align == type))
+	{
+		const lasm_expr_resolver_s resolver = (const lasm_expr_resolver_s)
+		{
+			.context = layout,
+			.resolve = _resolve_expr_label,
+		};
+
+		const uint64_t value = lasm_expr_eval(attr->expr, &resolver);
+
+		switch (type)
+		{
+			case lasm_ast_attr_type_addr: { attr->as.addr.value = value; } break;
+			case lasm_ast_attr_type_size: { attr->as.size.value = value; } break;
+
+			case lasm_ast_attr_type_align:
+			{
+				if ((0 == value) || (value > 8))
+				{
+					_log_layout_error(attr->expr->location,
+						"align attribute value of label '%s' must be between 1 and 8, but it evaluated to %lu.",
+						label->name, value
+					);
+				}
+
+				attr->as.align.value = value;
+			} break;
+
+			default:
+			{
+				lasm_debug_assert(0);  // note: sanity check for developers.
+			} break;
+		}
+	}
+
+	switch (type)
+	{
+		case lasm_ast_attr_type_addr:  { return attr->as.addr.value;  } break;
+		case lasm_ast_attr_type_align: { return attr->as.align.value; } break;
+		case lasm_ast_attr_type_size:  { return attr->as.size.value;  } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static uint64_t _resolve_expr_label(void* const context, const lasm_ast_expr_s* const expr)
+{
+	lasm_debug_assert(context != NULL);
+	lasm_debug_assert(expr != NULL);
+
+	_layout_s* const layout = (_layout_s* const)context;
+	uint64_t index = 0;
+
+	if (!lasm_symtab_find(layout->symtab, expr->as.symbol.name, expr->as.symbol.length, &index))
+	{
+		_log_layout_error(expr->location,
+			"unknown label '%.*s' referenced in the expression.",
+			(int32_t)expr->as.symbol.length, expr->as.symbol.name
+		);
+	}
+
+	lasm_ast_label_s* label = lasm_labels_vector_at(layout->labels, index);
+	uint64_t offset = 0;
+
+	// note: the address of a folded or pooled label is derived from the address
+	// of the label, that it is folded or pooled into.
+	if ((expr->type != lasm_ast_expr_type_sizeof) && (label->alias != lasm_ast_label_none))
+	{
+		offset = label->alias_offset;
+		index = label->alias;
+		label = lasm_labels_vector_at(layout->labels, index);
+	}
+
+	switch (expr->type)
+	{
+		case lasm_ast_expr_type_sizeof:
+		{
+			return _resolve_attr(layout, label, lasm_ast_attr_type_size);
+		} break;
+
+		case lasm_ast_expr_type_symbol:
+		case lasm_ast_expr_type_addrof:
+		{
+			if ((index >= layout->placed) && label->attrs[lasm_ast_attr_type_addr].inferred)
+			{
+				_log_layout_error(expr->location,
+					"the address of label '%.*s' is inferred and it is not placed yet at this point. only labels with explicit addresses, or labels defined earlier, can be referenced by an address.",
+					(int32_t)expr->as.symbol.length, expr->as.symbol.name
+				);
+			}
+
+			return _resolve_attr(layout, label, lasm_ast_attr_type_addr) + offset;
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return 0;
+		} break;
+	}
+}
+
+static uint64_t _align_up(const uint64_t value, const uint64_t align)
+{
+	lasm_debug_assert(align > 0);
+	const uint64_t remainder = value % align;
+	return ((0 == remainder) ? value : (value + (align - remainder)));
+}
+
+static int32_t _compare_intervals(const void* const left, const void* const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	const _interval_s* const left_interval = (const _interval_s*)left;
+	const _interval_s* const right_interval = (const _interval_s*)right;
+
+	if (left_interval->bank != right_interval->bank)
+	{
+		return (left_interval->bank > right_interval->bank) - (left_interval->bank < right_interval->bank);
+	}
+
+	if (left_interval->start != right_interval->start)
+	{
+		return (left_interval->start > right_interval->start) - (left_interval->start < right_interval->start);
+	}
+
+	// note: ties are broken by the source order to keep the reports deterministic.
+	return (left_interval->index > right_interval->index) - (left_interval->index < right_interval->index);
+}
+
+static void _heap_push(_intervals_heap_s* const heap, const _interval_s interval)
+{
+	lasm_debug_assert(heap != NULL);
+
+	uint64_t index = heap->count++;
+
+	while (index > 0)
+	{
+		const uint64_t parent = (index - 1) / 2;
+
+		if (heap->data[parent].end <= interval.end)
+		{
+			break;
+		}
+
+		heap->data[index] = heap->data[parent];
+		index = parent;
+	}
+
+	heap->data[index] = interval;
+}
+
+static void _heap_pop(_intervals_heap_s* const heap)
+{
+	lasm_debug_assert(heap != NULL);
+	lasm_debug_assert(heap->count > 0);
+
+	const _interval_s last = heap->data[--heap->count];
+	uint64_t index = 0;
+
+	while (true)
+	{
+		uint64_t child = (index * 2) + 1;
+
+		if (child >= heap->count)
+		{
+			break;
+		}
+
+		if (((child + 1) < heap->count) && (heap->data[child + 1].end < heap->data[child].end))
+		{
+			++child;
+		}
+
+		if (last.end <= heap->data[child].end)
+		{
+			break;
+		}
+
+		heap->data[index] = heap->data[child];
+		index = child;
+	}
+
+	if (heap->count > 0)
+	{
+		heap->data[index] = last;
+	}
+}
@@ -275,9 +275,10 @@ lasm_lexer_s lasm_lexer_new(lasm_arena_s* const arena, lasm_config_build_s* cons
 
 	return (const lasm_lexer_s)
 	{
-		.arena  = arena,
-		.config = config,
-		.file   = file,
+		.arena        = arena,
+		.tokens_arena = arena,
+		.config       = config,
+		.file         = file,
 		.token  = (lasm_token_s)
 		{
 			.type = lasm_token_type_none,
@@ -348,6 +349,19 @@ lasm_token_type_e lasm_lexer_lex(lasm_lexer_s* const lexer, lasm_token_s* const
 		// preprocessor:
 		case '#':
 		{
+			// note: the line directives of the preprocessor always start a line, so
+			// a '#' anywhere else is a symbolic token (e.g. rl78 immediates).
+			if (token->location.column != 1)
+			{
+				*token = lasm_token_new(lasm_token_type_symbolic_hash, start_location);
+				break;
+			}
+
+			// note: the file name is referenced by all of the following locations,
+			// so it must outlive the tokens arena.
+			lasm_arena_s* const tokens_arena = lexer->tokens_arena;
+			lexer->tokens_arena = lexer->arena;
+
 			const lasm_location_s column_location = lexer->location;
 			lasm_token_s line_token = lasm_token_new(lasm_token_type_none, lexer->location);
 
@@ -375,6 +389,7 @@ lasm_token_type_e lasm_lexer_lex(lasm_lexer_s* const lexer, lasm_token_s* const
 				.column = 1,
 			};
 
+			lexer->tokens_arena = tokens_arena;
 			_skip_entire_line(lexer);
 			return lasm_lexer_lex(lexer, token);
 		} break;
@@ -387,8 +402,27 @@ lasm_token_type_e lasm_lexer_lex(lasm_lexer_s* const lexer, lasm_token_s* const
 		case '\'': { (void)_lex_rune_literal_token(lexer, token);                                     } break;
 		case '\"': { (void)_lex_single_line_string_literal_token(lexer, token);                       } break;
 
+		// local labels
+		case '.':
+		{
+			const utf8char_t next = _next_utf8char(lexer, NULL, false);
+			_push_utf8char(lexer, next, false);
+
+			// note: a dot, that is directly followed by an identifier, starts the
+			// name of a local label (e.g. '.loop'), while any other dot is a symbolic
+			// token (e.g. the rl78 '.bit' suffix).
+			if (!_is_symbol_first_of_keyword_or_identifier(next))
+			{
+				*token = lasm_token_new(lasm_token_type_symbolic_dot, start_location);
+				break;
+			}
+
+			_append_buffer(lexer, ".", 1);
+			(void)_lex_keyword_or_identifier(lexer, token);
+			token->location = start_location;
+		} break;
+
 		// symbolic tokens
-		case '.':  { *token = lasm_token_new(lasm_token_type_symbolic_dot,           start_location); } break;
 		case ',':  { *token = lasm_token_new(lasm_token_type_symbolic_comma,         start_location); } break;
 		case '=':  { *token = lasm_token_new(lasm_token_type_symbolic_equal,         start_location); } break;
 		case ':':  { *token = lasm_token_new(lasm_token_type_symbolic_colon,         start_location); } break;
@@ -396,6 +430,16 @@ lasm_token_type_e lasm_lexer_lex(lasm_lexer_s* const lexer, lasm_token_s* const
 		case ']':  { *token = lasm_token_new(lasm_token_type_symbolic_right_bracket, start_location); } break;
 		case '+':  { *token = lasm_token_new(lasm_token_type_symbolic_plus,          start_location); } break;
 		case '-':  { *token = lasm_token_new(lasm_token_type_symbolic_minus,         start_location); } break;
+		case '(':  { *token = lasm_token_new(lasm_token_type_symbolic_left_paren,    start_location); } break;
+		case ')':  { *token = lasm_token_new(lasm_token_type_symbolic_right_paren,   start_location); } break;
+		case '&':  { *token = lasm_token_new(lasm_token_type_symbolic_ampersand,     start_location); } break;
+		case '|':  { *token = lasm_token_new(lasm_token_type_symbolic_pipe,          start_location); } break;
+		case '^':  { *token = lasm_token_new(lasm_token_type_symbolic_caret,         start_location); } break;
+		case '~':  { *token = lasm_token_new(lasm_token_type_symbolic_tilde,         start_location); } break;
+		case '!':  { *token = lasm_token_new(lasm_token_type_symbolic_exclamation,   start_location); } break;
+		case '$':  { *token = lasm_token_new(lasm_token_type_symbolic_dollar,        start_location); } break;
+		case '<':  { (void)_lex_2_symbols_token(lexer, token, c);                                     } break;
+		case '>':  { (void)_lex_2_symbols_token(lexer, token, c);                                     } break;
 
 		// unknown/invalid tokens
 		default:
@@ -654,7 +698,7 @@ static lasm_token_type_e _lex_keyword_or_identifier(lasm_lexer_s* const lexer, l
 	}
 
 	token->type = lasm_token_type_ident;
-	token->as.ident.data = lasm_arena_alloc(lexer->arena, lexer->buffer.length);
+	token->as.ident.data = lasm_arena_alloc(lexer->tokens_arena, lexer->buffer.length + 1);
 	lasm_debug_assert(token->as.ident.data != NULL);
 
 	for (uint64_t index = 0; index < lexer->buffer.length; ++index)
@@ -662,6 +706,8 @@ static lasm_token_type_e _lex_keyword_or_identifier(lasm_lexer_s* const lexer, l
 		token->as.ident.data[index] = lexer->buffer.data[index];
 	}
 
+	token->as.ident.data[lexer->buffer.length] = 0;
+
 	token->as.ident.length = lexer->buffer.length;
 	_clear_buffer(lexer);
 	return token->type;
@@ -1000,10 +1046,11 @@ static lasm_token_type_e _lex_single_line_string_literal_token(lasm_lexer_s* con
 	}
 
 	lasm_debug_assert(lexer->buffer.length > 0);
-	char_t* const data = (char_t* const)lasm_arena_alloc(lexer->arena, lexer->buffer.length);
+	char_t* const data = (char_t* const)lasm_arena_alloc(lexer->tokens_arena, lexer->buffer.length + 1);
 	lasm_debug_assert(data != NULL);
 
 	lasm_common_memcpy(data, lexer->buffer.data, lexer->buffer.length);
+	data[lexer->buffer.length] = 0;
 	token->type = lasm_token_type_literal_str;
 	token->as.str.length = lexer->buffer.length;
 	token->as.str.data = data;
@@ -1018,9 +1065,23 @@ static lasm_token_type_e _lex_2_symbols_token(lasm_lexer_s* const lexer, lasm_to
 	lasm_debug_assert(token != NULL);
 	lasm_debug_assert(c != lasm_utf8_invalid);
 
-	lasm_debug_assert('/' == c);
 	token->location = lexer->location;
 
+	if (('<' == c) || ('>' == c))
+	{
+		const utf8char_t first = c;
+
+		if ((c = _next_utf8char(lexer, NULL, false)) != first)
+		{
+			_log_lexer_error(token->location, "invalid token encountered: '%c', did you mean '%c%c'?", (char_t)first, (char_t)first, (char_t)first);
+		}
+
+		token->type = (('<' == first) ? lasm_token_type_symbolic_shift_left : lasm_token_type_symbolic_shift_right);
+		return token->type;
+	}
+
+	lasm_debug_assert('/' == c);
+
 	switch ((c = _next_utf8char(lexer, NULL, false)))
 	{
 		case '/':
@@ -0,0 +1,115 @@
+
+/**
+ * @file local.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-08-01
+ */
+
+#include "lasm/local.h"
+#include "lasm/debug.h"
+#include "lasm/logger.h"
+
+#include <stdio.h>
+
+#define _log_local_error(_location, _format, ...)                              \
+	do                                                                         \
+	{                                                                          \
+		(void)fprintf(stderr, "%s:%lu:%lu: ",                                  \
+			(_location).file, (_location).line, (_location).column);           \
+		lasm_logger_error(_format, ## __VA_ARGS__);                            \
+		lasm_common_exit(1);                                                   \
+	} while (0)
+
+bool_t lasm_local_parse(lasm_arena_s* const arena, lasm_ast_label_s* const label, uint64_t* const index)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(index != NULL);
+
+	const lasm_tokens_vector_s* const tokens = &label->body_tokens;
+
+	if (((*index + 1) >= tokens->count) || (tokens->data[*index].type != lasm_token_type_ident) ||
+		(tokens->data[*index].as.ident.data[0] != '.') || (tokens->data[*index + 1].type != lasm_token_type_symbolic_colon))
+	{
+		return false;
+	}
+
+	const lasm_token_s* const token = &tokens->data[*index];
+	uint64_t existing = 0;
+
+	if (lasm_local_find(label, token->as.ident.data, token->as.ident.length, &existing))
+	{
+		_log_local_error(token->location,
+			"local label '%s' is already defined at " lasm_location_fmt " in the body of label '%s'. each local label must have a unique name within its label.",
+			token->as.ident.data, lasm_location_arg(label->locals.data[existing].location), label->name
+		);
+	}
+
+	// note: the body tokens are released after the label is parsed, so the local
+	// label keeps its own copy of the name.
+	char_t* const name = (char_t* const)lasm_arena_alloc(arena, token->as.ident.length + 1);
+	lasm_debug_assert(name != NULL);
+
+	lasm_common_memcpy(name, token->as.ident.data, token->as.ident.length);
+	name[token->as.ident.length] = 0;
+
+	const lasm_ast_local_s local = (const lasm_ast_local_s)
+	{
+		.location = token->location,
+		.name     = name,
+		.length   = token->as.ident.length,
+		.inst     = label->ir.count,
+		.offset   = 0,
+	};
+
+	lasm_locals_vector_push(&label->locals, local);
+	*index += 2;
+	return true;
+}
+
+bool_t lasm_local_find(const lasm_ast_label_s* const label, const char_t* const name, const uint64_t length, uint64_t* const index)
+{
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(name != NULL);
+	lasm_debug_assert(index != NULL);
+
+	// note: a label defines only a few local labels, so they are searched in
+	// the order of their definitions.
+	for (uint64_t local = 0; local < label->locals.count; ++local)
+	{
+		const lasm_ast_local_s* const entry = &label->locals.data[local];
+
+		if ((entry->length == length) && (lasm_common_memcmp((const uint8_t*)entry->name, (const uint8_t*)name, length) == 0))
+		{
+			*index = local;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void lasm_locals_place(lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	uint64_t offset = 0, inst = 0;
+
+	for (uint64_t index = 0; index < label->locals.count; ++index)
+	{
+		lasm_ast_local_s* const local = lasm_locals_vector_at(&label->locals, index);
+		lasm_debug_assert(local->inst <= label->ir.count);
+
+		for (; inst < local->inst; ++inst)
+		{
+			offset += label->ir.data[inst].size;
+		}
+
+		local->offset = offset;
+	}
+}
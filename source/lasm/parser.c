@@ -11,10 +11,17 @@
  */
 
 #include "lasm/parser.h"
+#include "lasm/expr.h"
+#include "lasm/fixup.h"
+#include "lasm/local.h"
+#include "lasm/data.h"
 #include "lasm/debug.h"
 #include "lasm/logger.h"
 #include "lasm/archs/z80_parser.h"
+#include "lasm/archs/z80_encoder.h"
+#include "lasm/archs/z80_peephole.h"
 #include "lasm/archs/rl78_parser.h"
+#include "lasm/archs/rl78_encoder.h"
 
 #define _log_parser_note(_location, _format, ...)                              \
 	do                                                                         \
@@ -41,18 +48,86 @@
 		lasm_common_exit(1);                                                   \
 	} while (0)
 
-static void _parse_label_attr_addr(lasm_parser_s* const parser, lasm_ast_label_s* const label);
+static lasm_token_type_e _lex_token(lasm_parser_s* const parser, lasm_token_s* const token);
 
-static void _parse_label_attr_align(lasm_parser_s* const parser, lasm_ast_label_s* const label);
+static void _set_attr_uval(lasm_ast_attr_s* const attr, const uint64_t value);
 
-static void _parse_label_attr_size(lasm_parser_s* const parser, lasm_ast_label_s* const label);
+static void _check_attr_align(const lasm_location_s location, const uint64_t value);
 
-static void _parse_label_attr_perm(lasm_parser_s* const parser, lasm_ast_label_s* const label);
+static void _parse_attr_uval_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens);
+
+static void _parse_attr_align_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens);
+
+static void _parse_attr_perm_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens);
+
+static void _parse_attr_region_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens);
+
+static void _parse_attr_cycles_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens);
+
+static void _collect_attr_value_tokens(lasm_parser_s* const parser, const lasm_token_s* const equal);
+
+static lasm_ast_attr_type_e _attr_type_from_keyword(const lasm_token_type_e keyword);
+
+static void _parse_label_attrs(lasm_parser_s* const parser, lasm_ast_label_s* const label);
+
+static uint64_t _parse_region_uval_value(lasm_parser_s* const parser, const lasm_token_s* const keyword);
+
+static void _parse_region(lasm_parser_s* const parser, const lasm_token_s* const keyword);
+
+static void _check_region_bank(const lasm_parser_s* const parser, const lasm_ast_region_s* const region, const bool_t has_bank, const bool_t has_port);
 
 static bool_t _parse_label_header(lasm_parser_s* const parser, lasm_ast_label_s* const label);
 
 static void _parse_label_body(lasm_parser_s* const parser, lasm_ast_label_s* const label);
 
+static bool_t _is_string_body(const lasm_ast_label_s* const label);
+
+static void _lower_string_body(lasm_parser_s* const parser, lasm_ast_label_s* const label);
+
+static void _encode_label_body(lasm_parser_s* const parser, lasm_ast_label_s* const label, const bool_t banked);
+
+#define _attrs_list_example                                                    \
+	"  |\n"                                                                    \
+	"2 |     [addr=<value>, align=<value>, size=<value>, perm=<value>,]\n"     \
+	"3 |     example:\n"                                                       \
+	"4 |         ; ...\n"                                                      \
+	"5 |     end\n"                                                            \
+	"  |\n"
+
+#define _region_example                                                        \
+	"  |\n"                                                                    \
+	"1 |     region rom [origin=<value>, length=<value>, perm=<value>,]\n"      \
+	"  |\n"
+
+#define _banked_region_example                                                 \
+	"  |\n"                                                                    \
+	"1 |     region rom1 [origin=<value>, length=<value>, perm=<value>, bank=<value>, port=<value>,]\n" \
+	"  |\n"
+
+typedef void (*_attr_value_parser_f)(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens);
+
+typedef struct
+{
+	lasm_token_type_e keyword;
+	bool_t required;
+	_attr_value_parser_f parse_value;
+} _attr_descriptor_s;
+
+static const _attr_descriptor_s _g_attr_descriptors[lasm_ast_attr_types_count] =
+{
+	[lasm_ast_attr_type_addr]   = { .keyword = lasm_token_type_keyword_addr,   .required = true,  .parse_value = _parse_attr_uval_value   },
+	[lasm_ast_attr_type_align]  = { .keyword = lasm_token_type_keyword_align,  .required = true,  .parse_value = _parse_attr_align_value  },
+	[lasm_ast_attr_type_size]   = { .keyword = lasm_token_type_keyword_size,   .required = true,  .parse_value = _parse_attr_uval_value   },
+	[lasm_ast_attr_type_perm]   = { .keyword = lasm_token_type_keyword_perm,   .required = true,  .parse_value = _parse_attr_perm_value   },
+	[lasm_ast_attr_type_region] = { .keyword = lasm_token_type_keyword_region, .required = false, .parse_value = _parse_attr_region_value },
+	[lasm_ast_attr_type_cycles] = { .keyword = lasm_token_type_keyword_cycles, .required = false, .parse_value = _parse_attr_cycles_value },
+};
+
+_Static_assert(
+	lasm_ast_attr_types_count == 6,
+	"_g_attr_descriptors is not in sync with lasm_ast_attr_type_e enum!"
+);
+
 lasm_parser_s lasm_parser_new(lasm_arena_s* const arena, lasm_config_build_s* const config)
 {
 	lasm_debug_assert(arena != NULL);
@@ -60,9 +135,15 @@ lasm_parser_s lasm_parser_new(lasm_arena_s* const arena, lasm_config_build_s* co
 
 	return (lasm_parser_s)
 	{
-		.arena  = arena,
-		.config = config,
-		.lexer  = lasm_lexer_new(arena, config),
+		.arena          = arena,
+		.config         = config,
+		.tokens_arena   = lasm_arena_new(),
+		.lexer          = lasm_lexer_new(arena, config),
+		.cache          = lasm_cache_load(arena, config),
+		.regions        = lasm_regions_vector_new(arena, 1),
+		.symtab         = lasm_symtab_new(arena),
+		.regions_symtab = lasm_symtab_new(arena),
+		.attr_tokens    = lasm_tokens_vector_new(arena, 8),
 	};
 }
 
@@ -70,6 +151,7 @@ void lasm_parser_drop(lasm_parser_s* const parser)
 {
 	lasm_debug_assert(parser != NULL);
 	lasm_lexer_drop(&parser->lexer);
+	lasm_arena_drop(&parser->tokens_arena);
 }
 
 void lasm_parser_shallow_parse(lasm_parser_s* const parser)
@@ -81,6 +163,22 @@ void lasm_parser_shallow_parse(lasm_parser_s* const parser)
 
 	while (_parse_label_header(parser, &label))
 	{
+		uint64_t existing = 0;
+
+		if (!lasm_symtab_insert(&parser->symtab, label.name, lasm_common_strlen(label.name), parser->labels.count, &existing))
+		{
+			_log_parser_error(label.location,
+				"label '%s' is already defined at " lasm_location_fmt ". each label must have a unique name.",
+				label.name, lasm_location_arg(parser->labels.data[existing].location)
+			);
+		}
+
+		_parse_label_body(parser, &label);
+
+		parser->tokens_released += parser->tokens_arena.size;
+		lasm_arena_drop(&parser->tokens_arena);
+		label.body_tokens = (lasm_tokens_vector_s) {0};
+
 		lasm_labels_vector_push(&parser->labels, label);
 	}
 }
@@ -89,350 +187,632 @@ lasm_labels_vector_s lasm_parser_deep_parse(lasm_parser_s* const parser)
 {
 	lasm_debug_assert(parser != NULL);
 
+	bool_t banked = false;
+
+	for (uint64_t index = 0; index < parser->regions.count; ++index)
+	{
+		banked |= (parser->regions.data[index].bank != lasm_ast_bank_none);
+	}
+
 	for (uint64_t index = 0; index < parser->labels.count; ++index)
 	{
 		lasm_ast_label_s* const label = lasm_labels_vector_at(&parser->labels, index);
-		_parse_label_body(parser, label);
+
+		if (!label->cached && !label->strings)
+		{
+			_encode_label_body(parser, label, banked);
+		}
 	}
 
+	lasm_fixups_bind(&parser->labels, &parser->symtab);
+	lasm_cache_store(&parser->cache, &parser->labels);
+
 	return parser->labels;
 }
 
-static void _parse_label_attr_addr(lasm_parser_s* const parser, lasm_ast_label_s* const label)
+static lasm_token_type_e _lex_token(lasm_parser_s* const parser, lasm_token_s* const token)
 {
 	lasm_debug_assert(parser != NULL);
-	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(token != NULL);
 
-	lasm_token_s token = lasm_token_new(lasm_token_type_none, parser->lexer.location);
+	// note: an unlexed token was already folded into the fingerprint when it
+	// was lexed for the first time.
+	const bool_t unlexed = (parser->lexer.token.type != lasm_token_type_none);
+	const lasm_token_type_e type = lasm_lexer_lex(&parser->lexer, token);
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_keyword_addr)
+	if (!unlexed)
 	{
-		_log_parser_error(token.location,
-			"expected a 'addr' keyword after symbolic token '[', but found '%s' token. the attributes list have a specific order that must be followed. follow the example below:\n" \
-			"  |                                                                                                                                                                 \n" \
-			"2 |     [%saddr%s=<value>, align=<value>, size=<value>, perm=<value>,]                                                                                              \n" \
-			"  |      %s^~~~ expected the 'addr' keyword as the first attribute in the attributes list.%s                                                                        \n" \
-			"3 |     example:                                                                                                                                                    \n" \
-			"4 |         ; ...                                                                                                                                                   \n" \
-			"5 |     end                                                                                                                                                         \n" \
-			"  |                                                                                                                                                                 \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
-		);
+		parser->fingerprint = lasm_token_fingerprint(parser->fingerprint, token);
 	}
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_equal)
+	return type;
+}
+
+static void _set_attr_uval(lasm_ast_attr_s* const attr, const uint64_t value)
+{
+	lasm_debug_assert(attr != NULL);
+
+	switch (attr->type)
 	{
-		_log_parser_error(token.location,
-			"expected a '=' symbol token after 'addr' keyword, but found '%s' token. each attribute in the list of attributes must have a value assigned to it. follow the example below:\n" \
-			"  |                                                                                                                                                                         \n" \
-			"2 |     [addr%s=%s<value>, align=<value>, size=<value>, perm=<value>,]                                                                                                      \n" \
-			"  |          %s^~~~ expected a '=' symbol to follow after the 'addr' keyword.%s                                                                                             \n" \
-			"3 |     example:                                                                                                                                                            \n" \
-			"4 |         ; ...                                                                                                                                                           \n" \
-			"5 |     end                                                                                                                                                                 \n" \
-			"  |                                                                                                                                                                         \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+		case lasm_ast_attr_type_addr:   { attr->as.addr.value   = value; } break;
+		case lasm_ast_attr_type_align:  { attr->as.align.value  = value; } break;
+		case lasm_ast_attr_type_size:   { attr->as.size.value   = value; } break;
+		case lasm_ast_attr_type_cycles: { attr->as.cycles.value = value; } break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+		} break;
+	}
+}
+
+static void _check_attr_align(const lasm_location_s location, const uint64_t value)
+{
+	if (value > 8)
+	{
+		_log_parser_error(location,
+			"align attribute value cannot exceed 8, but found value %lu specified for align attribute.",
+			value
 		);
 	}
+}
 
-	(void)lasm_lexer_lex(&parser->lexer, &token);
+static void _parse_attr_uval_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(attr != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(tokens->count > 0);
 
-	if ((token.type != lasm_token_type_keyword_auto) && (token.type != lasm_token_type_literal_uval))
+	if (lasm_token_type_keyword_auto == tokens->data[0].type)
 	{
-		_log_parser_error(token.location,
-			"expected an 'auto' keyword or a numeric value for the 'addr' attribute, but found '%s' token.",
-			lasm_token_type_to_string(token.type)
+		if (tokens->count > 1)
+		{
+			_log_parser_error(tokens->data[1].location,
+				"expected a ',' or ']' symbolic token after the 'auto' keyword of the '%s' attribute, but found '%s' token. 'auto' cannot be a part of an expression.",
+				lasm_token_type_to_string(_g_attr_descriptors[attr->type].keyword),
+				lasm_token_type_to_string(tokens->data[1].type)
+			);
+		}
+
+		attr->inferred = true;
+		_set_attr_uval(attr, 0);
+		return;
+	}
+
+	uint64_t index = 0;
+	attr->expr = lasm_expr_parse(parser->arena, tokens, &index);
+
+	if (index < tokens->count)
+	{
+		_log_parser_error(tokens->data[index].location,
+			"unexpected '%s' token in the value of the '%s' attribute. expected an 'auto' keyword or an expression, followed by a ',' or ']' symbolic token.",
+			lasm_token_type_to_string(tokens->data[index].type),
+			lasm_token_type_to_string(_g_attr_descriptors[attr->type].keyword)
 		);
 	}
 
-	label->attrs[lasm_ast_attr_type_addr] = (const lasm_ast_attr_s)
+	attr->inferred = false;
+	_set_attr_uval(attr, attr->expr->folded ? attr->expr->value : 0);
+}
+
+static void _parse_attr_align_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(attr != NULL);
+	lasm_debug_assert(tokens != NULL);
+
+	_parse_attr_uval_value(parser, attr, tokens);
+
+	if (!attr->inferred && attr->expr->folded)
+	{
+		_check_attr_align(attr->expr->location, attr->as.align.value);
+	}
+}
+
+static void _parse_attr_perm_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(attr != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(tokens->count > 0);
+
+	const lasm_token_s* const token = &tokens->data[0];
+	lasm_ast_perm_type_e perm_type = lasm_ast_perm_type_none;
+
+	switch (token->type)
 	{
-		.type     = lasm_ast_attr_type_addr,
-		.inferred = (lasm_token_type_keyword_auto == token.type),
-		.as.addr  = (const lasm_ast_attr_addr_s)
+		case lasm_token_type_keyword_r:    { perm_type = lasm_ast_perm_type_r;    } break;
+		case lasm_token_type_keyword_rw:   { perm_type = lasm_ast_perm_type_rw;   } break;
+		case lasm_token_type_keyword_rx:   { perm_type = lasm_ast_perm_type_rx;   } break;
+		case lasm_token_type_keyword_rwx:  { perm_type = lasm_ast_perm_type_rwx;  } break;
+		case lasm_token_type_keyword_auto: { perm_type = lasm_ast_perm_type_none; } break;
+
+		default:
 		{
-			.value = (lasm_token_type_keyword_auto == token.type ? 0 : token.as.uval),
-		},
-	};
+			_log_parser_error(token->location,
+				"expected an 'auto' keyword or any of the 'r', 'rw', 'rx', or 'rwx' keywords for the 'perm' attribute, but found '%s' token.",
+				lasm_token_type_to_string(token->type)
+			);
+		} break;
+	}
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_comma)
+	if (tokens->count > 1)
 	{
-		_log_parser_error(token.location,
-			"expected a ',' symbolic token after the 'addr' attribute's value, but found '%s' token. attributes must have a trailing ',' after their values. follow the example below:\n" \
-			"  |                                                                                                                                                                      \n" \
-			"2 |     [addr=<value>%s,%s align=<value>, size=<value>, perm=<value>,]                                                                                                   \n" \
-			"  |                  %s^~~~ expected a ',' symbol to follow after the 'addr' attribute value.%s                                                                          \n" \
-			"3 |     example:                                                                                                                                                         \n" \
-			"4 |         ; ...                                                                                                                                                        \n" \
-			"5 |     end                                                                                                                                                              \n" \
-			"  |                                                                                                                                                                      \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+		_log_parser_error(tokens->data[1].location,
+			"expected a ',' or ']' symbolic token after the value of the 'perm' attribute, but found '%s' token.",
+			lasm_token_type_to_string(tokens->data[1].type)
 		);
 	}
+
+	attr->inferred = (lasm_token_type_keyword_auto == token->type);
+	attr->as.perm.value = perm_type;
 }
 
-static void _parse_label_attr_align(lasm_parser_s* const parser, lasm_ast_label_s* const label)
+static void _parse_attr_region_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens)
 {
 	lasm_debug_assert(parser != NULL);
-	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(attr != NULL);
+	lasm_debug_assert(tokens != NULL);
+	lasm_debug_assert(tokens->count > 0);
 
-	lasm_token_s token = lasm_token_new(lasm_token_type_none, parser->lexer.location);
+	const lasm_token_s* const token = &tokens->data[0];
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_keyword_align)
+	if ((token->type != lasm_token_type_ident) && (token->type != lasm_token_type_keyword_auto))
 	{
-		_log_parser_error(token.location,
-			"expected a 'align' keyword as the second attribute, but found '%s' token. the attributes list have a specific order that must be followed. follow the example below:\n" \
-			"  |                                                                                                                                                                 \n" \
-			"2 |     [addr=<value>, %salign%s=<value>, size=<value>, perm=<value>,]                                                                                              \n" \
-			"  |                    %s^~~~ expected the 'align' keyword as the second attribute in the attributes list.%s                                                        \n" \
-			"3 |     example:                                                                                                                                                    \n" \
-			"4 |         ; ...                                                                                                                                                   \n" \
-			"5 |     end                                                                                                                                                         \n" \
-			"  |                                                                                                                                                                 \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+		_log_parser_error(token->location,
+			"expected an 'auto' keyword or a region identifier for the 'region' attribute, but found '%s' token.",
+			lasm_token_type_to_string(token->type)
 		);
 	}
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_equal)
+	if (tokens->count > 1)
 	{
-		_log_parser_error(token.location,
-			"expected a '=' symbol token after 'align' keyword, but found '%s' token. each attribute in the list of attributes must have a value assigned to it. follow the example below:\n" \
-			"  |                                                                                                                                                                         \n" \
-			"2 |     [addr=<value>, align%s=%s<value>, size=<value>, perm=<value>,]                                                                                                      \n" \
-			"  |                         %s^~~~ expected a '=' symbol to follow after the 'align' keyword.%s                                                                             \n" \
-			"3 |     example:                                                                                                                                                            \n" \
-			"4 |         ; ...                                                                                                                                                           \n" \
-			"5 |     end                                                                                                                                                                 \n" \
-			"  |                                                                                                                                                                         \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+		_log_parser_error(tokens->data[1].location,
+			"expected a ',' or ']' symbolic token after the value of the 'region' attribute, but found '%s' token.",
+			lasm_token_type_to_string(tokens->data[1].type)
 		);
 	}
 
-	(void)lasm_lexer_lex(&parser->lexer, &token);
+	attr->inferred = (lasm_token_type_keyword_auto == token->type);
+	attr->as.region.value = lasm_ast_region_none;
+	attr->as.region.name = NULL;
+	attr->as.region.bank = lasm_ast_bank_none;
 
-	if ((token.type != lasm_token_type_keyword_auto) && (token.type != lasm_token_type_literal_uval))
+	if (attr->inferred)
 	{
-		_log_parser_error(token.location,
-			"expected an 'auto' keyword or a numeric value for the 'align' attribute, but found '%s' token.",
-			lasm_token_type_to_string(token.type)
-		);
+		return;
 	}
 
-	if (lasm_token_type_literal_uval == token.type)
+	uint64_t index = 0;
+
+	if (!lasm_symtab_find(&parser->regions_symtab, token->as.ident.data, token->as.ident.length, &index))
 	{
-		if (token.as.uval > 8)
-		{
-			_log_parser_error(token.location,
-				"align attribute value cannot exceed 8, but found value %lu specified for align attribute.",
-				token.as.uval
-			);
-		}
+		_log_parser_error(token->location,
+			"unknown region '%s' referenced in the 'region' attribute. regions must be declared before the labels, that are placed in them. follow the example below:\n"
+			_region_example,
+			token->as.ident.data
+		);
 	}
 
-	label->attrs[lasm_ast_attr_type_align] = (const lasm_ast_attr_s)
-	{
-		.type     = lasm_ast_attr_type_align,
-		.inferred = (lasm_token_type_keyword_auto == token.type),
-		.as.align = (const lasm_ast_attr_align_s)
-		{
-			.value = (lasm_token_type_keyword_auto == token.type ? 0 : token.as.uval),
-		},
-	};
+	attr->as.region.value = index;
+	attr->as.region.name = parser->regions.data[index].name;
+	attr->as.region.bank = parser->regions.data[index].bank;
+}
+
+static void _parse_attr_cycles_value(lasm_parser_s* const parser, lasm_ast_attr_s* const attr, const lasm_tokens_vector_s* const tokens)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(attr != NULL);
+	lasm_debug_assert(tokens != NULL);
+
+	_parse_attr_uval_value(parser, attr, tokens);
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_comma)
+	// note: the budget is verified after the layout, but it does not depend on
+	// it, so it must be known while parsing.
+	if (!attr->inferred && !attr->expr->folded)
 	{
-		_log_parser_error(token.location,
-			"expected a ',' symbolic token after the 'align' attribute's value, but found '%s' token. attributes must have a trailing ',' after their values. follow the example below:\n" \
-			"  |                                                                                                                                                                       \n" \
-			"2 |     [addr=<value>, align=<value>%s,%s size=<value>, perm=<value>,]                                                                                                    \n" \
-			"  |                                 %s^~~~ expected a ',' symbol to follow after the 'align' attribute value.%s                                                           \n" \
-			"3 |     example:                                                                                                                                                          \n" \
-			"4 |         ; ...                                                                                                                                                         \n" \
-			"5 |     end                                                                                                                                                               \n" \
-			"  |                                                                                                                                                                       \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+		_log_parser_error(attr->expr->location,
+			"value of the 'cycles' attribute must be a constant expression, that does not reference any labels."
 		);
 	}
 }
 
-static void _parse_label_attr_size(lasm_parser_s* const parser, lasm_ast_label_s* const label)
+static void _collect_attr_value_tokens(lasm_parser_s* const parser, const lasm_token_s* const equal)
 {
 	lasm_debug_assert(parser != NULL);
-	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(equal != NULL);
 
 	lasm_token_s token = lasm_token_new(lasm_token_type_none, parser->lexer.location);
+	uint64_t depth = 0;
+	parser->attr_tokens.count = 0;
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_keyword_size)
+	while (!lasm_lexer_should_stop(_lex_token(parser, &token)))
 	{
-		_log_parser_error(token.location,
-			"expected a 'size' keyword as the third attribute, but found '%s' token. the attributes list have a specific order that must be followed. follow the example below:\n" \
-			"  |                                                                                                                                                               \n" \
-			"2 |     [addr=<value>, align=<value>, %ssize%s=<value>, perm=<value>,]                                                                                            \n" \
-			"  |                                   %s^~~~ expected the 'size' keyword as the third attribute in the attributes list.%s                                         \n" \
-			"3 |     example:                                                                                                                                                  \n" \
-			"4 |         ; ...                                                                                                                                                 \n" \
-			"5 |     end                                                                                                                                                       \n" \
-			"  |                                                                                                                                                               \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
-		);
+		if (((0 == depth) && (lasm_token_type_symbolic_comma == token.type)) || (lasm_token_type_symbolic_right_bracket == token.type))
+		{
+			break;
+		}
+
+		if (lasm_token_type_symbolic_left_paren == token.type)
+		{
+			++depth;
+		}
+		else if ((lasm_token_type_symbolic_right_paren == token.type) && (depth > 0))
+		{
+			--depth;
+		}
+
+		lasm_tokens_vector_push(&parser->attr_tokens, token);
 	}
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_equal)
+	if (lasm_lexer_should_stop(token.type))
 	{
 		_log_parser_error(token.location,
-			"expected a '=' symbol token after 'size' keyword, but found '%s' token. each attribute in the list of attributes must have a value assigned to it. follow the example below:\n" \
-			"  |                                                                                                                                                                         \n" \
-			"2 |     [addr=<value>, align=<value>, size%s=%s<value>, perm=<value>,]                                                                                                      \n" \
-			"  |                                       %s^~~~ expected a '=' symbol to follow after the 'size' keyword.%s                                                                \n" \
-			"3 |     example:                                                                                                                                                            \n" \
-			"4 |         ; ...                                                                                                                                                           \n" \
-			"5 |     end                                                                                                                                                                 \n" \
-			"  |                                                                                                                                                                         \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+			"unexpected end of file in the attributes list. expected a ']' symbolic token to close the attributes list. follow the example below:\n"
+			_attrs_list_example
 		);
 	}
 
-	(void)lasm_lexer_lex(&parser->lexer, &token);
+	lasm_lexer_unlex(&parser->lexer, &token);
 
-	if ((token.type != lasm_token_type_keyword_auto) && (token.type != lasm_token_type_literal_uval))
+	if (0 == parser->attr_tokens.count)
 	{
-		_log_parser_error(token.location,
-			"expected an 'auto' keyword or a numeric value for the 'size' attribute, but found '%s' token.",
+		_log_parser_error(equal->location,
+			"expected a value after the '=' symbolic token, but found '%s' token. each attribute in the list of attributes must have a value assigned to it. follow the example below:\n"
+			_attrs_list_example,
 			lasm_token_type_to_string(token.type)
 		);
 	}
+}
 
-	label->attrs[lasm_ast_attr_type_size] = (const lasm_ast_attr_s)
+static lasm_ast_attr_type_e _attr_type_from_keyword(const lasm_token_type_e keyword)
+{
+	for (uint64_t index = 0; index < lasm_ast_attr_types_count; ++index)
 	{
-		.type     = lasm_ast_attr_type_size,
-		.inferred = (lasm_token_type_keyword_auto == token.type),
-		.as.size  = (const lasm_ast_attr_size_s)
+		if (_g_attr_descriptors[index].keyword == keyword)
 		{
-			.value = (lasm_token_type_keyword_auto == token.type ? 0 : token.as.uval),
-		},
+			return (lasm_ast_attr_type_e)index;
+		}
+	}
+
+	return lasm_ast_attr_types_count;
+}
+
+static void _parse_label_attrs(lasm_parser_s* const parser, lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(label != NULL);
+
+	_Static_assert(lasm_ast_attr_types_count <= 32, "attributes bitmask cannot hold all of the lasm_ast_attr_type_e enum values!");
+	lasm_location_s locations[lasm_ast_attr_types_count] = {0};
+	uint32_t present = 0;
+	bool_t trailing_comma = true;
+
+	// note: the optional attributes are inferred, unless they are specified.
+	label->attrs[lasm_ast_attr_type_region] = (const lasm_ast_attr_s)
+	{
+		.type      = lasm_ast_attr_type_region,
+		.inferred  = true,
+		.as.region = { .value = lasm_ast_region_none, .name = NULL, .bank = lasm_ast_bank_none, },
 	};
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_comma)
+	label->attrs[lasm_ast_attr_type_cycles] = (const lasm_ast_attr_s)
 	{
-		_log_parser_error(token.location,
-			"expected a ',' symbolic token after the 'size' attribute's value, but found '%s' token. attributes must have a trailing ',' after their values. follow the example below:\n" \
-			"  |                                                                                                                                                                      \n" \
-			"2 |     [addr=<value>, align=<value>, size=<value>%s,%s perm=<value>,]                                                                                                   \n" \
-			"  |                                               %s^~~~ expected a ',' symbol to follow after the 'size' attribute value.%s                                             \n" \
-			"3 |     example:                                                                                                                                                         \n" \
-			"4 |         ; ...                                                                                                                                                        \n" \
-			"5 |     end                                                                                                                                                              \n" \
-			"  |                                                                                                                                                                      \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+		.type     = lasm_ast_attr_type_cycles,
+		.inferred = true,
+	};
+
+	lasm_token_s token = lasm_token_new(lasm_token_type_none, parser->lexer.location);
+
+	while (_lex_token(parser, &token) != lasm_token_type_symbolic_right_bracket)
+	{
+		if (!trailing_comma)
+		{
+			_log_parser_error(token.location,
+				"expected a ',' or ']' symbolic token after an attribute's value, but found '%s' token. attributes in the list must be separated with ',' symbolic tokens. follow the example below:\n"
+				_attrs_list_example,
+				lasm_token_type_to_string(token.type)
+			);
+		}
+
+		const lasm_ast_attr_type_e type = _attr_type_from_keyword(token.type);
+
+		if (lasm_ast_attr_types_count == type)
+		{
+			_log_parser_error(token.location,
+				"expected an attribute keyword or a symbolic token ']', but found '%s' token. supported attributes are 'addr', 'align', 'size', 'perm', and the optional 'region' and 'cycles', and they may appear in any order. follow the example below:\n"
+				_attrs_list_example,
+				lasm_token_type_to_string(token.type)
+			);
+		}
+
+		const _attr_descriptor_s* const descriptor = &_g_attr_descriptors[type];
+		const char_t* const name = lasm_token_type_to_string(descriptor->keyword);
+
+		if (present & (1u << type))
+		{
+			_log_parser_error(token.location,
+				"the '%s' attribute is specified more than once in the attributes list. it was already specified at " lasm_location_fmt ".",
+				name, lasm_location_arg(locations[type])
+			);
+		}
+
+		present |= (1u << type);
+		locations[type] = token.location;
+
+		if (_lex_token(parser, &token) != lasm_token_type_symbolic_equal)
+		{
+			_log_parser_error(token.location,
+				"expected a '=' symbol token after '%s' keyword, but found '%s' token. each attribute in the list of attributes must have a value assigned to it. follow the example below:\n"
+				_attrs_list_example,
+				name, lasm_token_type_to_string(token.type)
+			);
+		}
+
+		lasm_ast_attr_s* const attr = &label->attrs[type];
+		*attr = (const lasm_ast_attr_s) { .type = type, };
+
+		_collect_attr_value_tokens(parser, &token);
+		descriptor->parse_value(parser, attr, &parser->attr_tokens);
+
+		trailing_comma = (_lex_token(parser, &token) == lasm_token_type_symbolic_comma);
+
+		if (!trailing_comma)
+		{
+			lasm_lexer_unlex(&parser->lexer, &token);
+		}
+	}
+
+	for (uint64_t index = 0; index < lasm_ast_attr_types_count; ++index)
+	{
+		if (_g_attr_descriptors[index].required && !(present & (1u << index)))
+		{
+			_log_parser_error(token.location,
+				"the attributes list is missing the '%s' attribute, which is required for every label. follow the example below:\n"
+				_attrs_list_example,
+				lasm_token_type_to_string(_g_attr_descriptors[index].keyword)
+			);
+		}
+	}
+
+	if (!trailing_comma)
+	{
+		_log_parser_note(token.location,
+			"even thought it is not enforced by an error, it is a standard and a good practice to trail each attribute with a comma. follow the example below:\n"
+			_attrs_list_example
 		);
 	}
 }
 
-static void _parse_label_attr_perm(lasm_parser_s* const parser, lasm_ast_label_s* const label)
+static uint64_t _parse_region_uval_value(lasm_parser_s* const parser, const lasm_token_s* const keyword)
 {
 	lasm_debug_assert(parser != NULL);
-	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(keyword != NULL);
+
+	const lasm_tokens_vector_s* const tokens = &parser->attr_tokens;
+	uint64_t index = 0;
+	const lasm_ast_expr_s* const expr = lasm_expr_parse(parser->arena, tokens, &index);
+
+	if (index < tokens->count)
+	{
+		_log_parser_error(tokens->data[index].location,
+			"unexpected '%s' token in the value of the '%s' attribute of the region. expected an expression, followed by a ',' or ']' symbolic token.",
+			lasm_token_type_to_string(tokens->data[index].type),
+			lasm_token_type_to_string(keyword->type)
+		);
+	}
+
+	if (!expr->folded)
+	{
+		_log_parser_error(expr->location,
+			"the value of the '%s' attribute of the region must be a constant expression, as the regions are declared before any label is laid out.",
+			lasm_token_type_to_string(keyword->type)
+		);
+	}
+
+	return expr->value;
+}
+
+static void _parse_region(lasm_parser_s* const parser, const lasm_token_s* const keyword)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(keyword != NULL);
+
+	lasm_ast_region_s region = (lasm_ast_region_s)
+	{
+		.location = keyword->location,
+		.perm     = lasm_ast_perm_type_none,
+		.bank     = lasm_ast_bank_none,
+		.port     = 0,
+	};
 
 	lasm_token_s token = lasm_token_new(lasm_token_type_none, parser->lexer.location);
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_keyword_perm)
+	if (_lex_token(parser, &token) != lasm_token_type_ident)
 	{
 		_log_parser_error(token.location,
-			"expected a 'perm' keyword as the third attribute, but found '%s' token. the attributes list have a specific order that must be followed. follow the example below:\n" \
-			"  |                                                                                                                                                               \n" \
-			"2 |     [addr=<value>, align=<value>, size=<value>, %sperm%s=<value>,]                                                                                            \n" \
-			"  |                                                 %s^~~~ expected the 'perm' keyword as the fourth attribute in the attributes list.%s                          \n" \
-			"3 |     example:                                                                                                                                                  \n" \
-			"4 |         ; ...                                                                                                                                                 \n" \
-			"5 |     end                                                                                                                                                       \n" \
-			"  |                                                                                                                                                               \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+			"expected an identifier token after the 'region' keyword, but found '%s' token. a region name must follow the 'region' keyword. follow the example below:\n"
+			_region_example,
+			lasm_token_type_to_string(token.type)
 		);
 	}
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_equal)
+	region.name = token.as.ident.data;
+	uint64_t existing = 0;
+
+	if (!lasm_symtab_insert(&parser->regions_symtab, region.name, token.as.ident.length, parser->regions.count, &existing))
 	{
 		_log_parser_error(token.location,
-			"expected a '=' symbol token after 'size' keyword, but found '%s' token. each attribute in the list of attributes must have a value assigned to it. follow the example below:\n" \
-			"  |                                                                                                                                                                         \n" \
-			"2 |     [addr=<value>, align=<value>, size=<value>, perm%s=%s<value>,]                                                                                                      \n" \
-			"  |                                                     %s^~~~ expected a '=' symbol to follow after the 'perm' keyword.%s                                                  \n" \
-			"3 |     example:                                                                                                                                                            \n" \
-			"4 |         ; ...                                                                                                                                                           \n" \
-			"5 |     end                                                                                                                                                                 \n" \
-			"  |                                                                                                                                                                         \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
+			"region '%s' is already declared at " lasm_location_fmt ". each region must have a unique name.",
+			region.name, lasm_location_arg(parser->regions.data[existing].location)
 		);
 	}
 
-	lasm_ast_perm_type_e perm_type = lasm_ast_perm_type_none;
-	(void)lasm_lexer_lex(&parser->lexer, &token);
+	if (_lex_token(parser, &token) != lasm_token_type_symbolic_left_bracket)
+	{
+		_log_parser_error(token.location,
+			"expected a symbolic token '[' after the region's identifier, but found '%s' token. a region must have an attributes list. follow the example below:\n"
+			_region_example,
+			lasm_token_type_to_string(token.type)
+		);
+	}
+
+	uint32_t present = 0;
 
-	switch (token.type)
+	while (_lex_token(parser, &token) != lasm_token_type_symbolic_right_bracket)
 	{
-		case lasm_token_type_keyword_r:    { perm_type = lasm_ast_perm_type_r;    } break;
-		case lasm_token_type_keyword_rw:   { perm_type = lasm_ast_perm_type_rw;   } break;
-		case lasm_token_type_keyword_rx:   { perm_type = lasm_ast_perm_type_rx;   } break;
-		case lasm_token_type_keyword_rwx:  { perm_type = lasm_ast_perm_type_rwx;  } break;
-		case lasm_token_type_keyword_auto: { perm_type = lasm_ast_perm_type_none; } break;
+		const lasm_token_s attr_keyword = token;
+		uint32_t bit = 0;
 
-		default:
+		switch (attr_keyword.type)
+		{
+			case lasm_token_type_keyword_origin: { bit = 0x1; } break;
+			case lasm_token_type_keyword_length: { bit = 0x2; } break;
+			case lasm_token_type_keyword_perm:   { bit = 0x4; } break;
+			case lasm_token_type_keyword_bank:   { bit = 0x8; } break;
+			case lasm_token_type_keyword_port:   { bit = 0x10; } break;
+
+			default:
+			{
+				_log_parser_error(attr_keyword.location,
+					"expected a region attribute keyword or a symbolic token ']', but found '%s' token. supported region attributes are 'origin', 'length', 'perm', and the optional 'bank' and 'port'. follow the example below:\n"
+					_region_example,
+					lasm_token_type_to_string(attr_keyword.type)
+				);
+			} break;
+		}
+
+		if (present & bit)
+		{
+			_log_parser_error(attr_keyword.location,
+				"the '%s' attribute is specified more than once in the attributes list of the region.",
+				lasm_token_type_to_string(attr_keyword.type)
+			);
+		}
+
+		present |= bit;
+
+		if (_lex_token(parser, &token) != lasm_token_type_symbolic_equal)
 		{
 			_log_parser_error(token.location,
-				"expected an 'auto' keyword or any of the 'r', 'rw', 'rx', or 'rwx' keywords for the 'perm' attribute, but found '%s' token.",
-				lasm_token_type_to_string(token.type)
+				"expected a '=' symbol token after '%s' keyword, but found '%s' token. each attribute of the region must have a value assigned to it. follow the example below:\n"
+				_region_example,
+				lasm_token_type_to_string(attr_keyword.type), lasm_token_type_to_string(token.type)
 			);
-		} break;
+		}
+
+		_collect_attr_value_tokens(parser, &token);
+
+		switch (attr_keyword.type)
+		{
+			case lasm_token_type_keyword_origin: { region.origin = _parse_region_uval_value(parser, &attr_keyword); } break;
+			case lasm_token_type_keyword_length: { region.length = _parse_region_uval_value(parser, &attr_keyword); } break;
+			case lasm_token_type_keyword_bank:   { region.bank   = _parse_region_uval_value(parser, &attr_keyword); } break;
+			case lasm_token_type_keyword_port:   { region.port   = _parse_region_uval_value(parser, &attr_keyword); } break;
+
+			case lasm_token_type_keyword_perm:
+			{
+				lasm_ast_attr_s attr = (lasm_ast_attr_s) { .type = lasm_ast_attr_type_perm, };
+				_parse_attr_perm_value(parser, &attr, &parser->attr_tokens);
+
+				if (attr.inferred)
+				{
+					_log_parser_error(parser->attr_tokens.data[0].location,
+						"the permissions of the region cannot be inferred. expected any of the 'r', 'rw', 'rx', or 'rwx' keywords."
+					);
+				}
+
+				region.perm = attr.as.perm.value;
+			} break;
+
+			default:
+			{
+				lasm_debug_assert(0);  // note: sanity check for developers.
+			} break;
+		}
+
+		if (_lex_token(parser, &token) != lasm_token_type_symbolic_comma)
+		{
+			lasm_lexer_unlex(&parser->lexer, &token);
+		}
 	}
 
-	label->attrs[lasm_ast_attr_type_perm] = (const lasm_ast_attr_s)
+	if ((present & 0x7) != 0x7)
 	{
-		.type     = lasm_ast_attr_type_perm,
-		.inferred = (lasm_token_type_keyword_auto == token.type),
-		.as.perm  = (const lasm_ast_attr_perm_s)
-		{
-			.value = perm_type,
-		},
-	};
+		_log_parser_error(token.location,
+			"the attributes list of region '%s' must specify all of the 'origin', 'length', and 'perm' attributes. follow the example below:\n"
+			_region_example,
+			region.name
+		);
+	}
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_comma)
+	if ((0 == region.length) || ((region.origin + region.length) < region.origin))
 	{
-		_log_parser_note(token.location,
-			"even thought it is not enforced by an error, it is a standard and a good practice to trail each attribute with a comma. follow the example below:\n" \
-			"  |                                                                                                                                              \n" \
-			"2 |     [addr=<value>, align=<value>, size=<value>, perm=<value>%s,%s]                                                                           \n" \
-			"  |                                                             %s^~~~ expected a trailing comma here.%s                                         \n" \
-			"3 |     example:                                                                                                                                 \n" \
-			"4 |         ; ...                                                                                                                                \n" \
-			"5 |     end                                                                                                                                      \n" \
-			"  |                                                                                                                                              \n",
-			lasm_cyan, lasm_reset,
-			lasm_cyan, lasm_reset
+		_log_parser_error(region.location,
+			"region '%s' must have a non zero length and must fit into the address space, but it spans %lu bytes from 0x%lX.",
+			region.name, region.length, region.origin
+		);
+	}
+
+	_check_region_bank(parser, &region, ((present & 0x8) != 0), ((present & 0x10) != 0));
+	lasm_regions_vector_push(&parser->regions, region);
+}
+
+static void _check_region_bank(const lasm_parser_s* const parser, const lasm_ast_region_s* const region, const bool_t has_bank, const bool_t has_port)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(region != NULL);
+
+	if (has_bank != has_port)
+	{
+		_log_parser_error(region->location,
+			"the attributes list of region '%s' must specify both of the 'bank' and 'port' attributes, or neither of them. follow the example below:\n"
+			_banked_region_example,
+			region->name
+		);
+	}
+
+	// note: the far call trampolines, that switch the banks, are generated only
+	// for z80, while rl78 addresses all of its memory without the banks.
+	if (has_bank && (parser->config->arch != lasm_arch_type_z80))
+	{
+		_log_parser_error(region->location,
+			"region '%s' cannot have the 'bank' and 'port' attributes, as the banked regions are supported only for the z80 architecture.",
+			region->name
 		);
+	}
 
-		lasm_lexer_unlex(&parser->lexer, &token);
+	// note: the bank number and the port are loaded into 8 bit registers by the
+	// far call trampolines, and the windows are addressed with 16 bit addresses.
+	if (has_bank && ((region->bank > UINT8_MAX) || (region->port > UINT8_MAX) || ((region->origin + region->length) > 0x10000)))
+	{
+		_log_parser_error(region->location,
+			"banked region '%s' must have its bank number and port between 0 and 255, and must fit into the 16 bit address space, but it has bank %lu, port %lu, and spans [0x%lX, 0x%lX).",
+			region->name, region->bank, region->port, region->origin, region->origin + region->length
+		);
+	}
+
+	// note: the windows of the banks may overlap each other, as only one of the
+	// banks is mapped at a time, but never the memory outside of the banks.
+	for (uint64_t index = 0; index < parser->regions.count; ++index)
+	{
+		const lasm_ast_region_s* const other = &parser->regions.data[index];
+		const bool_t overlaps = (region->origin < (other->origin + other->length)) && (other->origin < (region->origin + region->length));
+
+		if (!overlaps || ((lasm_ast_bank_none == region->bank) && (lasm_ast_bank_none == other->bank)))
+		{
+			continue;
+		}
+
+		if ((lasm_ast_bank_none == region->bank) || (lasm_ast_bank_none == other->bank) ||
+			(region->bank == other->bank) || (region->port != other->port))
+		{
+			_log_parser_error(region->location,
+				"region '%s' overlaps region '%s', which is declared at " lasm_location_fmt ". only the regions of different banks, that are selected with the same port, may overlap.",
+				region->name, other->name, lasm_location_arg(other->location)
+			);
+		}
 	}
 }
 
@@ -442,7 +822,17 @@ static bool_t _parse_label_header(lasm_parser_s* const parser, lasm_ast_label_s*
 	lasm_debug_assert(label != NULL);
 
 	lasm_token_s token = lasm_token_new(lasm_token_type_none, parser->lexer.location);
-	(void)lasm_lexer_lex(&parser->lexer, &token);
+	parser->fingerprint = lasm_common_hash_seed;
+	(void)_lex_token(parser, &token);
+
+	// note: the region declarations are not part of any label's fingerprint, as
+	// they only affect the layout and not the encoded bodies.
+	while (lasm_token_type_keyword_region == token.type)
+	{
+		_parse_region(parser, &token);
+		parser->fingerprint = lasm_common_hash_seed;
+		(void)_lex_token(parser, &token);
+	}
 
 	if (lasm_lexer_should_stop(token.type))
 	{
@@ -450,6 +840,8 @@ static bool_t _parse_label_header(lasm_parser_s* const parser, lasm_ast_label_s*
 	}
 
 	label->location = parser->lexer.location;
+	label->alias = lasm_ast_label_none;
+	label->alias_offset = 0;
 
 	if (token.type != lasm_token_type_symbolic_left_bracket)
 	{
@@ -468,29 +860,9 @@ static bool_t _parse_label_header(lasm_parser_s* const parser, lasm_ast_label_s*
 		);
 	}
 
-	_parse_label_attr_addr( parser, label);
-	_parse_label_attr_align(parser, label);
-	_parse_label_attr_size( parser, label);
-	_parse_label_attr_perm( parser, label);
-
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_right_bracket)
-	{
-		_log_parser_error(token.location,
-			"expected a symbolic token ']' after the attributes list, but found '%s' token. an attributes list must be closed with the ']' symbolic token. follow the example below:\n" \
-			"  |                                                                                                                                                                    \n" \
-			"2 |     [addr=<value>, align=<value>, size=<value>, perm=<value>,%s]%s                                                                                                 \n" \
-			"  |                                                              %s^~~~ expected a ']' bracket to close the attributes list for a label in the global scope.%s         \n" \
-			"3 |     example:                                                                                                                                                       \n" \
-			"4 |         ; ...                                                                                                                                                      \n" \
-			"5 |     end                                                                                                                                                            \n" \
-			"  |                                                                                                                                                                    \n",
-			lasm_token_type_to_string(token.type),
-			lasm_red, lasm_reset,
-			lasm_red, lasm_reset
-		);
-	}
+	_parse_label_attrs(parser, label);
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_ident)
+	if (_lex_token(parser, &token) != lasm_token_type_ident)
 	{
 		_log_parser_error(token.location,
 			"expected an identifier token after attributes list for the label, but found '%s' token. a label name must follow the attributes list. follow the example below:\n" \
@@ -509,7 +881,7 @@ static bool_t _parse_label_header(lasm_parser_s* const parser, lasm_ast_label_s*
 
 	label->name = token.as.ident.data;
 
-	if (lasm_lexer_lex(&parser->lexer, &token) != lasm_token_type_symbolic_colon)
+	if (_lex_token(parser, &token) != lasm_token_type_symbolic_colon)
 	{
 		_log_parser_error(token.location,
 			"expected a ':' symbolic token after the label's identifier token, but found '%s' token. a ':' symbolic token must follow the label's identifier token. follow the example below:\n" \
@@ -526,9 +898,10 @@ static bool_t _parse_label_header(lasm_parser_s* const parser, lasm_ast_label_s*
 		);
 	}
 
-	label->body_tokens = lasm_tokens_vector_new(parser->arena, 1);
+	parser->lexer.tokens_arena = &parser->tokens_arena;
+	label->body_tokens = lasm_tokens_vector_new(&parser->tokens_arena, 1);
 
-	while (!lasm_lexer_should_stop(lasm_lexer_lex(&parser->lexer, &token)))
+	while (!lasm_lexer_should_stop(_lex_token(parser, &token)))
 	{
 		if (lasm_token_type_keyword_end == token.type)
 		{
@@ -538,6 +911,9 @@ static bool_t _parse_label_header(lasm_parser_s* const parser, lasm_ast_label_s*
 		lasm_tokens_vector_push(&label->body_tokens, token);
 	}
 
+	parser->lexer.tokens_arena = parser->arena;
+
+	label->fingerprint = parser->fingerprint;
 	return true;
 }
 
@@ -546,19 +922,58 @@ static void _parse_label_body(lasm_parser_s* const parser, lasm_ast_label_s* con
 	lasm_debug_assert(parser != NULL);
 	lasm_debug_assert(label != NULL);
 
-	label->body = lasm_bytes_vector_new(parser->arena, 1);
+	label->strings = _is_string_body(label);
+	label->fixups = lasm_fixups_vector_new(parser->arena, 1);
+	label->locals = lasm_locals_vector_new(parser->arena, 1);
+	label->data = lasm_data_vector_new(parser->arena, 1);
+
+	// note: the string literals are the bytes of the body, so there is nothing
+	// to parse, encode, or cache for such labels.
+	if (label->strings)
+	{
+		_lower_string_body(parser, label);
+		return;
+	}
+
+	label->fingerprint = lasm_data_fingerprint(parser->arena, label, label->fingerprint);
+	const lasm_cache_entry_s* const entry = lasm_cache_find(&parser->cache, label->fingerprint);
+
+	if (entry != NULL)
+	{
+		label->cached = true;
+		label->transient = false;
+		label->symbolic = entry->symbolic;
+		label->body = lasm_bytes_vector_new(parser->arena, entry->body.count + 1);
+		lasm_bytes_vector_append(&label->body, entry->body.data, entry->body.count);
+
+		// note: the cached fixups do not know the file of the label, as the same
+		// label may be moved to another file, that is included into the source.
+		for (uint64_t index = 0; index < entry->fixups.count; ++index)
+		{
+			lasm_ast_fixup_s fixup = entry->fixups.data[index];
+			fixup.location.file = label->location.file;
+			lasm_fixups_vector_push(&label->fixups, fixup);
+		}
+
+		lasm_locals_vector_append(&label->locals, entry->locals.data, entry->locals.count);
+		label->blob = entry->blob;
+		label->blob.location.file = label->location.file;
+		return;
+	}
+
+	label->cached = false;
+	label->transient = false;
+	label->ir = lasm_ir_insts_vector_new(&parser->tokens_arena, 1);
 
 	switch (parser->config->arch)
 	{
 		case lasm_arch_type_z80:
 		{
-			// todo: parse the z80 assembly!
 			z80_parser_parse_tokens(&parser->lexer, &parser->labels, label);
 		} break;
 
 		case lasm_arch_type_rl78:
 		{
-			// todo: parse the rl78 assembly!
 			rl78_parser_parse_tokens(&parser->lexer, &parser->labels, label);
 		} break;
 
@@ -567,4 +982,106 @@ static void _parse_label_body(lasm_parser_s* const parser, lasm_ast_label_s* con
 			lasm_debug_assert(0);
 		} break;
 	}
+
+	// note: the instructions are collected in the tokens arena and then moved to
+	// the parser's arena with an exact capacity, so the memory wasted by growing
+	// the vector is released along with the tokens.
+	lasm_ir_insts_vector_s ir = lasm_ir_insts_vector_new(parser->arena, label->ir.count + 1);
+	lasm_ir_insts_vector_append(&ir, label->ir.data, label->ir.count);
+	label->ir = ir;
+	label->symbolic = false;
+
+	for (uint64_t index = 0; index < ir.count; ++index)
+	{
+		for (uint8_t operand = 0; operand < ir.data[index].operands_count; ++operand)
+		{
+			label->symbolic |= lasm_ir_operand_is_symbolic(&ir.data[index].operands[operand]);
+		}
+	}
+
+	for (uint64_t index = 0; index < label->data.count; ++index)
+	{
+		label->symbolic |= (label->data.data[index].values.count > 0);
+	}
+}
+
+static bool_t _is_string_body(const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(label != NULL);
+
+	bool_t strings = false;
+
+	for (uint64_t index = 0; index < label->body_tokens.count; ++index)
+	{
+		switch (label->body_tokens.data[index].type)
+		{
+			case lasm_token_type_literal_str:     { strings = true; } break;
+			case lasm_token_type_symbolic_comma: {                 } break;
+			default:                              { return false;   } break;
+		}
+	}
+
+	return strings;
+}
+
+static void _lower_string_body(lasm_parser_s* const parser, lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(label != NULL);
+
+	uint64_t length = 0;
+
+	for (uint64_t index = 0; index < label->body_tokens.count; ++index)
+	{
+		if (lasm_token_type_literal_str == label->body_tokens.data[index].type)
+		{
+			length += label->body_tokens.data[index].as.str.length;
+		}
+	}
+
+	label->cached = false;
+	label->transient = false;
+	label->symbolic = false;
+	label->ir = lasm_ir_insts_vector_new(parser->arena, 1);
+	label->body = lasm_bytes_vector_new(parser->arena, length + 1);
+
+	for (uint64_t index = 0; index < label->body_tokens.count; ++index)
+	{
+		const lasm_token_s* const token = &label->body_tokens.data[index];
+
+		if (lasm_token_type_literal_str == token->type)
+		{
+			lasm_bytes_vector_append(&label->body, (const uint8_t*)token->as.str.data, token->as.str.length);
+		}
+	}
+}
+
+static void _encode_label_body(lasm_parser_s* const parser, lasm_ast_label_s* const label, const bool_t banked)
+{
+	lasm_debug_assert(parser != NULL);
+	lasm_debug_assert(label != NULL);
+
+	label->body = lasm_bytes_vector_new(parser->arena, 1);
+
+	switch (parser->config->arch)
+	{
+		case lasm_arch_type_z80:
+		{
+			if (parser->config->peephole)
+			{
+				label->transient = z80_peephole_rewrite(label, banked);
+			}
+
+			z80_encoder_encode(label);
+		} break;
+
+		case lasm_arch_type_rl78: { rl78_encoder_encode(label); } break;
+
+		default:
+		{
+			lasm_debug_assert(0);
+		} break;
+	}
+
+	lasm_locals_place(label);
 }
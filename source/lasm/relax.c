@@ -0,0 +1,281 @@
+
+/**
+ * @file relax.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-28
+ */
+
+#include "lasm/relax.h"
+#include "lasm/fixup.h"
+#include "lasm/debug.h"
+#include "lasm/archs/z80_encoder.h"
+#include "lasm/archs/rl78_encoder.h"
+#include "lasm/archs/rl78_isa.h"
+
+typedef struct
+{
+	lasm_arch_type_e arch;
+	lasm_labels_vector_s* labels;
+	bool_t grow;
+	bool_t branches;  // note: shrink the branches, and not only the operands.
+	bool_t guess;     // note: shrink the operands, which targets' addresses are not known yet.
+} _relax_s;
+
+static uint64_t _relax_labels(const _relax_s* const relax, uint64_t* const bytes, uint64_t* const first);
+
+static uint64_t _rewrite_label(const _relax_s* const relax, lasm_ast_label_s* const label, uint64_t* const bytes);
+
+static uint64_t _shift_locals(lasm_ast_label_s* const label, uint64_t local, const uint64_t limit, const int64_t delta);
+
+static bool_t _should_resize(const _relax_s* const relax, const lasm_ast_fixup_s* const fixup, lasm_ir_fixup_kind_e* const kind);
+
+static lasm_ir_fixup_kind_e _direct_kind(const _relax_s* const relax, const lasm_ast_fixup_s* const fixup);
+
+static bool_t _is_short(const lasm_ir_fixup_kind_e kind);
+
+static bool_t _relax_form(const lasm_arch_type_e arch, const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form);
+
+uint64_t lasm_relax_shrink(const lasm_arch_type_e arch, lasm_labels_vector_s* const labels, const bool_t branches, const bool_t guess, uint64_t* const saved)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(saved != NULL);
+
+	const _relax_s relax = (const _relax_s)
+	{
+		.arch     = arch,
+		.labels   = labels,
+		.grow     = false,
+		.branches = branches,
+		.guess    = guess,
+	};
+
+	uint64_t first = 0;
+	return _relax_labels(&relax, saved, &first);
+}
+
+uint64_t lasm_relax_grow(const lasm_arch_type_e arch, lasm_labels_vector_s* const labels, uint64_t* const grown, uint64_t* const first)
+{
+	lasm_debug_assert(labels != NULL);
+	lasm_debug_assert(grown != NULL);
+	lasm_debug_assert(first != NULL);
+
+	const _relax_s relax = (const _relax_s)
+	{
+		.arch     = arch,
+		.labels   = labels,
+		.grow     = true,
+		.branches = true,
+		.guess    = false,
+	};
+
+	return _relax_labels(&relax, grown, first);
+}
+
+static uint64_t _relax_labels(const _relax_s* const relax, uint64_t* const bytes, uint64_t* const first)
+{
+	lasm_debug_assert(relax != NULL);
+	lasm_debug_assert(bytes != NULL);
+	lasm_debug_assert(first != NULL);
+
+	uint64_t count = 0;
+	*bytes = 0;
+	*first = lasm_ast_label_none;
+
+	for (uint64_t index = 0; index < relax->labels->count; ++index)
+	{
+		lasm_ast_label_s* const label = lasm_labels_vector_at(relax->labels, index);
+
+		if (label->fixups.count > 0)
+		{
+			const uint64_t rewritten = _rewrite_label(relax, label, bytes);
+
+			if ((rewritten > 0) && (lasm_ast_label_none == *first))
+			{
+				*first = index;
+			}
+
+			count += rewritten;
+		}
+	}
+
+	return count;
+}
+
+static uint64_t _rewrite_label(const _relax_s* const relax, lasm_ast_label_s* const label, uint64_t* const bytes)
+{
+	lasm_debug_assert(relax != NULL);
+	lasm_debug_assert(label != NULL);
+	lasm_debug_assert(bytes != NULL);
+
+	lasm_bytes_vector_s body = {0};
+	uint64_t count = 0, read = 0, local = 0;
+	int64_t delta = 0;
+
+	// note: the fixups are ordered by their offsets, so the body is rebuilt in
+	// a single pass, and the offsets of the fixups are shifted along the way.
+	for (uint64_t index = 0; index < label->fixups.count; ++index)
+	{
+		lasm_ast_fixup_s* const fixup = lasm_fixups_vector_at(&label->fixups, index);
+		lasm_ir_fixup_kind_e kind = fixup->kind;
+		const bool_t resize = _should_resize(relax, fixup, &kind);
+		const uint64_t offset = fixup->offset;
+		const uint64_t inst = offset - fixup->field_offset;
+		fixup->offset = (uint64_t)((int64_t)offset + delta);
+
+		uint8_t length = 0;
+		lasm_relax_form_s form = {0};
+
+		// note: an operand without a form, that fits its target, is kept, and it
+		// is reported by the fixups.
+		if (!resize || !_relax_form(relax->arch, label->body.data + inst, kind, &length, &form))
+		{
+			continue;
+		}
+
+		if (0 == count)
+		{
+			body = lasm_bytes_vector_new(label->body.arena, label->body.count + (label->fixups.count * lasm_relax_form_capacity) + 1);
+		}
+
+		lasm_debug_assert((inst >= read) && (inst < label->body.count));
+		lasm_bytes_vector_append(&body, label->body.data + read, inst - read);
+		local = _shift_locals(label, local, inst, delta);
+
+		fixup->offset = body.count + form.field_offset;
+		fixup->field_offset = form.field_offset;
+		fixup->width = form.field_width;
+		fixup->kind = form.kind;
+
+		lasm_bytes_vector_append(&body, form.bytes, form.length);
+		read = inst + length;
+		delta += (int64_t)form.length - (int64_t)length;
+		*bytes += (relax->grow ? (uint64_t)(form.length - length) : (uint64_t)(length - form.length));
+		++count;
+	}
+
+	if (count > 0)
+	{
+		lasm_bytes_vector_append(&body, label->body.data + read, label->body.count - read);
+		(void)_shift_locals(label, local, UINT64_MAX, delta);
+		label->body = body;
+	}
+
+	return count;
+}
+
+static uint64_t _shift_locals(lasm_ast_label_s* const label, uint64_t local, const uint64_t limit, const int64_t delta)
+{
+	lasm_debug_assert(label != NULL);
+
+	// note: the local labels are ordered by their offsets, and the ones up to
+	// the rewritten instruction move along with the instructions before it.
+	for (; (local < label->locals.count) && (label->locals.data[local].offset <= limit); ++local)
+	{
+		lasm_ast_local_s* const entry = lasm_locals_vector_at(&label->locals, local);
+		entry->offset = (uint64_t)((int64_t)entry->offset + delta);
+	}
+
+	return local;
+}
+
+static bool_t _should_resize(const _relax_s* const relax, const lasm_ast_fixup_s* const fixup, lasm_ir_fixup_kind_e* const kind)
+{
+	lasm_debug_assert(relax != NULL);
+	lasm_debug_assert(fixup != NULL);
+	lasm_debug_assert(kind != NULL);
+
+	const bool_t branch = (fixup->flow != lasm_ir_flow_none);
+
+	if (!fixup->relax || (branch && !relax->branches))
+	{
+		return false;
+	}
+
+	// note: a short field grows into its long form, once its target is out of
+	// the range, or the window, of the short form.
+	if (relax->grow)
+	{
+		*kind = (branch ? lasm_ir_fixup_kind_abs : lasm_ir_fixup_kind_lo16);
+		return _is_short(fixup->kind) && !lasm_fixup_fits(fixup, lasm_fixup_value(relax->labels, fixup));
+	}
+
+	// note: the short form of a relaxable branch is its relative form, and the
+	// short form of a relaxable operand depends on the window of its target.
+	if (branch)
+	{
+		*kind = lasm_ir_fixup_kind_rel;
+		return !_is_short(fixup->kind);
+	}
+
+	*kind = _direct_kind(relax, fixup);
+	return (*kind != fixup->kind);
+}
+
+static lasm_ir_fixup_kind_e _direct_kind(const _relax_s* const relax, const lasm_ast_fixup_s* const fixup)
+{
+	lasm_debug_assert(relax != NULL);
+	lasm_debug_assert(fixup != NULL);
+
+	const lasm_ast_label_s* const target = ((lasm_ast_label_none == fixup->target) ? NULL : &relax->labels->data[fixup->target]);
+
+	// note: the operands, which targets have constant explicit addresses, take
+	// their final forms right away, while the other operands (including the ones,
+	// that target local labels, which move along with the relaxed bodies) are
+	// guessed to be in the saddr window, and grow after the layout, if they are
+	// not.
+	if ((NULL == target) || (fixup->local != lasm_ast_label_none) || (target->alias != lasm_ast_label_none) ||
+		target->attrs[lasm_ast_attr_type_addr].inferred || !target->attrs[lasm_ast_attr_type_addr].expr->folded)
+	{
+		return (relax->guess ? lasm_ir_fixup_kind_saddr : fixup->kind);
+	}
+
+	const uint64_t value = target->attrs[lasm_ast_attr_type_addr].expr->value + fixup->addend;
+
+	if ((value >= rl78_isa_saddr_first) && (value <= rl78_isa_saddr_last))
+	{
+		return lasm_ir_fixup_kind_saddr;
+	}
+
+	if ((value >= rl78_isa_sfr_first) && (value <= rl78_isa_sfr_last))
+	{
+		return lasm_ir_fixup_kind_sfr;
+	}
+
+	return lasm_ir_fixup_kind_lo16;
+}
+
+static bool_t _is_short(const lasm_ir_fixup_kind_e kind)
+{
+	return (lasm_ir_fixup_kind_rel == kind) || (lasm_ir_fixup_kind_saddr == kind) || (lasm_ir_fixup_kind_sfr == kind);
+}
+
+static bool_t _relax_form(const lasm_arch_type_e arch, const uint8_t* const inst, const lasm_ir_fixup_kind_e kind, uint8_t* const length, lasm_relax_form_s* const form)
+{
+	lasm_debug_assert(inst != NULL);
+	lasm_debug_assert(length != NULL);
+	lasm_debug_assert(form != NULL);
+
+	switch (arch)
+	{
+		case lasm_arch_type_z80:
+		{
+			return z80_encoder_relax(inst, kind, length, form);
+		} break;
+
+		case lasm_arch_type_rl78:
+		{
+			return rl78_encoder_relax(inst, kind, length, form);
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: sanity check for developers.
+			return false;
+		} break;
+	}
+}
@@ -0,0 +1,147 @@
+
+/**
+ * @file segment.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-27
+ */
+
+#include "lasm/segment.h"
+#include "lasm/debug.h"
+
+#include <stdlib.h>
+
+typedef struct
+{
+	uint64_t bank;
+	uint64_t addr;
+	uint64_t index;
+} _label_ref_s;
+
+static int32_t _compare_label_refs(const void* const left, const void* const right);
+
+static bool_t _segment_accepts(const lasm_segment_s* const segment, const lasm_ast_label_s* const label);
+
+lasm_implement_vector_type(lasm_segments_vector, lasm_segment_s);
+
+lasm_segments_s lasm_segments_build(lasm_arena_s* const arena, const lasm_labels_vector_s* const labels)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(labels != NULL);
+
+	lasm_segments_s segments = (lasm_segments_s)
+	{
+		.segments    = lasm_segments_vector_new(arena, 1),
+		.order       = (uint64_t*)lasm_arena_alloc(arena, (labels->count + 1) * sizeof(uint64_t)),
+		.order_count = 0,
+	};
+	lasm_debug_assert(segments.order != NULL);
+
+	_label_ref_s* const refs = (_label_ref_s* const)lasm_arena_alloc(arena, (labels->count + 1) * sizeof(_label_ref_s));
+	lasm_debug_assert(refs != NULL);
+
+	for (uint64_t index = 0; index < labels->count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[index];
+
+		if ((label->attrs[lasm_ast_attr_type_size].as.size.value > 0) && (lasm_ast_label_none == label->alias))
+		{
+			refs[segments.order_count++] = (_label_ref_s)
+			{
+				.bank  = label->attrs[lasm_ast_attr_type_region].as.region.bank,
+				.addr  = label->attrs[lasm_ast_attr_type_addr].as.addr.value,
+				.index = index,
+			};
+		}
+	}
+
+	qsort(refs, (size_t)segments.order_count, sizeof(_label_ref_s), _compare_label_refs);
+
+	for (uint64_t index = 0; index < segments.order_count; ++index)
+	{
+		segments.order[index] = refs[index].index;
+	}
+
+	for (uint64_t index = 0; index < segments.order_count; ++index)
+	{
+		const lasm_ast_label_s* const label = &labels->data[segments.order[index]];
+		const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+		const uint64_t size = label->attrs[lasm_ast_attr_type_size].as.size.value;
+
+		lasm_segment_s* segment = (segments.segments.count > 0) ? &segments.segments.data[segments.segments.count - 1] : NULL;
+
+		if ((NULL == segment) || !_segment_accepts(segment, label))
+		{
+			lasm_segments_vector_push(&segments.segments, (lasm_segment_s)
+			{
+				.addr      = addr,
+				.mem_size  = 0,
+				.file_size = 0,
+				.perm      = label->attrs[lasm_ast_attr_type_perm].as.perm.value,
+				.region    = label->attrs[lasm_ast_attr_type_region].as.region.value,
+				.bank      = label->attrs[lasm_ast_attr_type_region].as.region.bank,
+				.first     = index,
+				.count     = 0,
+			});
+
+			segment = &segments.segments.data[segments.segments.count - 1];
+		}
+
+		segment->mem_size = (addr + size) - segment->addr;
+		++segment->count;
+
+		if (lasm_ast_label_length(label) > 0)
+		{
+			segment->file_size = (addr + lasm_ast_label_length(label)) - segment->addr;
+		}
+	}
+
+	return segments;
+}
+
+static int32_t _compare_label_refs(const void* const left, const void* const right)
+{
+	lasm_debug_assert(left != NULL);
+	lasm_debug_assert(right != NULL);
+
+	const _label_ref_s* const left_ref = (const _label_ref_s*)left;
+	const _label_ref_s* const right_ref = (const _label_ref_s*)right;
+
+	// note: lasm_ast_bank_none wraps around to zero, so the labels outside of the
+	// banks go first.
+	if (left_ref->bank != right_ref->bank)
+	{
+		return ((left_ref->bank + 1) > (right_ref->bank + 1)) - ((left_ref->bank + 1) < (right_ref->bank + 1));
+	}
+
+	if (left_ref->addr != right_ref->addr)
+	{
+		return (left_ref->addr > right_ref->addr) - (left_ref->addr < right_ref->addr);
+	}
+
+	return (left_ref->index > right_ref->index) - (left_ref->index < right_ref->index);
+}
+
+static bool_t _segment_accepts(const lasm_segment_s* const segment, const lasm_ast_label_s* const label)
+{
+	lasm_debug_assert(segment != NULL);
+	lasm_debug_assert(label != NULL);
+
+	const uint64_t addr = label->attrs[lasm_ast_attr_type_addr].as.addr.value;
+	const uint64_t align = label->attrs[lasm_ast_attr_type_align].as.align.value;
+	const uint64_t end = segment->addr + segment->mem_size;
+
+	if ((label->attrs[lasm_ast_attr_type_perm].as.perm.value != segment->perm) ||
+		(label->attrs[lasm_ast_attr_type_region].as.region.value != segment->region))
+	{
+		return false;
+	}
+
+	// note: only the padding, that the label's alignment may require, is filled
+	// to keep the segment contiguous. larger gaps start a new segment.
+	return ((addr >= end) && ((addr - end) < align));
+}
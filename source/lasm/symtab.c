@@ -0,0 +1,142 @@
+
+/**
+ * @file symtab.c
+ * 
+ * @copyright This file is a part of the "lasm" project and is distributed, and
+ * licensed under "lasm gplv1" license.
+ * 
+ * @author joba14
+ * 
+ * @date 2024-07-24
+ */
+
+#include "lasm/symtab.h"
+#include "lasm/debug.h"
+
+#define _symtab_initial_capacity ((uint64_t)64)  // note: must be a power of 2.
+
+static lasm_symtab_slot_s* _alloc_slots(lasm_arena_s* const arena, const uint64_t capacity);
+
+static lasm_symtab_slot_s* _find_slot(const lasm_symtab_s* const symtab, const char_t* const name, const uint64_t length, const uint64_t hash);
+
+static void _grow(lasm_symtab_s* const symtab);
+
+lasm_symtab_s lasm_symtab_new(lasm_arena_s* const arena)
+{
+	lasm_debug_assert(arena != NULL);
+
+	return (lasm_symtab_s)
+	{
+		.arena    = arena,
+		.slots    = _alloc_slots(arena, _symtab_initial_capacity),
+		.capacity = _symtab_initial_capacity,
+		.count    = 0,
+	};
+}
+
+bool_t lasm_symtab_insert(lasm_symtab_s* const symtab, const char_t* const name, const uint64_t length, const uint64_t index, uint64_t* const existing)
+{
+	lasm_debug_assert(symtab != NULL);
+	lasm_debug_assert(name != NULL);
+	lasm_debug_assert(length > 0);
+	lasm_debug_assert(existing != NULL);
+
+	// note: the load factor is kept at or below 3/4.
+	if ((symtab->count + 1) * 4 > symtab->capacity * 3)
+	{
+		_grow(symtab);
+	}
+
+	const uint64_t hash = lasm_common_hash(lasm_common_hash_seed, name, length);
+	lasm_symtab_slot_s* const slot = _find_slot(symtab, name, length, hash);
+
+	if (slot->name != NULL)
+	{
+		*existing = slot->index;
+		return false;
+	}
+
+	*slot = (lasm_symtab_slot_s)
+	{
+		.name   = name,
+		.length = length,
+		.hash   = hash,
+		.index  = index,
+	};
+
+	++symtab->count;
+	return true;
+}
+
+bool_t lasm_symtab_find(const lasm_symtab_s* const symtab, const char_t* const name, const uint64_t length, uint64_t* const index)
+{
+	lasm_debug_assert(symtab != NULL);
+	lasm_debug_assert(name != NULL);
+	lasm_debug_assert(index != NULL);
+
+	const uint64_t hash = lasm_common_hash(lasm_common_hash_seed, name, length);
+	const lasm_symtab_slot_s* const slot = _find_slot(symtab, name, length, hash);
+
+	if (NULL == slot->name)
+	{
+		return false;
+	}
+
+	*index = slot->index;
+	return true;
+}
+
+static lasm_symtab_slot_s* _alloc_slots(lasm_arena_s* const arena, const uint64_t capacity)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(capacity > 0);
+
+	lasm_symtab_slot_s* const slots = (lasm_symtab_slot_s* const)lasm_arena_alloc(arena, capacity * sizeof(lasm_symtab_slot_s));
+	lasm_debug_assert(slots != NULL);
+
+	lasm_common_memset(slots, 0, capacity * sizeof(lasm_symtab_slot_s));
+	return slots;
+}
+
+static lasm_symtab_slot_s* _find_slot(const lasm_symtab_s* const symtab, const char_t* const name, const uint64_t length, const uint64_t hash)
+{
+	lasm_debug_assert(symtab != NULL);
+	lasm_debug_assert(name != NULL);
+
+	const uint64_t mask = symtab->capacity - 1;
+
+	for (uint64_t index = hash & mask; ; index = (index + 1) & mask)
+	{
+		lasm_symtab_slot_s* const slot = &symtab->slots[index];
+
+		if (NULL == slot->name)
+		{
+			return slot;
+		}
+
+		if ((slot->hash == hash) && (slot->length == length) &&
+			(lasm_common_memcmp((const uint8_t*)slot->name, (const uint8_t*)name, length) == 0))
+		{
+			return slot;
+		}
+	}
+}
+
+static void _grow(lasm_symtab_s* const symtab)
+{
+	lasm_debug_assert(symtab != NULL);
+
+	const lasm_symtab_slot_s* const slots = symtab->slots;
+	const uint64_t capacity = symtab->capacity;
+
+	symtab->capacity = capacity * 2;
+	symtab->slots = _alloc_slots(symtab->arena, symtab->capacity);
+
+	for (uint64_t index = 0; index < capacity; ++index)
+	{
+		if (slots[index].name != NULL)
+		{
+			*_find_slot(symtab, slots[index].name, slots[index].length, slots[index].hash) = slots[index];
+		}
+	}
+}
@@ -28,6 +28,14 @@ static const char_t* const _g_token_type_to_string_map[] =
 	[lasm_token_type_keyword_rwx]				= "rwx",
 	[lasm_token_type_keyword_auto]				= "auto",
 	[lasm_token_type_keyword_end]				= "end",
+	[lasm_token_type_keyword_sizeof]			= "sizeof",
+	[lasm_token_type_keyword_addrof]			= "addrof",
+	[lasm_token_type_keyword_region]			= "region",
+	[lasm_token_type_keyword_origin]			= "origin",
+	[lasm_token_type_keyword_length]			= "length",
+	[lasm_token_type_keyword_bank]				= "bank",
+	[lasm_token_type_keyword_port]				= "port",
+	[lasm_token_type_keyword_cycles]			= "cycles",
 
 	[lasm_token_type_symbolic_dot]				= ".",
 	[lasm_token_type_symbolic_comma]			= ",",
@@ -37,10 +45,21 @@ static const char_t* const _g_token_type_to_string_map[] =
 	[lasm_token_type_symbolic_right_bracket]	= "]",
 	[lasm_token_type_symbolic_plus]				= "+",
 	[lasm_token_type_symbolic_minus]			= "-",
+	[lasm_token_type_symbolic_left_paren]		= "(",
+	[lasm_token_type_symbolic_right_paren]		= ")",
+	[lasm_token_type_symbolic_shift_left]		= "<<",
+	[lasm_token_type_symbolic_shift_right]		= ">>",
+	[lasm_token_type_symbolic_ampersand]		= "&",
+	[lasm_token_type_symbolic_pipe]				= "|",
+	[lasm_token_type_symbolic_caret]			= "^",
+	[lasm_token_type_symbolic_tilde]			= "~",
+	[lasm_token_type_symbolic_hash]			= "#",
+	[lasm_token_type_symbolic_exclamation]		= "!",
+	[lasm_token_type_symbolic_dollar]			= "$",
 };
 
 _Static_assert(
-	lasm_token_type_keywords_count == 10,
+	lasm_token_type_keywords_count == 18,
 	"_g_token_type_to_string_map is not in sync with lasm_token_type_e enum!"
 );
 
@@ -148,4 +167,41 @@ const char_t* lasm_token_to_string(const lasm_token_s* const token)
 	return token_string_buffer;
 }
 
+uint64_t lasm_token_fingerprint(const uint64_t seed, const lasm_token_s* const token)
+{
+	lasm_debug_assert(token != NULL);
+
+	const uint32_t type = (uint32_t)token->type;
+	uint64_t hash = lasm_common_hash(seed, &type, sizeof(type));
+
+	switch (token->type)
+	{
+		case lasm_token_type_literal_uval:
+		{
+			hash = lasm_common_hash(hash, &token->as.uval, sizeof(token->as.uval));
+		} break;
+
+		case lasm_token_type_literal_rune:
+		{
+			hash = lasm_common_hash(hash, &token->as.rune, sizeof(token->as.rune));
+		} break;
+
+		case lasm_token_type_literal_str:
+		{
+			hash = lasm_common_hash(hash, token->as.str.data, token->as.str.length);
+		} break;
+
+		case lasm_token_type_ident:
+		{
+			hash = lasm_common_hash(hash, token->as.ident.data, token->as.ident.length);
+		} break;
+
+		default:
+		{
+		} break;
+	}
+
+	return hash;
+}
+
 lasm_implement_vector_type(lasm_tokens_vector, lasm_token_s);
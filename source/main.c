@@ -17,6 +17,13 @@
 #include "lasm/arena.h"
 #include "lasm/config.h"
 #include "lasm/parser.h"
+#include "lasm/bank.h"
+#include "lasm/layout.h"
+#include "lasm/fixup.h"
+#include "lasm/cycles.h"
+#include "lasm/segment.h"
+#include "lasm/elf.h"
+#include "lasm/disasm.h"
 
 #include <stdlib.h>
 
@@ -24,6 +31,10 @@ static void init(lasm_arena_s* const arena, lasm_config_init_s* const config);
 
 static void build(lasm_arena_s* const arena, lasm_config_build_s* const config);
 
+static void disasm(lasm_arena_s* const arena, lasm_config_disasm_s* const config);
+
+static lasm_labels_vector_s assemble(lasm_arena_s* const arena, lasm_config_build_s* const config, lasm_parser_s* const parser);
+
 int32_t main(int32_t argc, const char_t** argv)
 {
 	lasm_debug_assert(argc > 0);
@@ -44,6 +55,11 @@ int32_t main(int32_t argc, const char_t** argv)
 			build(&arena, &config.as.build);
 		} break;
 
+		case lasm_config_type_disasm:
+		{
+			disasm(&arena, &config.as.disasm);
+		} break;
+
 		default:
 		{
 			lasm_debug_assert(0);  // note: should never happen.
@@ -107,19 +123,137 @@ static void build(lasm_arena_s* const arena, lasm_config_build_s* const config)
 	lasm_debug_assert(config != NULL);
 
 	lasm_parser_s parser = lasm_parser_new(arena, config);
-	lasm_parser_shallow_parse(&parser);
-	const lasm_labels_vector_s labels = lasm_parser_deep_parse(&parser);
+	lasm_labels_vector_s labels = assemble(arena, config, &parser);
+	lasm_cycles_check(config, &labels);
+
+	if (config->stats)
+	{
+		const lasm_arena_stats_s stats = lasm_arena_stats();
+		lasm_logger_info("memory: %lu bytes peak, %lu bytes live, %lu bytes allocated in total, %lu bytes of label tokens released early.",
+			stats.peak, stats.live, stats.total, parser.tokens_released);
+		lasm_logger_info("cache: %lu hits, %lu misses.", parser.cache.hits, parser.cache.misses);
+	}
 
 	for (uint64_t index = 0; index < labels.count; ++index)
 	{
-		lasm_ast_label_s* const label = lasm_labels_vector_at((lasm_labels_vector_s* const)&labels, index);
+		lasm_ast_label_s* const label = lasm_labels_vector_at(&labels, index);
 		lasm_logger_info(lasm_location_fmt "\n%s\n", lasm_location_arg(label->location), lasm_ast_label_to_string(label));
 	}
 
-	// todo: when building the final executable file of provided format, if the
-	// provided format is not specific (e.g. elf or pe), it must be inferred by
-	// the provided architecture.
-	// todo: should check if any label matches the provided entry symbols.
+	const lasm_segments_s segments = lasm_segments_build(arena, &labels);
+	lasm_logger_info("output: %lu labels are grouped into %lu segments.", segments.order_count, segments.segments.count);
+
+	uint64_t entry = 0;
+	uint64_t entry_index = 0;
+
+	if (lasm_symtab_find(&parser.symtab, config->entry, lasm_common_strlen(config->entry), &entry_index))
+	{
+		entry = labels.data[entry_index].attrs[lasm_ast_attr_type_addr].as.addr.value;
+	}
+	else
+	{
+		lasm_logger_warn("entry label '%s' is not defined. the entry address of the executable defaults to 0x0.", config->entry);
+	}
+
+	switch (config->format)
+	{
+		case lasm_format_type_elf:
+		case lasm_format_type_elf32:
+		case lasm_format_type_elf64:
+		{
+			lasm_elf_write(arena, config, &labels, &segments, entry);
+		} break;
+
+		default:
+		{
+			lasm_debug_assert(0);  // note: should never happen.
+		} break;
+	}
 
 	lasm_parser_drop(&parser);
 }
+
+static void disasm(lasm_arena_s* const arena, lasm_config_disasm_s* const config)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+
+	const uint64_t source_length = lasm_common_strlen(config->source);
+	const bool_t assembled = (source_length > 5) && (lasm_common_strcmp(config->source + source_length - 5, ".lasm") == 0);
+
+	// note: the source is assembled without any of the optional passes, so the
+	// instructions IR of each label matches its encoded body.
+	lasm_config_build_s build_config = (lasm_config_build_s)
+	{
+		.arch     = config->arch        ,
+		.format   = lasm_format_type_elf,
+		.entry    = "main"              ,
+		.output   = config->output      ,
+		.source   = config->source      ,
+		.cache    = false               ,
+		.stats    = false               ,
+		.pack     = false               ,
+		.fold     = false               ,
+		.pool     = false               ,
+		.relax    = false               ,
+		.peephole = false               ,
+		.cycles   = false               ,
+	};
+
+	lasm_parser_s parser = {0};
+	lasm_labels_vector_s labels = {0};
+	lasm_regions_vector_s regions = lasm_regions_vector_new(arena, 1);
+
+	if (assembled)
+	{
+		parser = lasm_parser_new(arena, &build_config);
+		labels = assemble(arena, &build_config, &parser);
+		regions = parser.regions;
+	}
+	else
+	{
+		labels = lasm_disasm_read_image(arena, config);
+	}
+
+	const lasm_disasm_stats_s stats = lasm_disasm_write(arena, config, &labels, &regions);
+	lasm_logger_info("disasm: %lu labels are written into %s with %lu instructions and %lu bytes of data.", stats.labels, config->output, stats.insts, stats.bytes);
+
+	if (config->round_trip)
+	{
+		lasm_config_build_s round_trip_config = build_config;
+		round_trip_config.source = config->output;
+
+		lasm_parser_s round_trip_parser = lasm_parser_new(arena, &round_trip_config);
+		const lasm_labels_vector_s reassembled = assemble(arena, &round_trip_config, &round_trip_parser);
+		const uint64_t mismatches = lasm_disasm_compare(&labels, &reassembled);
+		lasm_parser_drop(&round_trip_parser);
+
+		if (mismatches > 0)
+		{
+			lasm_logger_error("round trip: %lu of %lu labels are not reassembled into their original bytes.", mismatches, stats.labels);
+			lasm_common_exit(1);
+		}
+
+		lasm_logger_info("round trip: all %lu labels are reassembled into their original bytes.", stats.labels);
+	}
+
+	if (assembled)
+	{
+		lasm_parser_drop(&parser);
+	}
+}
+
+static lasm_labels_vector_s assemble(lasm_arena_s* const arena, lasm_config_build_s* const config, lasm_parser_s* const parser)
+{
+	lasm_debug_assert(arena != NULL);
+	lasm_debug_assert(config != NULL);
+	lasm_debug_assert(parser != NULL);
+
+	lasm_parser_shallow_parse(parser);
+	lasm_labels_vector_s labels = lasm_parser_deep_parse(parser);
+	lasm_banks_route(arena, config, &labels, &parser->regions);
+	lasm_layout_apply(arena, config, &labels, &parser->symtab, &parser->regions);
+	lasm_layout_verify(arena, &labels, &parser->regions);
+	lasm_fixups_apply(arena, &labels);
+	return labels;
+}